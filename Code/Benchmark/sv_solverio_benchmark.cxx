@@ -0,0 +1,701 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Synthetic benchmark for the solver file I/O in cvsolverIO.
+//
+// Generates restart and geombc style files for a given node count and
+// number of fields in every requested format (ascii/binary, plain/gzip,
+// native/swapped byte order) and times header lookup, data block reads,
+// memory mapped reads, byte swapping and writes.  The timings are written
+// as JSON, to stdout or to the file given with -output.
+//
+// usage: sv_solverio_benchmark [-nodes n] [-fields n] [-dofs n]
+//                              [-iterations n] [-dir path] [-output file]
+//                              [-format ascii|binary|all]
+//                              [-compression none|gzip|all]
+//                              [-endian native|swapped|all] [-keep]
+
+#include "simvascular_solverio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define FLOWSOLVER_MAGIC_NUMBER 362436
+
+struct BenchmarkOptions {
+    int nodes;
+    int fields;
+    int dofs;
+    int iterations;
+    std::string dir;
+    std::string output;
+    std::vector<std::string> formats;
+    std::vector<std::string> compressions;
+    std::vector<std::string> endians;
+    bool keep;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    std::string file;
+    std::string format;
+    std::string compression;
+    std::string endian;
+    double bytes;
+    double count;
+    std::vector<double> seconds;
+};
+
+// one header and its data block, ints or doubles
+struct SyntheticBlock {
+    std::string key;
+    std::vector<int> headerValues;
+    std::vector<int> ints;
+    std::vector<double> doubles;
+    bool isDouble;
+    size_t numItems() const { return isDouble ? doubles.size() : ints.size(); }
+};
+
+struct SyntheticFile {
+    std::string name;
+    std::vector<SyntheticBlock> blocks;
+    size_t dataBytes() const {
+        size_t bytes = 0;
+        for (size_t i = 0; i < blocks.size(); i++) {
+            bytes += blocks[i].numItems()*(blocks[i].isDouble ? sizeof(double) : sizeof(int));
+        }
+        return bytes;
+    }
+};
+
+static double Now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// -----------
+// FileWriter
+// -----------
+// Writes the synthetic files directly so their format does not depend on
+// the code being measured, and so plain files can be made in zlib builds.
+
+class FileWriter {
+public:
+    FileWriter() : fp_(NULL) {
+#ifdef SV_USE_ZLIB
+        gz_ = NULL;
+#endif
+    }
+    int open(const char* filename, bool compress) {
+        if (compress) {
+#ifdef SV_USE_ZLIB
+            gz_ = gzopen(filename,"wb");
+            return (gz_ != NULL);
+#else
+            return 0;
+#endif
+        }
+        fp_ = fopen(filename,"wb");
+        return (fp_ != NULL);
+    }
+    void write(const void* data, size_t nbytes) {
+#ifdef SV_USE_ZLIB
+        if (gz_ != NULL) {
+            // gzwrite takes an unsigned int count
+            const char* p = static_cast<const char*>(data);
+            while (nbytes > 0) {
+                unsigned int n = (unsigned int)std::min(nbytes,(size_t)(1<<30));
+                ::gzwrite(gz_,p,n);
+                p += n;
+                nbytes -= n;
+            }
+            return;
+        }
+#endif
+        fwrite(data,1,nbytes,fp_);
+    }
+    void print(const char* str) {
+        write(str,strlen(str));
+    }
+    void close() {
+#ifdef SV_USE_ZLIB
+        if (gz_ != NULL) ::gzclose(gz_);
+        gz_ = NULL;
+#endif
+        if (fp_ != NULL) fclose(fp_);
+        fp_ = NULL;
+    }
+private:
+    FILE* fp_;
+#ifdef SV_USE_ZLIB
+    gzFile gz_;
+#endif
+};
+
+static void SwapBytes(void* data, size_t nbytes, size_t nItems) {
+    unsigned char* p = static_cast<unsigned char*>(data);
+    for (size_t i = 0; i < nItems; i++) {
+        std::reverse(p+i*nbytes,p+(i+1)*nbytes);
+    }
+}
+
+// ---------------------
+// WriteSyntheticFile
+// ---------------------
+
+static int WriteSyntheticFile(const SyntheticFile& file, const std::string& filename,
+                              bool binary, bool compress, bool swapped) {
+
+    FileWriter writer;
+    if (!writer.open(filename.c_str(),compress)) {
+        fprintf(stderr,"ERROR: could not create (%s).\n",filename.c_str());
+        return 0;
+    }
+
+    char line[1024];
+    writer.print("# SimVascular synthetic benchmark file\n");
+    writer.print("# version : 1\n");
+
+    int magic = FLOWSOLVER_MAGIC_NUMBER;
+    if (binary) {
+        sprintf(line,"byteorder magic number : < %i > 1 \n",(int)sizeof(int)+1);
+        writer.print(line);
+        if (swapped) SwapBytes(&magic,sizeof(int),1);
+        writer.write(&magic,sizeof(int));
+        writer.print("\n");
+    } else {
+        writer.print("byteorder magic number : < 1 > 1 \n");
+        sprintf(line,"%i\n",magic);
+        writer.print(line);
+    }
+
+    std::vector<char> buffer;
+    for (size_t b = 0; b < file.blocks.size(); b++) {
+        const SyntheticBlock& block = file.blocks[b];
+        size_t typeSize = block.isDouble ? sizeof(double) : sizeof(int);
+        size_t nItems = block.numItems();
+        size_t skip = binary ? nItems*typeSize+1 : nItems;
+
+        sprintf(line,"%s : < %lu > ",block.key.c_str(),(unsigned long)skip);
+        std::string header(line);
+        for (size_t i = 0; i < block.headerValues.size(); i++) {
+            sprintf(line,"%i ",block.headerValues[i]);
+            header += line;
+        }
+        header += "\n";
+        writer.print(header.c_str());
+
+        if (binary) {
+            const char* src = block.isDouble ? (const char*)&block.doubles[0] : (const char*)&block.ints[0];
+            buffer.assign(src,src+nItems*typeSize);
+            if (swapped) SwapBytes(&buffer[0],typeSize,nItems);
+            writer.write(&buffer[0],buffer.size());
+            writer.print("\n");
+        } else {
+            for (size_t i = 0; i < nItems; i++) {
+                if (block.isDouble) {
+                    sprintf(line,"%lf\n",block.doubles[i]);
+                } else {
+                    sprintf(line,"%i\n",block.ints[i]);
+                }
+                writer.print(line);
+            }
+        }
+    }
+
+    writer.close();
+    return 1;
+}
+
+// -----------------------
+// MakeSyntheticFiles
+// -----------------------
+// A restart file with the solution plus extra fields of nodes x dofs
+// doubles, and a geombc file with coordinates, the mode number map and
+// a tetrahedral connectivity of about five elements per node.
+
+static void MakeSyntheticFiles(const BenchmarkOptions& options, std::vector<SyntheticFile>& files) {
+
+    int nshg = options.nodes;
+    int ndof = options.dofs;
+    unsigned int seed = 12345;
+
+    SyntheticFile restart;
+    restart.name = "restart";
+    for (int f = 0; f < options.fields; f++) {
+        SyntheticBlock block;
+        if (f == 0) {
+            block.key = "solution";
+        } else if (f == 1) {
+            block.key = "time derivative of solution";
+        } else {
+            char key[64];
+            sprintf(key,"synthetic field %i",f);
+            block.key = key;
+        }
+        block.isDouble = true;
+        block.headerValues.push_back(nshg);
+        block.headerValues.push_back(ndof);
+        block.headerValues.push_back(100);
+        block.doubles.resize((size_t)nshg*ndof);
+        for (size_t i = 0; i < block.doubles.size(); i++) {
+            seed = seed*1103515245 + 12345;
+            block.doubles[i] = (double)(seed >> 8)/(double)(1 << 24) - 0.5;
+        }
+        restart.blocks.push_back(block);
+    }
+    files.push_back(restart);
+
+    SyntheticFile geombc;
+    geombc.name = "geombc";
+
+    SyntheticBlock coords;
+    coords.key = "co-ordinates";
+    coords.isDouble = true;
+    coords.headerValues.push_back(nshg);
+    coords.headerValues.push_back(3);
+    coords.doubles.resize((size_t)nshg*3);
+    for (size_t i = 0; i < coords.doubles.size(); i++) {
+        seed = seed*1103515245 + 12345;
+        coords.doubles[i] = (double)(seed >> 8)/(double)(1 << 24);
+    }
+    geombc.blocks.push_back(coords);
+
+    SyntheticBlock modeMap;
+    modeMap.key = "mode number map";
+    modeMap.isDouble = false;
+    modeMap.headerValues.push_back(nshg);
+    modeMap.ints.resize(nshg);
+    for (int i = 0; i < nshg; i++) {
+        modeMap.ints[i] = i+1;
+    }
+    geombc.blocks.push_back(modeMap);
+
+    int nelem = 5*nshg;
+    SyntheticBlock conn;
+    conn.key = "connectivity interior linear tetrahedron";
+    conn.isDouble = false;
+    conn.headerValues.push_back(nelem);
+    conn.headerValues.push_back(4);
+    conn.ints.resize((size_t)nelem*4);
+    for (size_t i = 0; i < conn.ints.size(); i++) {
+        seed = seed*1103515245 + 12345;
+        conn.ints[i] = (int)((seed >> 8) % (unsigned int)nshg) + 1;
+    }
+    geombc.blocks.push_back(conn);
+
+    files.push_back(geombc);
+}
+
+// -------------------
+// Benchmark kernels
+// -------------------
+// Each returns the elapsed seconds, or a negative value on failure.
+
+static double TimeHeaderLookup(const SyntheticFile& file, const std::string& filename,
+                               const char* iotype, int lookups) {
+    cvsolverIO io;
+    double start = Now();
+    if (io.openFile(filename.c_str(),"read") != CVSOLVER_IO_OK) return -1;
+    // walk the headers backwards so every lookup has to search
+    int values[8];
+    for (int n = 0; n < lookups; n++) {
+        const SyntheticBlock& block = file.blocks[file.blocks.size()-1-(n % file.blocks.size())];
+        int nvalues = std::min((int)block.headerValues.size(),8);
+        values[0] = -1;
+        io.readHeader(block.key.c_str(),values,nvalues,block.isDouble ? "double" : "integer",iotype);
+        if (values[0] != block.headerValues[0]) {
+            io.closeFile();
+            return -1;
+        }
+    }
+    io.closeFile();
+    return Now() - start;
+}
+
+// Compares the blocks read back to back into buffer with the values
+// they were written from, ascii doubles are rounded by %lf.
+static bool CheckBlocks(const SyntheticFile& file, const std::vector<char>& buffer) {
+    size_t offset = 0;
+    for (size_t b = 0; b < file.blocks.size(); b++) {
+        const SyntheticBlock& block = file.blocks[b];
+        if (block.isDouble) {
+            const double* d = reinterpret_cast<const double*>(&buffer[offset]);
+            for (size_t i = 0; i < block.numItems(); i++) {
+                if (fabs(d[i]-block.doubles[i]) > 1e-5) return false;
+            }
+            offset += block.numItems()*sizeof(double);
+        } else {
+            if (memcmp(&buffer[offset],&block.ints[0],block.numItems()*sizeof(int)) != 0) return false;
+            offset += block.numItems()*sizeof(int);
+        }
+    }
+    return true;
+}
+
+static double TimeBlockRead(const SyntheticFile& file, const std::string& filename,
+                            const char* iotype) {
+    cvsolverIO io;
+    std::vector<char> buffer(file.dataBytes());
+    double start = Now();
+    if (io.openFile(filename.c_str(),"read") != CVSOLVER_IO_OK) return -1;
+    size_t offset = 0;
+    int values[8];
+    for (size_t b = 0; b < file.blocks.size(); b++) {
+        const SyntheticBlock& block = file.blocks[b];
+        int nvalues = std::min((int)block.headerValues.size(),8);
+        const char* type = block.isDouble ? "double" : "integer";
+        io.readHeader(block.key.c_str(),values,nvalues,type,iotype);
+        if (io.readDataBlock(block.key.c_str(),&buffer[offset],(int)block.numItems(),type,iotype) != CVSOLVER_IO_OK) {
+            io.closeFile();
+            return -1;
+        }
+        offset += block.numItems()*(block.isDouble ? sizeof(double) : sizeof(int));
+    }
+    io.closeFile();
+    double elapsed = Now() - start;
+
+    if (!CheckBlocks(file,buffer)) return -1;
+
+    return elapsed;
+}
+
+static double TimeMappedRead(const SyntheticFile& file, const std::string& filename) {
+    cvsolverIO io;
+    std::vector<char> buffer(file.dataBytes());
+    double start = Now();
+    if (io.openFile(filename.c_str(),"mapped") != CVSOLVER_IO_OK) return -1;
+    if (!io.isMapped()) {
+        io.closeFile();
+        return -1;
+    }
+    // copy every value out of the mapping, the same work as the read
+    // path does into its caller's array
+    size_t offset = 0;
+    int values[8];
+    for (size_t b = 0; b < file.blocks.size(); b++) {
+        const SyntheticBlock& block = file.blocks[b];
+        int nvalues = std::min((int)block.headerValues.size(),8);
+        const char* type = block.isDouble ? "double" : "integer";
+        const void* data = NULL;
+        io.readHeader(block.key.c_str(),values,nvalues,type,"binary");
+        if (io.mapDataBlock(block.key.c_str(),&data,(int)block.numItems(),type,"binary") != CVSOLVER_IO_OK) {
+            io.closeFile();
+            return -1;
+        }
+        size_t nbytes = block.numItems()*(block.isDouble ? sizeof(double) : sizeof(int));
+        memcpy(&buffer[offset],data,nbytes);
+        offset += nbytes;
+    }
+    io.closeFile();
+    double elapsed = Now() - start;
+
+    if (!CheckBlocks(file,buffer)) return -1;
+
+    return elapsed;
+}
+
+static double TimeByteSwap(size_t numDoubles) {
+    std::vector<double> data(numDoubles,1.0);
+    cvsolverIO io;
+    double start = Now();
+    io.SwapArrayByteOrder(&data[0],sizeof(double),(int)numDoubles);
+    return Now() - start;
+}
+
+static double TimeWrite(const SyntheticFile& file, const std::string& filename,
+                        const char* iotype) {
+    cvsolverIO io;
+    double start = Now();
+    if (io.openFile(filename.c_str(),"write") != CVSOLVER_IO_OK) return -1;
+    int magic = FLOWSOLVER_MAGIC_NUMBER;
+    int one = 1;
+    io.writeHeader("byteorder magic number",&one,1,1,"integer",iotype);
+    io.writeDataBlock("byteorder magic number",&magic,1,"integer",iotype);
+    for (size_t b = 0; b < file.blocks.size(); b++) {
+        const SyntheticBlock& block = file.blocks[b];
+        const char* type = block.isDouble ? "double" : "integer";
+        void* data = block.isDouble ? (void*)&block.doubles[0] : (void*)&block.ints[0];
+        io.writeHeader(block.key.c_str(),(void*)&block.headerValues[0],(int)block.headerValues.size(),
+                       (int)block.numItems(),type,iotype);
+        if (io.writeDataBlock(block.key.c_str(),data,(int)block.numItems(),type,iotype) != CVSOLVER_IO_OK) {
+            io.closeFile();
+            return -1;
+        }
+    }
+    io.closeFile();
+    return Now() - start;
+}
+
+// ---------------
+// JSON output
+// ---------------
+
+static void WriteJSON(FILE* fp, const BenchmarkOptions& options, const std::vector<BenchmarkResult>& results) {
+
+    fprintf(fp,"{\n");
+    fprintf(fp,"  \"benchmark\": \"solverio\",\n");
+    fprintf(fp,"  \"config\": {\n");
+    fprintf(fp,"    \"nodes\": %i,\n",options.nodes);
+    fprintf(fp,"    \"fields\": %i,\n",options.fields);
+    fprintf(fp,"    \"dofs\": %i,\n",options.dofs);
+    fprintf(fp,"    \"iterations\": %i,\n",options.iterations);
+#ifdef SV_USE_ZLIB
+    fprintf(fp,"    \"zlib\": true\n");
+#else
+    fprintf(fp,"    \"zlib\": false\n");
+#endif
+    fprintf(fp,"  },\n");
+    fprintf(fp,"  \"results\": [\n");
+    for (size_t r = 0; r < results.size(); r++) {
+        const BenchmarkResult& res = results[r];
+        double minTime = *std::min_element(res.seconds.begin(),res.seconds.end());
+        double maxTime = *std::max_element(res.seconds.begin(),res.seconds.end());
+        double meanTime = 0;
+        for (size_t i = 0; i < res.seconds.size(); i++) meanTime += res.seconds[i];
+        meanTime /= res.seconds.size();
+        double best = (minTime > 0) ? minTime : 1e-12;
+        fprintf(fp,"    {\"name\": \"%s\", \"file\": \"%s\", \"format\": \"%s\", \"compression\": \"%s\", \"endian\": \"%s\",\n",
+                res.name.c_str(),res.file.c_str(),res.format.c_str(),res.compression.c_str(),res.endian.c_str());
+        fprintf(fp,"     \"bytes\": %.0f, \"count\": %.0f, \"seconds_min\": %.9f, \"seconds_mean\": %.9f, \"seconds_max\": %.9f,\n",
+                res.bytes,res.count,minTime,meanTime,maxTime);
+        fprintf(fp,"     \"mb_per_s\": %.3f, \"per_s\": %.3f}%s\n",
+                res.bytes/best/1.0e6,res.count/best,(r+1 < results.size()) ? "," : "");
+    }
+    fprintf(fp,"  ]\n");
+    fprintf(fp,"}\n");
+}
+
+// ---------------
+// main
+// ---------------
+
+static void ParseChoice(const char* value, const char* a, const char* b, std::vector<std::string>& out) {
+    out.clear();
+    if (!strcmp(value,"all")) {
+        out.push_back(a);
+        out.push_back(b);
+    } else {
+        out.push_back(value);
+    }
+}
+
+static int Usage(const char* prog) {
+    fprintf(stderr,"usage: %s [-nodes n] [-fields n] [-dofs n] [-iterations n] [-dir path]\n",prog);
+    fprintf(stderr,"          [-output file] [-format ascii|binary|all]\n");
+    fprintf(stderr,"          [-compression none|gzip|all] [-endian native|swapped|all] [-keep]\n");
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+
+    BenchmarkOptions options;
+    options.nodes = 100000;
+    options.fields = 4;
+    options.dofs = 5;
+    options.iterations = 5;
+    options.dir = ".";
+    options.keep = false;
+    ParseChoice("all","binary","ascii",options.formats);
+    ParseChoice("all","none","gzip",options.compressions);
+    ParseChoice("all","native","swapped",options.endians);
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "-keep") {
+            options.keep = true;
+            continue;
+        }
+        if (i+1 >= argc) return Usage(argv[0]);
+        const char* value = argv[++i];
+        if (arg == "-nodes") options.nodes = atoi(value);
+        else if (arg == "-fields") options.fields = atoi(value);
+        else if (arg == "-dofs") options.dofs = atoi(value);
+        else if (arg == "-iterations") options.iterations = atoi(value);
+        else if (arg == "-dir") options.dir = value;
+        else if (arg == "-output") options.output = value;
+        else if (arg == "-format") ParseChoice(value,"binary","ascii",options.formats);
+        else if (arg == "-compression") ParseChoice(value,"none","gzip",options.compressions);
+        else if (arg == "-endian") ParseChoice(value,"native","swapped",options.endians);
+        else return Usage(argv[0]);
+    }
+
+    if (options.nodes < 1 || options.fields < 1 || options.dofs < 1 || options.iterations < 1) {
+        return Usage(argv[0]);
+    }
+
+#ifndef SV_USE_ZLIB
+    // without zlib every file is plain
+    options.compressions.erase(std::remove(options.compressions.begin(),options.compressions.end(),"gzip"),
+                               options.compressions.end());
+    if (options.compressions.empty()) {
+        fprintf(stderr,"ERROR: gzip compression needs a zlib build.\n");
+        return 1;
+    }
+#endif
+
+    std::vector<SyntheticFile> files;
+    MakeSyntheticFiles(options,files);
+
+    std::vector<BenchmarkResult> results;
+    int failures = 0;
+
+    for (size_t f = 0; f < files.size(); f++) {
+      const SyntheticFile& file = files[f];
+      int numBlocks = file.blocks.size();
+      for (size_t fm = 0; fm < options.formats.size(); fm++) {
+        const std::string& format = options.formats[fm];
+        bool binary = (format == "binary");
+        for (size_t c = 0; c < options.compressions.size(); c++) {
+          const std::string& compression = options.compressions[c];
+          bool compress = (compression == "gzip");
+          for (size_t e = 0; e < options.endians.size(); e++) {
+            const std::string& endian = options.endians[e];
+            bool swapped = (endian == "swapped");
+            // byte order only matters for binary files
+            if (!binary && e > 0) continue;
+
+            std::string filename = options.dir + "/sv_solverio_benchmark." + file.name + "." +
+                                   format + "." + compression + "." + (binary ? endian : "text");
+            if (!WriteSyntheticFile(file,filename,binary,compress,swapped)) {
+                return 1;
+            }
+
+            BenchmarkResult lookup;
+            lookup.name = "header_lookup";
+            lookup.count = 10*numBlocks;
+            lookup.bytes = 0;
+
+            BenchmarkResult read;
+            read.name = "block_read";
+            read.count = numBlocks;
+            read.bytes = file.dataBytes();
+
+            BenchmarkResult mapped;
+            mapped.name = "mapped_read";
+            mapped.count = numBlocks;
+            mapped.bytes = file.dataBytes();
+            bool canMap = binary && !compress;
+#ifdef _WIN32
+            canMap = false;
+#endif
+
+            BenchmarkResult* all[3] = {&lookup,&read,&mapped};
+            for (int k = 0; k < 3; k++) {
+                all[k]->file = file.name;
+                all[k]->format = format;
+                all[k]->compression = compression;
+                all[k]->endian = binary ? endian : "text";
+            }
+
+            const char* iotype = binary ? "binary" : "ascii";
+            for (int it = 0; it < options.iterations; it++) {
+                lookup.seconds.push_back(TimeHeaderLookup(file,filename,iotype,(int)lookup.count));
+                read.seconds.push_back(TimeBlockRead(file,filename,iotype));
+                if (canMap) mapped.seconds.push_back(TimeMappedRead(file,filename));
+            }
+
+            for (int k = 0; k < 3; k++) {
+                if (all[k]->seconds.empty()) continue;
+                if (*std::min_element(all[k]->seconds.begin(),all[k]->seconds.end()) < 0) {
+                    fprintf(stderr,"ERROR: %s failed on (%s).\n",all[k]->name.c_str(),filename.c_str());
+                    failures++;
+                    continue;
+                }
+                results.push_back(*all[k]);
+            }
+
+            // write with cvsolverIO itself, once per format, compressed
+            // whenever zlib is used
+            if (c == 0 && e == 0) {
+                BenchmarkResult write;
+                write.name = "write";
+                write.file = file.name;
+                write.format = format;
+#ifdef SV_USE_ZLIB
+                write.compression = "gzip";
+#else
+                write.compression = "none";
+#endif
+                write.endian = binary ? "native" : "text";
+                write.count = numBlocks;
+                write.bytes = file.dataBytes();
+                std::string outname = filename + ".out";
+                for (int it = 0; it < options.iterations; it++) {
+                    write.seconds.push_back(TimeWrite(file,outname,iotype));
+                }
+                if (!options.keep) remove(outname.c_str());
+                if (*std::min_element(write.seconds.begin(),write.seconds.end()) < 0) {
+                    fprintf(stderr,"ERROR: write failed on (%s).\n",outname.c_str());
+                    failures++;
+                } else {
+                    results.push_back(write);
+                }
+            }
+
+            if (!options.keep) remove(filename.c_str());
+          }
+        }
+      }
+    }
+
+    BenchmarkResult swap;
+    swap.name = "byte_swap";
+    swap.file = "memory";
+    swap.format = "binary";
+    swap.compression = "none";
+    swap.endian = "swapped";
+    swap.count = (double)options.nodes*options.dofs;
+    swap.bytes = swap.count*sizeof(double);
+    for (int it = 0; it < options.iterations; it++) {
+        swap.seconds.push_back(TimeByteSwap((size_t)options.nodes*options.dofs));
+    }
+    results.push_back(swap);
+
+    FILE* fp = stdout;
+    if (!options.output.empty()) {
+        fp = fopen(options.output.c_str(),"w");
+        if (fp == NULL) {
+            fprintf(stderr,"ERROR: could not open (%s).\n",options.output.c_str());
+            return 1;
+        }
+    }
+    WriteJSON(fp,options,results);
+    if (fp != stdout) fclose(fp);
+
+    return (failures == 0) ? 0 : 1;
+}
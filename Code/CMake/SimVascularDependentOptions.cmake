@@ -152,7 +152,7 @@ endif()
 
 #-----------------------------------------------------------------------------
 # SolverIO
-if(SV_USE_MESHSIM_ADAPTOR OR SV_USE_TETGEN_ADAPTOR)
+if(SV_USE_MESHSIM_ADAPTOR OR SV_USE_TETGEN_ADAPTOR OR SV_USE_SV4_GUI OR SV_BUILD_BENCHMARKS)
   set(SV_USE_SOLVERIO ON)
 endif()
 #-----------------------------------------------------------------------------
@@ -62,6 +62,11 @@ set_property(CACHE SV_LIBRARY_TYPE PROPERTY STRINGS STATIC SHARED)
 option(SV_SUPPRESS_WARNINGS "Option to suppress all compiler warnings while compiling" ON)
 #-----------------------------------------------------------------------------
 
+#-----------------------------------------------------------------------------
+# Benchmarks
+option(SV_BUILD_BENCHMARKS "Option to build the benchmark executables in Benchmark" OFF)
+#-----------------------------------------------------------------------------
+
 #-----------------------------------------------------------------------------
 # Solver stuff
 option(SV_USE_THREEDSOLVER "Option to build flowsolver modules (requires Fortran)" OFF)
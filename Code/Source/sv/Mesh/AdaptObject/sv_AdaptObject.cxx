@@ -60,6 +60,16 @@ cvAdaptObject::~cvAdaptObject()
   ;
 }
 
+// ----------------------------
+// LoadAvgSolutionsFromFiles
+// ----------------------------
+// Not pure so kernels without file averaging still build
+int cvAdaptObject::LoadAvgSolutionsFromFiles(char *filePattern)
+{
+  fprintf(stderr,"Averaging solutions from files is not supported by this adapt kernel\n");
+  return SV_ERROR;
+}
+
 // ----------------------------
 // DefaultInstantiateAdaptObject
 // ----------------------------
@@ -116,6 +116,7 @@ public:
   virtual int ReadSolutionFromMesh()=0;
   virtual int ReadYbarFromMesh()=0;
   virtual int ReadAvgSpeedFromMesh()=0;
+  virtual int LoadAvgSolutionsFromFiles(char *filePattern);
 
   //Setup Operations
   virtual int SetAdaptOptions(char *flag,double value)=0;
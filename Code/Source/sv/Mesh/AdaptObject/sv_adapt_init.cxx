@@ -85,6 +85,8 @@ static int cvAdapt_ReadSolutionFromMeshMtd( ClientData clientData, Tcl_Interp *i
 		   int argc, CONST84 char *argv[] );
 static int cvAdapt_ReadYbarFromMeshMtd( ClientData clientData, Tcl_Interp *interp,
 		   int argc, CONST84 char *argv[] );
+static int cvAdapt_LoadAvgSolutionsFromFilesMtd( ClientData clientData, Tcl_Interp *interp,
+		   int argc, CONST84 char *argv[] );
 static int cvAdapt_ReadAvgSpeedFromMeshMtd( ClientData clientData, Tcl_Interp *interp,
 		   int argc, CONST84 char *argv[] );
 static int cvAdapt_SetAdaptOptionsMtd( ClientData clientData, Tcl_Interp *interp,
@@ -291,6 +293,10 @@ int cvAdapt_ObjectCmd( ClientData clientData, Tcl_Interp *interp,
     if ( cvAdapt_ReadYbarFromMeshMtd( clientData, interp, argc, argv ) != TCL_OK ) {
       return TCL_ERROR;
     }
+  } else if ( Tcl_StringMatch( argv[1], "LoadAvgSolutionsFromFiles" ) ) {
+    if ( cvAdapt_LoadAvgSolutionsFromFilesMtd( clientData, interp, argc, argv ) != TCL_OK ) {
+      return TCL_ERROR;
+    }
   } else if ( Tcl_StringMatch( argv[1], "ReadAvgSpeedFromMesh" ) ) {
     if ( cvAdapt_ReadAvgSpeedFromMeshMtd( clientData, interp, argc, argv ) != TCL_OK ) {
       return TCL_ERROR;
@@ -380,6 +386,7 @@ static void AdaptPrintMethods( Tcl_Interp *interp )
   tcl_printstr(interp, "ReadSolutionFromMesh\n");
   tcl_printstr(interp, "ReadYbarFromMesh\n");
   tcl_printstr(interp, "ReadAvgSpeedFromMesh\n");
+  tcl_printstr(interp, "LoadAvgSolutionsFromFiles\n");
   tcl_printstr(interp, "SetAdaptOptions\n");
   tcl_printstr(interp, "CheckOptions\n");
   tcl_printstr(interp, "SetMetric\n");
@@ -715,6 +722,47 @@ static int cvAdapt_ReadYbarFromMeshMtd( ClientData clientData, Tcl_Interp *inter
   return TCL_OK;
 }
 
+// ----------------
+// cvAdapt_LoadAvgSolutionsFromFilesMtd
+// ----------------
+static int cvAdapt_LoadAvgSolutionsFromFilesMtd( ClientData clientData, Tcl_Interp *interp,
+		   int argc, CONST84 char *argv[] )
+{
+  char *filePattern = NULL;
+
+  char *usage;
+
+  int table_sz = 1;
+  ARG_Entry arg_table[] = {
+    { "-file_pattern", STRING_Type, &filePattern, NULL, REQUIRED, 0, { 0 } },
+  };
+  usage = ARG_GenSyntaxStr( 2, argv, table_sz, arg_table );
+  if ( argc == 2 ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_OK;
+  }
+  if ( ARG_ParseTclStr( interp, argc, argv, 2,
+			table_sz, arg_table ) != TCL_OK ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_ERROR;
+  }
+
+  // Do work of command:
+
+  cvAdaptObject *geom = (cvAdaptObject *)clientData;
+  if ( geom == NULL ) {
+    fprintf(stderr,"Adapt object should already be created! It is NULL\n");
+    return TCL_ERROR;
+  }
+  if (geom->LoadAvgSolutionsFromFiles(filePattern) != SV_OK)
+  {
+    fprintf(stderr,"Error in averaging of solutions\n");
+    return TCL_ERROR;
+  }
+
+  return TCL_OK;
+}
+
 // ----------------
 // cvAdapt_ReadAvgSpeedFromMeshMtd
 // ----------------
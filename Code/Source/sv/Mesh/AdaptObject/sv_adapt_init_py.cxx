@@ -91,6 +91,7 @@ static PyObject* cvAdapt_LoadHessianFromFileMtd( pyAdaptObject* self, PyObject*
 static PyObject* cvAdapt_ReadSolutionFromMeshMtd( pyAdaptObject* self, PyObject* args);
 static PyObject* cvAdapt_ReadYbarFromMeshMtd( pyAdaptObject* self, PyObject* args);
 static PyObject* cvAdapt_ReadAvgSpeedFromMeshMtd( pyAdaptObject* self, PyObject* args);
+static PyObject* cvAdapt_LoadAvgSolutionsFromFilesMtd( pyAdaptObject* self, PyObject* args);
 static PyObject* cvAdapt_SetAdaptOptionsMtd( pyAdaptObject* self, PyObject* args);
 static PyObject* cvAdapt_CheckOptionsMtd( pyAdaptObject* self, PyObject* args);
 static PyObject* cvAdapt_SetMetricMtd( pyAdaptObject* self, PyObject* args);
@@ -149,6 +150,8 @@ static PyMethodDef pyAdaptObject_methods[]={
     (PyCFunction)cvAdapt_ReadYbarFromMeshMtd,METH_VARARGS,NULL},
   { "ReadAvgSpeedFromMesh",
     (PyCFunction)cvAdapt_ReadAvgSpeedFromMeshMtd,METH_VARARGS,NULL},
+  { "LoadAvgSolutionsFromFiles",
+    (PyCFunction)cvAdapt_LoadAvgSolutionsFromFilesMtd,METH_VARARGS,NULL},
   { "SetAdaptOptions",
     (PyCFunction)cvAdapt_SetAdaptOptionsMtd,METH_VARARGS,NULL},
   { "CheckOptions",
@@ -473,6 +476,7 @@ static void AdaptPrintMethods()
   PySys_WriteStdout( "ReadSolutionFromMesh\n");
   PySys_WriteStdout( "ReadYbarFromMesh\n");
   PySys_WriteStdout( "ReadAvgSpeedFromMesh\n");
+  PySys_WriteStdout( "LoadAvgSolutionsFromFiles\n");
   PySys_WriteStdout( "SetAdaptOptions\n");
   PySys_WriteStdout( "CheckOptions\n");
   PySys_WriteStdout( "SetMetric\n");
@@ -729,6 +733,35 @@ static PyObject* cvAdapt_ReadAvgSpeedFromMeshMtd( pyAdaptObject* self, PyObject*
   return SV_PYTHON_OK;
 }
 
+// ----------------
+// cvAdapt_LoadAvgSolutionsFromFilesMtd
+// ----------------
+static PyObject* cvAdapt_LoadAvgSolutionsFromFilesMtd( pyAdaptObject* self, PyObject* args)
+{
+  char *filePattern = NULL;
+
+  if(!(PyArg_ParseTuple(args,"s",&filePattern)))
+  {
+    PyErr_SetString(PyRunTimeErr,"Could not import one char, filePattern.");
+    return NULL;
+  }
+
+  // Do work of command:
+
+  cvAdaptObject *geom = self->geom;
+  if ( geom == NULL ) {
+    PyErr_SetString(PyRunTimeErr,"Adapt object should already be created! It is NULL\n");
+    return NULL;
+  }
+  if (geom->LoadAvgSolutionsFromFiles(filePattern) != SV_OK)
+  {
+    PyErr_SetString(PyRunTimeErr,"Error in averaging of solutions\n");
+    return NULL;
+  }
+
+  return SV_PYTHON_OK;
+}
+
 // ----------------
 // cvAdapt_SetAdaptOptionsMtd
 // ----------------
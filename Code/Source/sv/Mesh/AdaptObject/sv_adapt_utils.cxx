@@ -58,12 +58,20 @@
 #include "vtkPolygon.h"
 #include "vtkIdList.h"
 #include "vtkTetra.h"
+#include "vtkSMPTools.h"
+#include "vtkMath.h"
 
 #include "sv_eispack.h"
 
 #include "simvascular_solverio.h"
 
 #include <sys/stat.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #ifdef WIN32
 void  bzero(void* ptr, size_t sz) {
@@ -89,100 +97,229 @@ bool AdaptUtils_file_exists(const std::string& name) {
   return (stat (name.c_str(), &buffer) == 0);
 }
 
+// -----------------------------
+// Interior point adjacency
+// -----------------------------
+// The patch around a point is stored in compressed row form: the interior
+// points sharing a cell with point i are ids[offsets[i]..offsets[i+1]), in
+// the order they are first met walking the point's cells.  That is the
+// order vtkIdList::InsertUniqueId used to produce, so sums over the patch
+// are done in the same order as before.  The mesh is walked once, in
+// parallel over blocks of points, each block keeping its rows until the
+// offsets are known and they are copied into place.
+
+static const vtkIdType AdaptUtilsPatchBlockSize = 1024;
+
+struct AdaptUtilsPatchBlock {
+  std::vector<vtkIdType> counts;
+  std::vector<vtkIdType> ids;
+};
+
+// Drops repeated ids from patch, keeping the first of each.  Sorting
+// (id, position) pairs keeps this n log n in the number of cell points.
+static void AdaptUtils_uniquePatch(std::vector<vtkIdType> &patch,
+                                   std::vector<std::pair<vtkIdType,vtkIdType> > &sorted,
+                                   std::vector<char> &keep)
+{
+  size_t n = patch.size();
+  sorted.resize(n);
+  for (size_t k=0;k<n;k++)
+    sorted[k] = std::make_pair(patch[k],(vtkIdType) k);
+  std::sort(sorted.begin(),sorted.end());
+
+  keep.assign(n,0);
+  for (size_t k=0;k<n;k++)
+  {
+    if (k == 0 || sorted[k].first != sorted[k-1].first)
+      keep[sorted[k].second] = 1;
+  }
+
+  size_t numKept = 0;
+  for (size_t k=0;k<n;k++)
+  {
+    if (keep[k])
+      patch[numKept++] = patch[k];
+  }
+  patch.resize(numKept);
+}
+
+struct AdaptUtilsPatchCollectFunctor {
+  vtkUnstructuredGrid *mesh;
+  bool *pointOnSurface;
+  vtkIdType numVerts;
+  AdaptUtilsPatchBlock *blocks;
+
+  void operator()(vtkIdType beginBlock, vtkIdType endBlock) {
+    vtkSmartPointer<vtkIdList> patchElements = vtkSmartPointer<vtkIdList>::New();
+    std::vector<vtkIdType> patch;
+    std::vector<std::pair<vtkIdType,vtkIdType> > sorted;
+    std::vector<char> keep;
+    vtkIdType npts;
+    vtkIdType *pts;
+
+    for (vtkIdType b=beginBlock;b<endBlock;b++)
+    {
+      AdaptUtilsPatchBlock &block = blocks[b];
+      vtkIdType end = std::min((b+1)*AdaptUtilsPatchBlockSize,numVerts);
+      for (vtkIdType pointId=b*AdaptUtilsPatchBlockSize;pointId<end;pointId++)
+      {
+        patch.clear();
+        mesh->GetPointCells(pointId,patchElements);
+        for (vtkIdType cellId=0;cellId<patchElements->GetNumberOfIds();cellId++)
+        {
+          mesh->GetCellPoints(patchElements->GetId(cellId),npts,pts);
+          for (vtkIdType j=0;j<npts;j++)
+          {
+            if (pointOnSurface[pts[j]] == false)
+              patch.push_back(pts[j]);
+          }
+        }
+        AdaptUtils_uniquePatch(patch,sorted,keep);
+
+        block.counts.push_back((vtkIdType) patch.size());
+        block.ids.insert(block.ids.end(),patch.begin(),patch.end());
+      }
+    }
+  }
+};
+
+struct AdaptUtilsPatchCopyFunctor {
+  vtkIdType *offsets;
+  vtkIdType *ids;
+  AdaptUtilsPatchBlock *blocks;
+
+  void operator()(vtkIdType beginBlock, vtkIdType endBlock) {
+    for (vtkIdType b=beginBlock;b<endBlock;b++)
+    {
+      AdaptUtilsPatchBlock &block = blocks[b];
+      if (!block.ids.empty())
+        std::copy(block.ids.begin(),block.ids.end(),ids+offsets[b*AdaptUtilsPatchBlockSize]);
+      std::vector<vtkIdType>().swap(block.ids);
+    }
+  }
+};
+
+static void AdaptUtils_buildInteriorAdjacency(vtkUnstructuredGrid *mesh,bool *pointOnSurface,
+                                              std::vector<vtkIdType> &offsets,
+                                              std::vector<vtkIdType> &ids)
+{
+  vtkIdType numVerts = mesh->GetNumberOfPoints();
+  vtkIdType numBlocks = (numVerts+AdaptUtilsPatchBlockSize-1)/AdaptUtilsPatchBlockSize;
+  std::vector<AdaptUtilsPatchBlock> blocks(numBlocks);
+
+  mesh->BuildLinks();
+
+  AdaptUtilsPatchCollectFunctor collect;
+  collect.mesh = mesh;
+  collect.pointOnSurface = pointOnSurface;
+  collect.numVerts = numVerts;
+  collect.blocks = blocks.empty() ? NULL : &blocks[0];
+  vtkSMPTools::For(0,numBlocks,collect);
+
+  offsets.assign(numVerts+1,0);
+  vtkIdType pointId = 0;
+  for (vtkIdType b=0;b<numBlocks;b++)
+  {
+    for (size_t k=0;k<blocks[b].counts.size();k++,pointId++)
+      offsets[pointId+1] = offsets[pointId]+blocks[b].counts[k];
+  }
+
+  ids.resize(offsets[numVerts]);
+
+  AdaptUtilsPatchCopyFunctor copy;
+  copy.offsets = &offsets[0];
+  copy.ids = ids.empty() ? NULL : &ids[0];
+  copy.blocks = collect.blocks;
+  vtkSMPTools::For(0,numBlocks,copy);
+}
+
+struct AdaptUtilsSmoothFunctor {
+  const double *nodal;
+  const vtkIdType *offsets;
+  const vtkIdType *ids;
+  double *average;
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    for (vtkIdType pointId=begin;pointId<end;pointId++)
+    {
+      double sum[6];
+      const double *own = &nodal[6*pointId];
+      for (int j=0;j<6;j++)
+        sum[j] = 0.0 + own[j];
+
+      vtkIdType numSurroundingVerts = offsets[pointId+1]-offsets[pointId];
+      for (vtkIdType k=offsets[pointId];k<offsets[pointId+1];k++)
+      {
+        const double *nbr = &nodal[6*ids[k]];
+        for (int j=0;j<6;j++)
+          sum[j] = sum[j] + nbr[j];
+      }
+      if (numSurroundingVerts != 0)
+      {
+        for (int j=0;j<6;j++)
+          sum[j] = sum[j]/numSurroundingVerts;
+      }
+
+      double *out = &average[6*pointId];
+      for (int j=0;j<6;j++)
+        out[j] = sum[j];
+    }
+  }
+};
+
 // -----------------------------
 // SmoothHessians()
 // -----------------------------
 /**
  * @brief simple average over a patch surrounding the vertex
  * @note This smooths the hessians by patch method
+ * @note The patch adjacency is built once and the average is computed in
+ * parallel over the raw hessian arrays
  */
 //
 int AdaptUtils_SmoothHessians(vtkUnstructuredGrid *mesh)
 {
-  int i,j,k;
-  int numVerts;
-  int numSurroundingVerts;
-  double newHessian;
-  double averageHessian[6];
-  double nodalHessian[6];
-  vtkIdType checkPt;
-  vtkIdType npts;
-  vtkIdType *pts;
-  vtkIdType p1,p2;
-  vtkIdType pointId,cellId;
-  vtkIdType surfacePt,volumePt;
-  vtkIdType surfacePtId;
+  vtkIdType numVerts;
+  std::vector<vtkIdType> offsets;
+  std::vector<vtkIdType> ids;
 
   vtkSmartPointer<vtkDoubleArray>  averageHessians =
     vtkSmartPointer<vtkDoubleArray>::New();
   vtkSmartPointer<vtkDoubleArray>  nodalHessians =
     vtkSmartPointer<vtkDoubleArray>::New();
-  vtkSmartPointer<vtkIdList> patchElements =
-    vtkSmartPointer<vtkIdList>::New();
 
   numVerts = mesh->GetNumberOfPoints();
-  bool *pointOnSurface = new bool[numVerts];
+
+  nodalHessians = vtkDoubleArray::SafeDownCast(mesh->GetPointData()->GetArray("hessians"));
+  if (nodalHessians == NULL || nodalHessians->GetNumberOfComponents() != 6)
+  {
+    fprintf(stderr,"Mesh does not have a six component hessians array\n");
+    return SV_ERROR;
+  }
 
   averageHessians->SetNumberOfComponents(6);
-  averageHessians->Allocate(numVerts,10000);
   averageHessians->SetNumberOfTuples(numVerts);
   averageHessians->SetName("averagehessians");
 
-  nodalHessians = vtkDoubleArray::SafeDownCast(mesh->GetPointData()->GetArray("hessians"));
+  bool *pointOnSurface = new bool[numVerts];
 
   //Have no purpose for point mapping here
   AdaptUtils_getSurfaceBooleans(mesh,pointOnSurface);
 
-  for (pointId=0;pointId<numVerts;pointId++)
-  {
-    numSurroundingVerts = 0;
-    for (i=0;i<6;i++)
-    {
-      averageHessian[i] = 0.0;
-      nodalHessian[i] = nodalHessians->GetComponent(pointId,i);
-      averageHessian[i] = averageHessian[i] + nodalHessian[i];
-    }
-    mesh->GetPointCells(pointId,patchElements);
+  AdaptUtils_buildInteriorAdjacency(mesh,pointOnSurface,offsets,ids);
 
-    vtkSmartPointer<vtkIdList> neighborPoints =
-      vtkSmartPointer<vtkIdList>::New();
-    for (cellId=0;cellId<patchElements->GetNumberOfIds();cellId++)
-    {
-      mesh->GetCellPoints(patchElements->GetId(cellId),npts,pts);
-      for (j=0;j<npts;j++)
-      {
-	if (pointOnSurface[pts[j]] == false)
-	{
-	  neighborPoints->InsertUniqueId(pts[j]);
-	}
-      }
-    }
-    numSurroundingVerts = neighborPoints->GetNumberOfIds();
+  delete [] pointOnSurface;
 
-    if (numSurroundingVerts != 0)
-    {
-      for (i=0;i<numSurroundingVerts;i++)
-      {
-	checkPt = neighborPoints->GetId(i);
-	for (j=0;j<6;j++)
-	{
-	  newHessian = nodalHessians->GetComponent(checkPt,j);
-	  averageHessian[j] = averageHessian[j] + newHessian;
-	}
-      }
-      for (i=0;i<6;i++)
-      {
-	averageHessian[i] = averageHessian[i]/numSurroundingVerts;
-      }
-    }
-    averageHessians->SetTuple(pointId,averageHessian);
-  }
+  AdaptUtilsSmoothFunctor smooth;
+  smooth.nodal = nodalHessians->GetPointer(0);
+  smooth.offsets = &offsets[0];
+  smooth.ids = ids.empty() ? NULL : &ids[0];
+  smooth.average = averageHessians->GetPointer(0);
+  vtkSMPTools::For(0,numVerts,smooth);
 
   mesh->GetPointData()->AddArray(averageHessians);
   mesh->GetPointData()->SetActiveScalars("averagehessians");
 
-  delete [] pointOnSurface;
-
   return SV_OK;
 }
 
@@ -241,6 +378,60 @@ int AdaptUtils_getHessian(vtkDoubleArray *Hessians,vtkIdType v, double T[3][3])
   return SV_OK;
 }
 
+// ----------------------------
+// Solution averaging
+// ----------------------------
+// One step is folded into the running sums of the 5 component average
+// (vel_x, vel_y, vel_z, pressure, vel_magnitude) in parallel over the
+// nodes.  The sources are strided raw pointers so the same functor works
+// on interleaved vtk arrays and on the variable-major blocks of a restart.
+
+struct AdaptUtilsAccumulateFunctor {
+  const double *vx,*vy,*vz,*pressure;
+  vtkIdType velStride,pressureStride;
+  double *avg;
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i=begin;i<end;i++)
+    {
+      double vel_x = vx[i*velStride];
+      double vel_y = vy[i*velStride];
+      double vel_z = vz[i*velStride];
+      double *a = &avg[5*i];
+      a[0] += vel_x;
+      a[1] += vel_y;
+      a[2] += vel_z;
+      a[3] += pressure[i*pressureStride];
+      a[4] += sqrt(vel_x*vel_x + vel_y*vel_y + vel_z*vel_z);
+    }
+  }
+};
+
+struct AdaptUtilsScaleFunctor {
+  double *avg;
+  double scale;
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i=5*begin;i<5*end;i++)
+      avg[i] = avg[i]*scale;
+  }
+};
+
+static vtkSmartPointer<vtkDoubleArray> AdaptUtils_newAverageArray(vtkIdType numPoints)
+{
+  vtkSmartPointer<vtkDoubleArray> averageArray =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  averageArray->SetNumberOfComponents(5);
+  averageArray->SetNumberOfTuples(numPoints);
+  averageArray->SetName("avg_sols");
+  averageArray->FillComponent(0,0.0);
+  averageArray->FillComponent(1,0.0);
+  averageArray->FillComponent(2,0.0);
+  averageArray->FillComponent(3,0.0);
+  averageArray->FillComponent(4,0.0);
+  return averageArray;
+}
+
 // ----------------------------
 // averageSolutionsOnMesh()
 // ---------------------------
@@ -263,30 +454,20 @@ int AdaptUtils_averageSolutionsOnMesh(vtkUnstructuredGrid *mesh, int begin,
   //Component 5: vel_magnitude
   int numPoints = mesh->GetNumberOfPoints();
 
-  vtkSmartPointer<vtkDoubleArray> averageArray =
-    vtkSmartPointer<vtkDoubleArray>::New();
-  averageArray->SetNumberOfComponents(5);
-  averageArray->Allocate(numPoints,10000);
-  averageArray->SetNumberOfTuples(numPoints);
-  averageArray->SetName("avg_sols");
-  for (int i=0; i<numPoints;i++)
+  if (incr <= 0)
   {
-    for (int j=0;j<5;j++)
-    {
-      averageArray->InsertComponent(i,j,0);
-    }
+    fprintf(stderr,"Step increment must be positive\n");
+    return SV_ERROR;
   }
 
+  vtkSmartPointer<vtkDoubleArray> averageArray =
+    AdaptUtils_newAverageArray(numPoints);
+
   int numArrays = 0;
   for (int step_num = begin;step_num <= end;step_num += incr)
   {
     vtkDoubleArray *tmpVelArray;
     vtkDoubleArray *tmpPressureArray;
-    vtkSmartPointer<vtkDoubleArray> tmpArray =
-      vtkSmartPointer<vtkDoubleArray>::New();;
-    tmpArray->SetNumberOfComponents(5);
-    tmpArray->Allocate(numPoints,10000);
-    tmpArray->SetNumberOfTuples(numPoints);
     char vel_step[80];
     char press_step[80];
     sprintf(vel_step,"%s_%05i","velocity",step_num);
@@ -305,41 +486,220 @@ int AdaptUtils_averageSolutionsOnMesh(vtkUnstructuredGrid *mesh, int begin,
     }
     tmpPressureArray = vtkDoubleArray::SafeDownCast(
 	mesh->GetPointData()->GetArray(press_step));
-    for (int i = 0;i < numPoints;i++)
+    if (tmpVelArray == NULL || tmpVelArray->GetNumberOfComponents() != 3 ||
+        tmpPressureArray == NULL)
     {
-      double vel_x = tmpVelArray->GetComponent(i,0);
-      tmpArray->InsertComponent(i,0,vel_x);
+      fprintf(stderr,"Arrays %s and %s must be double arrays\n",vel_step,press_step);
+      return SV_ERROR;
+    }
 
-      double vel_y = tmpVelArray->GetComponent(i,0);
-      tmpArray->InsertComponent(i,1,vel_y);
+    AdaptUtilsAccumulateFunctor accumulate;
+    accumulate.vx = tmpVelArray->GetPointer(0);
+    accumulate.vy = accumulate.vx+1;
+    accumulate.vz = accumulate.vx+2;
+    accumulate.velStride = 3;
+    accumulate.pressure = tmpPressureArray->GetPointer(0);
+    accumulate.pressureStride = tmpPressureArray->GetNumberOfComponents();
+    accumulate.avg = averageArray->GetPointer(0);
+    vtkSMPTools::For(0,numPoints,accumulate);
 
-      double vel_z = tmpVelArray->GetComponent(i,0);
-      tmpArray->InsertComponent(i,2,vel_z);
+    numArrays++;
+  }
 
-      double pressure = tmpPressureArray->GetValue(i);
-      tmpArray->InsertComponent(i,3,pressure);
+  if (numArrays == 0)
+  {
+    fprintf(stderr,"No steps between %d and %d\n",begin,end);
+    return SV_ERROR;
+  }
 
-      double vel_mag = sqrt(pow(vel_x,2) + pow(vel_y,2) + pow(vel_z,2));
-      tmpArray->InsertComponent(i,4,vel_mag);
+  AdaptUtilsScaleFunctor scale;
+  scale.avg = averageArray->GetPointer(0);
+  scale.scale = 1.0/numArrays;
+  vtkSMPTools::For(0,numPoints,scale);
 
-      for (int j=0;j <5;j++)
-      {
-        double tmp = averageArray->GetComponent(i,j);
-        averageArray->InsertComponent(i,j,tmp+tmpArray->GetComponent(i,j));
-      }
-    }
-    numArrays++;
+  mesh->GetPointData()->AddArray(averageArray);
+  return SV_OK;
+}
+
+// only a single integer conversion (%d, %05i, ...) is allowed in a
+// step file pattern, anything else would be handed to sprintf
+static int AdaptUtils_checkStepPattern(const char *pattern)
+{
+  int numConversions = 0;
+  for (const char *c = pattern;*c != '\0';c++)
+  {
+    if (*c != '%')
+      continue;
+    c++;
+    if (*c == '%')
+      continue;
+    while (*c == '0' || *c == '-' || (*c >= '1' && *c <= '9'))
+      c++;
+    if (*c != 'd' && *c != 'i')
+      return SV_ERROR;
+    numConversions++;
+  }
+  return numConversions == 1 ? SV_OK : SV_ERROR;
+}
+
+// reads a double data block of a restart into buffer, keeping the
+// variable-major layout of the file; buffer is only grown, never shrunk
+static int AdaptUtils_readBlockIntoBuffer(const char *filename,
+                                          const char *fieldName,
+                                          std::vector<double> &buffer,
+                                          int &nshg,
+                                          int &numVars)
+{
+  int restart;
+  const char *iformat = "binary";
+
+  if (!AdaptUtils_file_exists(filename))
+  {
+    fprintf(stderr,"File %s does not exist\n",filename);
+    return SV_ERROR;
+  }
+  if (openfile_(filename,"mapped",&restart) != CVSOLVER_IO_OK)
+  {
+    fprintf(stderr,"Could not open %s\n",filename);
+    return SV_ERROR;
   }
 
-  for (int i=0; i<numPoints;i++)
+  int iarray[4] = {-1,-1,-1,-1};
+  int isize = 3;
+  readheader_(&restart,fieldName,iarray,&isize,"double",iformat);
+  nshg = iarray[0];
+  numVars = iarray[1];
+  if (nshg <= 0 || numVars <= 0)
   {
-    for (int j=0;j <5;j++)
+    fprintf(stderr,"No %s found in file %s\n",fieldName,filename);
+    closefile_(&restart,"read");
+    return SV_ERROR;
+  }
+
+  isize = nshg*numVars;
+  if (buffer.size() < (size_t) isize)
+    buffer.resize(isize);
+
+  const void *mapped = NULL;
+  mapdatablock_(&restart,fieldName,&mapped,&isize,"double",iformat);
+  if (mapped != NULL)
+    memcpy(&buffer[0],mapped,sizeof(double)*isize);
+  else
+    readdatablock_(&restart,fieldName,&buffer[0],&isize,"double",iformat);
+
+  closefile_(&restart,"read");
+  return SV_OK;
+}
+
+// ----------------------------
+// averageSolutionsFromFiles()
+// ---------------------------
+/**
+ * @brief This averages the solution blocks of a series of restart files
+ * into the avg_sols array on the mesh, the same array that
+ * averageSolutionsOnMesh creates.
+ * @param filePattern printf pattern of the restart file names with one
+ * integer conversion for the step number, e.g. restart.%d.1
+ * @param begin first step to use
+ * @param end last step to use
+ * @param incr increment to avg with
+ * @note Two buffers are reused for all steps: the next file is read on
+ * a separate thread while the current one is accumulated.
+ */
+
+int AdaptUtils_averageSolutionsFromFiles(vtkUnstructuredGrid *mesh,
+    char *filePattern, int begin, int end, int incr)
+{
+  int numPoints = mesh->GetNumberOfPoints();
+
+  if (incr <= 0)
+  {
+    fprintf(stderr,"Step increment must be positive\n");
+    return SV_ERROR;
+  }
+  if (AdaptUtils_checkStepPattern(filePattern) != SV_OK)
+  {
+    fprintf(stderr,"File pattern %s must contain exactly one integer conversion for the step\n",filePattern);
+    return SV_ERROR;
+  }
+
+  std::vector<int> steps;
+  for (int step_num = begin;step_num <= end;step_num += incr)
+    steps.push_back(step_num);
+  if (steps.empty())
+  {
+    fprintf(stderr,"No steps between %d and %d\n",begin,end);
+    return SV_ERROR;
+  }
+
+  std::vector<std::string> fileNames(steps.size());
+  for (size_t k=0;k<steps.size();k++)
+  {
+    char fileName[1024];
+    snprintf(fileName,sizeof(fileName),filePattern,steps[k]);
+    fileNames[k] = fileName;
+  }
+
+  vtkSmartPointer<vtkDoubleArray> averageArray =
+    AdaptUtils_newAverageArray(numPoints);
+
+  std::vector<double> buffers[2];
+  int nshg[2],numVars[2],status[2];
+  int current = 0;
+
+  status[current] = AdaptUtils_readBlockIntoBuffer(fileNames[0].c_str(),"solution",
+    buffers[current],nshg[current],numVars[current]);
+
+  for (size_t k=0;k<steps.size();k++)
+  {
+    int next = 1-current;
+    std::thread reader;
+    if (status[current] == SV_OK && k+1 < steps.size())
     {
-      double tmp = averageArray->GetComponent(i,j);
-      averageArray->InsertComponent(i,j,tmp/numArrays);
+      reader = std::thread([&,next,k]() {
+        status[next] = AdaptUtils_readBlockIntoBuffer(fileNames[k+1].c_str(),"solution",
+          buffers[next],nshg[next],numVars[next]);
+      });
+    }
+
+    int ok = status[current];
+    if (ok == SV_OK && (nshg[current] != numPoints || numVars[current] < 4))
+    {
+      fprintf(stderr,"Solution in %s has %d nodes and %d variables, mesh has %d nodes\n",
+        fileNames[k].c_str(),nshg[current],numVars[current],numPoints);
+      ok = SV_ERROR;
+    }
+    if (ok == SV_OK)
+    {
+      fprintf(stdout,"Averaging solution from %s\n",fileNames[k].c_str());
+      // solution is stored p,u,v,w by variable
+      const double *sol = &buffers[current][0];
+      AdaptUtilsAccumulateFunctor accumulate;
+      accumulate.pressure = sol;
+      accumulate.vx = sol+numPoints;
+      accumulate.vy = sol+2*numPoints;
+      accumulate.vz = sol+3*numPoints;
+      accumulate.velStride = 1;
+      accumulate.pressureStride = 1;
+      accumulate.avg = averageArray->GetPointer(0);
+      vtkSMPTools::For(0,numPoints,accumulate);
+    }
+
+    if (reader.joinable())
+      reader.join();
+    if (ok != SV_OK)
+    {
+      fprintf(stderr,"Error when averaging solution from %s\n",fileNames[k].c_str());
+      return SV_ERROR;
     }
+    current = next;
   }
 
+  AdaptUtilsScaleFunctor scale;
+  scale.avg = averageArray->GetPointer(0);
+  scale.scale = 1.0/steps.size();
+  vtkSMPTools::For(0,numPoints,scale);
+
   mesh->GetPointData()->AddArray(averageArray);
   return SV_OK;
 }
@@ -837,6 +1197,185 @@ double AdaptUtils_getErrorValue(double *nodalValues, int option) {
 }
 
 
+// -----------------------------
+// Symmetric 3x3 eigen decomposition
+// -----------------------------
+// Eigenvalues come from the trigonometric solution of the characteristic
+// cubic and the eigenvectors of the two outer eigenvalues from cross
+// products of the rows of (T - lambda I); the middle one completes the
+// frame.  Results are returned like tred2/tql2: eigenvalues ascending and
+// dir[j] the unit eigenvector of eigenVals[j].  When two eigenvalues are
+// too close for the cross products to be reliable SV_ERROR is returned
+// and the caller should use tred2/tql2 instead.
+
+static int AdaptUtils_eigenVector3(const double T[3][3],double lambda,double v[3])
+{
+  double r[3][3];
+  double c[3][3];
+  double len[3];
+  int i,best;
+
+  for (i=0;i<3;i++)
+  {
+    r[i][0] = T[i][0]; r[i][1] = T[i][1]; r[i][2] = T[i][2];
+    r[i][i] -= lambda;
+  }
+  for (i=0;i<3;i++)
+  {
+    const double *p = r[i];
+    const double *q = r[(i+1)%3];
+    c[i][0] = p[1]*q[2] - p[2]*q[1];
+    c[i][1] = p[2]*q[0] - p[0]*q[2];
+    c[i][2] = p[0]*q[1] - p[1]*q[0];
+    len[i] = c[i][0]*c[i][0] + c[i][1]*c[i][1] + c[i][2]*c[i][2];
+  }
+  best = 0;
+  if (len[1] > len[best]) best = 1;
+  if (len[2] > len[best]) best = 2;
+  if (len[best] <= 0.0)
+    return SV_ERROR;
+
+  double inv = 1.0/sqrt(len[best]);
+  v[0] = c[best][0]*inv;
+  v[1] = c[best][1]*inv;
+  v[2] = c[best][2]*inv;
+  return SV_OK;
+}
+
+static int AdaptUtils_symmetricEigen3(double T[3][3],double eigenVals[3],double dir[3][3])
+{
+  const double gapTol = 1.e-5;
+  double A[3][3];
+  double scale = 0.0;
+  int i,j;
+
+  for (i=0;i<3;i++)
+    for (j=0;j<3;j++)
+      if (ABS(T[i][j]) > scale)
+        scale = ABS(T[i][j]);
+
+  if (scale == 0.0)
+  {
+    for (i=0;i<3;i++)
+    {
+      eigenVals[i] = 0.0;
+      dir[i][0] = dir[i][1] = dir[i][2] = 0.0;
+      dir[i][i] = 1.0;
+    }
+    return SV_OK;
+  }
+
+  // work on T/scale so the cubic does not under/overflow
+  for (i=0;i<3;i++)
+    for (j=0;j<3;j++)
+      A[i][j] = T[i][j]/scale;
+
+  double p1 = A[0][1]*A[0][1] + A[0][2]*A[0][2] + A[1][2]*A[1][2];
+  double q = (A[0][0] + A[1][1] + A[2][2])/3.0;
+  double d0 = A[0][0]-q, d1 = A[1][1]-q, d2 = A[2][2]-q;
+  double p2 = d0*d0 + d1*d1 + d2*d2 + 2.0*p1;
+  double p = sqrt(p2/6.0);
+
+  if (p1 == 0.0 || p == 0.0)
+    return SV_ERROR;
+
+  // r = det((A - qI)/p)/2
+  double b00 = d0/p, b11 = d1/p, b22 = d2/p;
+  double b01 = A[0][1]/p, b02 = A[0][2]/p, b12 = A[1][2]/p;
+  double r = 0.5*(b00*(b11*b22 - b12*b12) -
+                  b01*(b01*b22 - b12*b02) +
+                  b02*(b01*b12 - b11*b02));
+  if (r < -1.0) r = -1.0;
+  if (r >  1.0) r =  1.0;
+
+  double phi = acos(r)/3.0;
+  double lmax = q + 2.0*p*cos(phi);
+  double lmin = q + 2.0*p*cos(phi + 2.0*vtkMath::Pi()/3.0);
+  double lmid = 3.0*q - lmax - lmin;
+
+  double spread = MAX(ABS(lmax),ABS(lmin));
+  if (lmax - lmid <= gapTol*spread || lmid - lmin <= gapTol*spread)
+    return SV_ERROR;
+
+  double vmin[3],vmax[3],vmid[3];
+  if (AdaptUtils_eigenVector3(A,lmin,vmin) != SV_OK ||
+      AdaptUtils_eigenVector3(A,lmax,vmax) != SV_OK)
+    return SV_ERROR;
+
+  // re-orthogonalize, then complete the right handed frame
+  double dot = vmax[0]*vmin[0] + vmax[1]*vmin[1] + vmax[2]*vmin[2];
+  for (i=0;i<3;i++)
+    vmax[i] -= dot*vmin[i];
+  double len = sqrt(vmax[0]*vmax[0] + vmax[1]*vmax[1] + vmax[2]*vmax[2]);
+  if (len == 0.0)
+    return SV_ERROR;
+  for (i=0;i<3;i++)
+    vmax[i] /= len;
+  vmid[0] = vmax[1]*vmin[2] - vmax[2]*vmin[1];
+  vmid[1] = vmax[2]*vmin[0] - vmax[0]*vmin[2];
+  vmid[2] = vmax[0]*vmin[1] - vmax[1]*vmin[0];
+
+  eigenVals[0] = lmin*scale;
+  eigenVals[1] = lmid*scale;
+  eigenVals[2] = lmax*scale;
+  for (i=0;i<3;i++)
+  {
+    dir[0][i] = vmin[i];
+    dir[1][i] = vmid[i];
+    dir[2][i] = vmax[i];
+  }
+  return SV_OK;
+}
+
+// decompose the averaged hessian of each node and get its local error
+struct AdaptUtilsHessianFunctor {
+  vtkUnstructuredGrid *mesh;
+  vtkDoubleArray *averageHessians;
+  Hessian *hess;
+  double *eloc;
+  double tol;
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    int three = 3;
+    int j,k;
+    double T[3][3];
+    double eigenVals[3];
+    double e[3];
+    double Tfoo[9];
+    double z[9];
+
+    for (vtkIdType pointId=begin;pointId<end;pointId++)
+    {
+      AdaptUtils_getHessian(averageHessians,pointId,T);
+
+      if (AdaptUtils_symmetricEigen3(T,eigenVals,hess[pointId].dir) != SV_OK)
+      {
+        for (j=0;j<3;j++)
+          for (k=0;k<3;k++)
+            Tfoo[j*3+k] = T[j][k];
+        tred2(three,Tfoo,eigenVals,e,z);
+        tql2(three,eigenVals,e,z);
+        for (j=0;j<3;j++)
+          for (k=0;k<3;k++)
+            hess[pointId].dir[j][k] = z[j*3+k];
+      }
+
+      for (j=0;j<3;j++)
+        hess[pointId].h[j] = ABS(eigenVals[j]);
+
+      // zero hessians are reported and skipped by the caller
+      eloc[pointId] = -1.0;
+      if (MAX(hess[pointId].h[0],MAX(hess[pointId].h[1],hess[pointId].h[2])) < tol)
+        continue;
+
+      // estimate relative interpolation error
+      // needed for scaling metric field (mesh size field)
+      // to get an idea refer Appendix A in Li's thesis
+      eloc[pointId] = AdaptUtils_maxLocalError(mesh,pointId,T);
+    }
+  }
+};
+
 // -----------------------------
 // setSizeFieldUsingHessians()
 // -----------------------------
@@ -858,31 +1397,25 @@ int AdaptUtils_setSizeFieldUsingHessians(vtkUnstructuredGrid *mesh,
 {
   int i,j,k;
   int nshg;
-  int ierr;
-  int three = 3;
   int bdryNumNodes = 0;
-  double xyz[3];
-  double T[3][3];
   double tol=1.e-12;
-  double maxEigenval=0;
   double eloc;  	  // local error at a vertex
   double etot=0.;	  // total error for all vertices
   double emean; 	  // emean = etot / nv
   double elocmax=0.;	  // max local error
   double elocmin=1.e20;   // min local error
-  //double z[3][3];
-  double z[9];
-  vtkIdType pointId,averageHessian;
+  vtkIdType pointId;
 
   vtkSmartPointer<vtkDoubleArray> averageHessians =
     vtkSmartPointer<vtkDoubleArray>::New();
 
   nshg = mesh->GetNumberOfPoints();
   averageHessians = vtkDoubleArray::SafeDownCast(mesh->GetPointData()->GetArray("averagehessians"));
-
-  // struct Hessian contains decomposed values
-  // mesh sizes and directional information
-  Hessian *hess = new Hessian[nshg];
+  if (averageHessians == NULL || averageHessians->GetNumberOfComponents() != 6)
+  {
+    fprintf(stderr,"Error when getting hessian\n");
+    return SV_ERROR;
+  }
 
   vtkSmartPointer<vtkDoubleArray> errorMetricArray =
     vtkSmartPointer<vtkDoubleArray>::New();
@@ -895,80 +1428,41 @@ int AdaptUtils_setSizeFieldUsingHessians(vtkUnstructuredGrid *mesh,
     fprintf(stderr,"Strategy does not exist\n");
     return SV_ERROR;
   }
-  errorMetricArray->Allocate(nshg,10000);
   errorMetricArray->SetNumberOfTuples(nshg);
   errorMetricArray->SetName("errormetric");
 
-  i=0;
-  for (pointId=0;pointId<nshg;pointId++)
-  {
-    mesh->GetPoint(pointId,xyz);
-
-    if (AdaptUtils_getHessian(averageHessians,pointId,T) != SV_OK)
-    {
-      fprintf(stderr,"Error when getting hessian\n");
-      return SV_OK;
-    }
-
-    double eigenVals[3];
-    double e[3];
-    //double Tfoo[3][3];
-    double Tfoo[9];
-
-    //copy T into temporary buffer
-    //for (j=0;j<3;j++)
-    //{
-    //  for (k=0;k<3;k++)
-    //  {
-    //    Tfoo[j][k] = T[j][k];
-    //  }
-    //}
-    for (j=0;j<3;j++)
-    {
-      for (k=0;k<3;k++)
-      {
-        Tfoo[j*3+k] = T[j][k];
-      }
-    }
-
-    //mytred(&three,&three,Tfoo,eigenVals,e,z);
-    tred2(three,Tfoo,eigenVals,e,z);
-
-    //tql2(&three,&three,eigenVals,e,z,&ierr);
-    ierr = tql2(three,eigenVals,e,z);
+  // struct Hessian contains decomposed values
+  // mesh sizes and directional information
+  Hessian *hess = new Hessian[nshg];
+  double *elocs = new double[nshg];
 
-    for (j=0;j<3;j++)
-    {
-      hess[i].h[j] = eigenVals[j];
-      for (k=0;k<3;k++)
-      {
-	//hess[i].dir[j][k]=z[j][k];
-	hess[i].dir[j][k]=z[j*3+k];
-      }
-    }
+  // links are built lazily by GetPointCells, do it before threading
+  mesh->BuildLinks();
 
-    hess[i].h[0] = ABS(hess[i].h[0]);
-    hess[i].h[1] = ABS(hess[i].h[1]);
-    hess[i].h[2] = ABS(hess[i].h[2]);
+  AdaptUtilsHessianFunctor decompose;
+  decompose.mesh = mesh;
+  decompose.averageHessians = averageHessians;
+  decompose.hess = hess;
+  decompose.eloc = elocs;
+  decompose.tol = tol;
+  vtkSMPTools::For(0,nshg,decompose);
 
-    if( MAX(hess[i].h[0],MAX(hess[i].h[1],hess[i].h[2])) < tol ) {
-      printf("Warning: zero maximum eigenvalue for node %d !!!\n",i);
-      printf("       %f %f %f\n", hess[i].h[0],
-             hess[i].h[1],hess[i].h[2]);
+  for (pointId=0;pointId<nshg;pointId++)
+  {
+    if (elocs[pointId] < 0.0) {
+      printf("Warning: zero maximum eigenvalue for node %d !!!\n",(int) pointId);
+      printf("       %f %f %f\n", hess[pointId].h[0],
+             hess[pointId].h[1],hess[pointId].h[2]);
       continue;
     }
-
-    // estimate relative interpolation error
-    // needed for scaling metric field (mesh size field)
-    // to get an idea refer Appendix A in Li's thesis
-    eloc=AdaptUtils_maxLocalError(mesh,pointId,T);
+    eloc = elocs[pointId];
     etot += eloc;
     if( eloc>elocmax )  elocmax=eloc;
     if( eloc<elocmin )  elocmin=eloc;
-
-    i++;
   }
 
+  delete [] elocs;
+
   printf("Info: Reading hessian... done...\n");
 
   emean =  etot / nshg;
@@ -1438,7 +1932,9 @@ int AdaptUtils_readArrayFromFile( char *filename,
   // format of the file
   char* iformat = "binary";
 
-  openfile_( filename, "read",  &restart );
+  // uncompressed files are memory mapped, compressed ones are read
+  // through zlib as before
+  openfile_( filename, "mapped",  &restart );
 
   // contains: nshg,numVars,lstep
   int iarray[4];
@@ -1465,13 +1961,29 @@ int AdaptUtils_readArrayFromFile( char *filename,
   fprintf(stdout,"Number of vars found in %s: %d\n",fieldName,numVars);
   isize = iarray[0]*iarray[1];
 
+  valueArray = new double[nshg*numVars];
+
+  // transpose straight out of the mapping, the block is not
+  // necessarily aligned for doubles so copy element-wise
+  const void* mapped = NULL;
+  mapdatablock_( &restart, fieldName, &mapped, &isize,
+		 "double" , iformat );
+  if (mapped != NULL) {
+    const char* bytes = static_cast<const char*>(mapped);
+    for(int i = 0; i< nshg; i++){
+      for( int j=0; j< numVars; j++){
+        memcpy(&valueArray[i*numVars+j],bytes+sizeof(double)*(j*nshg+i),sizeof(double));
+      }
+    }
+    closefile_(&restart, "read");
+    return SV_OK;
+  }
+
   double* q = new double[nshg*numVars];
 
   readdatablock_( &restart, fieldName, q, &isize,
 		  "double" , iformat );
 
-  valueArray = new double[nshg*numVars];
-
   for(int i = 0; i< nshg; i++){
     for( int j=0; j< numVars; j++){
       valueArray[i*numVars+j] = q[j*nshg+i];
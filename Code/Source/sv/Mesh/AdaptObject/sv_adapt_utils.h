@@ -103,6 +103,11 @@ SV_EXPORT_ADAPTOR int AdaptUtils_getHessian (vtkDoubleArray *Hessians,vtkIdType
 SV_EXPORT_ADAPTOR int AdaptUtils_averageSolutionsOnMesh(vtkUnstructuredGrid *mesh, int begin,
     int end, int incr);
 
+// averages the solution blocks of the restart files named by
+// `filePattern' (e.g. restart.%d.1) into avg_sols on the mesh
+SV_EXPORT_ADAPTOR int AdaptUtils_averageSolutionsFromFiles(vtkUnstructuredGrid *mesh,
+    char *filePattern, int begin, int end, int incr);
+
 // attaches array to mesh entities
 // `dataID' is the MeshDataId
 // `nVar' is the no. of variables at each dof
@@ -97,6 +97,12 @@ cvMeshObject::KernelType cvMeshObject::GetKernelType( const char* kernel_name )
 }
 
 
+int cvMeshObject::WritePartition(char *filename, int numParts) {
+  fprintf(stderr,"Element partitioning is not supported by this mesh kernel\n");
+  return SV_ERROR;
+}
+
+
 int cvMeshObject::openOutputFile(char* filename) {
   fp_ = NULL;
   // open the output file
@@ -129,6 +129,9 @@ public:
   //Not necessary anymore, but leaving for now
   virtual int WriteMetisAdjacency (char *filename) = 0;
 
+  //Element partition, one part id per line; kernels without it return SV_ERROR
+  virtual int WritePartition (char *filename, int numParts);
+
   // general queries
   virtual int GetNodeCoords(int node) = 0;
   virtual cvPolyData *GetPolyData() = 0;
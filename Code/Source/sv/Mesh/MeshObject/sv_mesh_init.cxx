@@ -80,6 +80,8 @@ static int cvMesh_UpdateMtd( ClientData clientData, Tcl_Interp *interp,
 				int argc, CONST84 char *argv[] );
 static int cvMesh_WriteMetisAdjacencyMtd( ClientData clientData, Tcl_Interp *interp,
 				int argc, CONST84 char *argv[] );
+static int cvMesh_WritePartitionMtd( ClientData clientData, Tcl_Interp *interp,
+				int argc, CONST84 char *argv[] );
 
 static int cvMesh_GetPolyDataMtd( ClientData clientData, Tcl_Interp *interp,
 				 int argc, CONST84 char *argv[] );
@@ -390,6 +392,10 @@ int cvMesh_ObjectCmd( ClientData clientData, Tcl_Interp *interp,
     if ( cvMesh_WriteMetisAdjacencyMtd( clientData, interp, argc, argv ) != TCL_OK ) {
       return TCL_ERROR;
     }
+  } else if ( Tcl_StringMatch( argv[1], "WritePartition" ) ) {
+    if ( cvMesh_WritePartitionMtd( clientData, interp, argc, argv ) != TCL_OK ) {
+      return TCL_ERROR;
+    }
   } else if ( Tcl_StringMatch( argv[1], "GetPolyData" ) ) {
     if ( cvMesh_GetPolyDataMtd( clientData, interp, argc, argv ) != TCL_OK ) {
       return TCL_ERROR;
@@ -476,6 +482,7 @@ static void MeshPrintMethods( Tcl_Interp *interp )
   tcl_printstr(interp, "Print\n");
   tcl_printstr(interp, "Update\n");
   tcl_printstr(interp, "WriteMetisAdjacency\n");
+  tcl_printstr(interp, "WritePartition\n");
   tcl_printstr(interp, "*** methods to generate meshes ***\n");
   tcl_printstr(interp, "LoadModel\n");
   /*
@@ -645,6 +652,47 @@ static int cvMesh_WriteMetisAdjacencyMtd( ClientData clientData, Tcl_Interp *int
   }
 }
 
+// --------------------------
+// cvMesh_WritePartitionMtd
+// --------------------------
+
+static int cvMesh_WritePartitionMtd( ClientData clientData, Tcl_Interp *interp,
+				 int argc, CONST84 char *argv[] ) {
+  cvMeshObject *geom = (cvMeshObject *)clientData;
+  char *usage;
+  char *fn;
+  int nparts;
+  int status;
+
+  int table_size = 2;
+  ARG_Entry arg_table[] = {
+    { "-file", STRING_Type, &fn, NULL, REQUIRED, 0, { 0 } },
+    { "-nparts", INT_Type, &nparts, NULL, REQUIRED, 0, { 0 } },
+  };
+
+  usage = ARG_GenSyntaxStr( 2, argv, table_size, arg_table );
+  if ( argc == 2 ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_OK;
+  }
+  if ( ARG_ParseTclStr( interp, argc, argv, 2,
+			table_size, arg_table ) != TCL_OK ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_ERROR;
+  }
+
+  // Do work of command:
+  status = geom->WritePartition( fn, nparts );
+
+  if ( status != SV_OK ) {
+    Tcl_AppendResult( interp, "error partitioning object ", geom->GetName(),
+		      " to file ", fn, (char *)NULL );
+    return TCL_ERROR;
+  } else {
+    return TCL_OK;
+  }
+}
+
 // ----------------------
 // cvMesh_GetPolyDataMtd
 // ----------------------
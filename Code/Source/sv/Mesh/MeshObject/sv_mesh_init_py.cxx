@@ -86,6 +86,7 @@ static PyObject* cvMesh_GetKernelMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_PrintMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_UpdateMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_WriteMetisAdjacencyMtd( pyMeshObject* self, PyObject* args);
+static PyObject* cvMesh_WritePartitionMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_GetPolyDataMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_GetSolidMtd( pyMeshObject* self, PyObject* args);
 static PyObject* cvMesh_SetVtkPolyDataMtd( pyMeshObject* self, PyObject* args);
@@ -168,6 +169,7 @@ static PyMethodDef pyMeshObject_methods[]={
   { "Print",(PyCFunction)cvMesh_PrintMtd,METH_VARARGS,NULL},
   { "GetKernel", (PyCFunction)cvMesh_GetKernelMtd,METH_VARARGS,NULL},
   { "WriteMetisAdjacency", (PyCFunction)cvMesh_WriteMetisAdjacencyMtd,METH_VARARGS,NULL},
+  { "WritePartition", (PyCFunction)cvMesh_WritePartitionMtd,METH_VARARGS,NULL},
   { "GetPolyData", (PyCFunction)cvMesh_GetPolyDataMtd,METH_VARARGS,NULL},
   { "GetSolid", (PyCFunction)cvMesh_GetSolidMtd,METH_VARARGS,NULL},
   { "SetVtkPolyData",(PyCFunction)cvMesh_SetVtkPolyDataMtd,METH_VARARGS,NULL},
@@ -511,6 +513,7 @@ static void MeshPrintMethods()
   PySys_WriteStdout( "Print\n");
   PySys_WriteStdout( "Update\n");
   PySys_WriteStdout( "WriteMetisAdjacency\n");
+  PySys_WriteStdout( "WritePartition\n");
   PySys_WriteStdout( "*** methods to generate meshes ***\n");
   PySys_WriteStdout( "LoadModel\n");
   /*
@@ -663,6 +666,41 @@ static PyObject* cvMesh_WriteMetisAdjacencyMtd( pyMeshObject* self, PyObject* ar
   }
 }
 
+// --------------------------
+// cvMesh_WritePartitionMtd
+// --------------------------
+
+static PyObject* cvMesh_WritePartitionMtd( pyMeshObject* self, PyObject* args)
+{
+  cvMeshObject *geom = self->geom;
+  char *fn;
+  int nparts;
+  int status;
+  if(!PyArg_ParseTuple(args,"si",&fn,&nparts))
+  {
+    PyErr_SetString(PyRunTimeErr,"Could not import one char and one int, fn, nparts.");
+    return NULL;
+  }
+
+  if (geom->GetMeshLoaded() == 0)
+  {
+    if (geom->Update() == SV_ERROR)
+    {
+      PyErr_SetString(PyRunTimeErr, "error update.");
+      return NULL;
+    }
+  }
+  // Do work of command:
+  status = geom->WritePartition( fn, nparts );
+
+  if ( status != SV_OK ) {
+    PyErr_SetString(PyRunTimeErr, "error partitioning object ");
+    return NULL;
+  }
+
+  return SV_PYTHON_OK;
+}
+
 // ----------------------
 // cvMesh_GetPolyDataMtd
 // ----------------------
@@ -680,6 +680,32 @@ int cvTetGenAdapt::ReadSolutionFromMesh()
   return SV_OK;
 }
 
+// ---------------
+//  LoadAvgSolutionsFromFiles
+// ---------------
+int cvTetGenAdapt::LoadAvgSolutionsFromFiles(char *filePattern)
+{
+  if (inmesh_ == NULL)
+  {
+    fprintf(stderr,"Must load mesh before averaging solutions onto it\n");
+    return SV_ERROR;
+  }
+
+  fprintf(stdout,"Averaging solution files from step %d to step %d in increments of %d\n",
+      options.instep_,options.outstep_,options.step_incr_);
+  if (AdaptUtils_averageSolutionsFromFiles(inmesh_,filePattern,options.instep_,
+	options.outstep_,options.step_incr_) != SV_OK)
+    return SV_ERROR;
+
+  if (AdaptUtils_splitSpeedFromAvgSols(inmesh_) != SV_OK)
+  {
+    fprintf(stderr,"Could not converate solution into average speed array\n");
+    return SV_ERROR;
+  }
+
+  return SV_OK;
+}
+
 //Retain for old solver versions for now
 // ---------------
 //  ReadYbarFromMesh
@@ -124,6 +124,7 @@ public:
   int ReadSolutionFromMesh();
   int ReadYbarFromMesh();
   int ReadAvgSpeedFromMesh();
+  int LoadAvgSolutionsFromFiles(char *filePattern);
 
   //Setup Operations
   int SetAdaptOptions(char *flag,double value);
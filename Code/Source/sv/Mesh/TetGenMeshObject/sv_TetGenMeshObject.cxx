@@ -625,109 +625,94 @@ cvUnstructuredGrid* cvTetGenMeshObject::GetUnstructuredGrid() {
 }
 /**
  * @brief Function that writes the adjacency between tetrahedral elements
- * @param *filename char holding the name of the file to be written to
+ * @param *filename char holding the name of the file to be written to;
+ * a name ending in ".bin" selects the binary layout described at
+ * TGenUtils_WriteAdjacency
  * @return SV_OK if executed correctly
- * @note This function is not necessarily needed anymore. The functionality
- * to extract the adjacency from the vtu is added in the presolver
+ * @note The presolver can also extract the adjacency from the vtu; this
+ * writes it directly from the mesh in one pass over the elements
  */
 
 int cvTetGenMeshObject::WriteMetisAdjacency(char *filename) {
 
-  //No longer need to write adjacency
-  return SV_OK;
-
   if (filename == NULL) {
         return SV_ERROR;
   }
 
-  if (meshoptions_.volumemeshflag)
+  if (meshoptions_.volumemeshflag && volumemesh_ != NULL)
   {
-    // open the output file
-    if (openOutputFile(filename) != SV_OK) return SV_ERROR;
-
-    //Different way to write Adjacency, used for comparison
-    int i;
-    int numCells;
-    int *xadj;
-    int *adjacency;
-    vtkIdType cellId;
-    vtkIdType meshCellId;
-    vtkIdType p1,p2,p3;
-    vtkIdType npts = 0;
-    vtkIdType *pts = 0;
-    vtkSmartPointer<vtkCellArray> volCells = vtkSmartPointer<vtkCellArray>::New();
-    vtkSmartPointer<vtkIntArray> globalIds = vtkSmartPointer<vtkIntArray>::New();
-    vtkSmartPointer<vtkIdList> ptIds = vtkSmartPointer<vtkIdList>::New();
-    vtkSmartPointer<vtkIdList> cellIds = vtkSmartPointer<vtkIdList>::New();
-    volumemesh_->BuildLinks();
-
-    if (VtkUtils_UGCheckArrayName(volumemesh_,1,"GlobalElementID") != SV_OK)
+    std::vector<int> xadj;
+    std::vector<int> adjacency;
+    if (TGenUtils_BuildElementAdjacency(volumemesh_,xadj,adjacency) != SV_OK)
     {
-      fprintf(stderr,"Array name 'GlobalElementID' does not exist in volume mesh. \
-		      Something wrong with ids on mesh");
+      fprintf(stderr,"Could not build the element adjacency\n");
       return SV_ERROR;
     }
-    globalIds = vtkIntArray::SafeDownCast(volumemesh_->GetCellData()->
-      GetScalars("GlobalElementID"));
-    numCells = volumemesh_->GetNumberOfCells();
-    volCells = volumemesh_->GetCells();
-
-    xadj = new int[numCells+1];
-    adjacency = new int[4*numCells];
-    int adj = 0;
-    int xcheck = 0;
-    xadj[xcheck] = 0;
-
-    ptIds->SetNumberOfIds(3);
-    for (cellId = 0;cellId<numCells;cellId++)
-    {
-      meshCellId = globalIds->LookupValue(cellId+1);
-      volumemesh_->GetCellPoints(meshCellId,npts,pts);
-      for (i=0;i < npts; i++)
-      {
-	p1 = pts[i];
-	p2 = pts[(i+1)%(npts)];
-	p3 = pts[(i+2)%(npts)];
 
-	ptIds->InsertId(0,p1);
-	ptIds->InsertId(1,p2);
-	ptIds->InsertId(2,p3);
+    int len = strlen(filename);
+    int binary = len > 4 && strcmp(filename+len-4,".bin") == 0;
 
-	volumemesh_->GetCellNeighbors(meshCellId,ptIds,cellIds);
+    return TGenUtils_WriteAdjacency(filename,xadj,adjacency,binary);
+  }
+  else
+  {
+  //  fprintf(stdout,"No volumemesh, not writing adjacency file\n");
+    return SV_OK;
+  }
+}
 
-	//If it is zero, it is a face on the exterior. Otherwise, it has
-	//neighbors
-	if (cellIds->GetNumberOfIds() != 0)
-	{
-	  adjacency[adj++] = (int) globalIds->GetValue(cellIds->GetId(0))-1;
-	}
+/**
+ * @brief Function that splits the tetrahedral elements into parts of
+ * equal size and writes the part of each element
+ * @param *filename char holding the name of the file to be written to;
+ * the file has one part id (0 to numParts-1) per line, ordered by
+ * GlobalElementID, like a METIS partition file
+ * @param numParts number of parts
+ * @return SV_OK if executed correctly
+ * @note the parts come from TGenUtils_PartitionAdjacency on the element
+ * adjacency
+ */
 
-      }
-      xadj[++xcheck] = adj;
-    }
+int cvTetGenMeshObject::WritePartition(char *filename, int numParts) {
 
-    gzprintf(fp_,"xadj: %i\n",numCells+1);
-    gzprintf(fp_,"adjncy: %i\n",adj);
+  if (filename == NULL) {
+        return SV_ERROR;
+  }
 
-    for (i=0;i < numCells+1; i++)
-    {
-	gzprintf(fp_,"%i\n",xadj[i]);
-    }
-    for (i=0;i < adj; i++)
-    {
-	gzprintf(fp_,"%i\n",adjacency[i]);
-    }
+  if (volumemesh_ == NULL)
+  {
+    fprintf(stderr,"Mesh needs to be computed before it can be partitioned\n");
+    return SV_ERROR;
+  }
+
+  std::vector<int> xadj;
+  std::vector<int> adjacency;
+  if (TGenUtils_BuildElementAdjacency(volumemesh_,xadj,adjacency) != SV_OK)
+  {
+    fprintf(stderr,"Could not build the element adjacency\n");
+    return SV_ERROR;
+  }
 
-    delete [] xadj;
-    delete [] adjacency;
+  std::vector<int> part;
+  if (TGenUtils_PartitionAdjacency(xadj,adjacency,numParts,part) != SV_OK)
+    return SV_ERROR;
 
-    return closeOutputFile();
+  FILE *fp = fopen(filename,"w");
+  if (fp == NULL)
+  {
+    fprintf(stderr,"Error: Could not open output file %s.\n",filename);
+    return SV_ERROR;
   }
-  else
+  bool ok = true;
+  for (int i=0;i<(int)part.size() && ok;i++)
+    ok = fprintf(fp,"%i\n",part[i]) > 0;
+  if (fclose(fp) != 0 || !ok)
   {
-  //  fprintf(stdout,"No volumemesh, not writing adjacency file\n");
-    return SV_OK;
+    fprintf(stderr,"Error: Could not write output file %s.\n",filename);
+    return SV_ERROR;
   }
+
+  return SV_OK;
 }
 
 int cvTetGenMeshObject::GetNodeCoords(int node)
@@ -1341,6 +1326,60 @@ int cvTetGenMeshObject::SetSphereRefinement(double size, double radius,
   return SV_OK;
 }
 
+// --------------------
+//  SetRefinementZones
+// --------------------
+/**
+ * @brief Function to set several sphere and cylinder refinement regions
+ * at once. The zones are applied in order in a single pass over the
+ * surface, giving the same sizing function as setting them one by one.
+ * @param numZones This is the number of refinement zones.
+ * @param zones This is the array of refinement zones.
+ * @return SV_OK if the mesh sizing function based on the zones is computed
+ * correctly
+ */
+int cvTetGenMeshObject::SetRefinementZones(int numZones,
+    TGenUtils_RefinementZone *zones)
+{
+  if (numZones < 1)
+    return SV_OK;
+
+  //Set meshoptions_ parameters based on the last zone.
+  int i;
+  TGenUtils_RefinementZone *last = &zones[numZones-1];
+  meshoptions_.refinement = 1;
+  meshoptions_.refinedsize = last->size;
+  if (last->type == TGENUTILS_CYLINDER_ZONE)
+  {
+    meshoptions_.cylinderradius = last->radius;
+    meshoptions_.cylinderlength = last->length;
+    for (i=0;i<3;i++)
+    {
+      meshoptions_.cylindercenter[i] = last->center[i];
+      meshoptions_.cylindernormal[i] = last->normal[i];
+    }
+  }
+  else
+  {
+    meshoptions_.sphereradius = last->radius;
+    for (i=0;i<3;i++)
+    {
+      meshoptions_.spherecenter[i] = last->center[i];
+    }
+  }
+
+  if (TGenUtils_SetRefinementZones(polydatasolid_,"MeshSizingFunction",
+	numZones,zones,meshoptions_.secondarrayfunction,
+	meshoptions_.maxedgesize,"RefineID",meshoptions_.refinecount) != SV_OK)
+  {
+    return SV_ERROR;
+  }
+
+  meshoptions_.secondarrayfunction = 1;
+  meshoptions_.refinecount += numZones;
+  return SV_OK;
+}
+
 // --------------------
 //  SetSizeFunctionBasedMesh
 // --------------------
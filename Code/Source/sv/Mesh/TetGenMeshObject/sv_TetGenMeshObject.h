@@ -55,6 +55,7 @@
 #include "sv_MeshObject.h"
 
 #include "simvascular_tetgen.h"
+#include "sv_tetgenmesh_utils.h"
 
 class SV_EXPORT_TETGEN_MESH cvTetGenMeshObject : public cvMeshObject {
 
@@ -143,6 +144,7 @@ class SV_EXPORT_TETGEN_MESH cvTetGenMeshObject : public cvMeshObject {
   int SetCylinderRefinement(double size, double radius, double length,
                             double* center, double *normal);
   int SetSphereRefinement(double size, double radius, double* center);
+  int SetRefinementZones(int numZones, TGenUtils_RefinementZone *zones);
   int SetSizeFunctionBasedMesh(double size,char *sizefunctionname);
 
   void SetAllowMultipleRegions(bool value);
@@ -154,6 +156,7 @@ class SV_EXPORT_TETGEN_MESH cvTetGenMeshObject : public cvMeshObject {
 
   // output visualization files
   int WriteMetisAdjacency (char *filename);
+  int WritePartition (char *filename, int numParts);
 
   // general queries
   int GetNodeCoords(int node);
@@ -58,6 +58,7 @@
 #include "vtkGenericCell.h"
 #include "vtkConnectivityFilter.h"
 #include "vtkDataSetSurfaceFilter.h"
+#include "vtkMath.h"
 
 #include "simvascular_tetgen.h"
 
@@ -65,6 +66,10 @@
 #include "sv_misc_utils.h"
 #include "sv_vtk_utils.h"
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #define MAXPATHLEN 1024
 
 #ifdef SV_USE_ZLIB
@@ -79,6 +84,7 @@
   #define gzprintf fprintf
   #define gzFile FILE*
   #define gzclose fclose
+  #define gzwrite(fp,buf,len) fwrite(buf,1,len,fp)
 #endif
 
 #include "sv_tetgenmesh_utils.h"
@@ -780,244 +786,569 @@ int TGenUtils_GetFacePolyData(int id,vtkPolyData *mesh, vtkPolyData *face)
 }
 
 // -----------------------------
-// cvTGenUtils_writeDiffAdj()
+// Element adjacency
+// -----------------------------
+// Elements are numbered by GlobalElementID-1.  Element e has one face
+// for each of its points i, made of points i, i+1 and i+2 (mod npts);
+// for a tetrahedron these are its four faces.  Faces are numbered
+// consecutively per element, faceStart[e] to faceStart[e+1].  Matching
+// faces are found by bucketing every face under its lowest point id and
+// comparing faces only within a bucket, which keeps the whole build
+// linear in the number of elements.
+
+typedef struct TGenUtils_AdjacencyData {
+  vtkUnstructuredGrid *mesh;
+  int numElems;
+  const vtkIdType *cellOfElem;
+  int *faceStart;
+  int *faceInfo;
+  const int *bucketStart;
+  const int *bucket;
+} TGenUtils_AdjacencyData;
+
+static void TGenUtils_getFacePoints(vtkIdType npts,vtkIdType *pts,int i,vtkIdType face[3])
+{
+  face[0] = pts[i];
+  face[1] = pts[(i+1)%npts];
+  face[2] = pts[(i+2)%npts];
+  std::sort(face,face+3);
+}
+
+//Number of faces of each element, stored one past it for the prefix sum
+static void TGenUtils_countElementFaces(TGenUtils_AdjacencyData *data,int first,int last)
+{
+  vtkIdType npts,*pts;
+  for (int e=first;e<last;e++)
+  {
+    data->mesh->GetCellPoints(data->cellOfElem[e],npts,pts);
+    data->faceStart[e+1] = (int) npts;
+  }
+}
+
+//Lowest point of each face, which is the bucket it goes in
+static void TGenUtils_getFaceBuckets(TGenUtils_AdjacencyData *data,int first,int last)
+{
+  vtkIdType npts,*pts,face[3];
+  for (int e=first;e<last;e++)
+  {
+    data->mesh->GetCellPoints(data->cellOfElem[e],npts,pts);
+    for (int i=0;i<npts;i++)
+    {
+      TGenUtils_getFacePoints(npts,pts,i,face);
+      data->faceInfo[data->faceStart[e]+i] = (int) face[0];
+    }
+  }
+}
+
+//Replace the bucket of each face in buckets [first,last) by the element
+//on the other side of it, or -1 on the boundary.  When more than one
+//element shares a face the one with the lowest cell id is taken, as
+//vtkUnstructuredGrid::GetCellNeighbors lists it first.
+static void TGenUtils_matchFaces(TGenUtils_AdjacencyData *data,int first,int last)
+{
+  std::vector<vtkIdType> keys;
+  std::vector<int> elems;
+  vtkIdType npts,*pts,face[3];
+  for (int v=first;v<last;v++)
+  {
+    int begin = data->bucketStart[v];
+    int end = data->bucketStart[v+1];
+    if (begin == end)
+      continue;
+    keys.resize(2*(end-begin));
+    elems.resize(end-begin);
+    for (int k=begin;k<end;k++)
+    {
+      int f = data->bucket[k];
+      int e = (int) (std::upper_bound(data->faceStart,data->faceStart+data->numElems+1,f) -
+        data->faceStart) - 1;
+      data->mesh->GetCellPoints(data->cellOfElem[e],npts,pts);
+      TGenUtils_getFacePoints(npts,pts,f-data->faceStart[e],face);
+      keys[2*(k-begin)] = face[1];
+      keys[2*(k-begin)+1] = face[2];
+      elems[k-begin] = e;
+    }
+    for (int k=0;k<end-begin;k++)
+    {
+      int neighbor = -1;
+      for (int l=0;l<end-begin;l++)
+      {
+        if (elems[l] == elems[k] || keys[2*l] != keys[2*k] ||
+            keys[2*l+1] != keys[2*k+1])
+          continue;
+        if (neighbor == -1 ||
+            data->cellOfElem[elems[l]] < data->cellOfElem[neighbor])
+          neighbor = elems[l];
+      }
+      data->faceInfo[data->bucket[begin+k]] = neighbor;
+    }
+  }
+}
+
+static void TGenUtils_runThreaded(void (*work)(TGenUtils_AdjacencyData*,int,int),
+                                  TGenUtils_AdjacencyData *data,int num)
+{
+  int numThreads = std::max(1,(int)std::thread::hardware_concurrency());
+  numThreads = std::min(numThreads,std::max(1,num/10000));
+  std::vector<std::thread> workers;
+  for (int i=1;i<numThreads;i++)
+  {
+    int first = (int)(((long long)i*num)/numThreads);
+    int last = (int)(((long long)(i+1)*num)/numThreads);
+    workers.push_back(std::thread(work,data,first,last));
+  }
+  work(data,0,(int)((long long)num/numThreads));
+  for (int i=0;i<(int)workers.size();i++)
+    workers[i].join();
+}
+
+// -----------------------------
+// TGenUtils_BuildElementAdjacency()
 // -----------------------------
 /**
- * @brief This is the new way to write an adjacency file based on the mesh
- * @note now implemented in the presolver as new command
+ * @brief builds the element adjacency graph of a volume mesh in the
+ * compressed row form METIS takes
+ * @param *volumemesh mesh with a "GlobalElementID" cell array numbering
+ * the elements from 1
+ * @param xadj, adjncy on return, the neighbors of element e (numbered
+ * GlobalElementID-1) are adjncy[xadj[e]] to adjncy[xadj[e+1]-1], in the
+ * order of the element's faces
+ * @return SV_OK if the ids are valid
  */
 
-int TGenUtils_writeDiffAdj(vtkUnstructuredGrid *volumemesh)
+int TGenUtils_BuildElementAdjacency(vtkUnstructuredGrid *volumemesh,
+    std::vector<int> &xadj,std::vector<int> &adjncy)
 {
-  gzFile myfile = NULL;
+  if (VtkUtils_UGCheckArrayName(volumemesh,1,"GlobalElementID") != SV_OK)
+  {
+    fprintf(stderr,"Array name 'GlobalElementID' does not exist. IDs on mesh may not have been assigned properly\n");
+    return SV_ERROR;
+  }
+  vtkIntArray *globalIds = vtkIntArray::SafeDownCast(
+    volumemesh->GetCellData()->GetScalars("GlobalElementID"));
+  if (globalIds == NULL)
+  {
+    fprintf(stderr,"Array 'GlobalElementID' is not an integer array\n");
+    return SV_ERROR;
+  }
+
+  int numElems = volumemesh->GetNumberOfCells();
+  int numPts = volumemesh->GetNumberOfPoints();
+  int e,f,v;
+
+  std::vector<vtkIdType> cellOfElem(numElems,-1);
+  for (vtkIdType cellId=0;cellId<numElems;cellId++)
+  {
+    int id = globalIds->GetValue(cellId);
+    if (id < 1 || id > numElems || cellOfElem[id-1] != -1)
+    {
+      fprintf(stderr,"GlobalElementID %d of cell %lld is out of range or repeated\n",
+        id,(long long)cellId);
+      return SV_ERROR;
+    }
+    cellOfElem[id-1] = cellId;
+  }
+
+  std::vector<int> faceStart(numElems+1,0);
+  TGenUtils_AdjacencyData data;
+  data.mesh = volumemesh;
+  data.numElems = numElems;
+  data.cellOfElem = numElems ? &cellOfElem[0] : NULL;
+  data.faceStart = &faceStart[0];
+
+  TGenUtils_runThreaded(TGenUtils_countElementFaces,&data,numElems);
+  for (e=0;e<numElems;e++)
+    faceStart[e+1] += faceStart[e];
+  int numFaces = faceStart[numElems];
+
+  //adjncy first holds the bucket of each face, then its neighbor
+  adjncy.resize(numFaces);
+  data.faceInfo = numFaces ? &adjncy[0] : NULL;
+  TGenUtils_runThreaded(TGenUtils_getFaceBuckets,&data,numElems);
+
+  std::vector<int> bucketStart(numPts+1,0);
+  for (f=0;f<numFaces;f++)
+    bucketStart[adjncy[f]+1]++;
+  for (v=0;v<numPts;v++)
+    bucketStart[v+1] += bucketStart[v];
+  std::vector<int> bucket(numFaces);
+  {
+    std::vector<int> next(bucketStart.begin(),bucketStart.end()-1);
+    for (f=0;f<numFaces;f++)
+      bucket[next[adjncy[f]]++] = f;
+  }
+  data.bucketStart = &bucketStart[0];
+  data.bucket = numFaces ? &bucket[0] : NULL;
+  TGenUtils_runThreaded(TGenUtils_matchFaces,&data,numPts);
+
+  std::vector<int>().swap(bucket);
+
+  //Drop boundary faces in place
+  xadj.resize(numElems+1);
+  xadj[0] = 0;
+  int numAdj = 0;
+  for (e=0;e<numElems;e++)
+  {
+    for (f=faceStart[e];f<faceStart[e+1];f++)
+    {
+      if (adjncy[f] != -1)
+        adjncy[numAdj++] = adjncy[f];
+    }
+    xadj[e+1] = numAdj;
+  }
+  adjncy.resize(numAdj);
 
-  std::string filename("compareAdjacency.xadj");
+  return SV_OK;
+}
 
+// -----------------------------
+// TGenUtils_WriteAdjacency()
+// -----------------------------
+/**
+ * @brief writes an adjacency graph from TGenUtils_BuildElementAdjacency
+ * @param *filename output file; with zlib, the text format goes to
+ * filename.gz
+ * @param binary 0 for the text format ("xadj: n", "adjncy: m", then one
+ * value per line), 1 for the binary layout: the 8 characters "SVADJBIN",
+ * int32 1 (version, also shows the byte order), int64 n, int64 m, then n
+ * int32 xadj values and m int32 adjncy values
+ * @return SV_OK if the file was written
+ */
+
+int TGenUtils_WriteAdjacency(char *filename,std::vector<int> &xadj,
+    std::vector<int> &adjncy,int binary)
+{
+  long long numXadj = xadj.size();
+  long long numAdj = adjncy.size();
+
+  if (binary)
+  {
+    FILE *fp = fopen(filename,"wb");
+    if (fp == NULL)
+    {
+      fprintf(stderr,"Error: Could not open output file %s.\n",filename);
+      return SV_ERROR;
+    }
+    int version = 1;
+    bool ok = fwrite("SVADJBIN",1,8,fp) == 8 &&
+      fwrite(&version,sizeof(int),1,fp) == 1 &&
+      fwrite(&numXadj,sizeof(long long),1,fp) == 1 &&
+      fwrite(&numAdj,sizeof(long long),1,fp) == 1 &&
+      (numXadj == 0 || fwrite(&xadj[0],sizeof(int),numXadj,fp) == (size_t)numXadj) &&
+      (numAdj == 0 || fwrite(&adjncy[0],sizeof(int),numAdj,fp) == (size_t)numAdj);
+    if (fclose(fp) != 0 || !ok)
+    {
+      fprintf(stderr,"Error: Could not write output file %s.\n",filename);
+      return SV_ERROR;
+    }
+    return SV_OK;
+  }
+
+  gzFile fp = NULL;
   #ifdef SV_USE_ZLIB
   char filenamegz[MAXPATHLEN];
   filenamegz[0]='\0';
-  sprintf (filenamegz, "%s.gz", filename.c_str());
-  myfile = gzopen (filenamegz, "wb");
-  if (myfile == NULL) {
+  sprintf (filenamegz, "%s.gz", filename);
+  fp = gzopen (filenamegz, "wb");
+  if (fp == NULL) {
       fprintf(stderr,"Error: Could not open output file %s.\n",filenamegz);
       return SV_ERROR;
   }
   #else
-  myfile = gzopen (filename.c_str(), "wb");
-  if (myfile == NULL) {
-      fprintf(stderr,"Error: Could not open output file %s.\n",filename.c_str());
+  fp = gzopen (filename, "wb");
+  if (fp == NULL) {
+      fprintf(stderr,"Error: Could not open output file %s.\n",filename);
       return SV_ERROR;
   }
   #endif
 
-  int i;
-  int numCells;
-  int *xadj;
-  int *adjacency;
-  vtkIdType cellId;
-  vtkIdType meshCellId;
-  vtkIdType p1,p2,p3;
-  vtkIdType npts = 0;
-  vtkIdType *pts = 0;
-  vtkSmartPointer<vtkCellArray> volCells = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkIntArray> globalIds = vtkSmartPointer<vtkIntArray>::New();
-  vtkSmartPointer<vtkIdList> ptIds = vtkSmartPointer<vtkIdList>::New();
-  vtkSmartPointer<vtkIdList> cellIds = vtkSmartPointer<vtkIdList>::New();
-  volumemesh->BuildLinks();
+  gzprintf(fp,"xadj: %i\n",(int)numXadj);
+  gzprintf(fp,"adjncy: %i\n",(int)numAdj);
 
-  if (VtkUtils_UGCheckArrayName(volumemesh,1,"GlobalElementID") != SV_OK)
+  //Format into a buffer instead of one gzprintf per value
+  std::vector<char> buffer(1<<20);
+  int used = 0;
+  for (long long i=0;i<numXadj+numAdj;i++)
   {
-    fprintf(stderr,"Array name 'GlobalElementID' does not exist. IDs on mesh may not have been assigned properly\n");
-    return SV_ERROR;
+    int value = i < numXadj ? xadj[i] : adjncy[i-numXadj];
+    used += sprintf(&buffer[used],"%i\n",value);
+    if (used > (int)buffer.size()-16 || i == numXadj+numAdj-1)
+    {
+      gzwrite(fp,&buffer[0],used);
+      used = 0;
+    }
   }
-  globalIds = vtkIntArray::SafeDownCast(volumemesh->GetCellData()->GetScalars("GlobalElementID"));
-  numCells = volumemesh->GetNumberOfCells();
-  volCells = volumemesh->GetCells();
 
-  xadj = new int[numCells];
-  adjacency = new int[4*numCells];
-  int adj = 0;
-  int xcheck = 0;
-  xadj[xcheck] = 0;
+  gzclose(fp);
+  return SV_OK;
+}
 
-  ptIds->SetNumberOfIds(3);
-  for (cellId = 0;cellId<numCells;cellId++)
+// -----------------------------
+// TGenUtils_PartitionAdjacency()
+// -----------------------------
+/**
+ * @brief splits an adjacency graph into parts of equal size by greedy
+ * graph growing
+ * @details Each connected component is ordered breadth first from a
+ * pseudo-peripheral element, and parts are grown by taking the next
+ * elements in that order, so every part after the first starts from the
+ * frontier of the previous one.
+ * @param numParts number of parts
+ * @param part on return, the part (0 to numParts-1) of each element
+ * @return SV_OK if numParts is positive
+ */
+
+int TGenUtils_PartitionAdjacency(std::vector<int> &xadj,std::vector<int> &adjncy,
+    int numParts,std::vector<int> &part)
+{
+  if (numParts < 1)
   {
-    meshCellId = globalIds->LookupValue(cellId+1);
-    volumemesh->GetCellPoints(meshCellId,npts,pts);
-    for (i=0;i < npts; i++)
-    {
-      p1 = pts[i];
-      p2 = pts[(i+1)%(npts)];
-      p3 = pts[(i+2)%(npts)];
+    fprintf(stderr,"Number of parts must be positive\n");
+    return SV_ERROR;
+  }
 
-      ptIds->InsertId(0,p1);
-      ptIds->InsertId(1,p2);
-      ptIds->InsertId(2,p3);
+  int numElems = xadj.empty() ? 0 : (int)xadj.size()-1;
+  std::vector<int> order;
+  order.reserve(numElems);
+  std::vector<int> seen(numElems,0);
+  int e,i,k;
 
-      volumemesh->GetCellNeighbors(meshCellId,ptIds,cellIds);
+  //seen is 1 for elements reached by the probe, 2 once they are ordered
+  for (e=0;e<numElems;e++)
+  {
+    if (seen[e] != 0)
+      continue;
 
-      //If it is zero, it is a face on the exterior. Otherwise, it has
-      //neighbors
-      if (cellIds->GetNumberOfIds() != 0)
+    //The last element reached from e is the seed
+    int start = (int)order.size();
+    order.push_back(e);
+    seen[e] = 1;
+    for (i=start;i<(int)order.size();i++)
+    {
+      for (k=xadj[order[i]];k<xadj[order[i]+1];k++)
       {
-	adjacency[adj++] = (int) globalIds->GetValue(cellIds->GetId(0)-1);
+        if (seen[adjncy[k]] == 0)
+        {
+          seen[adjncy[k]] = 1;
+          order.push_back(adjncy[k]);
+        }
       }
+    }
+    int seed = order.back();
+    order.resize(start);
 
+    order.push_back(seed);
+    seen[seed] = 2;
+    for (i=start;i<(int)order.size();i++)
+    {
+      for (k=xadj[order[i]];k<xadj[order[i]+1];k++)
+      {
+        if (seen[adjncy[k]] == 1)
+        {
+          seen[adjncy[k]] = 2;
+          order.push_back(adjncy[k]);
+        }
+      }
     }
-    xadj[++xcheck] = adj;
   }
 
-  gzprintf(myfile,"xadj: %i\n",numCells+1);
-  gzprintf(myfile,"adjncy: %i\n",adj);
-
-  for (i=0;i < numCells+1; i++)
+  part.resize(numElems);
+  for (int p=0;p<numParts;p++)
   {
-      gzprintf(myfile,"%i\n",xadj[i]);
+    int first = (int)(((long long)p*numElems)/numParts);
+    int last = (int)(((long long)(p+1)*numElems)/numParts);
+    for (i=first;i<last;i++)
+      part[order[i]] = p;
   }
-  for (i=0;i < adj; i++)
-  {
-      gzprintf(myfile,"%i\n",adjacency[i]);
-  }
-
-  delete xadj;
-  delete adjacency;
 
-  gzclose(myfile);
   return SV_OK;
 }
 
 // -----------------------------
-// cvTGenUtils_SetRefinementCylinder()
+// cvTGenUtils_writeDiffAdj()
 // -----------------------------
 /**
- * @brief computes the distance between each point on surface and center
- * @brief of cylinder. Then, if inside radius, the meshsizing function at the
- * @brief is set to the reduced size,
- * @param size This is the smaller refined of the edges within cylinder region.
- * @param radius This is the radius of the refinement cylinder.
- * @param center This is the center of the refinement cylinder.
- * @param length This is the length of the cylinder. Center is half the length.
- * @param normal This is the normal direction of the length of the cylinder.
- * It is normalized before being used for compuation.
- * @return SV_OK if function completes properly
+ * @brief This is the new way to write an adjacency file based on the mesh
+ * @note now implemented in the presolver as new command
  */
 
-int TGenUtils_SetRefinementCylinder(vtkPolyData *polydatasolid,
-    std::string sizingFunctionArrayName,double size,double radius, double *center,
-    double length, double *normal, int secondarray,double maxedgesize,
-    std::string refineIDArrayName, int refinecount)
+int TGenUtils_writeDiffAdj(vtkUnstructuredGrid *volumemesh)
 {
-  int numPts;
-  double disttopoint;
-  double distalonglength;
-  double pts[3];
-  double norm[3];
-  for (int i=0;i < 3;i++)
-    norm[i] = normal[i];
-  vtkIdType pointId;
-  vtkSmartPointer<vtkDoubleArray> meshSizeArray = vtkSmartPointer<vtkDoubleArray>::New();
-  vtkSmartPointer<vtkIntArray> refineIDArray = vtkSmartPointer<vtkIntArray>::New();
+  std::vector<int> xadj,adjncy;
+  if (TGenUtils_BuildElementAdjacency(volumemesh,xadj,adjncy) != SV_OK)
+    return SV_ERROR;
 
-  //Set sizing function params
-  numPts = polydatasolid->GetNumberOfPoints();
-  if (secondarray)
+  char filename[] = "compareAdjacency.xadj";
+  return TGenUtils_WriteAdjacency(filename,xadj,adjncy,0);
+}
+
+// Bounding volume hierarchy over the refinement zones.  Nodes are
+// stored in a flat array; a leaf holds the zones in order[first,first+count),
+// an inner node has its children at left and left+1.
+typedef struct TGenUtils_ZoneBVHNode {
+  double bounds[6];
+  int left;
+  int first;
+  int count;
+} TGenUtils_ZoneBVHNode;
+
+typedef struct TGenUtils_ZoneBVH {
+  std::vector<TGenUtils_ZoneBVHNode> nodes;
+  std::vector<int> order;
+  std::vector<double> zoneBounds;
+} TGenUtils_ZoneBVH;
+
+static void TGenUtils_BuildZoneBVHNode(TGenUtils_ZoneBVH &bvh,int nodeId,
+    int first,int count)
+{
+  int i,j,axis;
+  double cbounds[6];
+  TGenUtils_ZoneBVHNode &node = bvh.nodes[nodeId];
+  for (j=0;j<3;j++)
   {
-    if (VtkUtils_PDCheckArrayName(polydatasolid,0,sizingFunctionArrayName) != SV_OK)
-    {
-      fprintf(stderr,"Solid does not contain a double array of name %s. Regions must be identified \
-		      Reset or remake the array and try again\n",sizingFunctionArrayName.c_str());
-      return SV_ERROR;
-    }
-    meshSizeArray = vtkDoubleArray::SafeDownCast(polydatasolid->GetPointData()->GetArray(sizingFunctionArrayName.c_str()));
-    if (VtkUtils_PDCheckArrayName(polydatasolid,0,refineIDArrayName) != SV_OK)
-    {
-      fprintf(stderr,"Solid does not contain an int array of name %s. Regions must be identified \
-		      Reset or remake the array and try again\n",refineIDArrayName.c_str());
-      return SV_ERROR;
-    }
-    refineIDArray = vtkIntArray::SafeDownCast(polydatasolid->GetPointData()->GetArray(refineIDArrayName.c_str()));
+    node.bounds[2*j] = VTK_DOUBLE_MAX;
+    node.bounds[2*j+1] = -VTK_DOUBLE_MAX;
+    cbounds[2*j] = VTK_DOUBLE_MAX;
+    cbounds[2*j+1] = -VTK_DOUBLE_MAX;
   }
-  else
+  for (i=first;i<first+count;i++)
   {
-    meshSizeArray->SetNumberOfComponents(1);
-    meshSizeArray->Allocate(numPts,1000);
-    meshSizeArray->SetNumberOfTuples(numPts);
-    meshSizeArray->SetName(sizingFunctionArrayName.c_str());
-    refineIDArray->SetNumberOfComponents(1);
-    refineIDArray->Allocate(numPts,1000);
-    refineIDArray->SetNumberOfTuples(numPts);
-    refineIDArray->SetName(refineIDArrayName.c_str());
-    for (pointId = 0;pointId<numPts;pointId++)
+    double *zb = &bvh.zoneBounds[6*bvh.order[i]];
+    for (j=0;j<3;j++)
     {
-      meshSizeArray->SetValue(pointId,0.0);
-      refineIDArray->SetValue(pointId,0);
+      double c = 0.5*(zb[2*j]+zb[2*j+1]);
+      node.bounds[2*j] = std::min(node.bounds[2*j],zb[2*j]);
+      node.bounds[2*j+1] = std::max(node.bounds[2*j+1],zb[2*j+1]);
+      cbounds[2*j] = std::min(cbounds[2*j],c);
+      cbounds[2*j+1] = std::max(cbounds[2*j+1],c);
     }
   }
-
-  for (pointId = 0;pointId<numPts;pointId++)
+  node.first = first;
+  node.count = count;
+  node.left = -1;
+  if (count <= 4)
+    return;
+
+  //Split at the median zone center along the widest axis
+  axis = 0;
+  for (j=1;j<3;j++)
   {
-    polydatasolid->GetPoint(pointId,pts);
-    //compute distance
-    double pvec[3];
-    double scale;
-    vtkMath::Norm(norm);
-    vtkMath::Subtract(pts,center,pvec);
-    scale = vtkMath::Dot(pvec,norm);
-    vtkMath::MultiplyScalar(norm,scale);
-    disttopoint = sqrt(pow(pts[0]-norm[0],2)+
-	pow(pts[1]-norm[1],2)+
-	pow(pts[2]-norm[2],2));
+    if (cbounds[2*j+1]-cbounds[2*j] > cbounds[2*axis+1]-cbounds[2*axis])
+      axis = j;
+  }
+  int half = count/2;
+  const std::vector<double> &zoneBounds = bvh.zoneBounds;
+  std::nth_element(bvh.order.begin()+first,bvh.order.begin()+first+half,
+      bvh.order.begin()+first+count,
+      [&zoneBounds,axis](int a,int b) {
+        return zoneBounds[6*a+2*axis]+zoneBounds[6*a+2*axis+1] <
+               zoneBounds[6*b+2*axis]+zoneBounds[6*b+2*axis+1]; });
+
+  int left = bvh.nodes.size();
+  bvh.nodes[nodeId].left = left;
+  bvh.nodes.resize(left+2);
+  TGenUtils_BuildZoneBVHNode(bvh,left,first,half);
+  TGenUtils_BuildZoneBVHNode(bvh,left+1,first+half,count-half);
+}
 
-    distalonglength = sqrt(pow(norm[0]-center[0],2)+
-	pow(norm[1]-center[1],2)+
-	pow(norm[2]-center[2],2));
+static int TGenUtils_PointInZone(TGenUtils_RefinementZone *zone,double *pt)
+{
+  double pvec[3];
+  vtkMath::Subtract(pt,zone->center,pvec);
+  if (zone->type == TGENUTILS_SPHERE_ZONE)
+    return sqrt(vtkMath::Dot(pvec,pvec)) <= zone->radius;
+
+  //Cylinder: axial distance from the center and distance from the axis
+  double scale = vtkMath::Dot(pvec,zone->normal);
+  double perp[3];
+  for (int j=0;j<3;j++)
+    perp[j] = pvec[j] - scale*zone->normal[j];
+  return sqrt(vtkMath::Dot(perp,perp)) <= zone->radius &&
+         fabs(scale) <= zone->length/2;
+}
 
-    //set value to new size
-    if (disttopoint <= radius && distalonglength <= length/2)
+// Index of the last zone in zones that contains pt, or -1
+static int TGenUtils_FindLastZone(TGenUtils_ZoneBVH &bvh,
+    TGenUtils_RefinementZone *zones,double *pt)
+{
+  int best = -1;
+  int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0)
+  {
+    TGenUtils_ZoneBVHNode &node = bvh.nodes[stack[--top]];
+    if (pt[0] < node.bounds[0] || pt[0] > node.bounds[1] ||
+        pt[1] < node.bounds[2] || pt[1] > node.bounds[3] ||
+        pt[2] < node.bounds[4] || pt[2] > node.bounds[5])
+      continue;
+    if (node.left >= 0)
     {
-      meshSizeArray->SetValue(pointId,size);
-      refineIDArray->SetValue(pointId,refinecount+1);
+      stack[top++] = node.left;
+      stack[top++] = node.left+1;
+      continue;
     }
-    else
+    for (int i=node.first;i<node.first+node.count;i++)
     {
-      if (meshSizeArray->GetValue(pointId) == 0)
-        meshSizeArray->SetValue(pointId,maxedgesize);
+      int zoneId = bvh.order[i];
+      if (zoneId > best && TGenUtils_PointInZone(&zones[zoneId],pt))
+        best = zoneId;
     }
   }
+  return best;
+}
 
-  if (secondarray)
+template <class T>
+static void TGenUtils_ApplyRefinementZones(const T *xyz,int firstPt,int lastPt,
+    TGenUtils_ZoneBVH *bvh,TGenUtils_RefinementZone *zones,int numZones,
+    double *meshSize,int *refineID,double maxedgesize,int refinecount)
+{
+  double pt[3];
+  for (int pointId=firstPt;pointId<lastPt;pointId++)
   {
-    polydatasolid->GetPointData()->RemoveArray(sizingFunctionArrayName.c_str());
+    pt[0] = xyz[3*pointId];
+    pt[1] = xyz[3*pointId+1];
+    pt[2] = xyz[3*pointId+2];
+    int zoneId = TGenUtils_FindLastZone(*bvh,zones,pt);
+    if (zoneId >= 0)
+    {
+      meshSize[pointId] = zones[zoneId].size;
+      refineID[pointId] = refinecount+zoneId+1;
+    }
+    //Every zone after the one containing the point fills a zero size
+    //with maxedgesize, exactly as applying the zones one by one
+    if (meshSize[pointId] == 0 && zoneId != numZones-1)
+      meshSize[pointId] = maxedgesize;
   }
-  polydatasolid->GetPointData()->AddArray(meshSizeArray);
-  polydatasolid->GetPointData()->SetActiveScalars(sizingFunctionArrayName.c_str());
-  polydatasolid->GetPointData()->AddArray(refineIDArray);
-
-  return SV_OK;
 }
 
 // -----------------------------
-// cvTGenUtils_SetRefinementSphere()
+// cvTGenUtils_SetRefinementZones()
 // -----------------------------
 /**
- * @brief computes the distance between each point on surface and center
- * @brief of sphere. Then, if inside radius, the meshsizing function at the
- * @brief is set to the reduced size,
- * @param size This is the smaller refined of the edges within sphere region.
- * @param radius This is the radius of the refinement sphere.
- * @param center This is the center of the refinement sphere.
+ * @brief applies a list of sphere and cylinder refinement zones to the
+ * @brief mesh sizing function in one pass over the surface points. A point
+ * @brief inside one or more zones gets the size of the last of them, as if
+ * @brief the zones had been applied one after the other. The zones are kept
+ * @brief in a bounding volume hierarchy so only the zones near a point are
+ * @brief tested, and the points are split between threads.
+ * @param numZones This is the number of refinement zones.
+ * @param zones This is the array of refinement zones, in order.
+ * @param secondarray This designates whether a previous function is already
+ * applied.
+ * @param refinecount This is the number of zones already applied; zone i
+ * is given refine id refinecount+i+1.
  * @return SV_OK if function completes properly
  */
 
-int TGenUtils_SetRefinementSphere(vtkPolyData *polydatasolid,
-    std::string sizingFunctionArrayName,double size,double radius, double *center,
-    int secondarray,double maxedgesize, std::string refineIDArrayName, int refinecount)
+int TGenUtils_SetRefinementZones(vtkPolyData *polydatasolid,
+    std::string sizingFunctionArrayName,int numZones,
+    TGenUtils_RefinementZone *zones,int secondarray,double maxedgesize,
+    std::string refineIDArrayName,int refinecount)
 {
+  int i,j;
   int numPts;
-  double dist;
-  double pts[3];
-  vtkIdType pointId, cellId;
+  vtkIdType pointId;
   vtkSmartPointer<vtkDoubleArray> meshSizeArray = vtkSmartPointer<vtkDoubleArray>::New();
   vtkSmartPointer<vtkIntArray> refineIDArray = vtkSmartPointer<vtkIntArray>::New();
 
@@ -1032,17 +1363,18 @@ int TGenUtils_SetRefinementSphere(vtkPolyData *polydatasolid,
       return SV_ERROR;
     }
     meshSizeArray = vtkDoubleArray::SafeDownCast(polydatasolid->GetPointData()->GetArray(sizingFunctionArrayName.c_str()));
+    if (meshSizeArray == NULL)
+    {
+      fprintf(stderr,"Array %s is not a double array\n",sizingFunctionArrayName.c_str());
+      return SV_ERROR;
+    }
   }
   else
   {
     meshSizeArray->SetNumberOfComponents(1);
-    meshSizeArray->Allocate(numPts,1000);
     meshSizeArray->SetNumberOfTuples(numPts);
     meshSizeArray->SetName(sizingFunctionArrayName.c_str());
-    for (pointId = 0;pointId<numPts;pointId++)
-    {
-      meshSizeArray->SetValue(pointId,0.0);
-    }
+    meshSizeArray->FillComponent(0,0.0);
   }
   if (refinecount != 0)
   {
@@ -1053,43 +1385,107 @@ int TGenUtils_SetRefinementSphere(vtkPolyData *polydatasolid,
       return SV_ERROR;
     }
     refineIDArray = vtkIntArray::SafeDownCast(polydatasolid->GetPointData()->GetArray(refineIDArrayName.c_str()));
+    if (refineIDArray == NULL)
+    {
+      fprintf(stderr,"Array %s is not an int array\n",refineIDArrayName.c_str());
+      return SV_ERROR;
+    }
   }
   else
   {
     refineIDArray->SetNumberOfComponents(1);
-    refineIDArray->Allocate(numPts,1000);
     refineIDArray->SetNumberOfTuples(numPts);
     refineIDArray->SetName(refineIDArrayName.c_str());
-    for (pointId = 0;pointId<numPts;pointId++)
-    {
-      refineIDArray->SetValue(pointId,0);
-    }
+    refineIDArray->FillComponent(0,0);
   }
 
-  for (pointId = 0;pointId<numPts;pointId++)
+  if (numZones > 0 && numPts > 0)
   {
-    polydatasolid->GetPoint(pointId,pts);
-    //compute distance
-    dist = sqrt(pow(pts[0]-center[0],2)+
-	pow(pts[1]-center[1],2)+
-	pow(pts[2]-center[2],2));
-
-    //set value to new size
-    if (dist <= radius)
+    //Normalize the cylinder axes and bound every zone
+    std::vector<TGenUtils_RefinementZone> zoneList(zones,zones+numZones);
+    TGenUtils_ZoneBVH bvh;
+    bvh.zoneBounds.resize(6*numZones);
+    bvh.order.resize(numZones);
+    for (i=0;i<numZones;i++)
     {
-      meshSizeArray->SetValue(pointId,size);
-      refineIDArray->SetValue(pointId,refinecount+1);
+      TGenUtils_RefinementZone &zone = zoneList[i];
+      double *zb = &bvh.zoneBounds[6*i];
+      double extent[3] = {zone.radius,zone.radius,zone.radius};
+      if (zone.type == TGENUTILS_CYLINDER_ZONE)
+      {
+        if (vtkMath::Normalize(zone.normal) == 0.0)
+        {
+          fprintf(stderr,"Refinement cylinder %d has a zero normal\n",i);
+          return SV_ERROR;
+        }
+        for (j=0;j<3;j++)
+        {
+          double n = zone.normal[j];
+          extent[j] = fabs(n)*zone.length/2 +
+            zone.radius*sqrt(std::max(0.0,1.0-n*n));
+        }
+      }
+      //Pad so rounding never culls a point on the zone boundary
+      for (j=0;j<3;j++)
+      {
+        double pad = 1.0e-9*(fabs(zone.center[j])+fabs(extent[j]));
+        zb[2*j] = zone.center[j] - extent[j] - pad;
+        zb[2*j+1] = zone.center[j] + extent[j] + pad;
+      }
+      bvh.order[i] = i;
     }
-    else
+    bvh.nodes.resize(1);
+    TGenUtils_BuildZoneBVHNode(bvh,0,0,numZones);
+
+    //Evaluate all zones on the raw point, size and id buffers
+    double *meshSize = meshSizeArray->GetPointer(0);
+    int *refineID = refineIDArray->GetPointer(0);
+    vtkDataArray *coords = polydatasolid->GetPoints()->GetData();
+    std::vector<double> copied;
+    int coordType = coords->GetDataType();
+    if (coordType != VTK_DOUBLE && coordType != VTK_FLOAT)
+    {
+      copied.resize(3*numPts);
+      for (pointId=0;pointId<numPts;pointId++)
+        polydatasolid->GetPoint(pointId,&copied[3*pointId]);
+      coordType = VTK_DOUBLE;
+    }
+
+    int numThreads = std::max(1,(int)std::thread::hardware_concurrency());
+    numThreads = std::min(numThreads,std::max(1,numPts/10000));
+    std::vector<std::thread> workers;
+    for (i=0;i<numThreads;i++)
     {
-      if (meshSizeArray->GetValue(pointId) == 0)
-        meshSizeArray->SetValue(pointId,maxedgesize);
+      int firstPt = (int)(((long long)i*numPts)/numThreads);
+      int lastPt = (int)(((long long)(i+1)*numPts)/numThreads);
+      if (coordType == VTK_FLOAT)
+      {
+        const float *xyz = static_cast<float*>(coords->GetVoidPointer(0));
+        workers.push_back(std::thread(TGenUtils_ApplyRefinementZones<float>,
+          xyz,firstPt,lastPt,&bvh,&zoneList[0],numZones,meshSize,refineID,
+          maxedgesize,refinecount));
+      }
+      else
+      {
+        const double *xyz = copied.empty() ?
+          static_cast<double*>(coords->GetVoidPointer(0)) : &copied[0];
+        workers.push_back(std::thread(TGenUtils_ApplyRefinementZones<double>,
+          xyz,firstPt,lastPt,&bvh,&zoneList[0],numZones,meshSize,refineID,
+          maxedgesize,refinecount));
+      }
     }
+    for (i=0;i<(int)workers.size();i++)
+      workers[i].join();
+    meshSizeArray->Modified();
+    refineIDArray->Modified();
   }
 
   if (secondarray)
   {
     polydatasolid->GetPointData()->RemoveArray(sizingFunctionArrayName.c_str());
+  }
+  if (refinecount != 0)
+  {
     polydatasolid->GetPointData()->RemoveArray(refineIDArrayName.c_str());
   }
   polydatasolid->GetPointData()->AddArray(meshSizeArray);
@@ -1099,6 +1495,75 @@ int TGenUtils_SetRefinementSphere(vtkPolyData *polydatasolid,
   return SV_OK;
 }
 
+// -----------------------------
+// cvTGenUtils_SetRefinementCylinder()
+// -----------------------------
+/**
+ * @brief computes the distance between each point on surface and the axis
+ * @brief of cylinder. Then, if inside radius and within half the length of
+ * @brief the center along the axis, the meshsizing function at the point
+ * @brief is set to the reduced size,
+ * @param size This is the smaller refined of the edges within cylinder region.
+ * @param radius This is the radius of the refinement cylinder.
+ * @param center This is the center of the refinement cylinder.
+ * @param length This is the length of the cylinder. Center is half the length.
+ * @param normal This is the normal direction of the length of the cylinder.
+ * It is normalized before being used for compuation.
+ * @return SV_OK if function completes properly
+ */
+
+int TGenUtils_SetRefinementCylinder(vtkPolyData *polydatasolid,
+    std::string sizingFunctionArrayName,double size,double radius, double *center,
+    double length, double *normal, int secondarray,double maxedgesize,
+    std::string refineIDArrayName, int refinecount)
+{
+  TGenUtils_RefinementZone zone;
+  zone.type = TGENUTILS_CYLINDER_ZONE;
+  zone.size = size;
+  zone.radius = radius;
+  zone.length = length;
+  for (int i=0;i<3;i++)
+  {
+    zone.center[i] = center[i];
+    zone.normal[i] = normal[i];
+  }
+
+  return TGenUtils_SetRefinementZones(polydatasolid,sizingFunctionArrayName,
+    1,&zone,secondarray,maxedgesize,refineIDArrayName,refinecount);
+}
+
+// -----------------------------
+// cvTGenUtils_SetRefinementSphere()
+// -----------------------------
+/**
+ * @brief computes the distance between each point on surface and center
+ * @brief of sphere. Then, if inside radius, the meshsizing function at the
+ * @brief is set to the reduced size,
+ * @param size This is the smaller refined of the edges within sphere region.
+ * @param radius This is the radius of the refinement sphere.
+ * @param center This is the center of the refinement sphere.
+ * @return SV_OK if function completes properly
+ */
+
+int TGenUtils_SetRefinementSphere(vtkPolyData *polydatasolid,
+    std::string sizingFunctionArrayName,double size,double radius, double *center,
+    int secondarray,double maxedgesize, std::string refineIDArrayName, int refinecount)
+{
+  TGenUtils_RefinementZone zone;
+  zone.type = TGENUTILS_SPHERE_ZONE;
+  zone.size = size;
+  zone.radius = radius;
+  zone.length = 0.0;
+  for (int i=0;i<3;i++)
+  {
+    zone.center[i] = center[i];
+    zone.normal[i] = 0.0;
+  }
+
+  return TGenUtils_SetRefinementZones(polydatasolid,sizingFunctionArrayName,
+    1,&zone,secondarray,maxedgesize,refineIDArrayName,refinecount);
+}
+
 // -----------------------------
 // cvTGenUtils_SetSizeFunctionArray()
 // -----------------------------
@@ -1184,15 +1649,15 @@ int TGenUtils_SetSizeFunctionArray(vtkPolyData *polydatasolid,
       size = min;
     }
 
+    double *values = arrayonmesh->GetPointer(0);
+    double *meshSize = meshSizeArray->GetPointer(0);
     for (pointId = 0;pointId<numPts;pointId++)
     {
-      value = arrayonmesh->GetValue(pointId);
-      factor = value/min;
-  //    fprintf(stderr,"Value is : %.4f\n",factor);
-      //compute distance
+      factor = values[pointId]/min;
       //set value to reduced size
-      meshSizeArray->SetValue(pointId,factor*size);
+      meshSize[pointId] = factor*size;
     }
+    meshSizeArray->Modified();
     polydatasolid->GetPointData()->RemoveArray(functionname);
   }
   else
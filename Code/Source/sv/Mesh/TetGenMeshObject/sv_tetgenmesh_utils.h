@@ -54,6 +54,8 @@
 
 #include "simvascular_tetgen.h"
 
+#include <vector>
+
 SV_EXPORT_TETGEN_MESH int TGenUtils_Init();
 //int cvTetGenMeshObjectUtils_Logon(char *filename);
 //int cvTetGenMeshObjectUtils_Logoff();
@@ -82,6 +84,38 @@ SV_EXPORT_TETGEN_MESH int TGenUtils_WriteVTP(char *filename,vtkPolyData *PData);
 
 SV_EXPORT_TETGEN_MESH int TGenUtils_writeDiffAdj(vtkUnstructuredGrid *volumemesh);
 
+// Element adjacency in the compressed row (METIS) form; elements are
+// numbered by GlobalElementID-1.
+SV_EXPORT_TETGEN_MESH int TGenUtils_BuildElementAdjacency(vtkUnstructuredGrid *volumemesh,
+    std::vector<int> &xadj,std::vector<int> &adjncy);
+
+// Used by the mesh object's WriteMetisAdjacency (binary for ".bin" names)
+// and WritePartition methods, which are in the Tcl and Python mesh API.
+SV_EXPORT_TETGEN_MESH int TGenUtils_WriteAdjacency(char *filename,std::vector<int> &xadj,
+    std::vector<int> &adjncy,int binary);
+
+SV_EXPORT_TETGEN_MESH int TGenUtils_PartitionAdjacency(std::vector<int> &xadj,
+    std::vector<int> &adjncy,int numParts,std::vector<int> &part);
+
+// A sphere or cylinder region in which the mesh size is reduced.
+// For a cylinder, center is halfway along the length and normal gives
+// the direction of the axis; length and normal are unused for spheres.
+enum { TGENUTILS_SPHERE_ZONE = 0, TGENUTILS_CYLINDER_ZONE = 1 };
+
+typedef struct TGenUtils_RefinementZone {
+  int type;
+  double size;
+  double radius;
+  double center[3];
+  double length;
+  double normal[3];
+} TGenUtils_RefinementZone;
+
+SV_EXPORT_TETGEN_MESH int TGenUtils_SetRefinementZones(vtkPolyData *polydatasolid,
+    std::string sizingFunctionArrayName,int numZones,
+    TGenUtils_RefinementZone *zones,int secondarray,double maxedgesize,
+    std::string refineIDArrayName,int refinecount);
+
 SV_EXPORT_TETGEN_MESH int TGenUtils_SetRefinementCylinder(vtkPolyData *polydatasolid,
     std::string sizingFunctionArrayName,double size,double radius,
     double* center,double length, double *normal, int secondarray,
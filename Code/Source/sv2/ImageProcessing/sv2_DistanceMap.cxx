@@ -36,10 +36,16 @@
 #include <stdio.h>
 #include <math.h>
 
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
 #include "vtkXMLDataSetWriter.h"
 
 cvDistanceMap::cvDistanceMap() {
     map_ = NULL;
+    edt_ = NULL;
     path_ = NULL;
     mask_ = NULL;
     useCityBlock_ = 1;
@@ -67,11 +73,32 @@ cvDistanceMap::~cvDistanceMap() {
     if (map_ != NULL) {
         map_->Delete();
     }
+    if (edt_ != NULL) {
+        edt_->Delete();
+    }
     if (path_ != NULL) {
         path_->Delete();
     }
 }
 
+// thresholds the input scalars straight from their buffer: pixels
+// in threshold get MAX_DISTANCE_VAL, others -1
+template <class T>
+static int cvDistanceMap_Threshold(const T *data, int num,
+                                   vtkFloatingPointType thrval,
+                                   distanceMapType *dist) {
+    int nonZeroPixels = 0;
+    for (int s = 0; s < num; s++) {
+      if ((int)(data[s]) >= thrval) {
+        dist[s] = MAX_DISTANCE_VAL;
+        nonZeroPixels++;
+      } else {
+        dist[s] = -1;
+      }
+    }
+    return nonZeroPixels;
+}
+
 int cvDistanceMap::createDistanceMap (vtkStructuredPoints *vtksp,
                                         vtkFloatingPointType thrval,
                                         int start[3]) {
@@ -88,19 +115,15 @@ int cvDistanceMap::createDistanceMap (vtkStructuredPoints *vtksp,
     start_[1] = start[1];
     start_[2] = start[2];
 
-    int s;
-
     DISTANCEMAPVTKTYPE *mapScalars = DISTANCEMAPVTKTYPE::New();
     mapScalars->SetNumberOfComponents(1);
-    mapScalars->Allocate(1000,1000);
-    mapScalars->Initialize();
 
     vtkStructuredPoints *mapsp;
     mapsp = vtkStructuredPoints::New();
-//    mapsp = vtkStructuredPoints::New();
     mapsp->CopyStructure(vtksp);
     // not-in-vtk-6.0    mapsp->CopyInformation(vtksp);
     mapsp->GetPointData()->SetScalars(mapScalars);
+    mapScalars->Delete();
     vtkFloatingPointType origin[3];
     vtkFloatingPointType spacing[3];
     vtksp->GetOrigin(origin);
@@ -108,177 +131,224 @@ int cvDistanceMap::createDistanceMap (vtkStructuredPoints *vtksp,
     vtksp->GetSpacing(spacing);
     mapsp->SetSpacing(spacing);
 
-    int n;
-    distanceMapType Dq;
-
-    vtkFloatingPointType pixDimsF[3];
-    vtkFloatingPointType originF[3];
-
     vtksp->GetDimensions( imgDims_ );
-    vtksp->GetSpacing( pixDimsF );
-    vtksp->GetOrigin( originF );
 
     fprintf(stdout,"dims: %i %i %i\n", imgDims_[0],imgDims_[1],imgDims_[2]);
 
     vtkDataArray *vScalars = vtksp->GetPointData()->GetScalars();
 
-    int buckindex, bloop;
-
-    // count the number of non-zero
-    int nonZeroPixels = 0;
     int totalNumPixels = imgDims_[0]*imgDims_[1]*imgDims_[2];
+    int nonZeroPixels = 0;
 
-    for (s = 0; s < totalNumPixels; s++) {
-      if ((int)(vScalars->GetTuple1(s)) >= thrval) {
-        nonZeroPixels++;
-      }
+    mapScalars->SetNumberOfTuples(totalNumPixels);
+    distanceMapType *dist = mapScalars->GetPointer(0);
+
+    // all interior pixels start out at a (hopefully big) max distance
+    switch (vScalars->GetDataType()) {
+      vtkTemplateMacro(
+        nonZeroPixels = cvDistanceMap_Threshold(
+          static_cast<VTK_TT*>(vScalars->GetVoidPointer(0)),
+          totalNumPixels, thrval, dist));
+      default:
+        fprintf(stderr,"ERROR:  unsupported scalar type for distance map\n");
+        mapsp->Delete();
+        return SV_ERROR;
     }
 
     fprintf(stdout,"pixels in threshold: %i\n",nonZeroPixels);
 
-    mapScalars->SetNumberOfTuples(totalNumPixels);
+    setUpNeighborOffsets();
 
-    // add all interior pixels into the first bucket
-    for (s = 0; s < totalNumPixels;s++) {
-      if ((int)(vScalars->GetTuple1(s)) >= thrval) {
-          //bucket[0]->InsertNextId(s);
-         // hopefully big number!
-         mapScalars->SetTuple1(s,MAX_DISTANCE_VAL);
-      } else {
-          mapScalars->SetTuple1(s,-1);
-      }
+    // Every step costs 1, so the bucket queue only ever holds two
+    // buckets: pixels at the current distance and pixels at the next.
+    // A pixel's distance is final when it is first reached.
+    std::vector<int> bucket[2];
+    int cur = 0;
+    int nbrs[26];
+    int b, n, p, q, numNbrs;
+    distanceMapType Dq = 0;
+
+    // id point is a zero distance from itself
+    p = vtksp->ComputePointId(start);
+    dist[p] = 0;
+    if (nonZeroPixels > 0) {
+      bucket[cur].push_back(p);
     }
 
-    // wastefully allocation
-    int bucketlookup[5];
-    for (int i = 0; i < 5; i++) {
-      bucketlookup[i] = i;
+    while (!bucket[cur].empty()) {
+      Dq++;
+      bucket[1-cur].clear();
+      for (b = 0; b < (int)bucket[cur].size(); b++) {
+        p = bucket[cur][b];
+        numNbrs = getNeighborsFast(p,nbrs);
+        for (n = 0; n < numNbrs; n++) {
+          q = nbrs[n];
+          if (dist[q] > Dq) {
+            dist[q] = Dq;
+            bucket[1-cur].push_back(q);
+          }
+        }
+      }
+      cur = 1 - cur;
     }
 
-    vtkIdList *bucket[4];
-    bucket[0] = vtkIdList::New();bucket[0]->Allocate(100,100);
-    bucket[1] = vtkIdList::New();bucket[1]->Allocate(100,100);
-    bucket[2] = vtkIdList::New();bucket[2]->Allocate(100,100);
+    map_ = mapsp;
 
-    bucketlookup[0] = 0;
-    bucketlookup[1] = 1;
-    bucketlookup[2] = 2;
+    return SV_OK;
 
-    // loop until all the buckets are empty
-    int loopAllBuckets = 0;
-    int p = vtksp->ComputePointId(start);
-    int q = 0;
+}
 
-    // id point is a zero distance from itself
-    mapScalars->SetTuple1(p,0);
+// 1-D squared distance transform (Felzenszwalb & Huttenlocher) of
+// each line along axis whose index along the slowest remaining axis
+// lies in [first,last).  f holds squared distances in physical units,
+// with infinity for pixels with no site yet.
 
-//    bucket[0]->InsertNextId(p);
-//    bucket[0]->DeleteId(p);
+int cvDistanceMap::computeEDTLines(float *f, int axis, int first, int last) {
 
-    while ((loopAllBuckets < nonZeroPixels) && (p != -1)) {
+    int nx = imgDims_[0];
+    int nxy = imgDims_[0]*imgDims_[1];
+    int len = imgDims_[axis];
+    int stride = (axis == 0) ? 1 : ((axis == 1) ? nx : nxy);
+    double h = spacing_[axis];
+    float inf = std::numeric_limits<float>::infinity();
 
-        if (useCityBlock_ == 0) {
-          get26ConnectivityNeighbors(p);
-        } else {
-          getCityBlockNeighbors(p);
-        }
+    // the other two axes, outer one split between threads
+    int inner = (axis == 0) ? 1 : 0;
+    int outer = (axis == 2) ? 1 : 2;
+    int innerStride = (inner == 0) ? 1 : nx;
+    int outerStride = (outer == 1) ? nx : nxy;
 
-        // loop over neighbors_s and calc distance
-        for (n = 0; n < numNeighbors_; n++) {
-            q = neighbors_[n];
+    std::vector<double> line(len), out(len), z(len+1);
+    std::vector<int> v(len);
 
-            if (q < 0) continue;
-            // check distance value
-            //fprintf(stdout,"mapScalars [%i] : %i\n",q,(int)mapScalars->GetTuple1(q));
-            if ((int)(mapScalars->GetTuple1(q)) >= 0) {
-                distanceMapType pval = (distanceMapType)(mapScalars->GetTuple1(p));
-                distanceMapType qval = (distanceMapType)(mapScalars->GetTuple1(q));
-                Dq = pval + 1;
-                //fprintf(stdout,"%i %i %i\n",p,q,Dq);
-                if (Dq < qval) {
-                    if (qval != MAX_DISTANCE_VAL) {
-                      buckindex = -1;
-                      for (bloop = 0; bloop < 3; bloop++) {
-                        if (qval == bucketlookup[bloop]) {
-                          buckindex = bloop;
-                          break;
-                          }
-                      }
-                      if (buckindex < 0) {
-                        fprintf(stdout,"invalid bucket (Dq = %i, qval = %i)\n",Dq,qval);
-                        exit(-1);
-                      }
-                      bucket[buckindex] -> DeleteId(q);
-                    }
-                    mapScalars->SetTuple1(q,Dq);
-                    buckindex = -1;
-                    for (bloop = 0; bloop < 3; bloop++) {
-                      if (Dq == bucketlookup[bloop]) {
-                          buckindex = bloop;
-                          break;
-                      }
-                    }
-                    if (buckindex < 0) {
-                      fprintf(stdout,"invalid bucket (Dq = %i, q = %i)\n",Dq,q);
-                      exit(-1);
-                    }
-                    bucket[buckindex]->InsertNextId(q);
-                }
-            }
-        }
+    for (int a = first; a < last; a++) {
+      for (int b = 0; b < imgDims_[inner]; b++) {
+        float *base = f + a*outerStride + b*innerStride;
+        int i, k = -1;
 
-      p = -1;
+        for (i = 0; i < len; i++) {
+          line[i] = base[i*stride];
+        }
 
-      while (loopAllBuckets < nonZeroPixels) {
-        buckindex = -1;
-        for (bloop = 0; bloop < 3; bloop++) {
-          if (loopAllBuckets == bucketlookup[bloop]) {
-             buckindex = bloop;
-             break;
+        // lower envelope of the parabolas rooted at finite sites
+        for (i = 0; i < len; i++) {
+          if (line[i] == inf) continue;
+          double xi = h*i;
+          while (k >= 0) {
+            double xv = h*v[k];
+            double s = ((line[i] + xi*xi) - (line[v[k]] + xv*xv)) / (2.0*(xi - xv));
+            if (s > z[k]) {
+              k++;
+              v[k] = i;
+              z[k] = s;
+              z[k+1] = inf;
+              break;
+            }
+            k--;
+          }
+          if (k < 0) {
+            k = 0;
+            v[0] = i;
+            z[0] = -inf;
+            z[1] = inf;
           }
         }
-        if (buckindex < 0) {
-          fprintf(stdout,"invalid bucket (loopAllBuckets %i)\n",loopAllBuckets);
-                        exit(-1);
+
+        if (k < 0) continue;   // no sites on this line
+
+        int j = 0;
+        for (i = 0; i < len; i++) {
+          double xi = h*i;
+          while (z[j+1] < xi) j++;
+          double d = xi - h*v[j];
+          out[i] = d*d + line[v[j]];
         }
-        if (bucket[buckindex]->GetNumberOfIds() == 0) {
-            //buckets[buckindex+3] = buckets[buckindex];
-          bucketlookup[buckindex] = loopAllBuckets+3;
-            //buckets[buckindex] = NULL;
-          loopAllBuckets++;
-        } else {
-            //if (buckets[loopAllBuckets] == NULL) {
-            //  fprintf(stdout,"invalid bucket (loopAllBuckets %i)\n",loopAllBuckets);
-            //  exit(-1);
-            //}
-            //if (buckets[loopAllBuckets]->GetNumberOfIds() == 0) {
-            //    fprintf(stdout,"error, zero entries in bucket %i\n",loopAllBuckets);
-            //    exit(-1);
-            //}
-            p = bucket[buckindex]->GetId(0);
-            bucket[buckindex]->DeleteId(p);
-            break;
+        for (i = 0; i < len; i++) {
+          base[i*stride] = (float)out[i];
         }
       }
+    }
+
+    return SV_OK;
+
+}
+
+int cvDistanceMap::createEuclideanDistanceMap (vtkStructuredPoints *vtksp,
+                                                 vtkFloatingPointType thrval) {
 
+    if (edt_ != NULL) {
+        edt_->Delete();
+        edt_ = NULL;
     }
 
-//    vtkXMLDataSetWriter *foo = vtkXMLDataSetWriter::New();
-//    foo->SetInputDataObject(mapsp);
-//    foo->SetFileName("debug.vti");
-//    foo->Write();
+    vtksp->GetDimensions( imgDims_ );
+    vtksp->GetSpacing( spacing_ );
+
+    int totalNumPixels = imgDims_[0]*imgDims_[1]*imgDims_[2];
 
-    map_ = mapsp;
+    // squared distances start at 0 on the background and infinity
+    // inside; reuse the thresholding of createDistanceMap
+    std::vector<distanceMapType> inside(totalNumPixels);
+    vtkDataArray *vScalars = vtksp->GetPointData()->GetScalars();
+    switch (vScalars->GetDataType()) {
+      vtkTemplateMacro(
+        cvDistanceMap_Threshold(
+          static_cast<VTK_TT*>(vScalars->GetVoidPointer(0)),
+          totalNumPixels, thrval, &inside[0]));
+      default:
+        fprintf(stderr,"ERROR:  unsupported scalar type for distance map\n");
+        return SV_ERROR;
+    }
+
+    vtkFloatArray *edtScalars = vtkFloatArray::New();
+    edtScalars->SetNumberOfComponents(1);
+    edtScalars->SetNumberOfTuples(totalNumPixels);
+    float *f = edtScalars->GetPointer(0);
+    int s;
+    for (s = 0; s < totalNumPixels; s++) {
+      f[s] = (inside[s] < 0) ? 0.0f : std::numeric_limits<float>::infinity();
+    }
 
-    //delete [] buckets;
-    bucket[0]->Delete();
-    bucket[1]->Delete();
-    bucket[2]->Delete();
+    // separable passes along x, y and z; the lines of a pass are
+    // independent, so each pass is split over slices of the outer axis
+    int numThreads = std::max(1,(int)std::thread::hardware_concurrency());
+    int axis, t;
+    for (axis = 0; axis < 3; axis++) {
+      if (imgDims_[axis] < 2) continue;
+      int numOuter = (axis == 2) ? imgDims_[1] : imgDims_[2];
+      int nt = std::min(numThreads,numOuter);
+      std::vector<std::thread> workers;
+      for (t = 1; t < nt; t++) {
+        workers.push_back(std::thread(&cvDistanceMap::computeEDTLines, this, f, axis,
+                                      (t*numOuter)/nt, ((t+1)*numOuter)/nt));
+      }
+      computeEDTLines(f, axis, 0, numOuter/nt);
+      for (t = 0; t < (int)workers.size(); t++) {
+        workers[t].join();
+      }
+    }
+
+    for (s = 0; s < totalNumPixels; s++) {
+      f[s] = sqrt(f[s]);
+    }
+
+    edt_ = vtkStructuredPoints::New();
+    edt_->CopyStructure(vtksp);
+    edt_->GetPointData()->SetScalars(edtScalars);
+    edtScalars->Delete();
+    vtkFloatingPointType origin[3];
+    vtksp->GetOrigin(origin);
+    edt_->SetOrigin(origin);
+    edt_->SetSpacing(spacing_);
 
     return SV_OK;
 
 }
 
+vtkStructuredPoints* cvDistanceMap::getEuclideanDistanceMap() {
+    return edt_;
+}
+
 vtkStructuredPoints* cvDistanceMap::getDistanceMap() {
     return map_;
 }
@@ -383,7 +453,7 @@ vtkPolyData* cvDistanceMap::getPathOld(int stop[3]) {
 
 vtkPolyData* cvDistanceMap::getPath(int stop[3], int minqstop) {
 
-    int i,n;
+    int i;
 
     if (map_ == NULL) {
         return NULL;
@@ -396,51 +466,34 @@ vtkPolyData* cvDistanceMap::getPath(int stop[3], int minqstop) {
     stop_[2] = stop[2];
 
     map_->GetDimensions( imgDims_ );
+    setUpNeighborOffsets();
 
-    vtkDataArray *mapScalars = map_->GetPointData()->GetScalars();
+    std::vector<distanceMapType> tmp;
+    const distanceMapType *dist = getMapBuffer(tmp);
 
     int p = map_->ComputePointId(stop);
-    int q = 0;
 
     distanceMapType minq = MAX_DISTANCE_VAL;
 
-    vtkIdList *curpath = vtkIdList::New();
-    curpath->Allocate(100,100);
+    std::vector<int> curpath;
 
     while (minq > minqstop) {
 
-        if (useCityBlock_ == 0) {
-          get26ConnectivityNeighbors(p);
-        } else {
-          getCityBlockNeighbors(p);
-        }
-
-        // loop over neighbors and calc distance
-        p = -1;
-        for (n = 0; n < numNeighbors_; n++) {
-            q = neighbors_[n];
-            if (q < 0) continue;
-            distanceMapType qval = (distanceMapType)(mapScalars->GetTuple1(q));
-            if (qval >= 0 && qval <= minq) {
-                minq = qval;
-                p = q;
-            }
-        }
+        p = stepDown(dist,p,&minq);
 
         if (p < 0) {
           fprintf(stdout,"ERROR:  could not find less than equal path to next pt!\n");
-          curpath->Delete();
           return NULL;
         }
 
-        curpath->InsertNextId(p);
+        curpath.push_back(p);
 
     }
 
     // create return vtk polydata
 
     vtkPoints *mypts   =  vtkPoints::New();
-    mypts->Allocate(100,100);
+    mypts->Allocate(curpath.size(),100);
     vtkCellArray  *mylines =  vtkCellArray::New();
     mylines->Allocate(100,100);
     mylines->InitTraversal();
@@ -451,12 +504,13 @@ vtkPolyData* cvDistanceMap::getPath(int stop[3], int minqstop) {
 
     mypd->SetPoints(mypts);
     mypd->SetLines(mylines);
+    mypts->Delete();
+    mylines->Delete();
 
     double x[3];
 
-    for (i = curpath->GetNumberOfIds() - 1; i >= 0; i--) {
-        p = curpath->GetId(i);
-        map_ -> GetPoint(p,x);
+    for (i = (int)curpath.size() - 1; i >= 0; i--) {
+        map_ -> GetPoint(curpath[i],x);
         mypts->InsertNextPoint(x);
         int numpts = mypts->GetNumberOfPoints();
         if ( numpts > 1) {
@@ -467,15 +521,100 @@ vtkPolyData* cvDistanceMap::getPath(int stop[3], int minqstop) {
         }
     }
 
-    path_ = mypd;
+    line->Delete();
 
-    curpath->Delete();
+    path_ = mypd;
 
     return path_;
 
 }
 
 
+vtkPolyData* cvDistanceMap::getPaths(int numStops, int stops[][3], int minqstop) {
+
+    int i,s;
+
+    if (map_ == NULL || numStops < 1) {
+        return NULL;
+    }
+
+    map_->GetDimensions( imgDims_ );
+    setUpNeighborOffsets();
+
+    std::vector<distanceMapType> tmp;
+    const distanceMapType *dist = getMapBuffer(tmp);
+
+    // point id in the output for every pixel already on some path,
+    // so later paths stop where they run into an earlier one
+    std::unordered_map<int,vtkIdType> visited;
+
+    vtkPoints *mypts   =  vtkPoints::New();
+    mypts->Allocate(1000,1000);
+    vtkCellArray  *mylines =  vtkCellArray::New();
+    mylines->Allocate(100,100);
+    vtkPolyData *mypd  =  vtkPolyData::New();
+    mypd->SetPoints(mypts);
+    mypd->SetLines(mylines);
+    mypts->Delete();
+    mylines->Delete();
+
+    vtkIdList *line = vtkIdList::New();
+    std::vector<int> curpath;
+    double x[3];
+
+    for (s = 0; s < numStops; s++) {
+
+        int p = map_->ComputePointId(stops[s]);
+        distanceMapType minq = MAX_DISTANCE_VAL;
+        vtkIdType joinId = -1;
+
+        curpath.clear();
+
+        while (minq > minqstop) {
+
+            p = stepDown(dist,p,&minq);
+
+            if (p < 0) {
+              fprintf(stdout,"ERROR:  could not find less than equal path to next pt (stop %i)!\n",s);
+              line->Delete();
+              mypd->Delete();
+              return NULL;
+            }
+
+            // the descent is deterministic, so from here on this path
+            // is the same as the one already traced
+            std::unordered_map<int,vtkIdType>::iterator it = visited.find(p);
+            if (it != visited.end()) {
+              joinId = it->second;
+              break;
+            }
+
+            curpath.push_back(p);
+
+        }
+
+        // polyline from the start side out to this stop
+        line->Initialize();
+        if (joinId >= 0) {
+          line->InsertNextId(joinId);
+        }
+        for (i = (int)curpath.size() - 1; i >= 0; i--) {
+            map_ -> GetPoint(curpath[i],x);
+            vtkIdType id = mypts->InsertNextPoint(x);
+            visited[curpath[i]] = id;
+            line->InsertNextId(id);
+        }
+        mypd->InsertNextCell(VTK_POLY_LINE,line);
+
+    }
+
+    line->Delete();
+
+    return mypd;
+
+}
+
+
 vtkPolyData* cvDistanceMap::getPathByThinning(int stop[3],  int minqstop, int maxIterNum) {
 
   int i,n;
@@ -710,7 +849,7 @@ int cvDistanceMap::get26ConnectivityNeighbors(int p) {
 
   int n,ti,tj,tk;
 
-  for (n = 0; n < 27; n++) {
+  for (n = 0; n < 26; n++) {
       ti = i + b_[0][n];
       tj = j + b_[1][n];
       tk = k + b_[2][n];
@@ -842,3 +981,118 @@ int cvDistanceMap::thinMask(int *numPixelsRemoved) {
     return SV_OK;
 
 }
+
+// Id offsets of the neighbors for the current dimensions, listed in
+// the order getCityBlockNeighbors / get26ConnectivityNeighbors use,
+// so ties in the path descent are broken the same way.
+
+void cvDistanceMap::setUpNeighborOffsets() {
+
+  int n;
+  int nx = imgDims_[0];
+  int nxy = imgDims_[0]*imgDims_[1];
+
+  if (useCityBlock_ == 0) {
+    for (n = 0; n < 26; n++) {
+      offsetIJK_[n][0] = b_[0][n];
+      offsetIJK_[n][1] = b_[1][n];
+      offsetIJK_[n][2] = b_[2][n];
+    }
+    numOffsets_ = 26;
+  } else {
+    static const int cb[6][3] = {{-1,0,0},{1,0,0},{0,-1,0},
+                                 {0,1,0},{0,0,-1},{0,0,1}};
+    for (n = 0; n < 6; n++) {
+      offsetIJK_[n][0] = cb[n][0];
+      offsetIJK_[n][1] = cb[n][1];
+      offsetIJK_[n][2] = cb[n][2];
+    }
+    numOffsets_ = 6;
+  }
+
+  for (n = 0; n < numOffsets_; n++) {
+    offsets_[n] = offsetIJK_[n][0] + nx*offsetIJK_[n][1] + nxy*offsetIJK_[n][2];
+  }
+
+}
+
+// Fills nbrs with the in-bounds neighbors of p (in offset order) and
+// returns how many there are.  Pixels away from the image border take the
+// plain offset path with no bounds checks.
+
+int cvDistanceMap::getNeighborsFast(int p, int nbrs[26]) {
+
+  int n,num = 0;
+  int nxy = imgDims_[0]*imgDims_[1];
+
+  int k = p / nxy;
+  int j = (p - k*nxy) / imgDims_[0];
+  int i = p - k*nxy - j*imgDims_[0];
+
+  if (i > 0 && j > 0 && k > 0 &&
+      i < imgDims_[0]-1 && j < imgDims_[1]-1 && k < imgDims_[2]-1) {
+    for (n = 0; n < numOffsets_; n++) {
+      nbrs[n] = p + offsets_[n];
+    }
+    return numOffsets_;
+  }
+
+  for (n = 0; n < numOffsets_; n++) {
+    int ti = i + offsetIJK_[n][0];
+    int tj = j + offsetIJK_[n][1];
+    int tk = k + offsetIJK_[n][2];
+    if (ti < 0 || tj <  0 || tk < 0 ||
+        ti >= imgDims_[0] || tj >= imgDims_[1] || tk >= imgDims_[2]) {
+      continue;
+    }
+    nbrs[num++] = p + offsets_[n];
+  }
+
+  return num;
+
+}
+
+// Raw distance values of map_.  Maps built here are read in place;
+// a map handed in with setDistanceMap in some other type is converted
+// once into tmp.
+
+const distanceMapType* cvDistanceMap::getMapBuffer(std::vector<distanceMapType> &tmp) {
+
+  vtkDataArray *mapScalars = map_->GetPointData()->GetScalars();
+
+  DISTANCEMAPVTKTYPE *native = DISTANCEMAPVTKTYPE::SafeDownCast(mapScalars);
+  if (native != NULL) {
+    return native->GetPointer(0);
+  }
+
+  int s,num = mapScalars->GetNumberOfTuples();
+  tmp.resize(num);
+  for (s = 0; s < num; s++) {
+    tmp[s] = (distanceMapType)(mapScalars->GetTuple1(s));
+  }
+
+  return tmp.empty() ? NULL : &tmp[0];
+
+}
+
+// One step of the path descent from p: the last neighbor with a
+// distance in [0,*minq] wins and *minq is lowered to it.  Returns -1
+// if there is none.
+
+int cvDistanceMap::stepDown(const distanceMapType *dist, int p, distanceMapType *minq) {
+
+  int nbrs[26];
+  int n,q = -1;
+  int numNbrs = getNeighborsFast(p,nbrs);
+
+  for (n = 0; n < numNbrs; n++) {
+    distanceMapType qval = dist[nbrs[n]];
+    if (qval >= 0 && qval <= *minq) {
+      *minq = qval;
+      q = nbrs[n];
+    }
+  }
+
+  return q;
+
+}
@@ -36,6 +36,8 @@
 #include "svImageExports.h"
 #include "sv_VTK.h"
 
+#include <vector>
+
 // use ints for distance map
 typedef int distanceMapType;
 #define DISTANCEMAPVTKTYPE vtkIntArray
@@ -58,7 +60,17 @@ class SV_EXPORT_IMAGE cvDistanceMap {
     vtkStructuredPoints* getDistanceMap();
     void setDistanceMap(vtkStructuredPoints *sp);
 
+    // exact Euclidean distance (in physical units) from every pixel
+    // at or above thrval to the nearest pixel below it; kept apart
+    // from the map used for path finding
+    int createEuclideanDistanceMap(vtkStructuredPoints *vtksp,
+                                   vtkFloatingPointType thrval);
+    vtkStructuredPoints* getEuclideanDistanceMap();
+
     vtkPolyData* getPath(int stop[3], int minqstop);
+    // one polyline per stop point, all traced on the same map; paths
+    // share the points where they merge
+    vtkPolyData* getPaths(int numStops, int stops[][3], int minqstop);
     vtkPolyData* getPathByThinning(int stop[3], int minqstop, int maxIterNum);
     vtkPolyData* getPathOld(int stop[3]);
 
@@ -72,7 +84,14 @@ class SV_EXPORT_IMAGE cvDistanceMap {
     int createInitMask();
     int thinMask(int *numPixelsRemoved);
 
+    void setUpNeighborOffsets();
+    int getNeighborsFast(int p, int nbrs[26]);
+    const distanceMapType* getMapBuffer(std::vector<distanceMapType> &tmp);
+    int stepDown(const distanceMapType *dist, int p, distanceMapType *minq);
+    int computeEDTLines(float *f, int axis, int first, int last);
+
     vtkStructuredPoints *map_;
+    vtkStructuredPoints *edt_;
     vtkStructuredPoints *mask_;
     vtkPolyData *path_;
     int start_[3];
@@ -85,6 +104,13 @@ class SV_EXPORT_IMAGE cvDistanceMap {
     int useCityBlock_;
 
     int imgDims_[3];
+    double spacing_[3];
+
+    // neighbor id offsets (and their ijk steps) in the same order as
+    // getCityBlockNeighbors / get26ConnectivityNeighbors
+    int offsets_[26];
+    int offsetIJK_[26][3];
+    int numOffsets_;
 
 };
 
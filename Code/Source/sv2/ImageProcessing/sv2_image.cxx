@@ -36,12 +36,105 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <atomic>
 #include "sv2_image.h"
 #include "sv_misc_utils.h"
 
 
 static double gMachineEpsilon;
 
+// Width (in pixels) of the region sealed off by CloseImageGradBounds:
+static const int gGradBdReg = 3;
+
+// Edge length (in pixels) of a gradient tile:
+static const int gGradTileSz = 8;
+
+// At most one tile in gGradTileFrac is kept.  A tile costs 12 bytes
+// per pixel, so this holds cached gradients to 3 bytes per pixel
+// averaged over the image, and the whole image (intensities included)
+// to under 8 bytes per pixel.
+static const int gGradTileFrac = 4;
+
+
+// Gradient tiles.  Each tile holds gradX, gradY, gradZ (as float's)
+// for a block of pixels and is filled in by the first lookup which
+// touches it.  Tiles are published with a compare-and-swap, so
+// concurrent lookups (e.g. from a multi-threaded level set velocity
+// evaluation) are safe; a thread which loses the race simply drops
+// its copy, which holds the same values.  Once maxTiles tiles have
+// been filled in, lookups in the remaining tiles compute the pixel
+// gradients directly and nothing more is cached.
+
+struct ImgGradTiles_T {
+  int tileDims[3];
+  int numTiles[3];
+  int maxTiles;
+  std::atomic<float*> *tiles;
+  std::atomic<int> numAllocated;
+};
+
+
+// ---------
+// Img_Datum
+// ---------
+
+static inline double Img_Datum( Image_T *image, int pixIx )
+{
+  if ( image->scalarType == IMG_SHORT ) {
+    return (double)( ((short *)(image->data))[pixIx] );
+  } else {
+    return (double)( ((float *)(image->data))[pixIx] );
+  }
+}
+
+
+// ----------------
+// Img_AllocateData
+// ----------------
+// The type used for storage: short data stays short, anything else
+// is stored as float.
+
+static void Img_AllocateData( Image_T *image, int convertShort )
+{
+  int len = image->imgDims[0] * image->imgDims[1] * image->imgDims[2];
+
+  if ( convertShort ) {
+    image->scalarType = IMG_SHORT;
+    image->data = (void *) new short [len];
+  } else {
+    image->scalarType = IMG_FLOAT;
+    image->data = (void *) new float [len];
+  }
+  image->gradTiles = NULL;
+  image->gradValid = 0;
+  image->closed = 0;
+  image->gradBoundsClosed = 0;
+  image->gradBoundValue = 0.0;
+}
+
+
+// -------------------
+// Img_DeleteGradTiles
+// -------------------
+
+static void Img_DeleteGradTiles( Image_T *image )
+{
+  ImgGradTiles_T *gt = image->gradTiles;
+  int numTiles, t;
+
+  if ( gt == NULL ) {
+    return;
+  }
+  numTiles = gt->numTiles[0] * gt->numTiles[1] * gt->numTiles[2];
+  for ( t = 0; t < numTiles; t++ ) {
+    delete [] gt->tiles[t].load();
+  }
+  delete [] gt->tiles;
+  delete gt;
+  image->gradTiles = NULL;
+  image->gradValid = 0;
+}
+
 
 // =============
 //   ReadImage
@@ -52,8 +145,8 @@ static double gMachineEpsilon;
 // is the responsibility of the caller.  If the function fails, a NULL
 // pointer is returned.  Note that it seems that both raw MR data in
 // the Signa format and slice planes from David Paik's path planner
-// store images as arrays of short's (size = 2), so that's why
-// Image_T::data is a short *.
+// store images as arrays of short's (size = 2), so that's why short
+// files are kept as short's.  Files of double's are kept as float's.
 
 Image_T *ReadImage( char *filebase, int fileNumRange[], char *imgTypeFlag,
 		    int imgDims[], double pixelDims[] )
@@ -62,10 +155,10 @@ Image_T *ReadImage( char *filebase, int fileNumRange[], char *imgTypeFlag,
   Image_T *image;
   char filename[1000];
   int filecount, filenum;
-  int i, dataLen, fileLen, num;
+  int i, fileLen, num;
   short *tmpDataShort = NULL;
   double *tmpDataDouble = NULL;
-  int rowIx, colIx, planeIx, planeOffset;
+  float *floatData;
   int convertShort;
 
   // Uh, yeah, I know it's ugly to put this here, but what else are we
@@ -92,7 +185,6 @@ Image_T *ReadImage( char *filebase, int fileNumRange[], char *imgTypeFlag,
   }
 
   image = new Image_T;
-  image->gradValid = 0;
   if ( fileNumRange[0] == fileNumRange[1] ) {
     image->dim = 2;
   } else {
@@ -115,15 +207,16 @@ Image_T *ReadImage( char *filebase, int fileNumRange[], char *imgTypeFlag,
     image->pixelDims[2] = 1.0;
   }
 
-  dataLen = imgDims[0] * imgDims[1] * imgDims[2];
   fileLen = imgDims[0] * imgDims[1];
 
-  image->pixels = new Pixel_T [dataLen];
+  // Short files are read straight into the image:
+  Img_AllocateData( image, convertShort );
   if (convertShort) {
-    tmpDataShort = new short [dataLen];
+    tmpDataShort = (short *)(image->data);
   } else {
-    tmpDataDouble = new double [dataLen];
+    tmpDataDouble = new double [fileLen];
   }
+  floatData = (float *)(image->data);
 
   for ( filecount = fileNumRange[0];
 	filecount <= fileNumRange[1];
@@ -135,8 +228,8 @@ Image_T *ReadImage( char *filebase, int fileNumRange[], char *imgTypeFlag,
     fp = fopen( filename, "r" );
     if (fp == NULL) {
       fprintf(stderr, "ERR: Couldn't open image file %s.\n", filename);
-      delete image->pixels;
-      delete image;
+      delete [] tmpDataDouble;
+      Image_Delete( image );
       return NULL;
     }
 
@@ -144,43 +237,27 @@ Image_T *ReadImage( char *filebase, int fileNumRange[], char *imgTypeFlag,
       num = fread( (tmpDataShort + (filenum * fileLen)), sizeof(short),
 		   fileLen, fp );
     } else {
-      num = fread( (tmpDataDouble + (filenum * fileLen)), sizeof(double),
-		   fileLen, fp );
+      num = fread( tmpDataDouble, sizeof(double), fileLen, fp );
+      for ( i = 0; i < num; i++ ) {
+	floatData[filenum * fileLen + i] = (float)tmpDataDouble[i];
+      }
     }
 
     fclose(fp);
     if (num != fileLen) {
       fprintf(stderr, "ERR: Image file size mismatch [%s].\n", filename);
-      delete image->pixels;
-      delete image;
+      delete [] tmpDataDouble;
+      Image_Delete( image );
       return NULL;
     }
   }
 
-  for (i = 0; i < dataLen; i++) {
-    planeIx = i / (imgDims[0] * imgDims[1]);
-    planeOffset = i % (imgDims[0] * imgDims[1]);
-    rowIx = planeOffset / imgDims[0];
-    colIx = planeOffset % imgDims[0];
-    if (convertShort) {
-      image->pixels[i].intensity = (double)tmpDataShort[i];
-    } else {
-      image->pixels[i].intensity = tmpDataDouble[i];
-    }
-    image->pixels[i].plane = planeIx;
-    image->pixels[i].row = rowIx;
-    image->pixels[i].col = colIx;
-  }
-
-  if (convertShort) delete tmpDataShort;
-  else delete tmpDataDouble;
+  delete [] tmpDataDouble;
 
   strcpy( image->filebase, filebase );
   image->fileNumRange[0] = fileNumRange[0];
   image->fileNumRange[1] = fileNumRange[1];
 
-  image->closed = 0;
-
   image->lowerleft[0] = 0.0;
   image->lowerleft[1] = 0.0;
   image->lowerleft[2] = 0.0;
@@ -197,8 +274,13 @@ Image_T *ReadImage( char *filebase, int fileNumRange[], char *imgTypeFlag,
 void Image_Delete( Image_T *img )
 {
   if ( img != NULL ) {
-    if ( img->pixels != NULL ) {
-      delete [] img->pixels;
+    Img_DeleteGradTiles( img );
+    if ( img->data != NULL ) {
+      if ( img->scalarType == IMG_SHORT ) {
+	delete [] (short *)(img->data);
+      } else {
+	delete [] (float *)(img->data);
+      }
     }
     delete img;
   }
@@ -209,53 +291,30 @@ void Image_Delete( Image_T *img )
 // =====================
 //   ComputePointSlope
 // =====================
-// Computes the first spatial derivative at a given point (curr) in
-// the dimension indicated by dimFlag (0 = x, 1 = y, 2 = z).  The
-// derivative is computed using linear interpolation, and the points
-// prev, curr and next are presumed to be from a single-valued
-// function.  That is, it is assumed that the slopes of the previous
-// and next edges are both finite (i.e. not infinite).
-//
-// Note some funny business with mixing of types (i.e. of short, int
-// and double).  This arises from the fact that the images are stored
-// as short's, but working in physical space (i.e. mm) requires
-// double's.  And just to be safe, I assign operations btw short's to
-// int's to avoid potential overflow problems.
-
-double ComputePointSlope( Pixel_T *prev, Pixel_T *curr, Pixel_T *next,
-                          Image_T *image, int dimFlag )
+// Computes the first spatial derivative at a given point (curr) from
+// the intensities of its neighbors (prev, next) along one axis, where
+// ddom is the pixel size along that axis.  The derivative is computed
+// using linear interpolation, and the points prev, curr and next are
+// presumed to be from a single-valued function.  That is, it is
+// assumed that the slopes of the previous and next edges are both
+// finite (i.e. not infinite).
+
+double ComputePointSlope( double prev, double curr, double next,
+                          double ddom )
 {
   double rngPrev, rngCurr, rngNext;
   double drng;
-  double ddom, domCoord;
   double lenPrev, lenNext;
   double interpFactor, domInterp, rngInterp;
   double slopeDdom, slopeDrng, slope;
 
-  rngPrev = prev->intensity;
-  rngCurr = curr->intensity;
-  rngNext = next->intensity;
+  // Only differences of domain coordinates enter the slope, so the
+  // current point is taken as the origin.
+  double domCoord = 0.0;
 
-  switch (dimFlag) {
-  case 0:
-    // Differentiate w.r.t. x.
-    ddom = image->pixelDims[0];
-    domCoord = (curr->row * ddom) + (ddom / 2.0);
-    break;
-  case 1:
-    // Differentiate w.r.t. y.
-    ddom = image->pixelDims[1];
-    domCoord = (curr->col * ddom) + (ddom / 2.0);
-    break;
-  case 2:
-    // Differentiate w.r.t. z.
-    ddom = image->pixelDims[2];
-    domCoord = (curr->plane * ddom) + (ddom / 2.0);
-    break;
-  default:
-    fprintf(stderr, "ERR: Invalid dimension flag in ComputePointSlope.\n");
-    exit(0);
-  }
+  rngPrev = prev;
+  rngCurr = curr;
+  rngNext = next;
 
   drng = rngCurr - rngPrev;
   lenPrev = sqrt( svSqr(ddom) + svSqr(drng) );
@@ -266,18 +325,18 @@ double ComputePointSlope( Pixel_T *prev, Pixel_T *curr, Pixel_T *next,
   if (lenPrev < lenNext) {
     interpFactor = lenPrev / lenNext;
     domInterp = domCoord + interpFactor * ddom;
-    rngInterp = (double)rngCurr - interpFactor * (rngCurr - rngNext);
+    rngInterp = rngCurr - interpFactor * (rngCurr - rngNext);
     slopeDdom = ddom + (domInterp - domCoord);
-    slopeDrng = rngInterp - (double)rngPrev;
+    slopeDrng = rngInterp - rngPrev;
   }
 
   // Interpolate along previous edge.
   else {
     interpFactor = lenNext / lenPrev;
     domInterp = domCoord - interpFactor * ddom;
-    rngInterp = (double)rngCurr - interpFactor * (rngCurr - rngPrev);
+    rngInterp = rngCurr - interpFactor * (rngCurr - rngPrev);
     slopeDdom = (domCoord - domInterp) + ddom;
-    slopeDrng = (double)rngNext - rngInterp;
+    slopeDrng = rngNext - rngInterp;
   }
 
   slope = slopeDrng / slopeDdom;
@@ -286,127 +345,177 @@ double ComputePointSlope( Pixel_T *prev, Pixel_T *curr, Pixel_T *next,
 }
 
 
-// ====================
-//   ComputeImageGrad
-// ====================
+// =================
+//   Img_PixelGrad
+// =================
+// Gradient at pixel (i,j,k), rounded to the precision of the tiles.
 // It's not exactly clear whether image data is in row-major or
 // column-major order.  All indications point to column-major
-// (i.e. elements in a particular *row* are contiguous).  As a result,
-// I'm going to assume for now that I should traverse all columns for
-// each row, and then traverse rows.  If this assumption is wrong
-// (i.e. if the file was in fact written s.t. all elements in a
-// *column* are contiguous), then what is computed as the x component
-// of grad I will actually be the y component, and vice versa.
+// (i.e. elements in a particular *row* are contiguous), so i is taken
+// to be the column and adjacent elements in x are physically
+// adjacent.
 //
-// Note that this implementation does not compute first derivatives at
-// pixels along the outside border of the image.  This is because the
-// linear interpolation scheme employed in ComputePointSlope requires
-// one neighbor on each side of the pixel at which the derivative is
-// being computed.  We could do any of various things to get around
-// this (e.g. pad an extra layer of pixels around the image whose
-// intensities are copied from the edge of the actual image), but
-// being able to evaluate the gradient at the very edge of the image
-// is probably not important, as the propagating front should probably
-// not get too close to the image boundary.
-
-void ComputeImageGrad( Image_T *image )
+// The linear interpolation scheme employed in ComputePointSlope
+// requires one neighbor on each side of the pixel.  Along the outside
+// border of the image the missing neighbor is replaced as it always
+// has been, but being able to evaluate the gradient at the very edge
+// of the image is probably not important, as the propagating front
+// should probably not get too close to the image boundary.
+
+static void Img_PixelGrad( Image_T *image, int i, int j, int k, float grad[] )
 {
   int xdim, ydim, zdim;
-  int i, j, k, pixIx, prevIx, nextIx;
-  Pixel_T *prev, *curr, *next;
+  int pixIx, prevIx, nextIx;
   int tri;
 
-  if ( image->gradValid ) {
-    return;
-  }
-
   xdim = image->imgDims[0];   // xdim == # cols
   ydim = image->imgDims[1];   // ydim == # rows
   zdim = image->imgDims[2];   // zdim == # planes
 
-  if ( image->dim == 3 ) {
-    tri = 1;
+  tri = ( image->dim == 3 );
+
+  if ( image->gradBoundsClosed &&
+       ( ( i < gGradBdReg ) || ( i >= (xdim-gGradBdReg) ) ||
+	 ( j < gGradBdReg ) || ( j >= (ydim-gGradBdReg) ) ||
+	 ( (tri) && ( k < gGradBdReg ) ) ||
+	 ( (tri) && ( k >= (zdim-gGradBdReg) ) ) ) ) {
+    grad[0] = (float)image->gradBoundValue;
+    grad[1] = (float)image->gradBoundValue;
+    grad[2] = (float)image->gradBoundValue;
+    return;
+  }
+
+  pixIx = (k * xdim * ydim) + (j * xdim) + i;
+
+  // x:
+  prevIx = ( i == 0 ) ? 0 : pixIx-1;
+  nextIx = ( i == (xdim-1) ) ? (xdim-1) : pixIx+1;
+  grad[0] = (float)ComputePointSlope( Img_Datum( image, prevIx ),
+				      Img_Datum( image, pixIx ),
+				      Img_Datum( image, nextIx ),
+				      image->pixelDims[0] );
+
+  // y:
+  prevIx = ( j == 0 ) ? 0 : pixIx-xdim;
+  nextIx = ( j == (ydim-1) ) ? (ydim-1) : pixIx+xdim;
+  grad[1] = (float)ComputePointSlope( Img_Datum( image, prevIx ),
+				      Img_Datum( image, pixIx ),
+				      Img_Datum( image, nextIx ),
+				      image->pixelDims[1] );
+
+  // z:
+  if ( tri ) {
+    prevIx = ( k == 0 ) ? 0 : pixIx - (xdim*ydim);
+    nextIx = ( k == (zdim-1) ) ? (zdim-1) : pixIx + (xdim*ydim);
+    grad[2] = (float)ComputePointSlope( Img_Datum( image, prevIx ),
+					Img_Datum( image, pixIx ),
+					Img_Datum( image, nextIx ),
+					image->pixelDims[2] );
   } else {
-    tri = 0;
+    grad[2] = 0.0;
   }
 
-  for (k = 0; k < zdim; k++) {
-    for (j = 0; j < ydim; j++) {
-      for (i = 0; i < xdim; i++) {
-	pixIx = (k * xdim * ydim) + (j * xdim) + i;
-
-	// Boundary pixels:
-	if ( ( i == 0 ) || ( i == (xdim-1) ) ||
-	     ( j == 0 ) || ( j == (ydim-1) ) ||
-	     ( (tri) && ( k == 0 ) ) || ( (tri) && ( k == (zdim-1) ) ) ) {
-
-	  curr = &( image->pixels[pixIx] );
-
-	  // x:
-	  prevIx = ( i == 0 ) ? 0 : pixIx-1;
-	  nextIx = ( i == (xdim-1) ) ? (xdim-1) : pixIx+1;
-	  prev = &( image->pixels[prevIx] );
-	  next = &( image->pixels[nextIx] );
-	  image->pixels[pixIx].gradX = ComputePointSlope( prev, curr, next,
-							  image, 0 );
-
-	  // y:
-	  prevIx = ( j == 0 ) ? 0 : pixIx-xdim;
-	  nextIx = ( j == (ydim-1) ) ? (ydim-1) : pixIx+xdim;
-	  prev = &( image->pixels[prevIx] );
-	  next = &( image->pixels[nextIx] );
-	  image->pixels[pixIx].gradY = ComputePointSlope( prev, curr, next,
-							  image, 1 );
-
-	  // z:
-	  if ( tri ) {
-	    prevIx = ( k == 0 ) ? 0 : pixIx - (xdim*ydim);
-	    nextIx = ( k == (zdim-1) ) ? (zdim-1) : pixIx + (xdim*ydim);
-	    prev = &( image->pixels[prevIx] );
-	    next = &( image->pixels[nextIx] );
-	    image->pixels[pixIx].gradZ = ComputePointSlope( prev, curr, next,
-							    image, 2 );
-	  } else {
-	    image->pixels[pixIx].gradZ = 0.0;
-	  }
-
-	  // Before 2/16/00:
-	  //	  image->pixels[pixIx].gradX = 0.0;
-	  //	  image->pixels[pixIx].gradY = 0.0;
-	  //	  image->pixels[pixIx].gradZ = 0.0;
-
-	  continue;
-	}
+  return;
+}
 
-	// Differentiation w.r.t. x:
-	// (adjacent elements in x are also physically adjacent)
-	prev = &( image->pixels[pixIx-1] );
-	curr = &( image->pixels[pixIx] );
-	next = &( image->pixels[pixIx+1] );
-	image->pixels[pixIx].gradX = ComputePointSlope( prev, curr, next,
-							image, 0 );
-
-	// Differentiation w.r.t. y:
-	prev = &( image->pixels[pixIx-xdim] );
-	curr = &( image->pixels[pixIx] );
-	next = &( image->pixels[pixIx+xdim] );
-	image->pixels[pixIx].gradY = ComputePointSlope( prev, curr, next,
-							image, 1 );
-
-	// Differentiation w.r.t. z:
-	if ( tri ) {
-	  prev = &( image->pixels[pixIx - (xdim*ydim)] );
-	  curr = &( image->pixels[pixIx] );
-	  next = &( image->pixels[pixIx + (xdim*ydim)] );
-	  image->pixels[pixIx].gradZ = ComputePointSlope( prev, curr, next,
-							  image, 2 );
-	} else {
-	  image->pixels[pixIx].gradZ = 0.0;
+
+// ============
+//   Img_Grad
+// ============
+// The (gradX, gradY, gradZ) of pixel (i,j,k), filling in its tile
+// first if needed and the tile budget allows.  ComputeImageGrad must
+// have been called.
+
+static void Img_Grad( Image_T *image, int i, int j, int k, float grad[] )
+{
+  ImgGradTiles_T *gt = image->gradTiles;
+  int ti, tj, tk, t;
+  int ii, jj, kk, li, lj, lk;
+  int tileLen;
+  float *tile, *expected;
+
+  ti = i / gt->tileDims[0];
+  tj = j / gt->tileDims[1];
+  tk = k / gt->tileDims[2];
+  t = ( ( tk * gt->numTiles[1] ) + tj ) * gt->numTiles[0] + ti;
+
+  tile = gt->tiles[t].load( std::memory_order_acquire );
+
+  if ( tile == NULL ) {
+    if ( gt->numAllocated.fetch_add( 1 ) >= gt->maxTiles ) {
+      gt->numAllocated--;
+      Img_PixelGrad( image, i, j, k, grad );
+      return;
+    }
+    tileLen = gt->tileDims[0] * gt->tileDims[1] * gt->tileDims[2];
+    tile = new float [3 * tileLen];
+    for ( lk = 0; lk < gt->tileDims[2]; lk++ ) {
+      kk = svminimum( tk * gt->tileDims[2] + lk, image->imgDims[2] - 1 );
+      for ( lj = 0; lj < gt->tileDims[1]; lj++ ) {
+	jj = svminimum( tj * gt->tileDims[1] + lj, image->imgDims[1] - 1 );
+	for ( li = 0; li < gt->tileDims[0]; li++ ) {
+	  ii = svminimum( ti * gt->tileDims[0] + li, image->imgDims[0] - 1 );
+	  Img_PixelGrad( image, ii, jj, kk,
+			 tile + 3 * ( ( lk * gt->tileDims[1] + lj ) *
+				      gt->tileDims[0] + li ) );
 	}
       }
     }
+    expected = NULL;
+    if ( ! gt->tiles[t].compare_exchange_strong( expected, tile,
+						 std::memory_order_acq_rel ) ) {
+      gt->numAllocated--;
+      delete [] tile;
+      tile = expected;
+    }
+  }
+
+  li = i - ti * gt->tileDims[0];
+  lj = j - tj * gt->tileDims[1];
+  lk = k - tk * gt->tileDims[2];
+  tile += 3 * ( ( lk * gt->tileDims[1] + lj ) * gt->tileDims[0] + li );
+  grad[0] = tile[0];
+  grad[1] = tile[1];
+  grad[2] = tile[2];
+  return;
+}
+
+
+// ====================
+//   ComputeImageGrad
+// ====================
+// Gradients are no longer computed here for the whole image at once
+// (at 24 bytes per pixel that was most of the memory used by a large
+// volume).  This only sets up the table of gradient tiles; each tile
+// is computed by the first lookup which falls in it, up to the
+// budget set by gGradTileFrac.  Because setting
+// up the table is not thread-safe, callers which look up gradients
+// from several threads should call this first.
+
+void ComputeImageGrad( Image_T *image )
+{
+  ImgGradTiles_T *gt;
+  int numTiles, t, d;
+
+  if ( image->gradValid ) {
+    return;
+  }
+
+  gt = new ImgGradTiles_T;
+  for ( d = 0; d < 3; d++ ) {
+    gt->tileDims[d] = svminimum( gGradTileSz, image->imgDims[d] );
+    gt->numTiles[d] = ( image->imgDims[d] + gt->tileDims[d] - 1 ) /
+      gt->tileDims[d];
+  }
+  numTiles = gt->numTiles[0] * gt->numTiles[1] * gt->numTiles[2];
+  gt->maxTiles = svmaximum( numTiles / gGradTileFrac, 1 );
+  gt->tiles = new std::atomic<float*> [numTiles];
+  for ( t = 0; t < numTiles; t++ ) {
+    gt->tiles[t].store( NULL );
   }
+  gt->numAllocated.store( 0 );
 
+  image->gradTiles = gt;
   image->gradValid = 1;
   return;
 }
@@ -427,26 +536,29 @@ double GetMaxGrad( Image_T *image )
 // -------------------
 // Img_GetMagGradRange
 // -------------------
+// The range functions visit every pixel once, so they compute the
+// gradient directly instead of filling in tiles.
 
 void Img_GetMagGradRange( Image_T *image, double rng[] )
 {
-  int numPix;
-  int i;
-  double gx, gy, gz;
+  int i, j, k;
+  float g[3];
   double mag, currMin, currMax;
-
-  ComputeImageGrad( image );
-  numPix = (image->imgDims[0]) * (image->imgDims[1]) * (image->imgDims[2]);
-  for ( i = 0; i < numPix; i++ ) {
-    gx = image->pixels[i].gradX;
-    gy = image->pixels[i].gradY;
-    gz = image->pixels[i].gradZ;
-    mag = Magnitude( gx, gy, gz );
-    if ( i == 0 ) {
-      currMin = currMax = mag;
-    } else {
-      currMax = svmaximum( mag, currMax );
-      currMin = svminimum( mag, currMin );
+  int first = 1;
+
+  for ( k = 0; k < image->imgDims[2]; k++ ) {
+    for ( j = 0; j < image->imgDims[1]; j++ ) {
+      for ( i = 0; i < image->imgDims[0]; i++ ) {
+	Img_PixelGrad( image, i, j, k, g );
+	mag = Magnitude( g[0], g[1], g[2] );
+	if ( first ) {
+	  currMin = currMax = mag;
+	  first = 0;
+	} else {
+	  currMax = svmaximum( mag, currMax );
+	  currMin = svminimum( mag, currMin );
+	}
+      }
     }
   }
   rng[0] = currMin;
@@ -460,22 +572,24 @@ void Img_GetMagGradRange( Image_T *image, double rng[] )
 
 void Img_GetXYMagGradRange( Image_T *image, double rng[] )
 {
-  int numPix;
-  int i;
-  double gx, gy;
+  int i, j, k;
+  float g[3];
   double mag, currMin, currMax;
-
-  ComputeImageGrad( image );
-  numPix = (image->imgDims[0]) * (image->imgDims[1]) * (image->imgDims[2]);
-  for ( i = 0; i < numPix; i++ ) {
-    gx = image->pixels[i].gradX;
-    gy = image->pixels[i].gradY;
-    mag = Magnitude( gx, gy, 0.0 );
-    if ( i == 0 ) {
-      currMin = currMax = mag;
-    } else {
-      currMax = svmaximum( mag, currMax );
-      currMin = svminimum( mag, currMin );
+  int first = 1;
+
+  for ( k = 0; k < image->imgDims[2]; k++ ) {
+    for ( j = 0; j < image->imgDims[1]; j++ ) {
+      for ( i = 0; i < image->imgDims[0]; i++ ) {
+	Img_PixelGrad( image, i, j, k, g );
+	mag = Magnitude( g[0], g[1], 0.0 );
+	if ( first ) {
+	  currMin = currMax = mag;
+	  first = 0;
+	} else {
+	  currMax = svmaximum( mag, currMax );
+	  currMin = svminimum( mag, currMin );
+	}
+      }
     }
   }
   rng[0] = currMin;
@@ -489,21 +603,24 @@ void Img_GetXYMagGradRange( Image_T *image, double rng[] )
 
 void Img_GetZMagGradRange( Image_T *image, double rng[] )
 {
-  int numPix;
-  int i;
-  double gz;
+  int i, j, k;
+  float g[3];
   double mag, currMin, currMax;
-
-  ComputeImageGrad( image );
-  numPix = (image->imgDims[0]) * (image->imgDims[1]) * (image->imgDims[2]);
-  for ( i = 0; i < numPix; i++ ) {
-    gz = image->pixels[i].gradZ;
-    mag = fabs(gz);
-    if ( i == 0 ) {
-      currMin = currMax = mag;
-    } else {
-      currMax = svmaximum( mag, currMax );
-      currMin = svminimum( mag, currMin );
+  int first = 1;
+
+  for ( k = 0; k < image->imgDims[2]; k++ ) {
+    for ( j = 0; j < image->imgDims[1]; j++ ) {
+      for ( i = 0; i < image->imgDims[0]; i++ ) {
+	Img_PixelGrad( image, i, j, k, g );
+	mag = fabs( g[2] );
+	if ( first ) {
+	  currMin = currMax = mag;
+	  first = 0;
+	} else {
+	  currMax = svmaximum( mag, currMax );
+	  currMin = svminimum( mag, currMin );
+	}
+      }
     }
   }
   rng[0] = currMin;
@@ -524,7 +641,7 @@ void Img_GetIntensityRange( Image_T *image, double rng[] )
 
   numPix = (image->imgDims[0]) * (image->imgDims[1]) * (image->imgDims[2]);
   for ( i = 0; i < numPix; i++ ) {
-    datum = image->pixels[i].intensity;
+    datum = Img_Datum( image, i );
     if ( i == 0 ) {
       currMin = currMax = datum;
     } else {
@@ -622,6 +739,7 @@ int InBorder( Image_T *image, double pos[], int borderWd )
 }
 
 
+
 // --------------------
 // CloseImageGradBounds
 // --------------------
@@ -629,54 +747,26 @@ int InBorder( Image_T *image, double pos[], int borderWd )
 // computed values in a boundary region (of an arbitrary width) with
 // the maximum gradient value.  This is being done so that fronts
 // propagating in an image can be "sealed off" at the image edges.
+// The over-write is applied as gradients are looked up, so tiles
+// which were already filled in are dropped here.
 
 // The DIRECTIONALITY of the applied maximum gradient is an unresolved
 // issue.
 
 void CloseImageGradBounds( Image_T *image )
 {
-  int xdim, ydim, zdim;
-  int i, j, k, pixIx;
-  double maxG;
   double rng[2];
-  int tri;
-  int bdReg = 3;
 
   if ( image->closed ) {
     return;
   }
 
-  ComputeImageGrad( image );
   Img_GetMagGradRange( image, rng );
-  maxG = rng[1];
-
-  xdim = image->imgDims[0];   // xdim == # cols
-  ydim = image->imgDims[1];   // ydim == # rows
-  zdim = image->imgDims[2];   // zdim == # planes
-
-  if ( image->dim == 3 ) {
-    tri = 1;
-  } else {
-    tri = 0;
-  }
 
-  for (k = 0; k < zdim; k++) {
-    for (j = 0; j < ydim; j++) {
-      for (i = 0; i < xdim; i++) {
-	pixIx = (k * xdim * ydim) + (j * ydim) + i;
-
-	if ( ( i < bdReg ) || ( i >= (xdim-bdReg) ) ||
-	     ( j < bdReg ) || ( j >= (ydim-bdReg) ) ||
-	     ( (tri) && ( k < bdReg ) ) ||
-	     ( (tri) && ( k >= (zdim-bdReg) ) ) ) {
-	  image->pixels[pixIx].gradX = maxG;
-	  image->pixels[pixIx].gradY = maxG;
-	  image->pixels[pixIx].gradZ = maxG;
-	  continue;
-	}
-      }
-    }
-  }
+  Img_DeleteGradTiles( image );
+  image->gradBoundValue = rng[1];
+  image->gradBoundsClosed = 1;
+  ComputeImageGrad( image );
 
   image->closed = 1;
 
@@ -688,11 +778,12 @@ void CloseImageGradBounds( Image_T *image )
 // CreateImage
 // -----------
 // Build an Image_T object using a given data array.  The data may
-// be of either type double or short, as specified with imgTypeFlag,
-// but the is currently no error checking for inconsistency.  The data
-// object may actually be double's, while imgTypeFlag may be
-// incorrectly specified as -short, which would obviously cause things
-// to be all hosed up.
+// be of either type double, float or short, as specified with
+// imgTypeFlag, but the is currently no error checking for
+// inconsistency.  The data object may actually be double's, while
+// imgTypeFlag may be incorrectly specified as -short, which would
+// obviously cause things to be all hosed up.  Short data is stored as
+// short's, everything else as float's.
 //
 // NOTE that the input data array is COPIED, so the caller should NOT
 // surrender memory mgmt of that array upon calling this function.
@@ -702,10 +793,8 @@ Image_T *CreateImage( void *data, int numData, char *imgTypeFlag,
 {
   Image_T *image;
   int i, len;
-  short *tmpDataShort;
-  float *tmpDataFloat;
+  float *floatData;
   double *tmpDataDouble;
-  int rowIx, colIx, planeIx, planeOffset;
   int dataCode;
 
    // See notes at the other call to FindMachineEpsilon.
@@ -722,8 +811,13 @@ Image_T *CreateImage( void *data, int numData, char *imgTypeFlag,
     exit(0);
   }
 
+  len = imgDims[0] * imgDims[1] * imgDims[2];
+  if (len != numData) {
+    fprintf(stderr, "ERR: Data size mismatch.\n");
+    return NULL;
+  }
+
   image = new Image_T;
-  image->gradValid = 0;
   for (i = 0; i < 3; i++) {
     image->imgDims[i] = imgDims[i];
     image->pixelDims[i] = pixelDims[i];
@@ -733,50 +827,24 @@ Image_T *CreateImage( void *data, int numData, char *imgTypeFlag,
   } else {
     image->dim = 3;
   }
-  len = imgDims[0] * imgDims[1] * imgDims[2];
-  if (len != numData) {
-    fprintf(stderr, "ERR: Data size mismatch.\n");
-    return NULL;
-  }
-  image->pixels = new Pixel_T [len];
+  Img_AllocateData( image, ( dataCode == 0 ) );
+  floatData = (float *)(image->data);
 
   switch (dataCode) {
   case 0:
-    tmpDataShort = (short *)data;
+    memcpy( image->data, data, len * sizeof(short) );
     break;
   case 1:
     tmpDataDouble = (double *)data;
+    for (i = 0; i < len; i++) {
+      floatData[i] = (float)tmpDataDouble[i];
+    }
     break;
   case 2:
-    tmpDataFloat = (float *)data;
+    memcpy( image->data, data, len * sizeof(float) );
     break;
   }
 
-  for (i = 0; i < len; i++) {
-    planeIx = i / (imgDims[0] * imgDims[1]);
-    planeOffset = i % (imgDims[0] * imgDims[1]);
-    rowIx = planeOffset / imgDims[0];
-    colIx = planeOffset % imgDims[0];
-
-    switch (dataCode) {
-    case 0:
-      image->pixels[i].intensity = (double)tmpDataShort[i];
-      break;
-    case 1:
-      image->pixels[i].intensity = tmpDataDouble[i];
-      break;
-    case 2:
-      image->pixels[i].intensity = (double)tmpDataFloat[i];
-      break;
-    }
-
-    image->pixels[i].plane = planeIx;
-    image->pixels[i].row = rowIx;
-    image->pixels[i].col = colIx;
-  }
-
-  image->closed = 0;
-
   image->lowerleft[0] = 0.0;
   image->lowerleft[1] = 0.0;
   image->lowerleft[2] = 0.0;
@@ -785,25 +853,34 @@ Image_T *CreateImage( void *data, int numData, char *imgTypeFlag,
 }
 
 
-// ------------
-// LinearInterp
-// ------------
-// Bi-/tri- linear interpolation of specified image quantity.
+// ---------------
+// Img_SetUpInterp
+// ---------------
+// Find the pixels and weights for bi-/tri- linear interpolation at
+// pos.  Pixels are numbered as in the original octant scheme: 1 to 4
+// counter-clockwise in the lower plane starting from the pixel whose
+// centroid lies below and to the left of pos, and 5 to 8 likewise in
+// the next plane.  In the border region (within half a pixel of the
+// image edge) the containing pixel is used as is.
 
-int LinearInterp( Image_T *image, ImageData_T code, double pos[],
-		  double *value )
+typedef struct {
+  int numPix;
+  int ix[8];
+  int ijk[8][3];
+  double w[8];
+} ImgInterp_T;
+
+static int Img_SetUpInterp( Image_T *image, double pos[], ImgInterp_T *interp )
 {
-  int pixelCol, pixelRow, pixelPlane, pixelIx;
-  int inBorder, octant;
+  static const int offsets[8][3] = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0},
+				     {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} };
+  int pixelCol, pixelRow, pixelPlane;
+  int colNum1, rowNum1, planeNum1;
   double xBdWidth, yBdWidth, zBdWidth;
-  double pixelCx, pixelCy, pixelCz;
-  int ix1, ix2, ix3, ix4, ix5, ix6, ix7, ix8;
-  double I1, I2, I3, I4, I5, I6, I7, I8;
-  int rowNum1, colNum1, planeNum1, planeOffset;
   double cx1, cy1, cz1;
   double rx, ry, rz;
-  double q14, q58, result;
-  int tri;
+  double wx[2], wy[2], wz[2];
+  int tri, n, c;
   double x, y, z;
   double ppos[3];
 
@@ -828,17 +905,6 @@ int LinearInterp( Image_T *image, ImageData_T code, double pos[],
   xBdWidth = image->pixelDims[0] / 2.0;
   yBdWidth = image->pixelDims[1] / 2.0;
   zBdWidth = image->pixelDims[2] / 2.0;
-  if ( ( x <= xBdWidth ) ||
-       ( x >= ( ( image->imgDims[0] * image->pixelDims[0] ) - xBdWidth ) ) ||
-       ( y <= yBdWidth ) ||
-       ( y >= ( ( image->imgDims[1] * image->pixelDims[1] ) - yBdWidth ) ) ||
-       ( (tri) && ( z <= zBdWidth ) ) ||
-       ( (tri) && ( z >= ( ( image->imgDims[2] * image->pixelDims[2] ) -
-			   zBdWidth ) ) ) ) {
-    inBorder = 1;
-  } else {
-    inBorder = 0;
-  }
 
   pixelCol = (int)floor( x / image->pixelDims[0] );
   pixelRow = (int)floor( y / image->pixelDims[1] );
@@ -855,259 +921,44 @@ int LinearInterp( Image_T *image, ImageData_T code, double pos[],
   pixelPlane = ( pixelPlane >= image->imgDims[2] ) ?
     ( image->imgDims[2] - 1 ) : pixelPlane;
 
-  pixelIx = \
-    (image->imgDims[0] * image->imgDims[1] * pixelPlane) \
-    + (image->imgDims[0] * pixelRow) \
-    + pixelCol;
-
-  if (inBorder) {
-    switch (code) {
-    case IMG_INTENSITY:
-      *value = (image->pixels[pixelIx].intensity);
-      return SV_OK;
-    case IMG_GRADIX:
-      *value = (image->pixels[pixelIx].gradX);
-      return SV_OK;
-    case IMG_GRADIY:
-      *value = (image->pixels[pixelIx].gradY);
-      return SV_OK;
-    case IMG_GRADIZ:
-      *value = (image->pixels[pixelIx].gradZ);
-      return SV_OK;
-    default:
-      fprintf(stderr, "ERR: ImageData_T not handled correctly.\n");
-      return SV_ERROR;
-    }
-  }
-
-  // Find centroid of containing voxel:
-  pixelCx = pixelCol * image->pixelDims[0] + xBdWidth;
-  pixelCy = pixelRow * image->pixelDims[1] + yBdWidth;
-  pixelCz = pixelPlane * image->pixelDims[2] + zBdWidth;
-
-  if ( x > pixelCx ) {
-    if ( y > pixelCy ) {
-      if ( ( !tri ) || ( z > pixelCz ) ) {
-	octant = 1;
-      } else {
-	octant = 5;
-      }
-    } else {
-      if ( ( !tri ) || ( z > pixelCz ) ) {
-	octant = 4;
-      } else {
-	octant = 8;
-      }
-    }
-  } else {
-    if ( y > pixelCy ) {
-      if ( ( !tri ) || ( z > pixelCz ) ) {
-	octant = 2;
-      } else {
-	octant = 6;
-      }
-    } else {
-      if ( ( !tri ) || ( z > pixelCz ) ) {
-	octant = 3;
-      } else {
-	octant = 7;
-      }
-    }
-  }
-
-  if ( !tri ) {
-    assert( octant != 5 );
-    assert( octant != 6 );
-    assert( octant != 7 );
-    assert( octant != 8 );
+  if ( ( x <= xBdWidth ) ||
+       ( x >= ( ( image->imgDims[0] * image->pixelDims[0] ) - xBdWidth ) ) ||
+       ( y <= yBdWidth ) ||
+       ( y >= ( ( image->imgDims[1] * image->pixelDims[1] ) - yBdWidth ) ) ||
+       ( (tri) && ( z <= zBdWidth ) ) ||
+       ( (tri) && ( z >= ( ( image->imgDims[2] * image->pixelDims[2] ) -
+			   zBdWidth ) ) ) ) {
+    interp->numPix = 1;
+    interp->ijk[0][0] = pixelCol;
+    interp->ijk[0][1] = pixelRow;
+    interp->ijk[0][2] = pixelPlane;
+    interp->ix[0] = (image->imgDims[0] * image->imgDims[1] * pixelPlane)
+      + (image->imgDims[0] * pixelRow) + pixelCol;
+    interp->w[0] = 1.0;
+    return SV_OK;
   }
 
-  switch (octant) {
-  case 1:
-    // ix1 to ix4 lie in the same plane (i.e. z const.):
-    ix1 = pixelIx;
-    ix2 = ix1 + 1;
-    ix3 = ix2 + image->imgDims[0];
-    ix4 = ix3 - 1;
-
-    // ix5 to ix8 lie in the next plane (i.e. z' = z + 1):
-    ix5 = pixelIx + (image->imgDims[0] * image->imgDims[1]);
-    ix6 = ix5 + 1;
-    ix7 = ix6 + image->imgDims[0];
-    ix8 = ix7 - 1;
-    break;
-
-  case 2:
-    ix2 = pixelIx;
-    ix1 = ix2 - 1;
-    ix3 = ix2 + image->imgDims[0];
-    ix4 = ix3 - 1;
-
-    ix6 = pixelIx + (image->imgDims[0] * image->imgDims[1]);
-    ix5 = ix6 - 1;
-    ix7 = ix6 + image->imgDims[0];
-    ix8 = ix7 - 1;
-    break;
-
-  case 3:
-    ix3 = pixelIx;
-    ix2 = ix3 - image->imgDims[0];
-    ix4 = ix3 - 1;
-    ix1 = ix2 - 1;
-
-    ix7 = pixelIx + (image->imgDims[0] * image->imgDims[1]);
-    ix6 = ix7 - image->imgDims[0];
-    ix8 = ix7 - 1;
-    ix5 = ix6 - 1;
-    break;
-
-  case 4:
-    ix4 = pixelIx;
-    ix3 = ix4 + 1;
-    ix2 = ix3 - image->imgDims[0];
-    ix1 = ix2 - 1;
-
-    ix8 = pixelIx + (image->imgDims[0] * image->imgDims[1]);
-    ix7 = ix8 + 1;
-    ix6 = ix7 - image->imgDims[0];
-    ix5 = ix6 - 1;
-    break;
-
-  case 5:
-    // same as case 1 except pixelIx lies in the upper plane:
-    ix5 = pixelIx;
-    ix6 = ix5 + 1;
-    ix7 = ix6 + image->imgDims[0];
-    ix8 = ix7 - 1;
-
-    ix1 = pixelIx - (image->imgDims[0] * image->imgDims[1]);
-    ix2 = ix1 + 1;
-    ix3 = ix2 + image->imgDims[0];
-    ix4 = ix3 - 1;
-    break;
-
-  case 6:
-    ix6 = pixelIx;
-    ix5 = ix6 - 1;
-    ix7 = ix6 + image->imgDims[0];
-    ix8 = ix7 - 1;
-
-    ix2 = pixelIx - (image->imgDims[0] * image->imgDims[1]);
-    ix1 = ix2 - 1;
-    ix3 = ix2 + image->imgDims[0];
-    ix4 = ix3 - 1;
-    break;
-
-  case 7:
-    ix7 = pixelIx;
-    ix6 = ix7 - image->imgDims[0];
-    ix8 = ix7 - 1;
-    ix5 = ix6 - 1;
-
-    ix3 = pixelIx - (image->imgDims[0] * image->imgDims[1]);
-    ix2 = ix3 - image->imgDims[0];
-    ix4 = ix3 - 1;
-    ix1 = ix2 - 1;
-    break;
-
-  case 8:
-    ix8 = pixelIx;
-    ix7 = ix8 + 1;
-    ix6 = ix7 - image->imgDims[0];
-    ix5 = ix6 - 1;
-
-    ix4 = pixelIx - (image->imgDims[0] * image->imgDims[1]);
-    ix3 = ix4 + 1;
-    ix2 = ix3 - image->imgDims[0];
-    ix1 = ix2 - 1;
-    break;
-
-  default:
-    return SV_ERROR;
-    break;
+  // Pixel 1 is the containing pixel, or its neighbor on the low side
+  // along each axis where pos lies below the containing centroid:
+  colNum1 = pixelCol;
+  if ( x <= ( pixelCol * image->pixelDims[0] + xBdWidth ) ) {
+    colNum1--;
   }
-
-  // Check the sanity of the resulting indices (yes, I'm paranoid):
-
-  assert( (ix1 / (image->imgDims[0] * image->imgDims[1])) >= 0 );
-  assert( (ix1 / (image->imgDims[0] * image->imgDims[1])) <
-	  image->imgDims[2] );
-
-  if ( tri ) {
-    assert( (ix5 / (image->imgDims[0] * image->imgDims[1])) >= 0 );
-    assert( (ix5 / (image->imgDims[0] * image->imgDims[1])) <
-	    image->imgDims[2] );
+  rowNum1 = pixelRow;
+  if ( y <= ( pixelRow * image->pixelDims[1] + yBdWidth ) ) {
+    rowNum1--;
   }
-
-  switch (code) {
-  case IMG_INTENSITY:
-    I1 = image->pixels[ix1].intensity;
-    I2 = image->pixels[ix2].intensity;
-    I3 = image->pixels[ix3].intensity;
-    I4 = image->pixels[ix4].intensity;
-    if ( tri ) {
-      I5 = image->pixels[ix5].intensity;
-      I6 = image->pixels[ix6].intensity;
-      I7 = image->pixels[ix7].intensity;
-      I8 = image->pixels[ix8].intensity;
-    }
-    break;
-  case IMG_GRADIX:
-    I1 = image->pixels[ix1].gradX;
-    I2 = image->pixels[ix2].gradX;
-    I3 = image->pixels[ix3].gradX;
-    I4 = image->pixels[ix4].gradX;
-    if ( tri ) {
-      I5 = image->pixels[ix5].gradX;
-      I6 = image->pixels[ix6].gradX;
-      I7 = image->pixels[ix7].gradX;
-      I8 = image->pixels[ix8].gradX;
-    }
-    break;
-  case IMG_GRADIY:
-    I1 = image->pixels[ix1].gradY;
-    I2 = image->pixels[ix2].gradY;
-    I3 = image->pixels[ix3].gradY;
-    I4 = image->pixels[ix4].gradY;
-    if ( tri ) {
-      I5 = image->pixels[ix5].gradY;
-      I6 = image->pixels[ix6].gradY;
-      I7 = image->pixels[ix7].gradY;
-      I8 = image->pixels[ix8].gradY;
-    }
-    break;
-  case IMG_GRADIZ:
-    I1 = image->pixels[ix1].gradZ;
-    I2 = image->pixels[ix2].gradZ;
-    I3 = image->pixels[ix3].gradZ;
-    I4 = image->pixels[ix4].gradZ;
-    if ( tri ) {
-      I5 = image->pixels[ix5].gradZ;
-      I6 = image->pixels[ix6].gradZ;
-      I7 = image->pixels[ix7].gradZ;
-      I8 = image->pixels[ix8].gradZ;
-    }
-    break;
-  default:
-    fprintf(stderr, "ERR: ImageData_T not handled correctly.\n");
-    return SV_ERROR;
-    break;
+  planeNum1 = pixelPlane;
+  if ( (tri) && ( z <= ( pixelPlane * image->pixelDims[2] + zBdWidth ) ) ) {
+    planeNum1--;
   }
 
-  // To calculate rx and ry, we want to determine the x and y coords
-  // of the centroid of the pixel whose index we have assigned to be
-  // ix1.
-
-  planeNum1 = ix1 / (image->imgDims[0] * image->imgDims[1]);
-  planeOffset = ix1 % (image->imgDims[0] * image->imgDims[1]);
-  rowNum1 = planeOffset / image->imgDims[0];
-  colNum1 = planeOffset % image->imgDims[0];
+  assert( planeNum1 >= 0 );
+  assert( planeNum1 < image->imgDims[2] );
 
   cx1 = colNum1 * image->pixelDims[0] + xBdWidth;
   cy1 = rowNum1 * image->pixelDims[1] + yBdWidth;
-  if ( tri ) {
-    cz1 = planeNum1 * image->pixelDims[2] + zBdWidth;
-  }
+  cz1 = planeNum1 * image->pixelDims[2] + zBdWidth;
 
   rx = ( x - cx1 ) / image->pixelDims[0];
   if ( fabs(rx-1.0) <= gMachineEpsilon ) {
@@ -1117,6 +968,7 @@ int LinearInterp( Image_T *image, ImageData_T code, double pos[],
   if ( fabs(ry-1.0) <= gMachineEpsilon ) {
     ry = 1.0;
   }
+  rz = 0.0;
   if ( tri ) {
     rz = ( z - cz1 ) / image->pixelDims[2];
     if ( fabs(rz-1.0) <= gMachineEpsilon ) {
@@ -1133,26 +985,109 @@ int LinearInterp( Image_T *image, ImageData_T code, double pos[],
     assert( rz <= 1.0 );
   }
 
-  q14 = ( 1.0 - rx - ry + (rx*ry) ) * I1;
-  q14 += rx * ( 1.0 - ry ) * I2;
-  q14 += rx * ry * I3;
-  q14 += ry * ( 1.0 - rx ) * I4;
+  wx[0] = 1.0 - rx;
+  wx[1] = rx;
+  wy[0] = 1.0 - ry;
+  wy[1] = ry;
+  wz[0] = 1.0 - rz;
+  wz[1] = rz;
+
+  n = tri ? 8 : 4;
+  interp->numPix = n;
+  for ( c = 0; c < n; c++ ) {
+    interp->ijk[c][0] = colNum1 + offsets[c][0];
+    interp->ijk[c][1] = rowNum1 + offsets[c][1];
+    interp->ijk[c][2] = planeNum1 + offsets[c][2];
+    interp->ix[c] = (image->imgDims[0] * image->imgDims[1] * interp->ijk[c][2])
+      + (image->imgDims[0] * interp->ijk[c][1]) + interp->ijk[c][0];
+    interp->w[c] = wx[offsets[c][0]] * wy[offsets[c][1]] * wz[offsets[c][2]];
+  }
 
-  if ( tri ) {
-    q58 = ( 1.0 - rx - ry + (rx*ry) ) * I5;
-    q58 += rx * ( 1.0 - ry ) * I6;
-    q58 += rx * ry * I7;
-    q58 += ry * ( 1.0 - rx ) * I8;
+  return SV_OK;
+}
+
+
+// -------------------
+// Img_InterpIntensity
+// -------------------
+
+template <class T>
+static double Img_InterpIntensity( const T *data, const ImgInterp_T *interp )
+{
+  double I[8];
+  double result = 0.0;
+  int c;
+
+  for ( c = 0; c < interp->numPix; c++ ) {
+    I[c] = (double)data[interp->ix[c]];
+  }
+  for ( c = 0; c < interp->numPix; c++ ) {
+    result += interp->w[c] * I[c];
   }
+  return result;
+}
 
-  if ( !tri ) {
-    result = q14;
-  } else {
-    result = rz * ( q58 - q14 ) + q14;
+
+// --------------
+// Img_InterpGrad
+// --------------
+// Interpolates all three gradient components with one set of
+// weights.
+
+static void Img_InterpGrad( Image_T *image, const ImgInterp_T *interp,
+			    double grad[] )
+{
+  float g[3];
+  int c;
+
+  grad[0] = 0.0;
+  grad[1] = 0.0;
+  grad[2] = 0.0;
+  for ( c = 0; c < interp->numPix; c++ ) {
+    Img_Grad( image, interp->ijk[c][0], interp->ijk[c][1],
+	      interp->ijk[c][2], g );
+    grad[0] += interp->w[c] * g[0];
+    grad[1] += interp->w[c] * g[1];
+    grad[2] += interp->w[c] * g[2];
   }
+  return;
+}
 
-  *value = result;
-  return SV_OK;
+
+// ------------
+// LinearInterp
+// ------------
+// Bi-/tri- linear interpolation of specified image quantity.
+
+int LinearInterp( Image_T *image, ImageData_T code, double pos[],
+		  double *value )
+{
+  ImgInterp_T interp;
+  double grad[3];
+
+  if ( Img_SetUpInterp( image, pos, &interp ) != SV_OK ) {
+    return SV_ERROR;
+  }
+
+  switch (code) {
+  case IMG_INTENSITY:
+    if ( image->scalarType == IMG_SHORT ) {
+      *value = Img_InterpIntensity( (short *)(image->data), &interp );
+    } else {
+      *value = Img_InterpIntensity( (float *)(image->data), &interp );
+    }
+    return SV_OK;
+  case IMG_GRADIX:
+  case IMG_GRADIY:
+  case IMG_GRADIZ:
+    ComputeImageGrad( image );
+    Img_InterpGrad( image, &interp, grad );
+    *value = grad[code - IMG_GRADIX];
+    return SV_OK;
+  default:
+    fprintf(stderr, "ERR: ImageData_T not handled correctly.\n");
+    return SV_ERROR;
+  }
 }
 
 
@@ -1205,6 +1140,59 @@ int GetGradIz( Image_T *image, double pos[], double *result )
 }
 
 
+// -----------
+// Img_GetGrad
+// -----------
+// All three gradient components at pos in one interpolation.  This
+// is the same as calling GetGradIx, GetGradIy and GetGradIz, but
+// finds the pixels and weights only once.
+
+int Img_GetGrad( Image_T *image, double pos[], double grad[] )
+{
+  ImgInterp_T interp;
+
+  if ( ! image->gradValid ) {
+    ComputeImageGrad( image );
+  }
+  if ( Img_SetUpInterp( image, pos, &interp ) != SV_OK ) {
+    return SV_ERROR;
+  }
+  Img_InterpGrad( image, &interp, grad );
+  return SV_OK;
+}
+
+
+// ---------------------
+// Img_GetPixelIntensity
+// ---------------------
+
+double Img_GetPixelIntensity( Image_T *image, int pixIx )
+{
+  return Img_Datum( image, pixIx );
+}
+
+
+// ----------------
+// Img_GetPixelGrad
+// ----------------
+// Gradient at one pixel, computed directly (i.e. without filling in
+// its tile), for callers which walk over the whole image.
+
+void Img_GetPixelGrad( Image_T *image, int pixIx, double grad[] )
+{
+  int xdim = image->imgDims[0];
+  int ydim = image->imgDims[1];
+  float g[3];
+
+  Img_PixelGrad( image, pixIx % xdim, ( pixIx / xdim ) % ydim,
+		 pixIx / ( xdim * ydim ), g );
+  grad[0] = g[0];
+  grad[1] = g[1];
+  grad[2] = g[2];
+  return;
+}
+
+
 // -----------
 // WriteZSlice
 // -----------
@@ -1213,9 +1201,10 @@ void WriteZSlice( Image_T *image, char *filename, int num,
 		  char *imgTypeFlag, ImageData_T field )
 {
   FILE *fp;
-  int len, i;
+  int i, j;
   short sDatum;
   double dDatum;
+  float g[3];
   int convertShort;
 
   if ( !strcmp( imgTypeFlag, "-short" ) ) {
@@ -1229,46 +1218,25 @@ void WriteZSlice( Image_T *image, char *filename, int num,
 
   fp = fopen( filename, "w" );
 
-  len = image->imgDims[0] * image->imgDims[1] * image->imgDims[2];
-  for ( i = 0; i < len; i++ ) {
-    if ( image->pixels[i].plane == num ) {
-      switch (field) {
-      case IMG_INTENSITY:
-	if (convertShort) {
-	  sDatum = (short)(image->pixels[i].intensity);
-	  fwrite( &sDatum, sizeof(short), 1, fp );
-	} else {
-	  dDatum = image->pixels[i].intensity;
-	  fwrite( &dDatum, sizeof(double), 1, fp );
-	}
-	break;
-      case IMG_GRADIX:
-	if (convertShort) {
-	  sDatum = (short)(image->pixels[i].gradX);
-	  fwrite( &sDatum, sizeof(short), 1, fp );
-	} else {
-	  dDatum = image->pixels[i].gradX;
-	  fwrite( &dDatum, sizeof(double), 1, fp );
-	}
-	break;
-      case IMG_GRADIY:
-	if (convertShort) {
-	  sDatum = (short)(image->pixels[i].gradY);
-	  fwrite( &sDatum, sizeof(short), 1, fp );
-	} else {
-	  dDatum = image->pixels[i].gradY;
-	  fwrite( &dDatum, sizeof(double), 1, fp );
-	}
-	break;
-      case IMG_GRADIZ:
-	if (convertShort) {
-	  sDatum = (short)(image->pixels[i].gradZ);
-	  fwrite( &sDatum, sizeof(short), 1, fp );
-	} else {
-	  dDatum = image->pixels[i].gradZ;
-	  fwrite( &dDatum, sizeof(double), 1, fp );
-	}
-	break;
+  if ( ( num < 0 ) || ( num >= image->imgDims[2] ) ) {
+    fclose(fp);
+    return;
+  }
+
+  for ( j = 0; j < image->imgDims[1]; j++ ) {
+    for ( i = 0; i < image->imgDims[0]; i++ ) {
+      if ( field == IMG_INTENSITY ) {
+	dDatum = Img_Datum( image, ( num * image->imgDims[1] + j ) *
+			    image->imgDims[0] + i );
+      } else {
+	Img_PixelGrad( image, i, j, num, g );
+	dDatum = g[field - IMG_GRADIX];
+      }
+      if (convertShort) {
+	sDatum = (short)(dDatum);
+	fwrite( &sDatum, sizeof(short), 1, fp );
+      } else {
+	fwrite( &dDatum, sizeof(double), 1, fp );
       }
     }
   }
@@ -1320,6 +1288,7 @@ int InRange( Image_T *image, double pos[] )
 
 int Img_GetMemoryUsage( Image_T *image )
 {
+  ImgGradTiles_T *gt;
   int numPix;
   int sz;
 
@@ -1329,7 +1298,20 @@ int Img_GetMemoryUsage( Image_T *image )
 
   numPix = image->imgDims[0] * image->imgDims[1] * image->imgDims[2];
   sz = sizeof( Image_T );
-  sz += numPix * sizeof( Pixel_T );
+  if ( image->scalarType == IMG_SHORT ) {
+    sz += numPix * sizeof( short );
+  } else {
+    sz += numPix * sizeof( float );
+  }
+
+  gt = image->gradTiles;
+  if ( gt != NULL ) {
+    sz += sizeof( ImgGradTiles_T );
+    sz += gt->numTiles[0] * gt->numTiles[1] * gt->numTiles[2] *
+      sizeof( std::atomic<float*> );
+    sz += gt->numAllocated.load() * 3 * sizeof( float ) *
+      gt->tileDims[0] * gt->tileDims[1] * gt->tileDims[2];
+  }
 
   return sz;
 }
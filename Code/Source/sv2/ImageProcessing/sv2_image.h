@@ -42,18 +42,29 @@
  * evolved from a C-style implementation and will probably remain this
  * way until we build more image functionality. */
 
-typedef struct {
-  double intensity;
-  int row;
-  int col;
-  int plane;
-  double gradX;
-  double gradY;
-  double gradZ;
-} Pixel_T;
+/* Intensities are kept in their native type in one array, with
+ * column index fastest and plane index slowest, so a voxel's
+ * coordinates follow from its index.  Gradients are not stored per
+ * voxel; they are computed for one tile of voxels at a time when a
+ * lookup first touches the tile (see ComputeImageGrad).  At most a
+ * quarter of the tiles are kept, so an image stays under 8 bytes per
+ * voxel (5 for short data, 7 for float) however much of it is looked
+ * up; gradients outside the kept tiles are recomputed on each lookup.
+ *
+ * LinearInterp is scalar on purpose: its cost is the 4 or 8 gathers
+ * at scattered offsets, and summing the weighted corners in a
+ * different order would change results in the last bits. */
+
+typedef enum {
+  IMG_SHORT, IMG_FLOAT
+} ImageScalar_T;
+
+struct ImgGradTiles_T;
 
 typedef struct {
-  Pixel_T *pixels;
+  void *data;
+  ImageScalar_T scalarType;
+  struct ImgGradTiles_T *gradTiles;
   int imgDims[3];        // in pixels
   double pixelDims[3];   // in physical units
   char filebase[1000];
@@ -61,6 +72,8 @@ typedef struct {
   int dim;
   int gradValid;
   int closed;
+  int gradBoundsClosed;  // see CloseImageGradBounds
+  double gradBoundValue;
   double lowerleft[3];
 } Image_T;
 
@@ -77,8 +90,8 @@ SV_EXPORT_IMAGE Image_T *CreateImage( void *data, int numData, char *imgTypeFlag
 
 SV_EXPORT_IMAGE void Image_Delete( Image_T *img );
 
-SV_EXPORT_IMAGE double ComputePointSlope( Pixel_T *prev, Pixel_T *curr, Pixel_T *next,
-                          Image_T *image, int dimFlag );
+SV_EXPORT_IMAGE double ComputePointSlope( double prev, double curr, double next,
+                          double ddom );
 
 SV_EXPORT_IMAGE void ComputeImageGrad( Image_T *image );
 
@@ -115,6 +128,12 @@ SV_EXPORT_IMAGE int GetGradIy( Image_T *image, double pos[], double *result );
 
 SV_EXPORT_IMAGE int GetGradIz( Image_T *image, double pos[], double *result );
 
+SV_EXPORT_IMAGE int Img_GetGrad( Image_T *image, double pos[], double grad[] );
+
+SV_EXPORT_IMAGE double Img_GetPixelIntensity( Image_T *image, int pixIx );
+
+SV_EXPORT_IMAGE void Img_GetPixelGrad( Image_T *image, int pixIx, double grad[] );
+
 SV_EXPORT_IMAGE void WriteZSlice( Image_T *image, char *filename, int num,
 		  char *imgTypeFlag, ImageData_T field );
 
@@ -978,14 +978,16 @@ int Image_CreateDistanceMapCmd( ClientData clientData, Tcl_Interp *interp,
   ARG_List startList;
   double thr;
   int useCityBlock = 1;
+  int exact = 0;
 
-  int table_sz = 5;
+  int table_sz = 6;
   ARG_Entry arg_table[] = {
     { "-src", STRING_Type, &srcName, NULL, REQUIRED, 0, { 0 } },
-    { "-start", LIST_Type, &startList, NULL, REQUIRED, 0, { 0 } },
+    { "-start", LIST_Type, &startList, NULL, SV_OPTIONAL, 0, { 0 } },
     { "-thr", DOUBLE_Type, &thr, NULL, REQUIRED, 0, { 0 } },
     { "-dst", STRING_Type, &dstName, NULL, REQUIRED, 0, { 0 } },
     { "-city_block", BOOL_Type, &useCityBlock, NULL, SV_OPTIONAL, 0, { 0 } },
+    { "-exact", BOOL_Type, &exact, NULL, SV_OPTIONAL, 0, { 0 } },
   };
 
   usage = ARG_GenSyntaxStr( 1, argv, table_sz, arg_table );
@@ -1028,12 +1030,23 @@ int Image_CreateDistanceMapCmd( ClientData clientData, Tcl_Interp *interp,
   int nstart;
   int start[3];
 
-  // Parse coordinate lists:
-  if ( ARG_ParseTclListStatic( interp, startList, INT_Type, start, 3, &nstart )
-       != TCL_OK ) {
-    Tcl_SetResult( interp, usage, TCL_VOLATILE );
-    ARG_FreeListArgvs( table_sz, arg_table );
-    return TCL_ERROR;
+  // -start is only needed for the path finding map; -exact gives the
+  // Euclidean distance to the nearest pixel below -thr instead.
+  if ( !exact ) {
+    if ( !arg_table[1].valid ) {
+      Tcl_AppendResult( interp, "-start is required unless -exact is given",
+			(char *)NULL );
+      ARG_FreeListArgvs( table_sz, arg_table );
+      return TCL_ERROR;
+    }
+
+    // Parse coordinate lists:
+    if ( ARG_ParseTclListStatic( interp, startList, INT_Type, start, 3, &nstart )
+	 != TCL_OK ) {
+      Tcl_SetResult( interp, usage, TCL_VOLATILE );
+      ARG_FreeListArgvs( table_sz, arg_table );
+      return TCL_ERROR;
+    }
   }
 
   ARG_FreeListArgvs( table_sz, arg_table );
@@ -1052,14 +1065,25 @@ int Image_CreateDistanceMapCmd( ClientData clientData, Tcl_Interp *interp,
   if (useCityBlock == FALSE) {
       distmap->setUse26ConnectivityDistance();
   }
-  int status = distmap->createDistanceMap(sp,thrval,start);
+  int status;
+  if (exact) {
+    status = distmap->createEuclideanDistanceMap(sp,thrval);
+  } else {
+    status = distmap->createDistanceMap(sp,thrval,start);
+  }
 
   if ( status == SV_ERROR ) {
     Tcl_AppendResult( interp, "Problem creating distance map for ", srcName,(char *)NULL );
+    delete distmap;
     return TCL_ERROR;
   }
 
-  cvStrPts *repossp = new cvStrPts( distmap->getDistanceMap() );
+  cvStrPts *repossp;
+  if (exact) {
+    repossp = new cvStrPts( distmap->getEuclideanDistanceMap() );
+  } else {
+    repossp = new cvStrPts( distmap->getDistanceMap() );
+  }
   delete distmap;
 
   repossp->SetName( dstName );
@@ -1089,18 +1113,20 @@ int Image_FindPathCmd( ClientData clientData, Tcl_Interp *interp,
   char *dstName;
 
   ARG_List stopList;
+  ARG_List stopsList;
   int useCityBlock = 1;
   int maxIter = -1;
   int minqstop = 0;
 
-  int table_sz = 6;
+  int table_sz = 7;
   ARG_Entry arg_table[] = {
     { "-src", STRING_Type, &srcName, NULL, REQUIRED, 0, { 0 } },
-    { "-stop", LIST_Type, &stopList, NULL, REQUIRED, 0, { 0 } },
+    { "-stop", LIST_Type, &stopList, NULL, SV_OPTIONAL, 0, { 0 } },
     { "-dst", STRING_Type, &dstName, NULL, REQUIRED, 0, { 0 } },
     { "-city_block", BOOL_Type, &useCityBlock, NULL, SV_OPTIONAL, 0, { 0 } },
     { "-thin_passes", INT_Type, &maxIter, NULL, SV_OPTIONAL, 0, { 0 } },
     { "-min_dist", INT_Type, &minqstop, NULL, SV_OPTIONAL, 0, { 0 } },
+    { "-stops", LIST_Type, &stopsList, NULL, SV_OPTIONAL, 0, { 0 } },
   };
 
   usage = ARG_GenSyntaxStr( 1, argv, table_sz, arg_table );
@@ -1142,21 +1168,77 @@ int Image_FindPathCmd( ClientData clientData, Tcl_Interp *interp,
 
   int nstart;
   int stop[3];
+  int numStops = 0;
+  int (*stops)[3] = NULL;
 
-  // Parse coordinate lists:
-  if ( ARG_ParseTclListStatic( interp, stopList, INT_Type, stop, 3, &nstart )
-       != TCL_OK ) {
-    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+  // Exactly one of -stop (one ijk) and -stops (a list of ijk's, all
+  // traced on the same map) must be given:
+  if ( arg_table[1].valid == arg_table[6].valid ) {
+    Tcl_AppendResult( interp, "exactly one of -stop and -stops must be given",
+		      (char *)NULL );
     ARG_FreeListArgvs( table_sz, arg_table );
     return TCL_ERROR;
   }
 
+  if ( arg_table[6].valid && maxIter >= 0 ) {
+    Tcl_AppendResult( interp, "-thin_passes can not be used with -stops",
+		      (char *)NULL );
+    ARG_FreeListArgvs( table_sz, arg_table );
+    return TCL_ERROR;
+  }
+
+  // Parse coordinate lists:
+  if ( arg_table[1].valid ) {
+    if ( ARG_ParseTclListStatic( interp, stopList, INT_Type, stop, 3, &nstart )
+	 != TCL_OK ) {
+      Tcl_SetResult( interp, usage, TCL_VOLATILE );
+      ARG_FreeListArgvs( table_sz, arg_table );
+      return TCL_ERROR;
+    }
+  } else {
+    numStops = stopsList.argc;
+    if ( numStops == 0 ) {
+      Tcl_AppendResult( interp, "empty list of stops", (char *)NULL );
+      ARG_FreeListArgvs( table_sz, arg_table );
+      return TCL_ERROR;
+    }
+    ARG_List *indstops = new ARG_List [numStops];
+    for (int i = 0; i < numStops; i++) {
+      indstops[i].argc = 0;
+      indstops[i].argv = NULL;
+    }
+    int status = ARG_ParseTclListStatic( interp, stopsList, LIST_Type,
+					 indstops, numStops, &nstart );
+    stops = new int [numStops][3];
+    int npt;
+    for (int i = 0; i < numStops; i++) {
+      if ( status == TCL_OK &&
+	   ( ARG_ParseTclListStatic( interp, indstops[i], INT_Type, stops[i],
+				     3, &npt ) != TCL_OK || npt != 3 ) ) {
+	status = TCL_ERROR;
+      }
+      if ( indstops[i].argv != NULL ) {
+	Tcl_Free( (char *) indstops[i].argv );
+      }
+    }
+    if ( status != TCL_OK ) {
+      Tcl_SetResult( interp, "error in stops list", TCL_VOLATILE );
+    }
+    delete [] indstops;
+    if ( status != TCL_OK ) {
+      delete [] stops;
+      ARG_FreeListArgvs( table_sz, arg_table );
+      return TCL_ERROR;
+    }
+  }
+
   ARG_FreeListArgvs( table_sz, arg_table );
 
   // Make sure the specified result object does not exist:
   if ( gRepository->Exists( dstName ) ) {
     Tcl_AppendResult( interp, "object ", dstName, " already exists",
 		      (char *)NULL );
+    delete [] stops;
     return TCL_ERROR;
   }
 
@@ -1168,7 +1250,11 @@ int Image_FindPathCmd( ClientData clientData, Tcl_Interp *interp,
       distmap->setUse26ConnectivityDistance();
   }
   vtkPolyData *pd;
-  if (maxIter < 0) {
+  if (stops != NULL) {
+    // getPaths hands back a polydata owned by the caller
+    pd = distmap->getPaths(numStops,stops,minqstop);
+    delete [] stops;
+  } else if (maxIter < 0) {
     pd = distmap->getPath(stop,minqstop);
   } else {
     pd = distmap->getPathByThinning(stop,minqstop,maxIter);
@@ -1180,6 +1266,9 @@ int Image_FindPathCmd( ClientData clientData, Tcl_Interp *interp,
   }
 
   cvPolyData *dst = new cvPolyData (pd);
+  if (numStops > 0) {
+    pd->Delete();
+  }
 
   dst->SetName( dstName );
   if ( !( gRepository->Register( dst->GetName(), dst ) ) ) {
@@ -1012,12 +1012,13 @@ PyObject *Image_CreateDistanceMapCmd(PyObject *self, PyObject *args)
   char *dstName;
 
   int useCityBlock = 1;
+  int exact = 0;
 
 
-  if (!PyArg_ParseTuple(args,"sOds|i",&srcName,&startList,
-          &thr,&dstName,&useCityBlock))
+  if (!PyArg_ParseTuple(args,"sOds|ii",&srcName,&startList,
+          &thr,&dstName,&useCityBlock,&exact))
   {
-    PyErr_SetString(ImgErr,"Could not import 1 char, 1 tuple, 1 double, 1 char and 1 int(bool): srcName,startList,thr, dstName,useCityBlock");
+    PyErr_SetString(ImgErr,"Could not import 1 char, 1 tuple, 1 double, 1 char and 2 optional int(bool): srcName,startList,thr, dstName,useCityBlock,exact");
     
   }
 
@@ -1056,8 +1057,9 @@ PyObject *Image_CreateDistanceMapCmd(PyObject *self, PyObject *args)
   int nstart;
   int start[3];
 
-  // Parse coordinate lists:
-  for (int i = 0; i < 3; i++)
+  // Parse coordinate lists (the start point is not used by the exact
+  // Euclidean distance map):
+  for (int i = 0; i < 3 && !exact; i++)
   {
     start[i]=PyInt_AsLong(PyList_GetItem(startList,i));
     if (PyErr_Occurred()||PyList_Size(startList)!=3)
@@ -1085,7 +1087,15 @@ PyObject *Image_CreateDistanceMapCmd(PyObject *self, PyObject *args)
   {
       distmap->setUse26ConnectivityDistance();
   }
-  int status = distmap->createDistanceMap(sp,thrval,start);
+  int status;
+  if (exact)
+  {
+    status = distmap->createEuclideanDistanceMap(sp,thrval);
+  }
+  else
+  {
+    status = distmap->createDistanceMap(sp,thrval,start);
+  }
 
   if ( status == SV_ERROR )
   {
@@ -1095,7 +1105,15 @@ PyObject *Image_CreateDistanceMapCmd(PyObject *self, PyObject *args)
     
   }
 
-  cvStrPts *repossp = new cvStrPts( distmap->getDistanceMap() );
+  cvStrPts *repossp;
+  if (exact)
+  {
+    repossp = new cvStrPts( distmap->getEuclideanDistanceMap() );
+  }
+  else
+  {
+    repossp = new cvStrPts( distmap->getDistanceMap() );
+  }
   delete distmap;
 
   repossp->SetName( dstName );
@@ -1171,15 +1189,51 @@ PyObject *Image_FindPathCmd( PyObject *self, PyObject *args )
 
   int nstart;
   int stop[3];
+  int numStops = 0;
+  int (*stops)[3] = NULL;
 
-  // Parse coordinate lists:
-  for (int i = 0; i < 3; i++)
+  // Parse coordinate lists.  stopList is either one [i,j,k] or a list
+  // of them, which are all traced on the same map.
+  if (PyList_Size(stopList) > 0 && PyList_Check(PyList_GetItem(stopList,0)))
   {
-    stop[i]=PyInt_AsLong(PyList_GetItem(stopList,i));
-    if (PyErr_Occurred()||PyList_Size(stopList)!=3)
+    if (maxIter >= 0)
     {
-      PyErr_SetString( ImgErr, "Error parsing coordinate lists!" );
-      
+      PyErr_SetString( ImgErr, "maxIter can not be used with several stops" );
+      return NULL;
+    }
+    numStops = PyList_Size(stopList);
+    stops = new int [numStops][3];
+    for (int s = 0; s < numStops; s++)
+    {
+      PyObject* stopPt = PyList_GetItem(stopList,s);
+      if (!PyList_Check(stopPt) || PyList_Size(stopPt)!=3)
+      {
+        PyErr_SetString( ImgErr, "Error parsing coordinate lists!" );
+        delete [] stops;
+        return NULL;
+      }
+      for (int i = 0; i < 3; i++)
+      {
+        stops[s][i]=PyInt_AsLong(PyList_GetItem(stopPt,i));
+      }
+      if (PyErr_Occurred())
+      {
+        PyErr_SetString( ImgErr, "Error parsing coordinate lists!" );
+        delete [] stops;
+        return NULL;
+      }
+    }
+  }
+  else
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      stop[i]=PyInt_AsLong(PyList_GetItem(stopList,i));
+      if (PyErr_Occurred()||PyList_Size(stopList)!=3)
+      {
+        PyErr_SetString( ImgErr, "Error parsing coordinate lists!" );
+        
+      }
     }
   }
 
@@ -1199,7 +1253,11 @@ PyObject *Image_FindPathCmd( PyObject *self, PyObject *args )
       distmap->setUse26ConnectivityDistance();
   }
   vtkPolyData *pd;
-  if (maxIter < 0) {
+  if (stops != NULL) {
+    // getPaths hands back a polydata owned by the caller
+    pd = distmap->getPaths(numStops,stops,minqstop);
+    delete [] stops;
+  } else if (maxIter < 0) {
     pd = distmap->getPath(stop,minqstop);
   } else {
     pd = distmap->getPathByThinning(stop,minqstop,maxIter);
@@ -1227,6 +1285,9 @@ PyObject *Image_FindPathCmd( PyObject *self, PyObject *args )
 
   //instead of exporting the object name, output the vtkPolydata object
   PyObject* pyVtkObj=vtkPythonUtil::GetObjectFromPointer(pd);
+  if (numStops > 0) {
+    pd->Delete();
+  }
   return pyVtkObj;
 
 }
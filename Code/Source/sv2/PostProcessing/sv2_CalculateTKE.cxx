@@ -42,6 +42,144 @@
 
 #include "sv2_CalculateTKE.h"
 
+#include "vtkSMPTools.h"
+
+// ------------------------------
+// helpers for the parallel loops
+// ------------------------------
+// Points are processed in blocks by vtkSMPTools.  Inside a block each
+// input array is walked contiguously through a raw pointer when it is
+// a double array, so the inner loops vectorize; other array types go
+// through the (thread safe) GetTuple(i,double*).
+
+static double* GetRawVectors(vtkDataArray *array) {
+  vtkDoubleArray *doubles = vtkDoubleArray::SafeDownCast(array);
+  if (doubles == NULL || doubles->GetNumberOfComponents() != 3) {
+    return NULL;
+  }
+  return doubles->GetPointer(0);
+}
+
+static void GetVelocity(vtkDataArray *array, double *raw, vtkIdType i, double vel[3]) {
+  if (raw != NULL) {
+    vel[0] = raw[3*i];
+    vel[1] = raw[3*i+1];
+    vel[2] = raw[3*i+2];
+  } else {
+    array->GetTuple(i,vel);
+  }
+}
+
+struct cvCalculateTKEAverageFunctor {
+  vtkDataArray **inputVectors;
+  double **raw;
+  int numInputArrays;
+  double *avg;
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    vtkIdType i;
+    double vel[3];
+    for (i = begin; i < end; i++) {
+      avg[3*i] = avg[3*i+1] = avg[3*i+2] = 0.0;
+    }
+    // same summation order per point as a serial loop over the steps
+    for (int j = 0; j < numInputArrays; j++) {
+      double *u = raw[j];
+      if (u != NULL) {
+        for (i = 3*begin; i < 3*end; i++) {
+          avg[i] += u[i];
+        }
+      } else {
+        for (i = begin; i < end; i++) {
+          inputVectors[j]->GetTuple(i,vel);
+          avg[3*i] += vel[0]; avg[3*i+1] += vel[1]; avg[3*i+2] += vel[2];
+        }
+      }
+    }
+    for (i = 3*begin; i < 3*end; i++) {
+      avg[i] = avg[i]/numInputArrays;
+    }
+  }
+};
+
+struct cvCalculateTKEVarianceFunctor {
+  vtkDataArray **inputVectors;
+  double **raw;
+  int numInputArrays;
+  double *avg;
+  double *rms;
+  double *ke;
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    vtkIdType i;
+    double vel[3];
+    for (i = 3*begin; i < 3*end; i++) {
+      rms[i] = 0.0;
+    }
+    for (int j = 0; j < numInputArrays; j++) {
+      double *u = raw[j];
+      if (u != NULL) {
+        for (i = 3*begin; i < 3*end; i++) {
+          double d = u[i]-avg[i];
+          rms[i] += d*d;
+        }
+      } else {
+        for (i = begin; i < end; i++) {
+          inputVectors[j]->GetTuple(i,vel);
+          for (int k = 0; k < 3; k++) {
+            double d = vel[k]-avg[3*i+k];
+            rms[3*i+k] += d*d;
+          }
+        }
+      }
+    }
+    for (i = begin; i < end; i++) {
+      double v0 = sqrt(rms[3*i]/numInputArrays);
+      double v1 = sqrt(rms[3*i+1]/numInputArrays);
+      double v2 = sqrt(rms[3*i+2]/numInputArrays);
+      rms[3*i] = v0; rms[3*i+1] = v1; rms[3*i+2] = v2;
+      ke[i] = 0.5*((v0*v0)+(v1*v1)+(v2*v2));
+    }
+  }
+};
+
+struct cvCalculateTKEStreamFunctor {
+  vtkDataArray *vectors;
+  double *raw;
+  int count;
+  double *mean;
+  double *m2;
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    double vel[3];
+    for (vtkIdType i = begin; i < end; i++) {
+      GetVelocity(vectors,raw,i,vel);
+      for (int k = 0; k < 3; k++) {
+        double delta = vel[k]-mean[3*i+k];
+        mean[3*i+k] += delta/count;
+        m2[3*i+k] += delta*(vel[k]-mean[3*i+k]);
+      }
+    }
+  }
+};
+
+struct cvCalculateTKEStreamResultFunctor {
+  int count;
+  double *m2;
+  double *rms;
+  double *ke;
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; i++) {
+      double v0 = sqrt(m2[3*i]/count);
+      double v1 = sqrt(m2[3*i+1]/count);
+      double v2 = sqrt(m2[3*i+2]/count);
+      rms[3*i] = v0; rms[3*i+1] = v1; rms[3*i+2] = v2;
+      ke[i] = 0.5*((v0*v0)+(v1*v1)+(v2*v2));
+    }
+  }
+};
+
 // --------------
 // cvCalculateTKE
 // --------------
@@ -51,6 +189,9 @@ cvCalculateTKE::cvCalculateTKE() {
     averageU_ = NULL;
     rms_ = NULL;
     KE_ = NULL;
+    points_ = NULL;
+    streamMean_ = NULL;
+    streamM2_ = NULL;
     numInputArrays_ = 0;
     numArrayPts_ = 0;
 }
@@ -61,22 +202,66 @@ cvCalculateTKE::cvCalculateTKE() {
 // ---------------
 
 cvCalculateTKE::~cvCalculateTKE() {
+    this->Reset();
+}
+
+
+// -----
+// Reset
+// -----
+
+int cvCalculateTKE::Reset() {
 
     if (inputVectors_ != NULL) {
       delete [] inputVectors_;
     }
+    inputVectors_ = NULL;
+
+    if (streamMean_ != NULL) {
+      delete [] streamMean_;
+    }
+    streamMean_ = NULL;
+
+    if (streamM2_ != NULL) {
+      delete [] streamM2_;
+    }
+    streamM2_ = NULL;
+
+    if (points_ != NULL) {
+      points_->UnRegister(NULL);
+    }
+    points_ = NULL;
+
+    numInputArrays_ = 0;
+    numArrayPts_ = 0;
+
+    return this->ClearResults();
+
+}
+
+
+// ------------
+// ClearResults
+// ------------
+
+int cvCalculateTKE::ClearResults() {
 
     if (averageU_ != NULL) {
         averageU_->Delete();
     }
+    averageU_ = NULL;
 
     if (rms_ != NULL) {
         rms_->Delete();
     }
+    rms_ = NULL;
 
     if (KE_ != NULL) {
         KE_->Delete();
     }
+    KE_ = NULL;
+
+    return SV_OK;
 
 }
 
@@ -89,6 +274,8 @@ int cvCalculateTKE::SetInputData(int numPds, cvPolyData **inputPds) {
 
     int i = 0;
 
+    this->Reset();
+
     fprintf(stdout,"numPds: %i\n",numPds);
 
     numInputArrays_ = numPds;
@@ -104,6 +291,68 @@ int cvCalculateTKE::SetInputData(int numPds, cvPolyData **inputPds) {
     }
 
     points_=inputPds[0]->GetVtkPolyData()->GetPoints();
+    if (points_ != NULL) {
+      points_->Register(NULL);
+    }
+
+    return SV_OK;
+
+}
+
+
+// -----------
+// AddTimeStep
+// -----------
+// Streaming alternative to SetInputData.  Only the running mean and the
+// sum of squared deviations are kept, so the step can be released as
+// soon as this returns.
+
+int cvCalculateTKE::AddTimeStep(cvPolyData *inputPd) {
+
+    int i = 0;
+
+    if (inputVectors_ != NULL) {
+      fprintf(stderr,"ERROR: input already set with SetInputData\n");
+      return SV_ERROR;
+    }
+
+    vtkPolyData *pd = inputPd->GetVtkPolyData();
+    vtkDataArray *vectors = pd->GetPointData()->GetVectors();
+    if (vectors == NULL || vectors->GetNumberOfComponents() != 3) {
+      fprintf(stderr,"ERROR: no velocity vectors found\n");
+      return SV_ERROR;
+    }
+
+    if (numInputArrays_ == 0) {
+      numArrayPts_ = pd->GetNumberOfPoints();
+      streamMean_ = new double[3*numArrayPts_];
+      streamM2_ = new double[3*numArrayPts_];
+      for (i = 0; i < 3*numArrayPts_; i++) {
+        streamMean_[i] = 0.0;
+        streamM2_[i] = 0.0;
+      }
+      points_ = pd->GetPoints();
+      if (points_ != NULL) {
+        points_->Register(NULL);
+      }
+    } else if (pd->GetNumberOfPoints() != numArrayPts_) {
+      fprintf(stderr,"ERROR: number of points (%i) differs from first step (%i)\n",
+              (int)pd->GetNumberOfPoints(),numArrayPts_);
+      return SV_ERROR;
+    }
+
+    numInputArrays_++;
+
+    cvCalculateTKEStreamFunctor functor;
+    functor.vectors = vectors;
+    functor.raw = GetRawVectors(vectors);
+    functor.count = numInputArrays_;
+    functor.mean = streamMean_;
+    functor.m2 = streamM2_;
+    vtkSMPTools::For(0,numArrayPts_,functor);
+
+    // results computed so far are out of date
+    this->ClearResults();
 
     return SV_OK;
 
@@ -116,30 +365,33 @@ int cvCalculateTKE::SetInputData(int numPds, cvPolyData **inputPds) {
 
 int cvCalculateTKE::CalculateAverageVelocity() {
 
-    int i = 0;
     int j = 0;
-    vtkFloatingPointType vel[3];
 
     // create return vtk vector array
     averageU_ = vtkFloatingPointArrayType::New();
     averageU_->SetNumberOfComponents(3);
-    averageU_->Allocate(numArrayPts_,1000);
-    averageU_->Initialize();
-
-    for (i = 0; i < numArrayPts_; i++) {
-        double v0 = 0.0;
-        double v1 = 0.0;
-        double v2 = 0.0;
-        for (j = 0; j < numInputArrays_; j++) {
-            inputVectors_[j]->GetTuple(i,vel);
-            v0 += vel[0];v1 += vel[1];v2 += vel[2];
-        }
-        v0 = v0/numInputArrays_;
-        v1 = v1/numInputArrays_;
-        v2 = v2/numInputArrays_;
-        averageU_->InsertNextTuple3(v0,v1,v2);
+    averageU_->SetNumberOfTuples(numArrayPts_);
+    double *avg = averageU_->GetPointer(0);
+
+    if (streamMean_ != NULL) {
+      memcpy(avg,streamMean_,3*numArrayPts_*sizeof(double));
+      return SV_OK;
     }
 
+    double **raw = new double*[numInputArrays_];
+    for (j = 0; j < numInputArrays_; j++) {
+      raw[j] = GetRawVectors(inputVectors_[j]);
+    }
+
+    cvCalculateTKEAverageFunctor functor;
+    functor.inputVectors = inputVectors_;
+    functor.raw = raw;
+    functor.numInputArrays = numInputArrays_;
+    functor.avg = avg;
+    vtkSMPTools::For(0,numArrayPts_,functor);
+
+    delete [] raw;
+
     return SV_OK;
 
 }
@@ -151,6 +403,8 @@ int cvCalculateTKE::CalculateAverageVelocity() {
 
 int cvCalculateTKE::CalculateTKE() {
 
+    int j = 0;
+
     if (averageU_ == NULL) {
        this->CalculateAverageVelocity();
     }
@@ -158,39 +412,39 @@ int cvCalculateTKE::CalculateTKE() {
     // create return vtk vector array
     rms_ = vtkFloatingPointArrayType::New();
     rms_->SetNumberOfComponents(3);
-    rms_->Allocate(numArrayPts_,1000);
-    rms_->Initialize();
+    rms_->SetNumberOfTuples(numArrayPts_);
 
     // create return vtk scalar array
     KE_ = vtkFloatingPointArrayType::New();
     KE_->SetNumberOfComponents(1);
-    KE_->Allocate(numArrayPts_,1000);
-    KE_->Initialize();
+    KE_->SetNumberOfTuples(numArrayPts_);
+
+    if (streamM2_ != NULL) {
+      cvCalculateTKEStreamResultFunctor functor;
+      functor.count = numInputArrays_;
+      functor.m2 = streamM2_;
+      functor.rms = rms_->GetPointer(0);
+      functor.ke = KE_->GetPointer(0);
+      vtkSMPTools::For(0,numArrayPts_,functor);
+      return SV_OK;
+    }
 
-    int i = 0;
-    int j = 0;
-    vtkFloatingPointType avg[3];
-    vtkFloatingPointType vel[3];
-
-    for (i = 0; i < numArrayPts_; i++) {
-        double v0 = 0.0;
-        double v1 = 0.0;
-        double v2 = 0.0;
-        averageU_->GetTuple(i,avg);
-        for (j = 0; j < numInputArrays_; j++) {
-            inputVectors_[j]->GetTuple(i,vel);
-            v0 = v0 + (vel[0]-avg[0])*(vel[0]-avg[0]);
-            v1 = v1 + (vel[1]-avg[1])*(vel[1]-avg[1]);
-            v2 = v2 + (vel[2]-avg[2])*(vel[2]-avg[2]);
-        }
-        v0 = sqrt(v0/numInputArrays_);
-        v1 = sqrt(v1/numInputArrays_);
-        v2 = sqrt(v2/numInputArrays_);
-        rms_->InsertNextTuple3(v0,v1,v2);
-        double s = 0.5*((v0*v0)+(v1*v1)+(v2*v2));
-        KE_->InsertNextTuple1(s);
+    double **raw = new double*[numInputArrays_];
+    for (j = 0; j < numInputArrays_; j++) {
+      raw[j] = GetRawVectors(inputVectors_[j]);
     }
 
+    cvCalculateTKEVarianceFunctor functor;
+    functor.inputVectors = inputVectors_;
+    functor.raw = raw;
+    functor.numInputArrays = numInputArrays_;
+    functor.avg = averageU_->GetPointer(0);
+    functor.rms = rms_->GetPointer(0);
+    functor.ke = KE_->GetPointer(0);
+    vtkSMPTools::For(0,numArrayPts_,functor);
+
+    delete [] raw;
+
     return SV_OK;
 
 }
@@ -198,6 +452,10 @@ int cvCalculateTKE::CalculateTKE() {
 
 cvPolyData* cvCalculateTKE::GetAverageVelocityPolyData() {
 
+  if (numInputArrays_ == 0) {
+    return NULL;
+  }
+
   if (averageU_ == NULL) {
     this->CalculateAverageVelocity();
   }
@@ -207,6 +465,7 @@ cvPolyData* cvCalculateTKE::GetAverageVelocityPolyData() {
   pd->SetPoints(points_);
   pd->GetPointData()->SetVectors(averageU_);
   cvPolyData* reposobj = new cvPolyData(pd);
+  pd->Delete();
   return reposobj;
 
 }
@@ -214,6 +473,10 @@ cvPolyData* cvCalculateTKE::GetAverageVelocityPolyData() {
 
 cvPolyData* cvCalculateTKE::GetTKEPolyData() {
 
+  if (numInputArrays_ == 0) {
+    return NULL;
+  }
+
   if (rms_ == NULL) {
     this->CalculateTKE();
   }
@@ -224,7 +487,7 @@ cvPolyData* cvCalculateTKE::GetTKEPolyData() {
   pd->GetPointData()->SetVectors(rms_);
   pd->GetPointData()->SetScalars(KE_);
   cvPolyData* reposobj = new cvPolyData(pd);
+  pd->Delete();
   return reposobj;
 
 }
-
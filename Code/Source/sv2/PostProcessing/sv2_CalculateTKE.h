@@ -53,18 +53,28 @@ class SV_EXPORT_POST cvCalculateTKE {
     cvPolyData* GetAverageVelocityPolyData();
     cvPolyData* GetTKEPolyData();
 
+    // streaming mode, one time step at a time instead of SetInputData
+    int AddTimeStep(cvPolyData *inputPd);
+    int GetNumberOfTimeSteps() {return numInputArrays_;}
+    int Reset();
+
   protected:
 
   private:
 
     int CalculateAverageVelocity();
     int CalculateTKE();
+    int ClearResults();
 
     vtkDataArray** inputVectors_;
     int numInputArrays_;
     int numArrayPts_;
     vtkPoints* points_;
 
+    // running mean and sum of squared deviations (Welford), 3 per point
+    double* streamMean_;
+    double* streamM2_;
+
     vtkFloatingPointArrayType* averageU_;
     vtkFloatingPointArrayType* rms_;
     vtkFloatingPointArrayType* KE_;
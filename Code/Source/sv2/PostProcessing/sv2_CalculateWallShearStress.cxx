@@ -50,7 +50,11 @@ cvCalculateWallShearStress::cvCalculateWallShearStress() {
     wallshear_ = NULL;
     surfaceMesh_ = NULL;
     tensors_ = NULL;
-
+    accumNumPts_ = 0;
+    accumNumSteps_ = 0;
+    accumShear_ = NULL;
+    accumShearMag_ = NULL;
+    accumPoints_ = NULL;
 }
 
 
@@ -62,6 +66,7 @@ cvCalculateWallShearStress::~cvCalculateWallShearStress() {
     if (wallshear_ != NULL) {
         wallshear_->Delete();
     }
+    ResetAccumulation();
 }
 
 
@@ -71,7 +76,9 @@ cvCalculateWallShearStress::~cvCalculateWallShearStress() {
 
 int cvCalculateWallShearStress::SetSurfaceMesh(cvPolyData* surfaceMesh) {
     surfaceMesh_ = NULL;
-    surfaceMesh_ = surfaceMesh->GetVtkPolyData();
+    if (surfaceMesh != NULL) {
+        surfaceMesh_ = surfaceMesh->GetVtkPolyData();
+    }
     return SV_OK;
 }
 
@@ -279,49 +286,19 @@ cvPolyData* cvCalculateWallShearStress::GetWallShear() {
 cvPolyData* cvCalculateWallShearStress::CalcWallShearMean(int numPds, cvPolyData **shearPds) {
 
     int i = 0;
-    int j = 0;
-    vtkFloatingPointType shear[3];
 
     fprintf(stdout,"numPds: %i\n",numPds);
 
-    // all of the shear pds must have the same num pts
-    int numPts = shearPds[0]->GetVtkPolyData()->GetNumberOfPoints();
-    fprintf(stdout,"numPts: %i\n",numPts);
-
-    // create a list of the shear vectors
-    vtkDataArray **vectors = new vtkDataArray*[numPds];
+    ResetAccumulation();
     for (i = 0; i < numPds; i++) {
-      vectors[i]=shearPds[i]->GetVtkPolyData()->GetPointData()->GetVectors();
-    }
-
-    // create return vtk vector
-    vtkFloatingPointArrayType *shearmean = vtkFloatingPointArrayType::New();
-    shearmean->SetNumberOfComponents(1);
-    shearmean->Allocate(numPts,10000);
-    shearmean->Initialize();
-
-    for (i = 0; i < numPts; i++) {
-        double v0 = 0.0;
-        double v1 = 0.0;
-        double v2 = 0.0;
-        for (j = 0; j < numPds; j++) {
-            vectors[j]->GetTuple(i,shear);
-            v0 += shear[0];v1 += shear[1];v2 += shear[2];
+        if (AccumulateWallShear(shearPds[i]) == SV_ERROR) {
+            ResetAccumulation();
+            return NULL;
         }
-        v0 = v0/numPds; v1 = v1/numPds; v2 = v2/numPds;
-        vtkFloatingPointType mag = sqrt(v0*v0+v1*v1+v2*v2);
-        shearmean->InsertNextTuple1(mag);
     }
 
-    // create cvPolyData object to return
-    vtkPolyData* pd = vtkPolyData::New();
-    if (surfaceMesh_ == NULL) {
-      pd->SetPoints(shearPds[0]->GetVtkPolyData()->GetPoints());
-    } else {
-      pd->CopyStructure(surfaceMesh_);
-    }
-    pd->GetPointData()->SetScalars(shearmean);
-    cvPolyData* reposobj = new cvPolyData(pd);
+    cvPolyData* reposobj = GetAccumulatedWallShearMean();
+    ResetAccumulation();
     return reposobj;
 
 }
@@ -329,46 +306,19 @@ cvPolyData* cvCalculateWallShearStress::CalcWallShearMean(int numPds, cvPolyData
 cvPolyData* cvCalculateWallShearStress::CalcWallShearPulse(int numPds, cvPolyData **shearPds){
 
     int i = 0;
-    int j = 0;
-    vtkFloatingPointType shear[3];
 
     fprintf(stdout,"numPds: %i\n",numPds);
 
-    // all of the shear pds must have the same num pts
-    int numPts = shearPds[0]->GetVtkPolyData()->GetNumberOfPoints();
-    fprintf(stdout,"numPts: %i\n",numPts);
-
-    // create a list of the shear vectors
-    vtkDataArray **vectors = new vtkDataArray*[numPds];
+    ResetAccumulation();
     for (i = 0; i < numPds; i++) {
-      vectors[i]=shearPds[i]->GetVtkPolyData()->GetPointData()->GetVectors();
-    }
-
-    // create return vtk vector
-    vtkFloatingPointArrayType *shearpulse = vtkFloatingPointArrayType::New();
-    shearpulse->SetNumberOfComponents(1);
-    shearpulse->Allocate(numPts,10000);
-    shearpulse->Initialize();
-
-    for (i = 0; i < numPts; i++) {
-        vtkFloatingPointType mag = 0.0;
-        for (j = 0; j < numPds; j++) {
-            vectors[j]->GetTuple(i,shear);
-            mag += sqrt(shear[0]*shear[0]+shear[1]*shear[1]+shear[2]*shear[2]);
+        if (AccumulateWallShear(shearPds[i]) == SV_ERROR) {
+            ResetAccumulation();
+            return NULL;
         }
-        mag = mag/numPds;
-        shearpulse->InsertNextTuple1(mag);
     }
 
-    // create cvPolyData object to return
-    vtkPolyData* pd = vtkPolyData::New();
-    if (surfaceMesh_ == NULL) {
-      pd->SetPoints(shearPds[0]->GetVtkPolyData()->GetPoints());
-    } else {
-      pd->CopyStructure(surfaceMesh_);
-    }
-    pd->GetPointData()->SetScalars(shearpulse);
-    cvPolyData* reposobj = new cvPolyData(pd);
+    cvPolyData* reposobj = GetAccumulatedWallShearPulse();
+    ResetAccumulation();
     return reposobj;
 
 }
@@ -490,3 +440,204 @@ cvPolyData* cvCalculateWallShearStress::CalcAvgPointData(int numPds, cvPolyData
 
 }
 
+
+// ---------------------
+//   ResetAccumulation
+// ---------------------
+
+int cvCalculateWallShearStress::ResetAccumulation() {
+    if (accumShear_ != NULL) {
+        delete [] accumShear_;
+    }
+    if (accumShearMag_ != NULL) {
+        delete [] accumShearMag_;
+    }
+    if (accumPoints_ != NULL) {
+        accumPoints_->UnRegister(NULL);
+    }
+    accumShear_ = NULL;
+    accumShearMag_ = NULL;
+    accumPoints_ = NULL;
+    accumNumPts_ = 0;
+    accumNumSteps_ = 0;
+    return SV_OK;
+}
+
+// -----------------------
+//   AccumulateWallShear
+// -----------------------
+// Adds one time step to the running sums.  Only the sums are kept, so
+// the step can be deleted as soon as this returns.
+
+int cvCalculateWallShearStress::AccumulateWallShear(cvPolyData *shearPd) {
+
+    int i = 0;
+
+    vtkPolyData* pd = shearPd->GetVtkPolyData();
+    vtkDataArray* vectors = pd->GetPointData()->GetVectors();
+    if (vectors == NULL || vectors->GetNumberOfComponents() != 3) {
+        fprintf(stderr,"ERROR: no shear vectors found\n");
+        return SV_ERROR;
+    }
+
+    int numPts = pd->GetNumberOfPoints();
+
+    if (accumNumSteps_ == 0) {
+        ResetAccumulation();
+        accumNumPts_ = numPts;
+        accumShear_ = new double[3*numPts];
+        accumShearMag_ = new double[numPts];
+        for (i = 0; i < 3*numPts; i++) {
+            accumShear_[i] = 0.0;
+        }
+        for (i = 0; i < numPts; i++) {
+            accumShearMag_[i] = 0.0;
+        }
+        accumPoints_ = pd->GetPoints();
+        if (accumPoints_ != NULL) {
+            accumPoints_->Register(NULL);
+        }
+    } else if (numPts != accumNumPts_) {
+        // all of the shear pds must have the same num pts
+        fprintf(stderr,"ERROR: number of points (%i) differs from first step (%i)\n",numPts,accumNumPts_);
+        return SV_ERROR;
+    }
+
+    // contiguous double arrays are read directly
+    vtkDoubleArray* doubles = vtkDoubleArray::SafeDownCast(vectors);
+    if (doubles != NULL) {
+        double* shear = doubles->GetPointer(0);
+        for (i = 0; i < numPts; i++) {
+            double s0 = shear[3*i];
+            double s1 = shear[3*i+1];
+            double s2 = shear[3*i+2];
+            accumShear_[3*i]   += s0;
+            accumShear_[3*i+1] += s1;
+            accumShear_[3*i+2] += s2;
+            accumShearMag_[i] += sqrt(s0*s0+s1*s1+s2*s2);
+        }
+    } else {
+        double shear[3];
+        for (i = 0; i < numPts; i++) {
+            vectors->GetTuple(i,shear);
+            accumShear_[3*i]   += shear[0];
+            accumShear_[3*i+1] += shear[1];
+            accumShear_[3*i+2] += shear[2];
+            accumShearMag_[i] += sqrt(shear[0]*shear[0]+shear[1]*shear[1]+shear[2]*shear[2]);
+        }
+    }
+
+    accumNumSteps_++;
+    return SV_OK;
+}
+
+// -------------------------------
+//   GetAccumulatedWallShearMean
+// -------------------------------
+// Magnitude of the time averaged shear vector.
+
+cvPolyData* cvCalculateWallShearStress::GetAccumulatedWallShearMean() {
+
+    int i = 0;
+
+    if (accumNumSteps_ == 0) {
+        return NULL;
+    }
+
+    fprintf(stdout,"numPts: %i\n",accumNumPts_);
+
+    vtkFloatingPointArrayType *shearmean = vtkFloatingPointArrayType::New();
+    shearmean->SetNumberOfComponents(1);
+    shearmean->SetNumberOfTuples(accumNumPts_);
+
+    for (i = 0; i < accumNumPts_; i++) {
+        double v0 = accumShear_[3*i]/accumNumSteps_;
+        double v1 = accumShear_[3*i+1]/accumNumSteps_;
+        double v2 = accumShear_[3*i+2]/accumNumSteps_;
+        shearmean->SetValue(i,sqrt(v0*v0+v1*v1+v2*v2));
+    }
+
+    return CreateScalarPolyData(shearmean);
+}
+
+// --------------------------------
+//   GetAccumulatedWallShearPulse
+// --------------------------------
+// Time average of the shear magnitude.
+
+cvPolyData* cvCalculateWallShearStress::GetAccumulatedWallShearPulse() {
+
+    int i = 0;
+
+    if (accumNumSteps_ == 0) {
+        return NULL;
+    }
+
+    fprintf(stdout,"numPts: %i\n",accumNumPts_);
+
+    vtkFloatingPointArrayType *shearpulse = vtkFloatingPointArrayType::New();
+    shearpulse->SetNumberOfComponents(1);
+    shearpulse->SetNumberOfTuples(accumNumPts_);
+
+    for (i = 0; i < accumNumPts_; i++) {
+        shearpulse->SetValue(i,accumShearMag_[i]/accumNumSteps_);
+    }
+
+    return CreateScalarPolyData(shearpulse);
+}
+
+// ---------------------
+//   GetAccumulatedOSI
+// ---------------------
+// Same definition as CalcOSI, taken straight from the running sums.
+
+cvPolyData* cvCalculateWallShearStress::GetAccumulatedOSI() {
+
+    int i = 0;
+
+    if (accumNumSteps_ == 0) {
+        return NULL;
+    }
+
+    fprintf(stdout,"numPts: %i\n",accumNumPts_);
+
+    vtkFloatingPointArrayType *osiScalars = vtkFloatingPointArrayType::New();
+    osiScalars->SetNumberOfComponents(1);
+    osiScalars->SetNumberOfTuples(accumNumPts_);
+
+    for (i = 0; i < accumNumPts_; i++) {
+        double v0 = accumShear_[3*i]/accumNumSteps_;
+        double v1 = accumShear_[3*i+1]/accumNumSteps_;
+        double v2 = accumShear_[3*i+2]/accumNumSteps_;
+        double mean = sqrt(v0*v0+v1*v1+v2*v2);
+        double pulse = accumShearMag_[i]/accumNumSteps_;
+        double osi = 0.0;
+        if (pulse > 0.00001) {
+            osi = 1.0/2.0*(1-mean/pulse);
+        }
+        osiScalars->SetValue(i,osi);
+    }
+
+    return CreateScalarPolyData(osiScalars);
+}
+
+// ------------------------
+//   CreateScalarPolyData
+// ------------------------
+// Wraps the scalars (reference is taken over) in a cvPolyData using the
+// surface mesh structure if given, else the points of the first step.
+
+cvPolyData* cvCalculateWallShearStress::CreateScalarPolyData(vtkFloatingPointArrayType *scalars) {
+
+    vtkPolyData* pd = vtkPolyData::New();
+    if (surfaceMesh_ == NULL) {
+      pd->SetPoints(accumPoints_);
+    } else {
+      pd->CopyStructure(surfaceMesh_);
+    }
+    pd->GetPointData()->SetScalars(scalars);
+    scalars->Delete();
+    cvPolyData* reposobj = new cvPolyData(pd);
+    pd->Delete();
+    return reposobj;
+}
@@ -62,8 +62,17 @@ class SV_EXPORT_POST cvCalculateWallShearStress {
 
     cvPolyData* CalcAvgPointData(int numPds, cvPolyData **inputPds);
 
+    // streaming accumulation, one time step at a time
+    int ResetAccumulation();
+    int AccumulateWallShear(cvPolyData *shearPd);
+    int GetNumberOfAccumulatedSteps() {return accumNumSteps_;}
+    cvPolyData* GetAccumulatedWallShearMean();
+    cvPolyData* GetAccumulatedWallShearPulse();
+    cvPolyData* GetAccumulatedOSI();
+
   protected:
 
+    cvPolyData* CreateScalarPolyData(vtkFloatingPointArrayType *scalars);
 
   private:
 
@@ -72,6 +81,14 @@ class SV_EXPORT_POST cvCalculateWallShearStress {
     vtkPolyData* tractions_;
     vtkFloatingPointArrayType* wallshear_;
 
+    // running sums of the shear vectors (3 per point) and of their
+    // magnitudes, the points of the first step are kept for output
+    int accumNumPts_;
+    int accumNumSteps_;
+    double* accumShear_;
+    double* accumShearMag_;
+    vtkPoints* accumPoints_;
+
 };
 
 #endif
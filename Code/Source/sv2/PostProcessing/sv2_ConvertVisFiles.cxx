@@ -42,6 +42,207 @@
 
 #include "sv2_ConvertVisFiles.h"
 
+#include "vtkSMPTools.h"
+
+// size of each gzread into the input buffer
+#define VISFILE_READ_BLOCK (16*1024*1024)
+// data sections are split into chunks of about this many bytes which
+// are parsed concurrently
+#define VISFILE_PARSE_CHUNK (1024*1024)
+
+// ------------------
+// cvVisParseDouble
+// ------------------
+// Parses one number starting at p, skipping leading blanks but not
+// newlines.  Numbers with at most 19 significant digits and a decimal
+// exponent within [-22,22] are converted exactly with a single multiply
+// or divide (the mantissa is below 2^53 in that case for typical vis
+// output); anything else goes through strtod.  Returns the position
+// after the number, or NULL if there is no number before the end of
+// the line or it is not followed by a blank or newline.  Lines it
+// rejects are rescanned by cvVisScanLine.
+
+static const double cvVisPow10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const char* cvVisParseDouble(const char *p, const char *end, double *value) {
+
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    if (p >= end || *p == '\n') {
+        return NULL;
+    }
+
+    const char *start = p;
+    int negative = 0;
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+
+    unsigned long long mantissa = 0;
+    int numDigits = 0;
+    int exponent = 0;
+    int haveDigits = 0;
+    int fastPath = 1;
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        haveDigits = 1;
+        if (numDigits < 19) {
+            mantissa = 10*mantissa + (*p - '0');
+            if (mantissa != 0) numDigits++;
+        } else {
+            fastPath = 0;
+        }
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            haveDigits = 1;
+            if (numDigits < 19) {
+                mantissa = 10*mantissa + (*p - '0');
+                if (mantissa != 0) numDigits++;
+                exponent--;
+            } else {
+                fastPath = 0;
+            }
+            p++;
+        }
+    }
+    if (haveDigits && p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p+1;
+        int expNegative = 0;
+        if (q < end && (*q == '-' || *q == '+')) {
+            expNegative = (*q == '-');
+            q++;
+        }
+        if (q < end && *q >= '0' && *q <= '9') {
+            int e = 0;
+            while (q < end && *q >= '0' && *q <= '9') {
+                if (e < 10000) e = 10*e + (*q - '0');
+                q++;
+            }
+            exponent += expNegative ? -e : e;
+            p = q;
+        }
+    }
+
+    if (haveDigits && fastPath && mantissa < (1ULL << 53) &&
+        exponent >= -22 && exponent <= 22) {
+        double d = (double)mantissa;
+        d = (exponent < 0) ? d/cvVisPow10[-exponent] : d*cvVisPow10[exponent];
+        *value = negative ? -d : d;
+    } else {
+        // inf, nan, long mantissas and large exponents
+        char *stop = NULL;
+        *value = strtod(start,&stop);
+        if (stop == start) {
+            return NULL;
+        }
+        p = stop;
+    }
+
+    // stricter than sscanf, text glued to the number ("1.0D+00", "1e")
+    // is left to cvVisScanLine
+    if (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+        return NULL;
+    }
+    return p;
+}
+
+// ---------------
+// cvVisScanLine
+// ---------------
+// Scans a line with sscanf the way the line by line reader did, for
+// the lines cvVisParseDouble rejects.  Whatever sscanf accepted before
+// (e.g. the "1.0" of a Fortran "1.0D+00" as the last value on a line)
+// is read the same way.  Returns 0 if fewer than numPerLine values are
+// found.
+
+static int cvVisScanLine(const char *p, const char *end, int numPerLine, double *values) {
+
+    char line[MAXVISLINELENGTH];
+    size_t len = 0;
+    while (p+len < end && p[len] != '\n' && len < MAXVISLINELENGTH-1) len++;
+    memcpy(line,p,len);
+    line[len] = '\0';
+
+    // same as "%lf %lf ..." with numPerLine conversions
+    const char *s = line;
+    for (int k = 0; k < numPerLine; k++) {
+        int n = 0;
+        if (sscanf(s," %lf%n",&values[k],&n) != 1) {
+            return 0;
+        }
+        s += n;
+    }
+    return 1;
+}
+
+// -----------------------
+// cvVisCountLinesFunctor
+// -----------------------
+
+struct cvVisCountLinesFunctor {
+    const char *buf;
+    const size_t *chunkStart;
+    size_t *chunkLines;
+
+    void operator()(vtkIdType begin, vtkIdType end) {
+        for (vtkIdType c = begin; c < end; c++) {
+            size_t count = 0;
+            for (size_t i = chunkStart[c]; i < chunkStart[c+1]; i++) {
+                if (buf[i] == '\n') count++;
+            }
+            chunkLines[c] = count;
+        }
+    }
+};
+
+// -----------------------
+// cvVisParseLinesFunctor
+// -----------------------
+// Each chunk starts at the beginning of a line and ends just after a
+// newline, so chunks are parsed independently into their own slice of
+// the output.
+
+struct cvVisParseLinesFunctor {
+    const char *buf;
+    const size_t *chunkStart;
+    const size_t *chunkLines;
+    int numPerLine;
+    double *values;
+    size_t *badLine;
+
+    void operator()(vtkIdType begin, vtkIdType end) {
+        for (vtkIdType c = begin; c < end; c++) {
+            const char *p = buf + chunkStart[c];
+            const char *stop = buf + chunkStart[c+1];
+            double *out = values + chunkLines[c]*numPerLine;
+            badLine[c] = (size_t)-1;
+            while (p < stop) {
+                const char *lineStart = p;
+                for (int k = 0; k < numPerLine && p != NULL; k++) {
+                    p = cvVisParseDouble(p,stop,&out[k]);
+                }
+                if (p == NULL) {
+                    if (!cvVisScanLine(lineStart,stop,numPerLine,out)) {
+                        badLine[c] = lineStart - buf;
+                        break;
+                    }
+                    p = lineStart;
+                }
+                // extra values on the line are ignored, as with sscanf
+                while (p < stop && *p != '\n') p++;
+                p++;
+                out += numPerLine;
+            }
+        }
+    }
+};
+
 // -------------------
 // cvConvertVisFiles
 // -------------------
@@ -75,6 +276,13 @@ cvConvertVisFiles::cvConvertVisFiles() {
     currentLine_[0]  = '\0';
     meshpts_ = NULL;
     grid_ = NULL;
+    inbuf_ = NULL;
+    inbufSize_ = 0;
+    inbufLen_ = 0;
+    inbufPos_ = 0;
+    inbufEOF_ = 0;
+    dataValues_ = NULL;
+    dataValuesSize_ = 0;
 }
 
 
@@ -128,6 +336,13 @@ cvConvertVisFiles::~cvConvertVisFiles() {
     if (numTractionNodes_ != 0) {
         delete [] tractionNodes_;
     }
+
+    if (inbuf_ != NULL) {
+        delete [] inbuf_;
+    }
+    if (dataValues_ != NULL) {
+        delete [] dataValues_;
+    }
 }
 
 
@@ -139,6 +354,13 @@ int cvConvertVisFiles::openInputFile(char* filename, gzFile* fp) {
       fprintf(stderr,"Error: Could not open input file %s.\n",filename);
       return SV_ERROR;
     }
+    // start with an empty input buffer
+    inbufLen_ = 0;
+    inbufPos_ = 0;
+    inbufEOF_ = 0;
+    if (inbuf_ != NULL) {
+      inbuf_[0] = '\0';
+    }
     return SV_OK;
 }
 
@@ -187,53 +409,37 @@ int cvConvertVisFiles::ReadVisMesh(char *infilename) {
     }
 
     vtkPoints* meshpts_ = vtkPoints::New();
-    meshpts_->Allocate(numNodes+2,10000);
-    meshpts_->SetNumberOfPoints(numNodes);
-    meshpts_->Initialize();
-
-    double dpt[3];
-    dpt[0] = 0;dpt[1] = 0;dpt[2] = 0;
-    vtkFloatingPointType  fpt[3];
-    int nodeid = 0;
 
-    while (0 == 0) {
-      int flag = readNextLineFromFile(meshfp_);
-      if (flag == NEXTLINE_EOF) {
-          closeInputFile(meshfp_);
-          meshpts_->Delete();
-          return SV_ERROR;
-      }
-      if (strstr(currentLine_,"end node coordinates") != NULL) {
-          break;
-      }
-      if (strstr(currentLine_,"end nodal coordinates") != NULL) {
-          break;
-      }
-      if (sscanf(currentLine_,"%i %lf %lf %lf",&nodeid,&dpt[0],&dpt[1],&dpt[2]) != 4) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(meshfp_);
-          meshpts_->Delete();
-          return SV_ERROR;
-      }
-
-      // convert to vtkFloatingPointTypes for vtk
-      fpt[0] = dpt[0]; fpt[1] = dpt[1]; fpt[2] = dpt[2];
+    int i = 0;
+    int numLines = 0;
+    if (readDataSection(meshfp_,4,"end node coordinates","end nodal coordinates",&numLines) == SV_ERROR) {
+        closeInputFile(meshfp_);
+        meshpts_->Delete();
+        return SV_ERROR;
+    }
 
-      // in the tcl scripts, we keep track of a mapping between node ids
-      // and their location in the vtk pts list.  Here we just assume
-      // the pts are numbered from 1 to numNodes, and return an error
-      // otherwise.
-      //set map($node) $numNodes
+    // in the tcl scripts, we keep track of a mapping between node ids
+    // and their location in the vtk pts list.  Here we just assume
+    // the pts are numbered from 1 to numNodes, and return an error
+    // otherwise.
+    //set map($node) $numNodes
 
+    int maxNodeId = 0;
+    for (i = 0; i < numLines; i++) {
+      int nodeid = (int)dataValues_[4*i];
       if (nodeid < 1 || nodeid > numNodes) {
           fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",nodeid,numNodes);
           closeInputFile(meshfp_);
           meshpts_->Delete();
           return SV_ERROR;
       }
-      //fprintf(stdout,"insert pt: %i value: %f %f %f\n",nodeid-1,fpt[0],fpt[1],fpt[2]);
-      meshpts_->InsertPoint(nodeid-1,fpt);
+      if (nodeid > maxNodeId) maxNodeId = nodeid;
+    }
 
+    meshpts_->SetNumberOfPoints(maxNodeId);
+    for (i = 0; i < numLines; i++) {
+      int nodeid = (int)dataValues_[4*i];
+      meshpts_->SetPoint(nodeid-1,&dataValues_[4*i+1]);
     }
 
     fprintf(stdout,"Done reading %i nodes.\n",meshpts_->GetNumberOfPoints());
@@ -286,101 +492,64 @@ int cvConvertVisFiles::ReadVisMesh(char *infilename) {
 
     // create the unstructured grid object
     grid_ = vtkUnstructuredGrid::New();
-    grid_->Allocate(numElements+2,1000);
     grid_->SetPoints(meshpts_);
 
-    vtkIdList* ptids = vtkIdList::New();
-    ptids->Allocate(10,10);
-    ptids->Initialize();
-    ptids->SetNumberOfIds(10);
-
-    int conn[10];
-    conn[0] = 0;conn[1] = 0;conn[2] = 0;conn[3] = 0;
-    conn[4] = 0;conn[5] = 0;conn[6] = 0;conn[7] = 0;
-    int elementid = 0;
-    int currnum = 0;
-
-    while (0 == 0) {
+    int cellType = VTK_TETRA;
+    if (nodesPerElement == 4) {
+      cellType = VTK_TETRA;
+    } else if (nodesPerElement == 8) {
+      cellType = VTK_HEXAHEDRON;
+    } else {
+      fprintf(stderr,"ERROR: invalid nodes per element (%i).\n",nodesPerElement);
+      closeInputFile(meshfp_);
+      meshpts_->Delete();
+      grid_->Delete();
+      return SV_ERROR;
+    }
 
-      int flag = readNextLineFromFile(meshfp_);
-      if (flag == NEXTLINE_EOF) {
-          closeInputFile(meshfp_);
-          meshpts_->Delete();
-          ptids->Delete();
-          grid_->Delete();
-          return SV_ERROR;
-      }
-      if (strstr(currentLine_,"end connectivity") != NULL) {
-          break;
-      }
+    int numPerLine = nodesPerElement+1;
+    if (readDataSection(meshfp_,numPerLine,"end connectivity",NULL,&numLines) == SV_ERROR) {
+      closeInputFile(meshfp_);
+      meshpts_->Delete();
+      grid_->Delete();
+      return SV_ERROR;
+    }
 
-      if (nodesPerElement == 4) {
-        if (sscanf(currentLine_,"%i %i %i %i %i",&elementid,
-                &conn[0],&conn[1],&conn[2],&conn[3]) != 5) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(meshfp_);
-          meshpts_->Delete();
-          ptids->Delete();
-          grid_->Delete();
-          return SV_ERROR;
-        }
-        ptids->SetNumberOfIds(4);
-        ptids->SetId(0,conn[0]-1);ptids->SetId(1,conn[1]-1);
-        ptids->SetId(2,conn[2]-1);ptids->SetId(3,conn[3]-1);
-      } else if (nodesPerElement == 8) {
-        if (sscanf(currentLine_,"%i %i %i %i %i %i %i %i %i",&elementid,
-                &conn[0],&conn[1],&conn[2],&conn[3],
-                &conn[4],&conn[5],&conn[6],&conn[7]) != 9) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(meshfp_);
-          meshpts_->Delete();
-          ptids->Delete();
-          grid_->Delete();
-          return SV_ERROR;
-        }
-        ptids->SetNumberOfIds(8);
-        ptids->SetId(0,conn[0]-1);ptids->SetId(1,conn[1]-1);
-        ptids->SetId(2,conn[2]-1);ptids->SetId(3,conn[3]-1);
-        ptids->SetId(4,conn[4]-1);ptids->SetId(5,conn[5]-1);
-        ptids->SetId(6,conn[6]-1);ptids->SetId(7,conn[7]-1);
-      } else {
-        fprintf(stderr,"ERROR: invalid nodes per element (%i).\n",nodesPerElement);
-        closeInputFile(meshfp_);
-        meshpts_->Delete();
-        ptids->Delete();
-        grid_->Delete();
-        return SV_ERROR;
-      }
+    // cells are stored in file order, fill the connectivity in place
+    vtkIdTypeArray* cellIds = vtkIdTypeArray::New();
+    cellIds->SetNumberOfValues((vtkIdType)numLines*numPerLine);
+    vtkIdType* ids = cellIds->GetPointer(0);
 
+    int renumbered = 0;
+    for (i = 0; i < numLines; i++) {
+      double* line = &dataValues_[(size_t)numPerLine*i];
+      int elementid = (int)line[0];
       if (elementid < 1 || elementid > numElements) {
-          fprintf(stderr,"ERROR:  element id (%i) out of allowable range [1,%i].\n",nodeid,numElements);
+          fprintf(stderr,"ERROR:  element id (%i) out of allowable range [1,%i].\n",elementid,numElements);
           closeInputFile(meshfp_);
           meshpts_->Delete();
-          ptids->Delete();
+          cellIds->Delete();
           grid_->Delete();
           return SV_ERROR;
       }
-
-      if ((elementid-1) != currnum) {
-          fprintf(stderr,"\n\nWARNING: Elements are being renumbered!!!\n\n");
+      if ((elementid-1) != i) {
+          renumbered = 1;
       }
-      if (nodesPerElement == 4) {
-        grid_->InsertNextCell(VTK_TETRA,ptids);
-      } else if (nodesPerElement == 8) {
-        grid_->InsertNextCell(VTK_HEXAHEDRON,ptids);
-      } else {
-        closeInputFile(meshfp_);
-        meshpts_->Delete();
-        ptids->Delete();
-        grid_->Delete();
-        return SV_ERROR;
+      ids[(size_t)numPerLine*i] = nodesPerElement;
+      for (int j = 1; j < numPerLine; j++) {
+          ids[(size_t)numPerLine*i+j] = (vtkIdType)line[j] - 1;
       }
+    }
 
-      currnum++;
-
+    if (renumbered) {
+        fprintf(stderr,"\n\nWARNING: Elements are being renumbered!!!\n\n");
     }
 
-    ptids->Delete();
+    vtkCellArray* cells = vtkCellArray::New();
+    cells->SetCells(numLines,cellIds);
+    grid_->SetCells(cellType,cells);
+    cells->Delete();
+    cellIds->Delete();
 
     fprintf(stdout,"Done reading %i elements.\n",numElements);
 
@@ -399,21 +568,201 @@ int cvConvertVisFiles::ReadVisMesh(char *infilename) {
 
 }
 
+int cvConvertVisFiles::fillInputBuffer(gzFile fp) {
+
+    if (inbufEOF_) {
+        return 0;
+    }
+
+    // drop what has already been consumed
+    if (inbufPos_ > 0) {
+        memmove(inbuf_,inbuf_+inbufPos_,inbufLen_-inbufPos_);
+        inbufLen_ -= inbufPos_;
+        inbufPos_ = 0;
+    }
+
+    // grow so a whole data section can be held at once
+    if (inbufLen_ + VISFILE_READ_BLOCK + 1 > inbufSize_) {
+        size_t newSize = 2*inbufSize_;
+        if (newSize < inbufLen_ + VISFILE_READ_BLOCK + 1) {
+            newSize = inbufLen_ + VISFILE_READ_BLOCK + 1;
+        }
+        char *newbuf = new char[newSize];
+        if (inbuf_ != NULL) {
+            memcpy(newbuf,inbuf_,inbufLen_);
+            delete [] inbuf_;
+        }
+        inbuf_ = newbuf;
+        inbufSize_ = newSize;
+    }
+
+    int nread = gzread(fp,inbuf_+inbufLen_,VISFILE_READ_BLOCK);
+    if (nread <= 0) {
+        inbufEOF_ = 1;
+        nread = 0;
+    }
+    inbufLen_ += nread;
+    inbuf_[inbufLen_] = '\0';
+
+    return nread;
+
+}
+
 int cvConvertVisFiles::readNextLineFromFile(gzFile fp) {
 
-#ifdef SV_USE_ZLIB
-    if (gzgets(fp,currentLine_,MAXVISLINELENGTH) ==Z_NULL) {
-#else
-    if (fgets(currentLine_,MAXVISLINELENGTH,fp) == NULL) {
-#endif
+    // same contract as gzgets, at most MAXVISLINELENGTH-1 chars
+    // including the newline
+    char *newline = NULL;
+    while (0 == 0) {
+        if (inbufPos_ < inbufLen_) {
+            newline = (char*)memchr(inbuf_+inbufPos_,'\n',inbufLen_-inbufPos_);
+        }
+        if (newline != NULL || inbufEOF_ ||
+            inbufLen_ - inbufPos_ >= MAXVISLINELENGTH-1) {
+            break;
+        }
+        fillInputBuffer(fp);
+    }
+
+    size_t len = (newline != NULL) ? (newline-(inbuf_+inbufPos_))+1 : inbufLen_-inbufPos_;
+    if (len == 0) {
         //fprintf(stderr,"ERROR:  readNextLine failed.\n");
         return SV_ERROR;
     }
+    if (len > MAXVISLINELENGTH-1) {
+        len = MAXVISLINELENGTH-1;
+    }
+
+    memcpy(currentLine_,inbuf_+inbufPos_,len);
+    currentLine_[len] = '\0';
+    inbufPos_ += len;
 
     return SV_OK;
 
 }
 
+// ---------------
+// readDataSection
+// ---------------
+// Reads everything from the current position up to the line containing
+// endTag (or altEndTag) and parses numPerLine values from every line
+// into dataValues_.  The whole section is buffered and then parsed in
+// chunks concurrently, the end tag line is consumed like
+// readNextLineFromFile would.
+
+int cvConvertVisFiles::readDataSection(gzFile fp, int numPerLine, const char *endTag,
+                                       const char *altEndTag, int *numLines) {
+
+    size_t i;
+    *numLines = 0;
+
+    // make sure the whole section is in the buffer
+    size_t searchFrom = inbufPos_;
+    char *tag = NULL;
+    while (0 == 0) {
+        if (inbuf_ != NULL) {
+            tag = strstr(inbuf_+searchFrom,endTag);
+            if (altEndTag != NULL) {
+                char *alt = strstr(inbuf_+searchFrom,altEndTag);
+                if (alt != NULL && (tag == NULL || alt < tag)) tag = alt;
+            }
+        }
+        if (tag != NULL) {
+            break;
+        }
+        if (inbufEOF_) {
+            fprintf(stderr,"ERROR: could not find (%s).\n",endTag);
+            return SV_ERROR;
+        }
+        // positions shift when the buffer is compacted
+        size_t consumed = (inbuf_ != NULL) ? inbufPos_ : 0;
+        size_t searched = (inbuf_ != NULL) ? inbufLen_ : 0;
+        fillInputBuffer(fp);
+        searchFrom = searched - consumed;
+        searchFrom = (searchFrom > 64) ? searchFrom - 64 : 0;
+    }
+
+    // the data ends where the end tag line starts
+    size_t dataStart = inbufPos_;
+    size_t dataEnd = tag - inbuf_;
+    while (dataEnd > dataStart && inbuf_[dataEnd-1] != '\n') {
+        dataEnd--;
+    }
+
+    // split into chunks on line boundaries
+    int numChunks = (dataEnd - dataStart)/VISFILE_PARSE_CHUNK + 1;
+    size_t *chunkStart = new size_t[numChunks+1];
+    chunkStart[0] = dataStart;
+    int c = 1;
+    for (c = 1; c < numChunks; c++) {
+        size_t pos = dataStart + c*(size_t)VISFILE_PARSE_CHUNK;
+        if (pos < chunkStart[c-1]) pos = chunkStart[c-1];
+        while (pos < dataEnd && inbuf_[pos-1] != '\n') pos++;
+        chunkStart[c] = pos;
+    }
+    chunkStart[numChunks] = dataEnd;
+
+    size_t *chunkLines = new size_t[numChunks+1];
+    size_t *badLine = new size_t[numChunks];
+
+    cvVisCountLinesFunctor counter;
+    counter.buf = inbuf_;
+    counter.chunkStart = chunkStart;
+    counter.chunkLines = chunkLines;
+    vtkSMPTools::For(0,numChunks,1,counter);
+
+    // turn the counts into offsets
+    size_t totalLines = 0;
+    for (c = 0; c < numChunks; c++) {
+        size_t count = chunkLines[c];
+        chunkLines[c] = totalLines;
+        totalLines += count;
+    }
+    chunkLines[numChunks] = totalLines;
+
+    if (totalLines*numPerLine > dataValuesSize_) {
+        if (dataValues_ != NULL) {
+            delete [] dataValues_;
+        }
+        dataValuesSize_ = totalLines*numPerLine;
+        dataValues_ = new double[dataValuesSize_];
+    }
+
+    cvVisParseLinesFunctor parser;
+    parser.buf = inbuf_;
+    parser.chunkStart = chunkStart;
+    parser.chunkLines = chunkLines;
+    parser.numPerLine = numPerLine;
+    parser.values = dataValues_;
+    parser.badLine = badLine;
+    vtkSMPTools::For(0,numChunks,1,parser);
+
+    int rtn = SV_OK;
+    for (c = 0; c < numChunks; c++) {
+        if (badLine[c] != (size_t)-1) {
+            size_t len = strcspn(inbuf_+badLine[c],"\n");
+            if (len > MAXVISLINELENGTH-1) len = MAXVISLINELENGTH-1;
+            memcpy(currentLine_,inbuf_+badLine[c],len);
+            currentLine_[len] = '\0';
+            fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
+            rtn = SV_ERROR;
+            break;
+        }
+    }
+
+    delete [] chunkStart;
+    delete [] chunkLines;
+    delete [] badLine;
+
+    // consume the data and the end tag line
+    inbufPos_ = dataEnd;
+    readNextLineFromFile(fp);
+
+    *numLines = totalLines;
+    return rtn;
+
+}
+
 int cvConvertVisFiles::findStringInFile(char *findme, gzFile fp) {
 
     while (readNextLineFromFile(fp) == SV_OK) {
@@ -522,46 +871,24 @@ int cvConvertVisFiles::readPressureFromFile() {
         return SV_ERROR;
     }
 
-    vtkFloatingPointArrayType* scalars = vtkFloatingPointArrayType::New();
-    scalars->SetNumberOfComponents(1);
-    scalars->Allocate(numNodes,10000);
-    scalars->Initialize();
-
-    double d = 0;
-    vtkFloatingPointType f = 0;
-    int nodeid = 1;
-
-    while (0 == 0) {
-      int flag = readNextLineFromFile(resfp_);
-      if (flag == NEXTLINE_EOF) {
-          closeInputFile(resfp_);
-          scalars->Delete();
-          return SV_ERROR;
-      }
-      if (strstr(currentLine_,"end data") != NULL) {
-          break;
-      }
-      if (sscanf(currentLine_,"%lf",&d) != 1) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(resfp_);
-          scalars->Delete();
-          return SV_ERROR;
-      }
-
-      // convert to vtkFloatingPointTypes for vtk
-      f = d;
+    int numLines = 0;
+    if (readDataSection(resfp_,1,"end data",NULL,&numLines) == SV_ERROR) {
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
 
-      if (nodeid < 1 || nodeid > numNodes) {
-          fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",nodeid,numNodes);
-          closeInputFile(resfp_);
-          scalars->Delete();
-          return SV_ERROR;
-      }
+    if (numLines > numNodes) {
+        fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",numNodes+1,numNodes);
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
 
-      scalars->InsertNextTuple1(f);
-      nodeid++;
+    vtkFloatingPointArrayType* scalars = vtkFloatingPointArrayType::New();
+    scalars->SetNumberOfComponents(1);
+    scalars->SetNumberOfTuples(numLines);
+    memcpy(scalars->GetPointer(0),dataValues_,numLines*sizeof(double));
 
-    }
+    int nodeid = numLines+1;
 
     if (nodeid != (numNodes+1)) {
         fprintf(stderr,"ERROR:  not enough pressure data (%i != %i)\n",nodeid,numNodes);
@@ -595,48 +922,24 @@ int cvConvertVisFiles::readVelocityFromFile() {
         return SV_ERROR;
     }
 
-    vtkFloatingPointArrayType* vectors = vtkFloatingPointArrayType::New();
-    vectors->SetNumberOfComponents(3);
-    vectors->Allocate(numNodes,10000);
-    vectors->Initialize();
-
-    double d[3];
-    vtkFloatingPointType f[3];
-    d[0] = 0; d[1] = 0; d[2] = 0;
-    f[0] = 0; f[1] = 0; f[2] = 0;
-    int nodeid = 1;
-
-    while (0 == 0) {
-      int flag = readNextLineFromFile(resfp_);
-      if (flag == NEXTLINE_EOF) {
-          closeInputFile(resfp_);
-          vectors->Delete();
-          return SV_ERROR;
-      }
-      if (strstr(currentLine_,"end data") != NULL) {
-          break;
-      }
-      if (sscanf(currentLine_,"%lf %lf %lf",&d[0],&d[1],&d[2]) != 3) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(resfp_);
-          vectors->Delete();
-          return SV_ERROR;
-      }
-
-      // convert to vtkFloatingPointTypes for vtk
-      f[0] = d[0];f[1] = d[1];f[2] = d[2];
+    int numLines = 0;
+    if (readDataSection(resfp_,3,"end data",NULL,&numLines) == SV_ERROR) {
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
 
-      if (nodeid < 1 || nodeid > numNodes) {
-          fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",nodeid,numNodes);
-          closeInputFile(resfp_);
-          vectors->Delete();
-          return SV_ERROR;
-      }
+    if (numLines > numNodes) {
+        fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",numNodes+1,numNodes);
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
 
-      vectors->InsertNextTuple3(f[0],f[1],f[2]);
-      nodeid++;
+    vtkFloatingPointArrayType* vectors = vtkFloatingPointArrayType::New();
+    vectors->SetNumberOfComponents(3);
+    vectors->SetNumberOfTuples(numLines);
+    memcpy(vectors->GetPointer(0),dataValues_,3*numLines*sizeof(double));
 
-    }
+    int nodeid = numLines+1;
 
     if (nodeid != (numNodes+1)) {
         fprintf(stderr,"ERROR:  not enough velocity data (%i != %i)\n",nodeid,numNodes);
@@ -678,16 +981,16 @@ int cvConvertVisFiles::readTractionFromFile() {
         return SV_ERROR;
     }
 
+    int numLines = 0;
+    if (readDataSection(resfp_,3,"end data",NULL,&numLines) == SV_ERROR) {
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
+
     vtkFloatingPointArrayType* traction = vtkFloatingPointArrayType::New();
     traction->SetNumberOfComponents(3);
-    traction->Allocate(numNodes,10000);
     traction->SetNumberOfTuples(numNodes);
-
-    double d[3];
-    vtkFloatingPointType f[3];
-    d[0] = 0; d[1] = 0; d[2] = 0;
-    f[0] = 0; f[1] = 0; f[2] = 0;
-    int nodeid = 1;
+    double* t = traction->GetPointer(0);
 
     if (numTractionNodes_ > 0) {
 		traction->FillComponent(0,0.0);
@@ -695,36 +998,20 @@ int cvConvertVisFiles::readTractionFromFile() {
 		traction->FillComponent(2,0.0);
     }
 
-    while (0 == 0) {
-      int flag = readNextLineFromFile(resfp_);
-      if (flag == NEXTLINE_EOF) {
-          closeInputFile(resfp_);
-          traction->Delete();
-          return SV_ERROR;
-      }
-      if (strstr(currentLine_,"end data") != NULL) {
-          break;
-      }
-      if (sscanf(currentLine_,"%lf %lf %lf",&d[0],&d[1],&d[2]) != 3) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(resfp_);
-          traction->Delete();
-          return SV_ERROR;
-      }
+    int nodeid = 1;
 
-      // convert to vtkFloatingPointTypes for vtk
-      f[0] = d[0];f[1] = d[1];f[2] = d[2];
+    for (nodeid = 1; nodeid <= numLines; nodeid++) {
 
-      int realnodeid = nodeid;
+      realnodeid = nodeid;
 
       if (numTractionNodes_) {
-          realnodeid = tractionNodes_[nodeid-1];
           if (nodeid > numTractionNodes_) {
-            fprintf(stderr,"ERROR:  node id (%i) out of traction nodes range (%i).",realnodeid,numTractionNodes_);
+            fprintf(stderr,"ERROR:  node id (%i) out of traction nodes range (%i).",nodeid,numTractionNodes_);
             closeInputFile(resfp_);
             traction->Delete();
             return SV_ERROR;
           }
+          realnodeid = tractionNodes_[nodeid-1];
       }
 
       if (realnodeid < 1 || realnodeid > numNodes) {
@@ -734,11 +1021,11 @@ int cvConvertVisFiles::readTractionFromFile() {
           return SV_ERROR;
       }
 
-      //fprintf(stdout,"set node %i\n",realnodeid);
       // remember that in vtk data structures node 1 is actually in slot 0
-      traction->SetTuple3((vtkIdType)(realnodeid-1),f[0],f[1],f[2]);
-
-      nodeid++;
+      double* f = &dataValues_[3*(nodeid-1)];
+      t[3*(realnodeid-1)]   = f[0];
+      t[3*(realnodeid-1)+1] = f[1];
+      t[3*(realnodeid-1)+2] = f[2];
 
     }
 
@@ -788,16 +1075,22 @@ int cvConvertVisFiles::readDisplacementFromFile() {
         return SV_ERROR;
     }
 
+    int numLines = 0;
+    if (readDataSection(resfp_,3,"end data",NULL,&numLines) == SV_ERROR) {
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
+
+    if (numLines > numNodes) {
+        fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",numNodes+1,numNodes);
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
+
     vtkFloatingPointArrayType* displacement = vtkFloatingPointArrayType::New();
     displacement->SetNumberOfComponents(3);
-    displacement->Allocate(numNodes,10000);
     displacement->SetNumberOfTuples(numNodes);
-
-    double d[3];
-    vtkFloatingPointType f[3];
-    d[0] = 0; d[1] = 0; d[2] = 0;
-    f[0] = 0; f[1] = 0; f[2] = 0;
-    int nodeid = 1;
+    double* t = displacement->GetPointer(0);
 
     int* keepme = NULL;
     if (numTractionNodes_ > 0) {
@@ -814,53 +1107,20 @@ int cvConvertVisFiles::readDisplacementFromFile() {
 
     }
 
-    while (0 == 0) {
-      int flag = readNextLineFromFile(resfp_);
-      if (flag == NEXTLINE_EOF) {
-          closeInputFile(resfp_);
-          displacement->Delete();
-          if (keepme != NULL) delete [] keepme;
-          return SV_ERROR;
-      }
-      if (strstr(currentLine_,"end data") != NULL) {
-          break;
-      }
-      if (sscanf(currentLine_,"%lf %lf %lf",&d[0],&d[1],&d[2]) != 3) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(resfp_);
-          displacement->Delete();
-          if (keepme != NULL) delete [] keepme;
-          return SV_ERROR;
-      }
-
-      // convert to vtkFloatingPointTypes for vtk
-      f[0] = d[0];f[1] = d[1];f[2] = d[2];
-
-      int realnodeid = nodeid;
-
-      if (realnodeid < 1 || realnodeid > numNodes) {
-          fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",realnodeid,numNodes);
-          closeInputFile(resfp_);
-          displacement->Delete();
-          if (keepme != NULL) delete [] keepme;
-          return SV_ERROR;
-      }
-
-      //fprintf(stdout,"set node %i\n",realnodeid);
-      // remember that in vtk data structures node 1 is actually in slot 0
-      if (keepme == NULL) {
-        displacement->SetTuple3((vtkIdType)(realnodeid-1),f[0],f[1],f[2]);
-      } else {
-          if (keepme[realnodeid-1] == 0) {
-            displacement->SetTuple3((vtkIdType)(realnodeid-1),0,0,0);
-          } else {
-            displacement->SetTuple3((vtkIdType)(realnodeid-1),f[0],f[1],f[2]);
-          }
+    // remember that in vtk data structures node 1 is actually in slot 0
+    for (i = 0; i < 3*numLines; i++) {
+      t[i] = dataValues_[i];
+    }
+    if (keepme != NULL) {
+      for (i = 0; i < numLines; i++) {
+        if (keepme[i] == 0) {
+          t[3*i] = 0; t[3*i+1] = 0; t[3*i+2] = 0;
+        }
       }
-      nodeid++;
-
     }
 
+    int nodeid = numLines+1;
+
     if (nodeid != (numNodes+1)) {
         fprintf(stderr,"ERROR:  not enough displacement data (%i != %i)\n",nodeid,numNodes);
         displacement->Delete();
@@ -906,16 +1166,22 @@ int cvConvertVisFiles::readWSSFromFile() {
         return SV_ERROR;
     }
 
+    int numLines = 0;
+    if (readDataSection(resfp_,3,"end data",NULL,&numLines) == SV_ERROR) {
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
+
+    if (numLines > numNodes) {
+        fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",numNodes+1,numNodes);
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
+
     vtkFloatingPointArrayType* wss = vtkFloatingPointArrayType::New();
     wss->SetNumberOfComponents(3);
-    wss->Allocate(numNodes,10000);
     wss->SetNumberOfTuples(numNodes);
-
-    double d[3];
-    vtkFloatingPointType f[3];
-    d[0] = 0; d[1] = 0; d[2] = 0;
-    f[0] = 0; f[1] = 0; f[2] = 0;
-    int nodeid = 1;
+    double* t = wss->GetPointer(0);
 
     int* keepme = NULL;
     if (numTractionNodes_ > 0) {
@@ -932,53 +1198,20 @@ int cvConvertVisFiles::readWSSFromFile() {
 
     }
 
-    while (0 == 0) {
-      int flag = readNextLineFromFile(resfp_);
-      if (flag == NEXTLINE_EOF) {
-          closeInputFile(resfp_);
-          wss->Delete();
-          if (keepme != NULL) delete [] keepme;
-          return SV_ERROR;
-      }
-      if (strstr(currentLine_,"end data") != NULL) {
-          break;
-      }
-      if (sscanf(currentLine_,"%lf %lf %lf",&d[0],&d[1],&d[2]) != 3) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(resfp_);
-          wss->Delete();
-          if (keepme != NULL) delete [] keepme;
-          return SV_ERROR;
-      }
-
-      // convert to vtkFloatingPointTypes for vtk
-      f[0] = d[0];f[1] = d[1];f[2] = d[2];
-
-      int realnodeid = nodeid;
-
-      if (realnodeid < 1 || realnodeid > numNodes) {
-          fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",realnodeid,numNodes);
-          closeInputFile(resfp_);
-          wss->Delete();
-          if (keepme != NULL) delete [] keepme;
-          return SV_ERROR;
-      }
-
-      //fprintf(stdout,"set node %i\n",realnodeid);
-      // remember that in vtk data structures node 1 is actually in slot 0
-      if (keepme == NULL) {
-        wss->SetTuple3((vtkIdType)(realnodeid-1),f[0],f[1],f[2]);
-      } else {
-          if (keepme[realnodeid-1] == 0) {
-            wss->SetTuple3((vtkIdType)(realnodeid-1),0,0,0);
-          } else {
-            wss->SetTuple3((vtkIdType)(realnodeid-1),f[0],f[1],f[2]);
-          }
+    // remember that in vtk data structures node 1 is actually in slot 0
+    for (i = 0; i < 3*numLines; i++) {
+      t[i] = dataValues_[i];
+    }
+    if (keepme != NULL) {
+      for (i = 0; i < numLines; i++) {
+        if (keepme[i] == 0) {
+          t[3*i] = 0; t[3*i+1] = 0; t[3*i+2] = 0;
+        }
       }
-      nodeid++;
-
     }
 
+    int nodeid = numLines+1;
+
     if (nodeid != (numNodes+1)) {
         fprintf(stderr,"ERROR:  not enough wss data (%i != %i)\n",nodeid,numNodes);
         wss->Delete();
@@ -1015,46 +1248,24 @@ int cvConvertVisFiles::readTransportFromFile() {
         return SV_ERROR;
     }
 
-    vtkFloatingPointArrayType* scalars = vtkFloatingPointArrayType::New();
-    scalars->SetNumberOfComponents(1);
-    scalars->Allocate(numNodes,10000);
-    scalars->Initialize();
-
-    double d = 0;
-    vtkFloatingPointType f = 0;
-    int nodeid = 1;
-
-    while (0 == 0) {
-      int flag = readNextLineFromFile(resfp_);
-      if (flag == NEXTLINE_EOF) {
-          closeInputFile(resfp_);
-          scalars->Delete();
-          return SV_ERROR;
-      }
-      if (strstr(currentLine_,"end data") != NULL) {
-          break;
-      }
-      if (sscanf(currentLine_,"%lf",&d) != 1) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(resfp_);
-          scalars->Delete();
-          return SV_ERROR;
-      }
-
-      // convert to vtkFloatingPointTypes for vtk
-      f = d;
+    int numLines = 0;
+    if (readDataSection(resfp_,1,"end data",NULL,&numLines) == SV_ERROR) {
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
 
-      if (nodeid < 1 || nodeid > numNodes) {
-          fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",nodeid,numNodes);
-          closeInputFile(resfp_);
-          scalars->Delete();
-          return SV_ERROR;
-      }
+    if (numLines > numNodes) {
+        fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",numNodes+1,numNodes);
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
 
-      scalars->InsertNextTuple1(f);
-      nodeid++;
+    vtkFloatingPointArrayType* scalars = vtkFloatingPointArrayType::New();
+    scalars->SetNumberOfComponents(1);
+    scalars->SetNumberOfTuples(numLines);
+    memcpy(scalars->GetPointer(0),dataValues_,numLines*sizeof(double));
 
-    }
+    int nodeid = numLines+1;
 
     if (nodeid != (numNodes+1)) {
         fprintf(stderr,"ERROR:  not enough transport data (%i != %i)\n",nodeid,numNodes);
@@ -1090,68 +1301,47 @@ int cvConvertVisFiles::readStressFromFile() {
         return SV_ERROR;
     }
 
-    vtkFloatingPointArrayType* tensors = vtkFloatingPointArrayType::New();
-    tensors->SetNumberOfComponents(9);
-    tensors->Allocate(numNodes,10000);
-    tensors->Initialize();
-
-    double d[6];
-    vtkFloatingPointType f[6];
-    d[0] = 0; d[1] = 0; d[2] = 0;
-    d[3] = 0; d[4] = 0; d[5] = 0;
-    f[0] = 0; f[1] = 0; f[2] = 0;
-    f[3] = 0; f[4] = 0; f[5] = 0;
-    int nodeid = 1;
-
-    while (0 == 0) {
-      int flag = readNextLineFromFile(resfp_);
-      if (flag == NEXTLINE_EOF) {
-          closeInputFile(resfp_);
-          tensors->Delete();
-          return SV_ERROR;
-      }
-      if (strstr(currentLine_,"end data") != NULL) {
-          break;
-      }
-      if (sscanf(currentLine_,"%lf %lf %lf %lf %lf %lf",
-                 &d[0],&d[1],&d[2],&d[3],&d[4],&d[5]) != 6) {
-          fprintf(stderr,"ERROR: invalid line (%s).\n",currentLine_);
-          closeInputFile(resfp_);
-          tensors->Delete();
-          return SV_ERROR;
-      }
-
-      // convert to vtkFloatingPointTypes for vtk
-      f[0] = d[0];f[1] = d[1];f[2] = d[2];
-      f[3] = d[3];f[4] = d[4];f[5] = d[5];
+    int numLines = 0;
+    if (readDataSection(resfp_,6,"end data",NULL,&numLines) == SV_ERROR) {
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
 
-      if (nodeid < 1 || nodeid > numNodes) {
-          fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",nodeid,numNodes);
-          closeInputFile(resfp_);
-          tensors->Delete();
-          return SV_ERROR;
-      }
+    if (numLines > numNodes) {
+        fprintf(stderr,"ERROR:  node id (%i) out of allowable range [1,%i].",numNodes+1,numNodes);
+        closeInputFile(resfp_);
+        return SV_ERROR;
+    }
 
-      // assume the following format of the stress results
-      // components
-      // "xx"   0
-      // "yy"   1
-      // "zz"   2
-      // "xy"   3
-      // "yz"   4
-      // "xz"   5
-      //
-      //  | xx xy xz |       | 0 3 5 |
-      //  | yx yy yz |  -->  | 3 1 4 |
-      //  | xz yz zz |       | 5 4 2 |
-      //
-      // end components
-
-      tensors->InsertNextTuple9(f[0],f[3],f[5],f[3],f[1],f[4],f[5],f[4],f[2]);
-      nodeid++;
+    vtkFloatingPointArrayType* tensors = vtkFloatingPointArrayType::New();
+    tensors->SetNumberOfComponents(9);
+    tensors->SetNumberOfTuples(numLines);
+    double* t = tensors->GetPointer(0);
+
+    // assume the following format of the stress results
+    // components
+    // "xx"   0
+    // "yy"   1
+    // "zz"   2
+    // "xy"   3
+    // "yz"   4
+    // "xz"   5
+    //
+    //  | xx xy xz |       | 0 3 5 |
+    //  | yx yy yz |  -->  | 3 1 4 |
+    //  | xz yz zz |       | 5 4 2 |
+    //
+    // end components
 
+    for (int i = 0; i < numLines; i++) {
+      double* f = &dataValues_[6*i];
+      t[9*i]   = f[0]; t[9*i+1] = f[3]; t[9*i+2] = f[5];
+      t[9*i+3] = f[3]; t[9*i+4] = f[1]; t[9*i+5] = f[4];
+      t[9*i+6] = f[5]; t[9*i+7] = f[4]; t[9*i+8] = f[2];
     }
 
+    int nodeid = numLines+1;
+
     if (nodeid != (numNodes+1)) {
         fprintf(stderr,"ERROR:  not enough tensor data (%i != %i)\n",nodeid,numNodes);
         tensors->Delete();
@@ -60,6 +60,7 @@
   #define gzeof feof
   //gzgets requires different args than fgets
   //#define gzgets fgets
+  #define gzread(p1,p2,p3) fread((p2),1,(p3),(p1))
 #endif
 
 #define NEXTLINE_EOF -1
@@ -110,6 +111,11 @@ class SV_EXPORT_POST cvConvertVisFiles {
     int findStringInFile(char *findme, gzFile fp);
     int readNextLineFromFile(gzFile fp);
 
+    // bulk parsing of a whole data section into dataValues_
+    int fillInputBuffer(gzFile fp);
+    int readDataSection(gzFile fp, int numPerLine, const char *endTag,
+                        const char *altEndTag, int *numLines);
+
   private:
 
     gzFile meshfp_;
@@ -134,6 +140,18 @@ class SV_EXPORT_POST cvConvertVisFiles {
 
     char currentLine_[MAXVISLINELENGTH];
 
+    // decompressed input, both the line reader and the bulk reader
+    // consume from here; always '\0' terminated at inbufLen_
+    char* inbuf_;
+    size_t inbufSize_;
+    size_t inbufLen_;
+    size_t inbufPos_;
+    int inbufEOF_;
+
+    // values of the last data section, numPerLine per line
+    double* dataValues_;
+    size_t dataValuesSize_;
+
     vtkPoints* meshpts_;
     vtkUnstructuredGrid* grid_;
     vtkFloatingPointArrayType* pressure_;
@@ -75,6 +75,16 @@ int Post_calcAvgPointDataCmd( ClientData clientData, Tcl_Interp *interp,
 			int argc, CONST84 char *argv[] );
 int Post_calcTKECmd( ClientData clientData, Tcl_Interp *interp,
 			int argc, CONST84 char *argv[] );
+int Post_wallShearAccumulatorCmd( ClientData clientData, Tcl_Interp *interp,
+			int argc, CONST84 char *argv[] );
+int Post_WallShearAccumulatorObjectCmd( ClientData clientData, Tcl_Interp *interp,
+			int argc, CONST84 char *argv[] );
+void DeleteWallShearAccumulator( ClientData clientData );
+int Post_tkeAccumulatorCmd( ClientData clientData, Tcl_Interp *interp,
+			int argc, CONST84 char *argv[] );
+int Post_TKEAccumulatorObjectCmd( ClientData clientData, Tcl_Interp *interp,
+			int argc, CONST84 char *argv[] );
+void DeleteTKEAccumulator( ClientData clientData );
 
 
 // -------------
@@ -99,6 +109,10 @@ int Post_Init( Tcl_Interp *interp )
 		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
   Tcl_CreateCommand( interp, "post_calcTKE", Post_calcTKECmd,
 		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
+  Tcl_CreateCommand( interp, "post_wallShearAccumulator", Post_wallShearAccumulatorCmd,
+		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
+  Tcl_CreateCommand( interp, "post_tkeAccumulator", Post_tkeAccumulatorCmd,
+		     (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL );
   return TCL_OK;
 }
 
@@ -1184,3 +1198,393 @@ int Post_calcTKECmd( ClientData clientData, Tcl_Interp *interp,
 }
 
 
+// --------------------------------
+// Post_wallShearAccumulatorCmd
+// --------------------------------
+// post_wallShearAccumulator <objName>
+//
+// Creates an object command that accumulates the time averaged wall
+// shear quantities one step at a time, so each step can be deleted
+// from the repository once it has been added:
+//
+//   <objName> Add -shearPd <pd>
+//   <objName> GetMean -result <pd> ?-surfaceMesh <pd>?
+//   <objName> GetPulse -result <pd> ?-surfaceMesh <pd>?
+//   <objName> GetOSI -result <pd> ?-surfaceMesh <pd>?
+//   <objName> GetNumberOfSteps
+//   <objName> Reset
+//
+// The object is removed with "rename <objName> {}".
+
+int Post_wallShearAccumulatorCmd( ClientData clientData, Tcl_Interp *interp,
+		  int argc, CONST84 char *argv[] )
+{
+  if ( argc != 2 ) {
+    Tcl_AppendResult( interp, "usage: ", argv[0], " <objName>",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  Tcl_CmdInfo info;
+  if ( Tcl_GetCommandInfo( interp, argv[1], &info ) ) {
+    Tcl_AppendResult( interp, "command \"", argv[1], "\" already exists",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  cvCalculateWallShearStress *wallshear = new cvCalculateWallShearStress();
+
+  Tcl_CreateCommand( interp, argv[1], Post_WallShearAccumulatorObjectCmd,
+		     (ClientData)wallshear, DeleteWallShearAccumulator );
+  Tcl_SetResult( interp, (char*)argv[1], TCL_VOLATILE );
+  return TCL_OK;
+}
+
+
+// ------------------------------
+// DeleteWallShearAccumulator
+// ------------------------------
+
+void DeleteWallShearAccumulator( ClientData clientData )
+{
+  cvCalculateWallShearStress *wallshear = (cvCalculateWallShearStress *)clientData;
+  delete wallshear;
+}
+
+
+// -------------------------------------
+// Post_WallShearAccumulatorObjectCmd
+// -------------------------------------
+
+int Post_WallShearAccumulatorObjectCmd( ClientData clientData, Tcl_Interp *interp,
+		  int argc, CONST84 char *argv[] )
+{
+  cvCalculateWallShearStress *wallshear = (cvCalculateWallShearStress *)clientData;
+  RepositoryDataT type;
+
+  if ( argc < 2 ) {
+    Tcl_AppendResult( interp, "usage: ", argv[0],
+		      " Add|GetMean|GetPulse|GetOSI|GetNumberOfSteps|Reset ?args?",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  if ( Tcl_StringMatch( argv[1], "GetNumberOfSteps" ) ) {
+    char rtnstr[255];
+    sprintf( rtnstr, "%i", wallshear->GetNumberOfAccumulatedSteps() );
+    Tcl_SetResult( interp, rtnstr, TCL_VOLATILE );
+    return TCL_OK;
+  }
+
+  if ( Tcl_StringMatch( argv[1], "Reset" ) ) {
+    wallshear->ResetAccumulation();
+    return TCL_OK;
+  }
+
+  if ( Tcl_StringMatch( argv[1], "Add" ) ) {
+
+    char *usage;
+    char *shearPdName = NULL;
+
+    int table_size = 1;
+    ARG_Entry arg_table[] = {
+      { "-shearPd", STRING_Type, &shearPdName, NULL, REQUIRED, 0, { 0 } },
+    };
+    usage = ARG_GenSyntaxStr( 2, argv, table_size, arg_table );
+    if ( argc == 2 ) {
+      Tcl_SetResult( interp, usage, TCL_VOLATILE );
+      return TCL_OK;
+    }
+    if ( ARG_ParseTclStr( interp, argc, argv, 2,
+			  table_size, arg_table ) != TCL_OK ) {
+      Tcl_SetResult( interp, usage, TCL_VOLATILE );
+      return TCL_ERROR;
+    }
+
+    cvRepositoryData *src = gRepository->GetObject( shearPdName );
+    if ( src == NULL ) {
+      Tcl_AppendResult( interp, "couldn't find object ", shearPdName,
+			(char *)NULL );
+      return TCL_ERROR;
+    }
+    type = src->GetType();
+    if ( type != POLY_DATA_T ) {
+      Tcl_AppendResult( interp, "object ", shearPdName,
+			" not of type cvPolyData", (char *)NULL );
+      return TCL_ERROR;
+    }
+
+    if ( wallshear->AccumulateWallShear( (cvPolyData*)src ) == SV_ERROR ) {
+      Tcl_AppendResult( interp, "error adding ", shearPdName, (char *)NULL );
+      return TCL_ERROR;
+    }
+    return TCL_OK;
+  }
+
+  if ( !Tcl_StringMatch( argv[1], "GetMean" ) &&
+       !Tcl_StringMatch( argv[1], "GetPulse" ) &&
+       !Tcl_StringMatch( argv[1], "GetOSI" ) ) {
+    Tcl_AppendResult( interp, "\"", argv[1],
+		      "\" not a recognized wall shear accumulator method",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  char *usage;
+  char *resultName = NULL;
+  char *surfaceMeshName = NULL;
+  cvRepositoryData *surfaceMesh = NULL;
+
+  int table_size = 2;
+  ARG_Entry arg_table[] = {
+    { "-result", STRING_Type, &resultName, NULL, REQUIRED, 0, { 0 } },
+    { "-surfaceMesh", STRING_Type, &surfaceMeshName, NULL, SV_OPTIONAL, 0, { 0 } },
+  };
+  usage = ARG_GenSyntaxStr( 2, argv, table_size, arg_table );
+  if ( argc == 2 ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_OK;
+  }
+  if ( ARG_ParseTclStr( interp, argc, argv, 2,
+			table_size, arg_table ) != TCL_OK ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_ERROR;
+  }
+
+  // check to make sure we have a valid exterior surface mesh object
+  if (surfaceMeshName != NULL) {
+    if (! gRepository->Exists( surfaceMeshName ) ) {
+       Tcl_AppendResult( interp, "object ", surfaceMeshName, " does not exist",
+		      (char *)NULL );
+       return TCL_ERROR;
+     }
+
+     surfaceMesh = gRepository->GetObject( surfaceMeshName );
+     type = surfaceMesh->GetType();
+
+     if ( type != POLY_DATA_T ) {
+       Tcl_AppendResult( interp, surfaceMeshName, " not of type cvPolyData", (char *)NULL );
+       return TCL_ERROR;
+     }
+  }
+
+  // Make sure the specified result object does not exist:
+  if ( gRepository->Exists( resultName ) ) {
+    Tcl_AppendResult( interp, "object ", resultName, " already exists",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  if ( wallshear->GetNumberOfAccumulatedSteps() == 0 ) {
+    Tcl_AppendResult( interp, "no time steps have been added", (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  // the surface mesh is only used for this call, the repository object
+  // may be deleted before the next one
+  wallshear->SetSurfaceMesh((cvPolyData*)surfaceMesh);
+
+  cvPolyData *dst = NULL;
+  if ( Tcl_StringMatch( argv[1], "GetMean" ) ) {
+    dst = wallshear->GetAccumulatedWallShearMean();
+  } else if ( Tcl_StringMatch( argv[1], "GetPulse" ) ) {
+    dst = wallshear->GetAccumulatedWallShearPulse();
+  } else {
+    dst = wallshear->GetAccumulatedOSI();
+  }
+
+  wallshear->SetSurfaceMesh(NULL);
+
+  if (dst == NULL) {
+    Tcl_AppendResult( interp, "error getting obj ", resultName, (char *)NULL );
+    return TCL_ERROR;
+  }
+  if ( !( gRepository->Register( resultName , dst ) ) ) {
+    Tcl_AppendResult( interp, "error registering obj ", resultName,
+		      " in repository", (char *)NULL );
+    delete dst;
+    return TCL_ERROR;
+  }
+
+  Tcl_SetResult( interp, dst->GetName(), TCL_VOLATILE );
+
+  return TCL_OK;
+}
+
+
+// --------------------------
+// Post_tkeAccumulatorCmd
+// --------------------------
+// post_tkeAccumulator <objName>
+//
+// Creates an object command computing the average velocity and the
+// turbulent kinetic energy one step at a time:
+//
+//   <objName> Add -inputPd <pd>
+//   <objName> GetAverageVelocity -result <pd>
+//   <objName> GetTKE -result <pd>
+//   <objName> GetNumberOfSteps
+//   <objName> Reset
+//
+// The object is removed with "rename <objName> {}".
+
+int Post_tkeAccumulatorCmd( ClientData clientData, Tcl_Interp *interp,
+		  int argc, CONST84 char *argv[] )
+{
+  if ( argc != 2 ) {
+    Tcl_AppendResult( interp, "usage: ", argv[0], " <objName>",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  Tcl_CmdInfo info;
+  if ( Tcl_GetCommandInfo( interp, argv[1], &info ) ) {
+    Tcl_AppendResult( interp, "command \"", argv[1], "\" already exists",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  cvCalculateTKE *tke = new cvCalculateTKE();
+
+  Tcl_CreateCommand( interp, argv[1], Post_TKEAccumulatorObjectCmd,
+		     (ClientData)tke, DeleteTKEAccumulator );
+  Tcl_SetResult( interp, (char*)argv[1], TCL_VOLATILE );
+  return TCL_OK;
+}
+
+
+// ------------------------
+// DeleteTKEAccumulator
+// ------------------------
+
+void DeleteTKEAccumulator( ClientData clientData )
+{
+  cvCalculateTKE *tke = (cvCalculateTKE *)clientData;
+  delete tke;
+}
+
+
+// -------------------------------
+// Post_TKEAccumulatorObjectCmd
+// -------------------------------
+
+int Post_TKEAccumulatorObjectCmd( ClientData clientData, Tcl_Interp *interp,
+		  int argc, CONST84 char *argv[] )
+{
+  cvCalculateTKE *tke = (cvCalculateTKE *)clientData;
+  RepositoryDataT type;
+
+  if ( argc < 2 ) {
+    Tcl_AppendResult( interp, "usage: ", argv[0],
+		      " Add|GetAverageVelocity|GetTKE|GetNumberOfSteps|Reset ?args?",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  if ( Tcl_StringMatch( argv[1], "GetNumberOfSteps" ) ) {
+    char rtnstr[255];
+    sprintf( rtnstr, "%i", tke->GetNumberOfTimeSteps() );
+    Tcl_SetResult( interp, rtnstr, TCL_VOLATILE );
+    return TCL_OK;
+  }
+
+  if ( Tcl_StringMatch( argv[1], "Reset" ) ) {
+    tke->Reset();
+    return TCL_OK;
+  }
+
+  if ( Tcl_StringMatch( argv[1], "Add" ) ) {
+
+    char *usage;
+    char *inputPdName = NULL;
+
+    int table_size = 1;
+    ARG_Entry arg_table[] = {
+      { "-inputPd", STRING_Type, &inputPdName, NULL, REQUIRED, 0, { 0 } },
+    };
+    usage = ARG_GenSyntaxStr( 2, argv, table_size, arg_table );
+    if ( argc == 2 ) {
+      Tcl_SetResult( interp, usage, TCL_VOLATILE );
+      return TCL_OK;
+    }
+    if ( ARG_ParseTclStr( interp, argc, argv, 2,
+			  table_size, arg_table ) != TCL_OK ) {
+      Tcl_SetResult( interp, usage, TCL_VOLATILE );
+      return TCL_ERROR;
+    }
+
+    cvRepositoryData *src = gRepository->GetObject( inputPdName );
+    if ( src == NULL ) {
+      Tcl_AppendResult( interp, "couldn't find object ", inputPdName,
+			(char *)NULL );
+      return TCL_ERROR;
+    }
+    type = src->GetType();
+    if ( type != POLY_DATA_T ) {
+      Tcl_AppendResult( interp, "object ", inputPdName,
+			" not of type cvPolyData", (char *)NULL );
+      return TCL_ERROR;
+    }
+
+    if ( tke->AddTimeStep( (cvPolyData*)src ) == SV_ERROR ) {
+      Tcl_AppendResult( interp, "error adding ", inputPdName, (char *)NULL );
+      return TCL_ERROR;
+    }
+    return TCL_OK;
+  }
+
+  if ( !Tcl_StringMatch( argv[1], "GetAverageVelocity" ) &&
+       !Tcl_StringMatch( argv[1], "GetTKE" ) ) {
+    Tcl_AppendResult( interp, "\"", argv[1],
+		      "\" not a recognized tke accumulator method",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  char *usage;
+  char *resultName = NULL;
+
+  int table_size = 1;
+  ARG_Entry arg_table[] = {
+    { "-result", STRING_Type, &resultName, NULL, REQUIRED, 0, { 0 } },
+  };
+  usage = ARG_GenSyntaxStr( 2, argv, table_size, arg_table );
+  if ( argc == 2 ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_OK;
+  }
+  if ( ARG_ParseTclStr( interp, argc, argv, 2,
+			table_size, arg_table ) != TCL_OK ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_ERROR;
+  }
+
+  // Make sure the specified result object does not exist:
+  if ( gRepository->Exists( resultName ) ) {
+    Tcl_AppendResult( interp, "object ", resultName, " already exists",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  cvPolyData *dst = NULL;
+  if ( Tcl_StringMatch( argv[1], "GetAverageVelocity" ) ) {
+    dst = tke->GetAverageVelocityPolyData();
+  } else {
+    dst = tke->GetTKEPolyData();
+  }
+
+  if (dst == NULL) {
+    Tcl_AppendResult( interp, "error getting obj ", resultName, (char *)NULL );
+    return TCL_ERROR;
+  }
+  if ( !( gRepository->Register( resultName , dst ) ) ) {
+    Tcl_AppendResult( interp, "error registering obj ", resultName,
+		      " in repository", (char *)NULL );
+    delete dst;
+    return TCL_ERROR;
+  }
+
+  Tcl_SetResult( interp, dst->GetName(), TCL_VOLATILE );
+
+  return TCL_OK;
+}
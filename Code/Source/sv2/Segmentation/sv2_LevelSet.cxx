@@ -81,8 +81,10 @@ cvLevelSet::cvLevelSet()
 
   status_ = 0;
   timers_ = 0;
+  numThreads_ = 1;
   saveProjectionSets_ = 0;
   etype_ = PROJECT_V;
+  rtype_ = REINIT_FRONT;
   rebuildPhiValid_ = 0;
   zlsVanished_ = 0;
   maxPhiIncr_ = 0.0;
@@ -173,6 +175,25 @@ int cvLevelSet::SetGridType( GridT gt )
 }
 
 
+// -------------
+// SetNumThreads
+// -------------
+// Takes effect immediately if the grid already exists, otherwise at
+// Init.
+
+int cvLevelSet::SetNumThreads( int n )
+{
+  if ( n < 1 ) {
+    return SV_ERROR;
+  }
+  numThreads_ = n;
+  if ( grid_ != NULL ) {
+    grid_->SetNumThreads( n );
+  }
+  return SV_OK;
+}
+
+
 // --------------
 // SetGridSpacing
 // --------------
@@ -609,6 +630,8 @@ int cvLevelSet::Init()
       grid_ = NULL;
       return SV_ERROR;
     }
+    grid_->SetNumThreads( numThreads_ );
+    grid_->SetReinitMethod( rtype_ );
 
     if (timers_) {
       cpuTimer.reset();
@@ -964,6 +987,37 @@ int cvLevelSet::GetVExtension( ExtensionT *etype )
 }
 
 
+// ---------
+// SetReinit
+// ---------
+// Note that the default (to REINIT_FRONT) is set in the cvLevelSet
+// constructor.
+
+int cvLevelSet::SetReinit( ReinitT rtype )
+{
+  if ( rtype == Invalid_ReinitT ) {
+    return SV_ERROR;
+  }
+  rtype_ = rtype;
+  if ( grid_ != NULL ) {
+    grid_->SetReinitMethod( rtype );
+  }
+  rebuildPhiValid_ = 0;
+  return SV_OK;
+}
+
+
+// ---------
+// GetReinit
+// ---------
+
+int cvLevelSet::GetReinit( ReinitT *rtype )
+{
+  *rtype = rtype_;
+  return SV_OK;
+}
+
+
 // -----------------
 // GetGridStatString
 // -----------------
@@ -146,11 +146,19 @@ public:
   int SetVExtension( ExtensionT etype );
   int GetVExtension( ExtensionT *etype );
 
+  // Control method of phi reinitialization (see RebuildPhi):
+  int SetReinit( ReinitT rtype );
+  int GetReinit( ReinitT *rtype );
+
   // Timers:
   void SetTimers( int flag ) { timers_ = flag; };
   void GetTimers( int *flag ) { *flag = timers_; };
   double GetTimerGranularity() { return cpuTimer.granularity(); };
 
+  // Number of threads used to evolve the grid:
+  int SetNumThreads( int n );
+  void GetNumThreads( int *n ) { *n = numThreads_; };
+
   // Memory usage:
   int GetMemoryUsage();
 
@@ -179,6 +187,7 @@ private:
   int tn_;
   int status_;
   ExtensionT etype_;
+  ReinitT rtype_;
   int rebuildPhiValid_;
   double maxPhiIncr_;
   double maxV_;
@@ -196,6 +205,7 @@ private:
 
   int timers_;
   cvCPUTimer cpuTimer;
+  int numThreads_;
   int saveProjectionSets_;
 
 };
@@ -177,6 +177,8 @@ cvLevelSetDenseGrid::cvLevelSetDenseGrid( double h[], int dims[], double o[] )
     }
   }
 
+  nodeArrays_.Build( grid_, numNodes_ );
+
   scalars_ = NULL;
 
   return;
@@ -209,6 +211,7 @@ void cvLevelSetDenseGrid::DeallocateNodes()
   if ( grid_ != NULL ) {
     delete [] grid_;
   }
+  nodeArrays_.Deallocate();
   return;
 }
 
@@ -461,6 +464,7 @@ int cvLevelSetDenseGrid::InitPhi( cvPolyData *front )
   }
 
   phiVtkValid_ = 0;
+  nodeArrays_.InvalidatePhi();
   return SV_OK;
 }
 
@@ -503,6 +507,7 @@ int cvLevelSetDenseGrid::InitPhi( double ctr[], double radius )
   init_ = 1;
 
   phiVtkValid_ = 0;
+  nodeArrays_.InvalidatePhi();
   return SV_OK;
 }
 
@@ -534,6 +539,7 @@ int cvLevelSetDenseGrid::InitPhi( cvSolidModel *sm )
 
   init_ = 1;
   phiVtkValid_ = 0;
+  nodeArrays_.InvalidatePhi();
   return SV_OK;
 
 
@@ -603,6 +609,10 @@ int cvLevelSetDenseGrid::ReinitPhi()
 {
   cvPolyData *front;
 
+  if ( reinitMethod_ != REINIT_FRONT ) {
+    return ReinitPhiInGrid();
+  }
+
   front = GetFront();
   if ( front->GetVtkPolyData()->GetNumberOfCells() < 1 ) {
     printf("ERR: Current zero level set has no geometry.\n");
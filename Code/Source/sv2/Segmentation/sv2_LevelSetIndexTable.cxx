@@ -0,0 +1,221 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SimVascular.h"
+
+#include "sv2_LevelSetIndexTable.h"
+
+#include <cstddef>
+
+
+// --------------------
+// cvLevelSetIndexTable
+// --------------------
+
+cvLevelSetIndexTable::cvLevelSetIndexTable()
+{
+  keys_ = NULL;
+  values_ = NULL;
+  capacity_ = 0;
+  shift_ = 32;
+  numEntries_ = 0;
+  numUsed_ = 0;
+}
+
+
+// ---------------------
+// ~cvLevelSetIndexTable
+// ---------------------
+
+cvLevelSetIndexTable::~cvLevelSetIndexTable()
+{
+  delete [] keys_;
+  delete [] values_;
+}
+
+
+// -----
+// Clear
+// -----
+
+void cvLevelSetIndexTable::Clear()
+{
+  int i;
+
+  if ( numUsed_ == 0 ) {
+    return;
+  }
+  for ( i = 0; i < capacity_; i++ ) {
+    keys_[i] = EMPTY_KEY;
+  }
+  numEntries_ = 0;
+  numUsed_ = 0;
+}
+
+
+// -------
+// Reserve
+// -------
+// Make room for numEntries keys at a load factor of at most 1/2.
+
+void cvLevelSetIndexTable::Reserve( int numEntries )
+{
+  int capacity = 16;
+
+  while ( capacity < 2 * numEntries ) {
+    capacity *= 2;
+  }
+  if ( capacity > capacity_ ) {
+    Rehash( capacity );
+  }
+}
+
+
+// ------
+// Rehash
+// ------
+
+void cvLevelSetIndexTable::Rehash( int capacity )
+{
+  int *oldKeys = keys_;
+  int *oldValues = values_;
+  int oldCapacity = capacity_;
+  int i, slot;
+
+  keys_ = new int [capacity];
+  values_ = new int [capacity];
+  capacity_ = capacity;
+  shift_ = 32;
+  while ( ( 1 << ( 32 - shift_ ) ) < capacity_ ) {
+    shift_--;
+  }
+  for ( i = 0; i < capacity_; i++ ) {
+    keys_[i] = EMPTY_KEY;
+  }
+
+  // tombstones are dropped here
+  numUsed_ = numEntries_;
+  for ( i = 0; i < oldCapacity; i++ ) {
+    if ( oldKeys[i] < 0 ) {
+      continue;
+    }
+    slot = Slot( oldKeys[i] );
+    while ( keys_[slot] != EMPTY_KEY ) {
+      slot = ( slot + 1 ) & ( capacity_ - 1 );
+    }
+    keys_[slot] = oldKeys[i];
+    values_[slot] = oldValues[i];
+  }
+
+  delete [] oldKeys;
+  delete [] oldValues;
+}
+
+
+// ------
+// Insert
+// ------
+// Stores value for key, replacing any previous value.
+
+int cvLevelSetIndexTable::Insert( int key, int value )
+{
+  int slot, tomb, capacity;
+
+  if ( key < 0 ) {
+    return SV_ERROR;
+  }
+  // keep the load, tombstones included, at most 1/2; a rehash leaves
+  // it at most 1/4 so it is not repeated on the next insertion
+  if ( 2 * ( numUsed_ + 1 ) > capacity_ ) {
+    capacity = ( capacity_ < 16 ) ? 16 : capacity_;
+    while ( capacity < 4 * ( numEntries_ + 1 ) ) {
+      capacity *= 2;
+    }
+    Rehash( capacity );
+  }
+
+  tomb = -1;
+  slot = Slot( key );
+  while ( keys_[slot] != EMPTY_KEY ) {
+    if ( keys_[slot] == key ) {
+      values_[slot] = value;
+      return SV_OK;
+    }
+    if ( ( keys_[slot] == REMOVED_KEY ) && ( tomb < 0 ) ) {
+      tomb = slot;
+    }
+    slot = ( slot + 1 ) & ( capacity_ - 1 );
+  }
+
+  if ( tomb >= 0 ) {
+    slot = tomb;
+  } else {
+    numUsed_++;
+  }
+  keys_[slot] = key;
+  values_[slot] = value;
+  numEntries_++;
+  return SV_OK;
+}
+
+
+// ------
+// Remove
+// ------
+
+int cvLevelSetIndexTable::Remove( int key )
+{
+  int slot;
+
+  if ( ( numEntries_ == 0 ) || ( key < 0 ) ) {
+    return SV_ERROR;
+  }
+  slot = Slot( key );
+  while ( keys_[slot] != EMPTY_KEY ) {
+    if ( keys_[slot] == key ) {
+      keys_[slot] = REMOVED_KEY;
+      numEntries_--;
+      return SV_OK;
+    }
+    slot = ( slot + 1 ) & ( capacity_ - 1 );
+  }
+  return SV_ERROR;
+}
+
+
+// --------------
+// GetMemoryUsage
+// --------------
+
+int cvLevelSetIndexTable::GetMemoryUsage() const
+{
+  return sizeof( *this ) + 2 * capacity_ * sizeof(int);
+}
@@ -0,0 +1,115 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CVLEVELSETINDEXTABLE_H
+#define __CVLEVELSETINDEXTABLE_H
+
+#include "SimVascular.h"
+#include "svLSetExports.h" // For exports
+
+
+// Flat open addressing map from non-negative int keys (global dense
+// node indices) to int values.  Keys and values live in two parallel
+// arrays whose size is a power of two, collisions are resolved by
+// linear probing and removed keys leave a tombstone behind.  Lookups
+// never allocate, and since band nodes are inserted in dense order
+// neighboring keys tend to land in neighboring slots.
+
+class SV_EXPORT_LSET cvLevelSetIndexTable {
+
+public:
+  cvLevelSetIndexTable();
+  ~cvLevelSetIndexTable();
+
+  // Clear keeps the current allocation for reuse by the next band.
+  void Clear();
+  void Reserve( int numEntries );
+
+  int Insert( int key, int value );
+  int Remove( int key );
+  inline int Find( int key ) const;
+
+  int GetNumEntries() const { return numEntries_; };
+  int GetMemoryUsage() const;
+
+private:
+  enum { EMPTY_KEY = -1, REMOVED_KEY = -2 };
+
+  inline int Slot( int key ) const;
+  void Rehash( int capacity );
+
+  int *keys_;
+  int *values_;
+  int capacity_;
+  int shift_;     // 32 - log2(capacity_)
+  int numEntries_;
+  int numUsed_;   // entries plus tombstones
+
+};
+
+
+// ----
+// Slot
+// ----
+// Fibonacci hashing: keep the top log2(capacity_) bits of the product,
+// which are the best mixed.
+
+int cvLevelSetIndexTable::Slot( int key ) const
+{
+  unsigned int h = (unsigned int)key * 2654435769u;
+  return (int)( h >> shift_ );
+}
+
+
+// ----
+// Find
+// ----
+// Returns the value stored for key, or -1 if key is not present.
+
+int cvLevelSetIndexTable::Find( int key ) const
+{
+  int slot;
+
+  if ( ( numEntries_ == 0 ) || ( key < 0 ) ) {
+    return -1;
+  }
+  slot = Slot( key );
+  while ( keys_[slot] != EMPTY_KEY ) {
+    if ( keys_[slot] == key ) {
+      return values_[slot];
+    }
+    slot = ( slot + 1 ) & ( capacity_ - 1 );
+  }
+  return -1;
+}
+
+
+#endif // __CVLEVELSETINDEXTABLE_H
@@ -76,12 +76,9 @@ public:
   int logicalIx_;
   int index_;
 
-  double dp_[3];       // < D+x, D+y, D+z >
-  double dm_[3];       // < D-x, D-y, D-z >
-  double d0_[3];       // < D0x, D0y, D0z >
-  double d0x_[3];      // < D0xx, D0xy, D0xz >
-  double d0y_[3];      // < D0yx, D0yy, D0yz >
-  double d0z_[3];      // < D0zx, D0zy, D0zz >
+  // Finite differences (D+, D-, D0 and the second order centered
+  // terms) and the entropy-satisfying del terms are kept in the
+  // grid's cvLevelSetNodeArrays rather than here.
 
   double K_;
   double K3dg_;
@@ -96,7 +93,6 @@ public:
   int xNextIndex_, yNextIndex_, zNextIndex_;
 
   double F0_, F1_;
-  double delPlus_, delMinus_;
   double toDot_[3];   // new vector which is used in the geodesic
                       // image segmentation approach
 
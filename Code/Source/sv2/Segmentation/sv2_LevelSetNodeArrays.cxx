@@ -0,0 +1,211 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SimVascular.h"
+
+#include <stddef.h>
+#include "sv2_LevelSetNodeArrays.h"
+
+
+// --------------------
+// cvLevelSetNodeArrays
+// --------------------
+
+cvLevelSetNodeArrays::cvLevelSetNodeArrays()
+{
+  int i;
+
+  doubleBlock_ = NULL;
+  intBlock_ = NULL;
+  numNodes_ = 0;
+  phiValid_ = 0;
+
+  phi_ = NULL;
+  delPlus_ = NULL;
+  delMinus_ = NULL;
+  for ( i = 0; i < 3; i++ ) {
+    prev_[i] = NULL;
+    next_[i] = NULL;
+    dp_[i] = NULL;
+    dm_[i] = NULL;
+    d0_[i] = NULL;
+    d0x_[i] = NULL;
+    d0y_[i] = NULL;
+    d0z_[i] = NULL;
+  }
+}
+
+
+// ---------------------
+// ~cvLevelSetNodeArrays
+// ---------------------
+
+cvLevelSetNodeArrays::~cvLevelSetNodeArrays()
+{
+  Deallocate();
+}
+
+
+// ----------
+// Deallocate
+// ----------
+
+void cvLevelSetNodeArrays::Deallocate()
+{
+  int i;
+
+  delete [] doubleBlock_;
+  delete [] intBlock_;
+  doubleBlock_ = NULL;
+  intBlock_ = NULL;
+  numNodes_ = 0;
+  phiValid_ = 0;
+
+  phi_ = NULL;
+  delPlus_ = NULL;
+  delMinus_ = NULL;
+  for ( i = 0; i < 3; i++ ) {
+    prev_[i] = NULL;
+    next_[i] = NULL;
+    dp_[i] = NULL;
+    dm_[i] = NULL;
+    d0_[i] = NULL;
+    d0x_[i] = NULL;
+    d0y_[i] = NULL;
+    d0z_[i] = NULL;
+  }
+  return;
+}
+
+
+// -----
+// Build
+// -----
+// All double arrays are carved out of one block, and likewise all
+// int arrays, so a rebuild costs two allocations.  The block is only
+// reallocated when the node count changes.
+
+int cvLevelSetNodeArrays::Build( cvLevelSetNode *grid, int numNodes )
+{
+  int i, n;
+  double *dptr;
+  int *iptr;
+
+  if ( ( grid == NULL ) || ( numNodes < 1 ) ) {
+    Deallocate();
+    return SV_ERROR;
+  }
+
+  if ( numNodes != numNodes_ ) {
+    Deallocate();
+    doubleBlock_ = new double [(size_t)NUM_DOUBLE_ARRAYS * numNodes];
+    intBlock_ = new int [(size_t)NUM_INT_ARRAYS * numNodes];
+    numNodes_ = numNodes;
+
+    dptr = doubleBlock_;
+    phi_ = dptr;
+    dptr += numNodes;
+    for ( i = 0; i < 3; i++ ) {
+      dp_[i] = dptr;
+      dptr += numNodes;
+      dm_[i] = dptr;
+      dptr += numNodes;
+      d0_[i] = dptr;
+      dptr += numNodes;
+      d0x_[i] = dptr;
+      dptr += numNodes;
+      d0y_[i] = dptr;
+      dptr += numNodes;
+      d0z_[i] = dptr;
+      dptr += numNodes;
+    }
+    delPlus_ = dptr;
+    dptr += numNodes;
+    delMinus_ = dptr;
+
+    iptr = intBlock_;
+    for ( i = 0; i < 3; i++ ) {
+      prev_[i] = iptr;
+      iptr += numNodes;
+      next_[i] = iptr;
+      iptr += numNodes;
+    }
+  }
+
+  for ( n = 0; n < numNodes; n++ ) {
+    prev_[0][n] = grid[n].xPrevIndex_;
+    prev_[1][n] = grid[n].yPrevIndex_;
+    prev_[2][n] = grid[n].zPrevIndex_;
+    next_[0][n] = grid[n].xNextIndex_;
+    next_[1][n] = grid[n].yNextIndex_;
+    next_[2][n] = grid[n].zNextIndex_;
+  }
+  phiValid_ = 0;
+
+  return SV_OK;
+}
+
+
+// ---------
+// GatherPhi
+// ---------
+
+void cvLevelSetNodeArrays::GatherPhi( cvLevelSetNode *grid )
+{
+  int n;
+
+  if ( phiValid_ || ( grid == NULL ) ) {
+    return;
+  }
+  for ( n = 0; n < numNodes_; n++ ) {
+    phi_[n] = grid[n].phi_;
+  }
+  phiValid_ = 1;
+  return;
+}
+
+
+// --------------
+// GetMemoryUsage
+// --------------
+
+int cvLevelSetNodeArrays::GetMemoryUsage() const
+{
+  int sz = 0;
+
+  if ( doubleBlock_ ) {
+    sz += NUM_DOUBLE_ARRAYS * numNodes_ * sizeof(double);
+  }
+  if ( intBlock_ ) {
+    sz += NUM_INT_ARRAYS * numNodes_ * sizeof(int);
+  }
+  return sz;
+}
@@ -0,0 +1,90 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CVLEVELSETNODEARRAYS_H
+#define __CVLEVELSETNODEARRAYS_H
+
+#include "SimVascular.h"
+#include "svLSetExports.h" // For exports
+#include "sv2_LevelSetNode.h"
+
+
+// Structure-of-arrays storage for the finite difference stencils of a
+// cvLevelSetStructuredGrid.  Entry n of every array belongs to
+// grid_[n], whatever the layout of grid_ might be.  Phi is gathered
+// from the cvLevelSetNode's once per time step, and the difference
+// kernels then stream through these arrays instead of the much
+// larger cvLevelSetNode's.  Neighbor indices are copied when the node
+// list is (re)built, and the difference results live only here.
+
+class SV_EXPORT_LSET cvLevelSetNodeArrays {
+
+public:
+  cvLevelSetNodeArrays();
+  ~cvLevelSetNodeArrays();
+
+  // Build must be called whenever the node list or its neighbor
+  // indices change:
+  int Build( cvLevelSetNode *grid, int numNodes );
+  void Deallocate();
+
+  // Copy phi_ out of the node list unless the current copy is valid:
+  void GatherPhi( cvLevelSetNode *grid );
+  void InvalidatePhi() { phiValid_ = 0; };
+
+  int GetNumNodes() const { return numNodes_; };
+  int GetMemoryUsage() const;
+
+  double *phi_;
+  int *prev_[3];       // xPrevIndex_, yPrevIndex_, zPrevIndex_
+  int *next_[3];       // xNextIndex_, yNextIndex_, zNextIndex_
+
+  double *dp_[3];      // < D+x, D+y, D+z >
+  double *dm_[3];      // < D-x, D-y, D-z >
+  double *d0_[3];      // < D0x, D0y, D0z >
+  double *d0x_[3];     // < D0xx, D0xy, D0xz >
+  double *d0y_[3];     // < D0yx, D0yy, D0yz >
+  double *d0z_[3];     // < D0zx, D0zy, D0zz >
+  double *delPlus_;
+  double *delMinus_;
+
+private:
+  enum { NUM_DOUBLE_ARRAYS = 21, NUM_INT_ARRAYS = 6 };
+
+  double *doubleBlock_;
+  int *intBlock_;
+  int numNodes_;
+  int phiValid_;
+
+};
+
+
+#endif // __CVLEVELSETNODEARRAYS_H
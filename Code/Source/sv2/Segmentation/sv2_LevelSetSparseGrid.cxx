@@ -51,26 +51,18 @@
 cvLevelSetSparseGrid::cvLevelSetSparseGrid( double h[], int dims[], double o[] )
   : cvLevelSetStructuredGrid( h, dims, o )
 {
-  int i;
-
   currIx_ = 0;
 
   overlaySz_ = I_ * J_ * K_;
   topoOverlay_ = new cvStateArray( overlaySz_ );  // lifetime same as cvLevelSetSparseGrid
 
-  numBuckets_ = sqrt( 1.0 * numDenseNodes_ );
-  nodeTable_ = new cvSortedList<TableStruct*> * [numBuckets_];
-  if ( nodeTable_ == NULL ) {
-    printf("ERR: Couldn't allocate cvLevelSetSparseGrid::nodeTable_.\n");
-    return;
-  }
-  for (i = 0; i < numBuckets_; i++) {
-    nodeTable_[i] = new cvSortedList<TableStruct*>( TableStructCompareFn );
-  }
+  htEntries_ = NULL;
+  htSize_ = 0;
+  htAlloc_ = 0;
+  htCurrIx_ = 0;
 
   numSparseNodes_ = 0;
   numSparseEdges_ = 0;
-  htIter_ = NULL;
 
   adjIa_ = NULL;
   adjJa_ = NULL;
@@ -119,6 +111,7 @@ cvLevelSetSparseGrid::~cvLevelSetSparseGrid()
   delete topoOverlay_;
   delete [] adjIa_;
   delete [] adjJa_;
+  delete [] htEntries_;
 }
 
 
@@ -126,7 +119,7 @@ cvLevelSetSparseGrid::~cvLevelSetSparseGrid()
 // DeallocateNodes
 // ---------------
 // Free up all of the following:
-//   - hash table nodeTable_
+//   - hash table entries (htEntries_ / htIndex_ storage is reused)
 //   - CSR structure adjIa_, adjJa_, grid_
 //   - partition vector
 
@@ -143,21 +136,51 @@ void cvLevelSetSparseGrid::DeallocateNodes()
 // -------
 // ClearHT
 // -------
+// Entry and index storage is kept for the next band construction.
 
 void cvLevelSetSparseGrid::ClearHT()
 {
+  htSize_ = 0;
+  htIndex_.Clear();
+  return;
+}
+
+
+// --------
+// InsertHT
+// --------
+// Copies *entry into the table.  GetNextHTItem visits entries in
+// insertion order.
+
+int cvLevelSetSparseGrid::InsertHT( TableStruct *entry )
+{
+  TableStruct *tmp;
   int i;
-  cvSortedList<TableStruct*> *bucket;
-  TableStruct *entry;
 
-  for (i = 0; i < numBuckets_; i++) {
-    bucket = nodeTable_[i];
-    while ( ! bucket->IsEmpty() ) {
-      entry = bucket->RemoveFront();
-      delete entry;
+  if ( htSize_ == htAlloc_ ) {
+    htAlloc_ = ( htAlloc_ == 0 ) ? 1024 : 2 * htAlloc_;
+    tmp = new TableStruct [htAlloc_];
+    for ( i = 0; i < htSize_; i++ ) {
+      tmp[i] = htEntries_[i];
     }
+    delete [] htEntries_;
+    htEntries_ = tmp;
   }
+  htEntries_[htSize_] = *entry;
+  htIndex_.Insert( entry->tag_, htSize_ );
+  htSize_++;
+  return SV_OK;
+}
+
+
+// ------------
+// RemoveFromHT
+// ------------
 
+void cvLevelSetSparseGrid::RemoveFromHT( TableStruct *entry )
+{
+  htIndex_.Remove( entry->tag_ );
+  entry->tag_ = -1;
   return;
 }
 
@@ -168,6 +191,8 @@ void cvLevelSetSparseGrid::ClearHT()
 
 void cvLevelSetSparseGrid::DeallocateCSR()
 {
+  csrIndex_.Clear();
+  nodeArrays_.Deallocate();
   if ( grid_ != NULL ) {
     delete [] grid_;
     grid_ = NULL;
@@ -196,6 +221,7 @@ void cvLevelSetSparseGrid::ClearPartitioning()
     delete [] color_;
     color_ = NULL;
   }
+  InvalidatePartitions();
   return;
 }
 
@@ -737,6 +763,11 @@ int cvLevelSetSparseGrid::ReinitPhi()
     return SV_ERROR;
   }
 
+  if ( reinitMethod_ != REINIT_FRONT ) {
+    closedPhiVtkValid_ = 0;
+    return ReinitPhiInGrid();
+  }
+
   front = GetFront();
   if ( front->GetVtkPolyData()->GetNumberOfCells() < 1 ) {
     printf("ERR: Current zero level set has no geometry.\n");
@@ -761,6 +792,7 @@ int cvLevelSetSparseGrid::ReinitPhi()
     }
     currNode->phi_ = sign * dist;
   }
+  nodeArrays_.InvalidatePhi();
 
   delete front;
   return SV_OK;
@@ -780,11 +812,7 @@ void cvLevelSetSparseGrid::InitHTIterator()
   if ( gridState_ < SGST_HashTable ) {
     return;
   }
-  htCurrBucketId_ = 0;
-  if ( htIter_ != NULL ) {
-    delete htIter_;
-  }
-  htIter_ = new cvLispListIterator<TableStruct*>(nodeTable_[htCurrBucketId_]);
+  htCurrIx_ = 0;
   return;
 }
 
@@ -800,25 +828,17 @@ TableStruct *cvLevelSetSparseGrid::GetNextHTItem()
   if ( gridState_ < SGST_HashTable ) {
     return NULL;
   }
-  if ( htIter_ == NULL ) {
-    return NULL;
+
+  // skip entries removed by RemoveFromHT
+  while ( ( htCurrIx_ < htSize_ ) && ( htEntries_[htCurrIx_].tag_ < 0 ) ) {
+    htCurrIx_++;
   }
-  if ( htCurrBucketId_ >= numBuckets_ ) {
+  if ( htCurrIx_ >= htSize_ ) {
     return NULL;
   }
 
-  while ( htIter_->IsDone() ) {
-    delete htIter_;
-    htIter_ = NULL;
-    htCurrBucketId_++;
-    if ( htCurrBucketId_ >= numBuckets_ ) {
-      return NULL;
-    }
-    htIter_ = new cvLispListIterator<TableStruct*>(nodeTable_[htCurrBucketId_]);
-  }
-
-  item = htIter_->Item();
-  htIter_->Next();
+  item = &(htEntries_[htCurrIx_]);
+  htCurrIx_++;
   return item;
 }
 
@@ -834,8 +854,9 @@ int cvLevelSetSparseGrid::ConstructHT( double ctr[], double radius )
   double x, y, z;
   double tmp, dist, rsq, sign;
   TableStruct *htEntry;
+  TableStruct newEntry;
   int numSparseNodes = 0;
-  int logicalIx, hashIx;
+  int logicalIx;
   double irsq, orsq;
 
   if ( gridState_ < SGST_ExtentDefined ) {
@@ -855,7 +876,7 @@ int cvLevelSetSparseGrid::ConstructHT( double ctr[], double radius )
   // Given this indexing scheme, i varies the fastest and k the
   // slowest as we march sequentially through the physical memory of
   // topoOverlay_.  Anyway, march through all nodes in the dense grid,
-  // and push any nodes within the band boundaries into the nodeTable_
+  // and push any nodes within the band boundaries into the
   // hash table.
 
   for (k = 0; k < K_; k++) {
@@ -928,7 +949,7 @@ int cvLevelSetSparseGrid::ConstructHT( double ctr[], double radius )
 	}
 
 	if ( ( innerExtent_ <= dist ) && ( dist <= outerExtent_ ) ) {
-	  htEntry = new TableStruct;
+	  htEntry = &newEntry;
 	  htEntry->phi_ = dist;
 	  htEntry->logicalIx_[0] = i;
 	  htEntry->logicalIx_[1] = j;
@@ -943,8 +964,7 @@ int cvLevelSetSparseGrid::ConstructHT( double ctr[], double radius )
 	    htEntry->state_ |= STATE_MINE;
 	  }
 
-	  hashIx = ComputeHashIx( i, j, k );
-	  nodeTable_[hashIx]->Insert( htEntry );
+	  InsertHT( htEntry );
 	}
 
       } // i
@@ -987,8 +1007,9 @@ int cvLevelSetSparseGrid::ConstructHT( cvSolidModel *sm )
   double udist, dist;
   int cls;
   TableStruct *htEntry;
+  TableStruct newEntry;
   int numSparseNodes = 0;
-  int logicalIx, hashIx;
+  int logicalIx;
   double distLimit;
   int sign;
 
@@ -1095,7 +1116,7 @@ int cvLevelSetSparseGrid::ConstructHT( cvSolidModel *sm )
 	    dist = udist;
 	  }
 
-	  htEntry = new TableStruct;
+	  htEntry = &newEntry;
 	  htEntry->phi_ = dist;
 	  htEntry->logicalIx_[0] = i;
 	  htEntry->logicalIx_[1] = j;
@@ -1110,8 +1131,7 @@ int cvLevelSetSparseGrid::ConstructHT( cvSolidModel *sm )
 	    htEntry->state_ |= STATE_MINE;
 	  }
 
-	  hashIx = ComputeHashIx( i, j, k );
-	  nodeTable_[hashIx]->Insert( htEntry );
+	  InsertHT( htEntry );
 	}
 
       } // i
@@ -1137,8 +1157,9 @@ int cvLevelSetSparseGrid::ConstructHT( cvPolyData *front )
   double udist, dist, sign;
   int cls;
   TableStruct *htEntry;
+  TableStruct newEntry;
   int numSparseNodes = 0;
-  int logicalIx, hashIx;
+  int logicalIx;
   cvSolidModel *sm;
   int result;
 
@@ -1222,7 +1243,7 @@ int cvLevelSetSparseGrid::ConstructHT( cvPolyData *front )
 	    dist = udist;
 	  }
 
-	  htEntry = new TableStruct;
+	  htEntry = &newEntry;
 	  htEntry->phi_ = dist;
 	  htEntry->logicalIx_[0] = i;
 	  htEntry->logicalIx_[1] = j;
@@ -1237,8 +1258,7 @@ int cvLevelSetSparseGrid::ConstructHT( cvPolyData *front )
 	    htEntry->state_ |= STATE_MINE;
 	  }
 
-	  hashIx = ComputeHashIx( i, j, k );
-	  nodeTable_[hashIx]->Insert( htEntry );
+	  InsertHT( htEntry );
 	}
 
       } // i
@@ -1283,11 +1303,9 @@ int cvLevelSetSparseGrid::ConstructHT_Sweep( cvPolyData *front )
   int n, numActive;
   int i, j, k;
   double pos[3];
-  int hashIx;
   TableStruct *htEntry;
+  TableStruct newEntry;
   TableStruct *entryToRm;
-  cvSortedList<TableStruct*> *bucket;
-  cvSortedList<TableStruct*> *targetBucket;
   double udist, dist;
   int blotDims[3];
 
@@ -1378,7 +1396,7 @@ int cvLevelSetSparseGrid::ConstructHT_Sweep( cvPolyData *front )
 	  }
 
 	  if ( ( innerExtent_ <= dist ) && ( dist <= outerExtent_ ) ) {
-	    htEntry = new TableStruct;
+	    htEntry = &newEntry;
 	    htEntry->phi_ = dist;
 	    htEntry->logicalIx_[0] = i;
 	    htEntry->logicalIx_[1] = j;
@@ -1391,8 +1409,7 @@ int cvLevelSetSparseGrid::ConstructHT_Sweep( cvPolyData *front )
 		 ( dist > 0.0 ) && ( ( outerExtent_ - dist ) < mineWidth_ ) ) {
 	      htEntry->state_ |= STATE_MINE;
 	    }
-	    hashIx = ComputeHashIx( i, j, k );
-	    nodeTable_[hashIx]->Insert( htEntry );
+	    InsertHT( htEntry );
 
 	    numSparseNodes_++;
 	  }
@@ -1402,26 +1419,25 @@ int cvLevelSetSparseGrid::ConstructHT_Sweep( cvPolyData *front )
   }
 
   // Post-process the table and remove any entries which have NO
-  // cardinal neighbors:
-  for (k = 0; k < K_; k++) {
-    for (j = 0; j < J_; j++) {
-      for (i = 0; i < I_; i++) {
-	if ( ( IJKPresentInHT( i, j, k, &targetBucket, &entryToRm ) ) &&
-	     ( ! IJKPresentInHT( i-1, j, k, &bucket, &htEntry ) ) &&
-	     ( ! IJKPresentInHT( i+1, j, k, &bucket, &htEntry ) ) &&
-	     ( ! IJKPresentInHT( i, j-1, k, &bucket, &htEntry ) ) &&
-	     ( ! IJKPresentInHT( i, j+1, k, &bucket, &htEntry ) ) &&
-	     ( ! IJKPresentInHT( i, j, k-1, &bucket, &htEntry ) ) &&
-	     ( ! IJKPresentInHT( i, j, k+1, &bucket, &htEntry ) ) ) {
-	  targetBucket->Remove( entryToRm );
-	  numSparseNodes_--;
-	}
-      }
+  // cardinal neighbors.  Only table entries need to be visited, and
+  // removing an isolated entry cannot isolate another one:
+  gridState_ = SGST_HashTable;
+  InitHTIterator();
+  while ( entryToRm = GetNextHTItem() ) {
+    i = entryToRm->logicalIx_[0];
+    j = entryToRm->logicalIx_[1];
+    k = entryToRm->logicalIx_[2];
+    if ( ( ! IJKPresentInHT( i-1, j, k, &htEntry ) ) &&
+	 ( ! IJKPresentInHT( i+1, j, k, &htEntry ) ) &&
+	 ( ! IJKPresentInHT( i, j-1, k, &htEntry ) ) &&
+	 ( ! IJKPresentInHT( i, j+1, k, &htEntry ) ) &&
+	 ( ! IJKPresentInHT( i, j, k-1, &htEntry ) ) &&
+	 ( ! IJKPresentInHT( i, j, k+1, &htEntry ) ) ) {
+      RemoveFromHT( entryToRm );
+      numSparseNodes_--;
     }
   }
 
-  gridState_ = SGST_HashTable;
-
   return ConstructCSR();
 }
 
@@ -1728,11 +1744,15 @@ int cvLevelSetSparseGrid::ConstructCSR()
   // Sort grid_ on cvLevelSetNode::logicalIx_:
   qsort( (void *)grid_, numSparseNodes_, sizeof(cvLevelSetNode), cvLevelSetNodeCompareFn );
 
-  // *Now* set cvLevelSetNode::index_:
+  // *Now* set cvLevelSetNode::index_, and index the nodes by their
+  // global dense index for neighbor lookups:
+  csrIndex_.Clear();
+  csrIndex_.Reserve( numSparseNodes_ );
   n = 0;
   InitIter();
   while ( currNode = GetNext() ) {
     currNode->index_ = n;
+    csrIndex_.Insert( currNode->logicalIx_, n );
     n++;
   }
 
@@ -1744,6 +1764,7 @@ int cvLevelSetSparseGrid::ConstructCSR()
   while ( currNode = GetNext() ) {
     edgeCnt += SetNeighborInfo( currNode );
   }
+  nodeArrays_.Build( grid_, numSparseNodes_ );
 
   // Debug:
   /*
@@ -2113,21 +2134,12 @@ void cvLevelSetSparseGrid::TopoUpdate()
 // --------------
 // IJKPresentInHT
 // --------------
-// Doing a more efficient search through these lists would be a
-// pain...
 
 int cvLevelSetSparseGrid::IJKPresentInHT( int i, int j, int k,
-				cvSortedList<TableStruct*> **bucket,
 				TableStruct **entry )
 {
-  int hashIx;
-  cvSortedList<TableStruct*> *currList;
-  TableStruct *htEntry;
-  int tagToMatch;
-  int tag;
-  cvLispListIterator<TableStruct*> *iter;
+  int ix;
 
-  (*bucket) = NULL;
   (*entry) = NULL;
 
   if ( (i < 0) || (i >= I_) ||
@@ -2136,36 +2148,19 @@ int cvLevelSetSparseGrid::IJKPresentInHT( int i, int j, int k,
     return SV_ERROR;
   }
 
-  hashIx = ComputeHashIx( i, j, k );
-  tagToMatch = IJKToDenseIx( i, j, k );
-  currList = nodeTable_[hashIx];
-  (*bucket) = currList;
-
-  iter = new cvLispListIterator<TableStruct*>(currList);
-  for ( ; !iter->IsDone(); iter->Next() ) {
-    htEntry = iter->Item();
-    tag = htEntry->tag_;
-    if ( tag < tagToMatch ) {
-      continue;
-    } else if ( tag == tagToMatch ) {
-      (*entry) = htEntry;
-      delete iter;
-      return SV_OK;
-    } else {
-      delete iter;
-      return SV_ERROR;
-    }
+  ix = htIndex_.Find( IJKToDenseIx( i, j, k ) );
+  if ( ix < 0 ) {
+    return SV_ERROR;
   }
-  delete iter;
-  return SV_ERROR;
+  (*entry) = &(htEntries_[ix]);
+  return SV_OK;
 }
 
 
 // --------------------
 // TableStructCompareFn
 // --------------------
-// This function is to be passed to the hash table list class as the
-// function to use in sorting table entries (i.e. TableStruct*'s).
+// Orders table entries (i.e. TableStruct*'s) by tag_.
 
 int TableStructCompareFn( TableStruct *a, TableStruct *b )
 {
@@ -2183,14 +2178,11 @@ int TableStructCompareFn( TableStruct *a, TableStruct *b )
 // ---------------
 // SetNeighborInfo
 // ---------------
-// We are going to assume that this is ONLY called from a
-// ConstructBand method AFTER all member nodes have been pushed into
-// nodeTable_.  Then, inside this method, we're going to search
-// nodeTable_ for neighbors by (i,j,k), exploiting the way in which
-// nodeTable_ was populated... i.e. hashed on (i,j) with k inserted
-// into its corresponding bucket IN SORTED ORDER.  There are six
-// neighbors to search for.  If we don't find a particular neighbor,
-// then store node's index_ instead.
+// We are going to assume that this is ONLY called from ConstructCSR
+// AFTER grid_ has been filled and csrIndex_ built.  Then, inside this
+// method, we look up the six neighbors by (i,j,k) in csrIndex_.  If
+// we don't find a particular neighbor, then store node's index_
+// instead.
 
 int cvLevelSetSparseGrid::SetNeighborInfo( cvLevelSetNode *node )
 {
@@ -2254,55 +2246,10 @@ int cvLevelSetSparseGrid::SetNeighborInfo( cvLevelSetNode *node )
 
 int cvLevelSetSparseGrid::IJKToSparseIx( int i, int j, int k )
 {
-  int baseIx_2, boundIx_2, range_2, searchIx_2, offset_2;
-  int targetIx_1, currIx_1;
-  cvLevelSetNode *currNode;
-
   if ( gridState_ < SGST_GridAllocated ) {
     return -1;
   }
-
-  baseIx_2 = 0;
-  boundIx_2 = numSparseNodes_;
-  range_2 = boundIx_2 - baseIx_2;
-  searchIx_2 = baseIx_2 + range_2 / 2;
-  targetIx_1 = IJKToDenseIx( i, j, k );
-
-  while ( ( range_2 > 1 ) && ( searchIx_2 < numSparseNodes_ ) ) {
-    currNode = &(grid_[searchIx_2]);
-    currIx_1 = IJKToDenseIx( currNode->i_, currNode->j_, currNode->k_ );
-    if ( currIx_1 == targetIx_1 ) {
-      return currNode->index_;
-    } else if ( currIx_1 < targetIx_1 ) {
-      baseIx_2 = searchIx_2;
-    } else {
-      boundIx_2 = searchIx_2;
-    }
-    range_2 = boundIx_2 - baseIx_2;
-    offset_2 = range_2 / 2;
-    searchIx_2 = baseIx_2 + offset_2;
-  }
-
-  if ( range_2 == 1 ) {
-    currNode = &(grid_[baseIx_2]);
-    currIx_1 = IJKToDenseIx( currNode->i_, currNode->j_, currNode->k_ );
-    if ( currIx_1 == targetIx_1 ) {
-      return currNode->index_;
-    }
-    if ( boundIx_2 > numSparseNodes_ ) {
-      assert(0);
-    } else if ( boundIx_2 == numSparseNodes_ ) {
-      return -1;
-    } else {
-      currNode = &(grid_[boundIx_2]);
-      currIx_1 = IJKToDenseIx( currNode->i_, currNode->j_, currNode->k_ );
-      if ( currIx_1 == targetIx_1 ) {
-	return currNode->index_;
-      }
-    }
-  }
-
-  return -1;
+  return csrIndex_.Find( IJKToDenseIx( i, j, k ) );
 }
 
 
@@ -2310,9 +2257,8 @@ int cvLevelSetSparseGrid::IJKToSparseIx( int i, int j, int k )
 // IJKPresentInCSR
 // ---------------
 // Used by GetFront and GetCSRStructure to determine which cells have
-// the appropriate neighbors to indicate voxel creation.  Use a binary
-// search scheme since we know grid_ cvLevelSetNode's are in index_ / hash table
-// tag / global sparse index order.
+// the appropriate neighbors to indicate voxel creation.  The lookup
+// goes through csrIndex_ (global dense --> global sparse).
 
 cvLevelSetNode *cvLevelSetSparseGrid::IJKPresentInCSR( int i, int j, int k )
 {
@@ -2568,30 +2514,22 @@ int cvLevelSetSparseGrid::UpdatePhi()
   */
 
 
-  cvLevelSetNode *currNode;
-  int sign_t, sign_tn;
   cvPolyData *front;
+  int p;
 
   if ( ! deltaPhiValid_ ) {
     printf("ERR: unexpected call to UpdatePhi\n");
     return SV_ERROR;
   }
 
+  // Every partition updates all of its band nodes and flags any mine
+  // node whose sign flipped.  A hit anywhere is rolled back by
+  // UndoTimeStep below, so it does not matter which node was first.
   mineHit_ = 0;
-  InitIter();
-  while ( currNode = GetNext() ) {
-    if ( ! ( currNode->state_ & CV_NODE_COVERED ) &&
-	 ! ( currNode->state_ & CV_NODE_ACTIVE ) ) {
-      continue;
-    }
-    sign_t = IntSign( currNode->phi_, tol_ );
-    currNode->phi_ += currNode->deltaPhi_;
-    if ( currNode->state_ & CV_NODE_MINE ) {
-      sign_tn = IntSign( currNode->phi_, tol_ );
-      if ( sign_t != sign_tn ) {
-	mineHit_ = 1;
-	break;
-      }
+  ForEachPartition( (PartitionKernel)&cvLevelSetSparseGrid::UpdateBandPhiPart );
+  for ( p = 0; p < numPartitions_; p++ ) {
+    if ( partFlags_[p] ) {
+      mineHit_ = 1;
     }
   }
 
@@ -2605,6 +2543,7 @@ int cvLevelSetSparseGrid::UpdatePhi()
   k3dmValid_ = 0;
   k3dgValid_ = 0;
   phiVtkValid_ = 0;
+  nodeArrays_.InvalidatePhi();
   closedPhiVtkValid_ = 0;
 
   // If we hit a mine node, then rebuild the grid structure.  Note
@@ -2629,11 +2568,60 @@ int cvLevelSetSparseGrid::UpdatePhi()
 // ------------
 
 void cvLevelSetSparseGrid::UndoTimeStep()
+{
+  ForEachPartition( (PartitionKernel)&cvLevelSetSparseGrid::UndoBandPhiPart );
+  nodeArrays_.InvalidatePhi();
+  return;
+}
+
+
+// -----------------
+// UpdateBandPhiPart
+// -----------------
+// Only nodes covered by projection or made active by EvaluateV have
+// a current deltaPhi_, so only those are moved.
+
+void cvLevelSetSparseGrid::UpdateBandPhiPart( int part, int begin, int end )
 {
   cvLevelSetNode *currNode;
+  int sign_t, sign_tn;
+  int n;
 
-  InitIter();
-  while ( currNode = GetNext() ) {
+  partFlags_[part] = 0;
+  for ( n = begin; n < end; n++ ) {
+    currNode = &(grid_[n]);
+    if ( ! ( currNode->state_ & CV_NODE_COVERED ) &&
+	 ! ( currNode->state_ & CV_NODE_ACTIVE ) ) {
+      continue;
+    }
+    sign_t = IntSign( currNode->phi_, tol_ );
+    currNode->phi_ += currNode->deltaPhi_;
+    if ( currNode->state_ & CV_NODE_MINE ) {
+      sign_tn = IntSign( currNode->phi_, tol_ );
+      if ( sign_t != sign_tn ) {
+	partFlags_[part] = 1;
+      }
+    }
+  }
+  return;
+}
+
+
+// ---------------
+// UndoBandPhiPart
+// ---------------
+
+void cvLevelSetSparseGrid::UndoBandPhiPart( int part, int begin, int end )
+{
+  cvLevelSetNode *currNode;
+  int n;
+
+  for ( n = begin; n < end; n++ ) {
+    currNode = &(grid_[n]);
+    if ( ! ( currNode->state_ & CV_NODE_COVERED ) &&
+	 ! ( currNode->state_ & CV_NODE_ACTIVE ) ) {
+      continue;
+    }
     currNode->phi_ -= currNode->deltaPhi_;
   }
   return;
@@ -2970,8 +2958,8 @@ char *cvLevelSetSparseGrid::StatString()
   if ( gridState_ < SGST_CSR ) {
     sprintf( result, "cvLevelSetSparseGrid state is pre-CSR." );
   } else {
-    sprintf( result, "nodes %d hash_buckets %d",
-	     numSparseNodes_, numBuckets_ );
+    sprintf( result, "nodes %d hash_entries %d",
+	     numSparseNodes_, htIndex_.GetNumEntries() );
   }
 
   return result;
@@ -3032,11 +3020,9 @@ int cvLevelSetSparseGrid::BuildL1Map()
   L1map_ = new int [numSparseNodes_];
   for (i = 0; i < numSparseNodes_; i++) {
 
-    // See how items are hashed into the hash table (ComputeHashIx)
-    // and how they are traversed (GetNextHTItem).  These determine
-    // the order in which grid_ elements are written, which must be
-    // s.t. the global dense indices (i.e. hash table entry tag_'s)
-    // are ordered consistently with the global sparse ordering.
+    // grid_ is sorted on the global dense index in ConstructCSR, so
+    // the global dense indices (i.e. hash table entry tag_'s) are
+    // ordered consistently with the global sparse ordering.
     // Confused?  See notes, week of 10/18/99.
 
     L1map_[i] = IJKToDenseIx( grid_[i].i_, grid_[i].j_, grid_[i].k_ );
@@ -3359,12 +3345,11 @@ int cvLevelSetSparseGrid::GetMemoryUsage()
   if ( seedInterface_ ) {
     sz += seedInterface_->GetMemoryUsage();
   }
-  if ( nodeTable_ ) {
-    sz += numBuckets_ * sizeof( cvSortedList<TableStruct*> );
-  }
-  if ( htIter_ ) {
-    sz += sizeof( cvLispListIterator<TableStruct*> );
+  if ( htEntries_ ) {
+    sz += htAlloc_ * sizeof( TableStruct );
   }
+  sz += htIndex_.GetMemoryUsage();
+  sz += csrIndex_.GetMemoryUsage();
   sz += topoOverlay_->GetMemoryUsage();
   if ( adjIa_ ) {
     sz += iaSz_ * sizeof(int);
@@ -3373,7 +3358,6 @@ int cvLevelSetSparseGrid::GetMemoryUsage()
     sz += jaSz_ * sizeof(int);
   }
   if ( color_ ) {
-    printf("ERR: unexpected allocated component color_ found.\n");
     sz += numSparseNodes_ * sizeof(int);
   }
   if ( L1map_ ) {
@@ -3391,16 +3375,24 @@ int cvLevelSetSparseGrid::GetMemoryUsage()
 // --------------
 // PartitionGraph
 // --------------
+// Builds color_ from the contiguous node blocks used for
+// thread-parallel evolution (see cvLevelSetStructuredGrid::
+// PartitionNodes).  Sparse nodes are numbered in dense i-fastest
+// order, so each block is a slab of the band and the edge cut is
+// limited to the slab faces.
 
 int cvLevelSetSparseGrid::PartitionGraph( int numParts )
 {
-  int i;
+  int i, p;
 
   if ( gridState_ < SGST_CSR ) {
     return SV_ERROR;
   }
-  if ( gridState_ == SGST_Partitioned ) {
-    return SV_OK;
+  if ( ! partitionValid_ || ( numPartitions_ != numParts ) ||
+       ( partitionedNodes_ != numSparseNodes_ ) ) {
+    if ( cvLevelSetStructuredGrid::PartitionNodes( numParts ) != SV_OK ) {
+      return SV_ERROR;
+    }
   }
 
   // Prepare weightings:
@@ -3414,20 +3406,51 @@ int cvLevelSetSparseGrid::PartitionGraph( int numParts )
   // nodes... but by deferring allocation until we're actually about
   // to do a partitioning, we avoid using up that memory in serial
   // (non-partitioned) cases.
+  if ( color_ != NULL ) {
+    delete [] color_;
+  }
+  color_ = new int [numSparseNodes_];
 
-  // Call METIS.
-
-  // For now, serial partitioning:
-  for ( i = 0; i < numSparseNodes_; i++ ) {
-    color_[i] = 0;
+  for ( p = 0; p < numPartitions_; p++ ) {
+    for ( i = partOffsets_[p]; i < partOffsets_[p+1]; i++ ) {
+      color_[i] = p;
+    }
   }
 
   gridState_ = SGST_Partitioned;
-  numParts_ = numParts;
+  numParts_ = numPartitions_;
   return SV_OK;
 }
 
 
+// --------------
+// PartitionNodes
+// --------------
+
+int cvLevelSetSparseGrid::PartitionNodes( int numParts )
+{
+  if ( cvLevelSetStructuredGrid::PartitionNodes( numParts ) != SV_OK ) {
+    return SV_ERROR;
+  }
+  if ( gridState_ < SGST_CSR ) {
+    return SV_OK;
+  }
+
+  // Serial runs don't need a partition vector:
+  if ( numPartitions_ < 2 ) {
+    if ( color_ != NULL ) {
+      delete [] color_;
+      color_ = NULL;
+    }
+    if ( gridState_ > SGST_CSR ) {
+      gridState_ = SGST_CSR;
+    }
+    return SV_OK;
+  }
+  return PartitionGraph( numPartitions_ );
+}
+
+
 // ----------------
 // PackagePartition
 // ----------------
@@ -36,7 +36,7 @@
 #include "svLSetExports.h" // For exports
 #include "sv2_LevelSetStructuredGrid.h"
 #include "sv2_StateArray.h"
-#include "sv_LispList.hxx"
+#include "sv2_LevelSetIndexTable.h"
 
 
 // It's probably true that none of these enum's should be exposed in
@@ -129,6 +129,11 @@ public:
   int PartitionGraph( int numParts );
   int PackagePartition( int partNum );
 
+protected:
+
+  // Thread-parallel evolution partitions double as the color_ vector:
+  int PartitionNodes( int numParts );
+
 private:
 
   int InitSign_Internal( cvPolyData *front );
@@ -150,6 +155,8 @@ private:
   // and attempts to rebuild the grid based on the current phi values
   // will not capture that part of the front.
   void UndoTimeStep();
+  void UpdateBandPhiPart( int part, int begin, int end );
+  void UndoBandPhiPart( int part, int begin, int end );
 
   // seedInterface_ lets us build our grid near the interface of a
   // given cvSolidModel seed subject to the constraints of a given
@@ -160,27 +167,19 @@ private:
 
   // Hash table for band definition:
   // ---
-  // Note that this hash table is implemented as an *array* of the
-  // template class SortedList from the Berkeley list package.  As
-  // such, the nodeTable_ array pointer has no sorting associated with
-  // it... only the items of each array element (i.e. the items of
-  // each SortedList) are sorted.
+  // Band entries are appended to the flat array htEntries_ and
+  // htIndex_ maps a node's global dense index (its tag_) to its
+  // position in that array.  Entries are generated by marching the
+  // dense grid in (k,j,i) order, so iterating through htEntries_
+  // (InitHTIterator / GetNextHTItem) visits them in dense index
+  // order.  This is NOT the order of the old bucketed hash table;
+  // ConstructCSR sorts grid_ on the dense index afterwards, which is
+  // what keeps the sparse ordering independent of iteration order.
+  // Removed entries keep their slot with a tag_ of -1 and are skipped
+  // by the iterator.
   // ---
-  // In choosing a hash function for the table, we need to consider
-  // the fact that we will need to search the table by (i,j,k) logical
-  // node indices.  This search will be done several times for each
-  // sparse node as part of the cvLevelSetSparseGrid::ConstructNeighborInfo
-  // method.  Some alternatives:
-  //
-  //   1. h = (i+j) % n;        --> potentially many (i,j)'s per bucket
-  //   2. h = (j * iDim) + i;   --> one (i,j) per bucket
-  //
-  // Once we've stored all the entries and are actually ready to
-  // search the table, if we use (1), we'll have a more compact table,
-  // but we'll have to do a more complicated search within the bucket
-  // (i.e. SortedList).  If we use (2), we can do simple sorting /
-  // searching within buckets based on k, but there could be many many
-  // empty buckets in the table.
+  // Neighbor searches by (i,j,k) are a single probe sequence in
+  // htIndex_, with no allocation and no list traversal.
   // ---
   int ConstructHT( double ctr[], double radius );
   int ConstructHT( cvPolyData *front );
@@ -194,15 +193,16 @@ private:
   int Blot( int dim[3] );
 
   void ClearHT();
-  int IJKPresentInHT( int i, int j, int k, cvSortedList<TableStruct*> **bucket,
-		      TableStruct **entry );
-  inline int ComputeHashIx( int i, int j, int k );
-  cvSortedList<TableStruct*> **nodeTable_;
-  int numBuckets_;
+  int InsertHT( TableStruct *entry );
+  void RemoveFromHT( TableStruct *entry );
+  int IJKPresentInHT( int i, int j, int k, TableStruct **entry );
+  TableStruct *htEntries_;
+  int htSize_;
+  int htAlloc_;
+  cvLevelSetIndexTable htIndex_;
   void InitHTIterator();
   TableStruct *GetNextHTItem();
-  int htCurrBucketId_;
-  cvLispListIterator<TableStruct*> *htIter_;
+  int htCurrIx_;
 
   // Topological overlay.  Keep in mind that this overlay is being
   // kept for sign storage between band constructions.  That is, nodes
@@ -226,6 +226,9 @@ private:
   int numSparseNodes_;
   int numSparseEdges_;
 
+  // global dense index --> index into grid_, valid from SGST_GridAllocated
+  cvLevelSetIndexTable csrIndex_;
+
   int *adjIa_;
   int *adjJa_;
   int iaSz_;
@@ -282,24 +285,6 @@ private:
 // ---
 
 
-// -------------
-// ComputeHashIx
-// -------------
-// Note that this hash fn provides the needed functionality that
-// in-order traversal of (i,j,k)'s leads to a monotonic traversal of
-// hash table buckets.  This is the critical characteristic which
-// enables node-number-maps to be used efficiently (i.e. forward
-// mappings in O(log n) instead of O(n)).
-
-inline
-int cvLevelSetSparseGrid::ComputeHashIx( int i, int j, int k )
-{
-  return ( IJKToDenseIx( i, j, k ) % numBuckets_ );
-  return k;
-  return ( (j*I_) + i );
-}
-
-
 // ------------
 // IJKToDenseIx
 // ------------
@@ -40,6 +40,11 @@
 #include "sv2_IntArrayList.h"
 #include "sv_VTK.h"
 
+#include <string.h>
+#include <functional>
+#include <queue>
+#include <thread>
+
 
 // --------------
 // cvLevelSetStructuredGrid
@@ -62,6 +67,19 @@
 
 cvLevelSetStructuredGrid::cvLevelSetStructuredGrid( double h[], int dims[], double o[] )
 {
+  reinitMethod_ = REINIT_FRONT;
+  numThreads_ = 1;
+  numPartitions_ = 0;
+  partitionValid_ = 0;
+  partitionedNodes_ = 0;
+  partitionBusy_ = 0;
+  partOffsets_ = NULL;
+  partMax_ = NULL;
+  partFlags_ = NULL;
+  evalVfn_ = NULL;
+  deltaPhiDt_ = 0.0;
+  deltaPhiMaxF_ = 0.0;
+
   if ( (dims[0] < 1) || (dims[1] < 1) || (dims[2] < 1) ) {
     return;
   }
@@ -147,6 +165,114 @@ cvLevelSetStructuredGrid::~cvLevelSetStructuredGrid()
   if ( phiVtk_ ) {
     phiVtk_->Delete();
   }
+  delete [] partOffsets_;
+  delete [] partMax_;
+  delete [] partFlags_;
+}
+
+
+// -------------
+// SetNumThreads
+// -------------
+
+void cvLevelSetStructuredGrid::SetNumThreads( int n )
+{
+  if ( n < 1 ) {
+    n = 1;
+  }
+  numThreads_ = n;
+  InvalidatePartitions();
+  return;
+}
+
+
+// --------------
+// PartitionNodes
+// --------------
+// Split grid_ into numParts contiguous blocks of (nearly) equal
+// size.  Nodes are numbered in i-fastest order by both the dense and
+// sparse grids, so contiguous blocks are also spatially compact slabs
+// and only the nodes on either face of a slab read values owned by
+// another partition.  Derived classes may override this to build
+// their own partition data, but must keep partOffsets_ consistent.
+
+int cvLevelSetStructuredGrid::PartitionNodes( int numParts )
+{
+  int numNodes = nodeArrays_.GetNumNodes();
+  int p;
+
+  if ( numParts < 1 ) {
+    return SV_ERROR;
+  }
+  if ( numParts > numNodes ) {
+    numParts = ( numNodes > 0 ) ? numNodes : 1;
+  }
+
+  if ( numParts != numPartitions_ ) {
+    delete [] partOffsets_;
+    delete [] partMax_;
+    delete [] partFlags_;
+    partOffsets_ = new int [numParts + 1];
+    partMax_ = new double [numParts];
+    partFlags_ = new int [numParts];
+    vSamples_.resize( numParts );
+    numPartitions_ = numParts;
+  }
+
+  for ( p = 0; p <= numParts; p++ ) {
+    partOffsets_[p] = (int)( ( (long long)p * numNodes ) / numParts );
+  }
+
+  partitionedNodes_ = numNodes;
+  partitionValid_ = 1;
+  return SV_OK;
+}
+
+
+// ----------------
+// ForEachPartition
+// ----------------
+// Run kernel once per partition, one thread per partition, with the
+// calling thread taking partition 0.  Returns after all partitions
+// are done, so consecutive calls are separated by a barrier.  Kernels
+// may read anything but must only write to the nodes (and
+// nodeArrays_ entries) of their own partition, plus their own
+// partMax_ / partFlags_ / vSamples_ slot.
+
+void cvLevelSetStructuredGrid::ForEachPartition( PartitionKernel kernel )
+{
+  std::vector<std::thread> workers;
+  int p;
+
+  if ( ! partitionValid_ ||
+       ( partitionedNodes_ != nodeArrays_.GetNumNodes() ) ) {
+    if ( PartitionNodes( numThreads_ ) != SV_OK ) {
+      return;
+    }
+  }
+
+  // A kernel which (indirectly) calls back into a parallel method
+  // runs the inner loop serially on its own thread:
+  if ( ( numPartitions_ == 1 ) || partitionBusy_ ) {
+    for ( p = 0; p < numPartitions_; p++ ) {
+      (this->*kernel)( p, partOffsets_[p], partOffsets_[p+1] );
+    }
+    return;
+  }
+
+  partitionBusy_ = 1;
+  workers.reserve( numPartitions_ - 1 );
+  for ( p = 1; p < numPartitions_; p++ ) {
+    workers.push_back( std::thread( kernel, this, p, partOffsets_[p],
+				    partOffsets_[p+1] ) );
+  }
+  (this->*kernel)( 0, partOffsets_[0], partOffsets_[1] );
+  for ( p = 0; p < (int)workers.size(); p++ ) {
+    workers[p].join();
+  }
+  partitionBusy_ = 0;
+
+  return;
 }
 
 
@@ -168,6 +294,7 @@ int cvLevelSetStructuredGrid::CloseHoles()
     }
   }
   phiVtkValid_ = 0;
+  nodeArrays_.InvalidatePhi();
   return SV_OK;
 }
 
@@ -175,125 +302,71 @@ int cvLevelSetStructuredGrid::CloseHoles()
 // ---------
 // EvaluateV
 // ---------
+// Velocity samples are taken partition by partition (see
+// EvaluateVPart) and then applied to the grid in node order.  The
+// velocity function is evaluated concurrently, so it must not modify
+// shared state in Evaluate; anything it caches lazily should be set
+// up in PrepareEvaluate.
 
 int cvLevelSetStructuredGrid::EvaluateV( cvLevelSetVelocity *vfn, double factor )
 {
-  int i, j, k, ix;
-  cvLevelSetNode *currNode;
-  cvLevelSetNode *adjNode;
-  double tol;
-  int adjIxs[6];
-  char c;
-  double f0, f1, mag;
+  int p, i;
+  VelocitySample *s;
   int status = SV_OK;
-  double zls[3];
-  double v[3];
-  int forceMinVFlag;
-  double toDot[3] = {0.0, 0.0, 0.0};  // initialization is critical!
-
-  // Stuff to build up the set of velocity vectors:
-  vtkPolyData *pd = vtkPolyData::New();
-  vtkPoints *pts = vtkPoints::New();
-  vtkFloatingPointArrayType *vec = vtkFloatingPointArrayType::New();
-  vec->SetNumberOfComponents(3);
-  pts->Allocate(100,100);
-  vec->Allocate(100,100);
-  vtkFloatingPointType zlsf[3];
-  vtkFloatingPointType vf[3];
 
   if ( ! vfn->Valid() ) {
     return SV_ERROR;
   }
-
-  tol = relTol_ * minh_;
-  k = 0;
+  if ( vfn->PrepareEvaluate() != SV_OK ) {
+    return SV_ERROR;
+  }
 
   FindK();
   FindN();
   ClearActive();
   ClearForceMinV();
 
-  // Foreach grid node:
-  InitIter();
-  while ( currNode = GetNext() ) {
-
-    // If phi(i) ~= 0:
-    if ( fabs( currNode->phi_ ) < tol_ ) {
-      zls[0] = currNode->pos_[0];
-      zls[1] = currNode->pos_[1];
-      zls[2] = currNode->pos_[2];
-      status = vfn->Evaluate( zls, &f0, &f1, v, &forceMinVFlag, toDot );
-      if ( status != SV_OK ) {
-	break;  // i.e. out of global node loop
-      }
-      mag = fabs( f0 + f1 );
-
-      AssignNode( currNode, f0, f1, forceMinVFlag, toDot );
-
-      zlsf[0] = zls[0];
-      zlsf[1] = zls[1];
-      zlsf[2] = zls[2];
-      //pts->InsertPoint( k, zlsf );
-      pts->InsertNextPoint(zlsf);
-      vf[0] = v[0];
-      vf[1] = v[1];
-      vf[2] = v[2];
-      //vec->InsertTuple( k, vf );
-      vec->InsertNextTuple(vf);
-      k++;
+  evalVfn_ = vfn;
+  ForEachPartition( &cvLevelSetStructuredGrid::EvaluateVPart );
+  evalVfn_ = NULL;
 
-      continue;
-    }
+  // Stuff to build up the set of velocity vectors:
+  vtkPolyData *pd = vtkPolyData::New();
+  vtkPoints *pts = vtkPoints::New();
+  vtkFloatingPointArrayType *vec = vtkFloatingPointArrayType::New();
+  vec->SetNumberOfComponents(3);
+  pts->Allocate(100,100);
+  vec->Allocate(100,100);
+  vtkFloatingPointType zlsf[3];
+  vtkFloatingPointType vf[3];
 
-    // Look for active edges radiating from i:
-    GetAdjacentIxs( currNode, adjIxs );
-    for (j = 0; j < 6; j++) {
-      ix = adjIxs[j];
-      if ( ix >= 0 ) {
-	adjNode = &(grid_[ix]);
-
-	// If this pair of nodes have phi of opposite sign, then:
-	//   - set the direction code c
-	//   - interpolate the zls position
-	//   - evaluate velocity at the zls
-	//   - set active bits for curr and adj if not already set
-	//   - assign v components as above
-	if ( ( currNode->phi_ * adjNode->phi_ ) < 0.0 ) {
-	  if ( j < 2 ) {
-	    c = 'x';
-	  } else if ( j < 4 ) {
-	    c = 'y';
-	  } else if ( j < 6 ) {
-	    c = 'z';
-	  }
-	  InterpZLS( currNode, adjNode, c, zls );
-	  status = vfn->Evaluate( zls, &f0, &f1, v, &forceMinVFlag, toDot );
-	  if ( status != SV_OK ) {
-	    break;  // i.e. out of local radiating edge loop
-	  }
-	  mag = fabs( f0 + f1 );
-
-	  AssignNode( currNode, f0, f1, forceMinVFlag, toDot );
-	  AssignNode( adjNode, f0, f1, forceMinVFlag, toDot );
-
-	  zlsf[0] = zls[0];
-	  zlsf[1] = zls[1];
-	  zlsf[2] = zls[2];
-	  //pts->InsertPoint( k, zlsf );
-          pts->InsertNextPoint( zlsf );
-	  vf[0] = v[0];
-	  vf[1] = v[1];
-	  vf[2] = v[2];
-	  //vec->InsertTuple( k, vf );
-          vec->InsertNextTuple(vf);
-	  k++;
+  // Apply samples in node order.  A failed sample is the last one its
+  // partition recorded, and ends the sweep just as it would have
+  // ended a serial loop over the nodes:
+  for ( p = 0; p < numPartitions_; p++ ) {
+    for ( i = 0; i < (int)vSamples_[p].size(); i++ ) {
+      s = &( vSamples_[p][i] );
+      if ( s->status != SV_OK ) {
+	status = SV_ERROR;
+	break;
+      }
 
-	  continue;
-	}
+      AssignNode( &(grid_[s->nodeIx]), s->f0, s->f1, s->forceMinVFlag, s->toDot );
+      if ( s->adjIx >= 0 ) {
+	AssignNode( &(grid_[s->adjIx]), s->f0, s->f1, s->forceMinVFlag, s->toDot );
       }
+
+      zlsf[0] = s->zls[0];
+      zlsf[1] = s->zls[1];
+      zlsf[2] = s->zls[2];
+      pts->InsertNextPoint( zlsf );
+      vf[0] = s->v[0];
+      vf[1] = s->v[1];
+      vf[2] = s->v[2];
+      vec->InsertNextTuple( vf );
     }
     if ( status != SV_OK ) {
-      break;  // i.e. out of global node loop
+      break;
     }
   }
 
@@ -322,6 +395,85 @@ int cvLevelSetStructuredGrid::EvaluateV( cvLevelSetVelocity *vfn, double factor
 }
 
 
+// -------------
+// EvaluateVPart
+// -------------
+// Evaluate velocity wherever the zero level set passes through or
+// next to a node in [begin, end): once on the node itself if
+// phi ~= 0, otherwise once per sign-changing edge radiating from the
+// node.  Stops at the first failed evaluation.
+
+void cvLevelSetStructuredGrid::EvaluateVPart( int part, int begin, int end )
+{
+  std::vector<VelocitySample> &samples = vSamples_[part];
+  VelocitySample s;
+  cvLevelSetNode *currNode;
+  cvLevelSetNode *adjNode;
+  int adjIxs[6];
+  int n, j, ix;
+  char c;
+
+  samples.clear();
+
+  for ( n = begin; n < end; n++ ) {
+    currNode = &(grid_[n]);
+
+    // If phi(i) ~= 0:
+    if ( fabs( currNode->phi_ ) < tol_ ) {
+      s.nodeIx = n;
+      s.adjIx = -1;
+      s.zls[0] = currNode->pos_[0];
+      s.zls[1] = currNode->pos_[1];
+      s.zls[2] = currNode->pos_[2];
+      s.toDot[0] = 0.0;  // initialization is critical!
+      s.toDot[1] = 0.0;
+      s.toDot[2] = 0.0;
+      s.status = evalVfn_->Evaluate( s.zls, &s.f0, &s.f1, s.v,
+				     &s.forceMinVFlag, s.toDot );
+      samples.push_back( s );
+      if ( s.status != SV_OK ) {
+	return;
+      }
+      continue;
+    }
+
+    // Look for active edges radiating from i:
+    GetAdjacentIxs( currNode, adjIxs );
+    for (j = 0; j < 6; j++) {
+      ix = adjIxs[j];
+      if ( ix < 0 ) {
+	continue;
+      }
+      adjNode = &(grid_[ix]);
+      if ( ( currNode->phi_ * adjNode->phi_ ) >= 0.0 ) {
+	continue;
+      }
+      if ( j < 2 ) {
+	c = 'x';
+      } else if ( j < 4 ) {
+	c = 'y';
+      } else {
+	c = 'z';
+      }
+      s.nodeIx = n;
+      s.adjIx = ix;
+      InterpZLS( currNode, adjNode, c, s.zls );
+      s.toDot[0] = 0.0;
+      s.toDot[1] = 0.0;
+      s.toDot[2] = 0.0;
+      s.status = evalVfn_->Evaluate( s.zls, &s.f0, &s.f1, s.v,
+				     &s.forceMinVFlag, s.toDot );
+      samples.push_back( s );
+      if ( s.status != SV_OK ) {
+	return;
+      }
+    }
+  }
+
+  return;
+}
+
+
 // ---------------
 // ComputeDeltaPhi
 // ---------------
@@ -330,15 +482,11 @@ int cvLevelSetStructuredGrid::EvaluateV( cvLevelSetVelocity *vfn, double factor
 
 double cvLevelSetStructuredGrid::ComputeDeltaPhi( double factor )
 {
-  cvLevelSetNode *currNode;
-  double f0Contrib, f1Contrib;
-  double maxVal, minVal;
-  double tmp, f1MagGradPhi;
-  double phi_t;
-  double v;
+  double maxf;
   double dt;
 
-  dt = ComputeDt( factor );
+  maxf = GetMaxF();
+  dt = ComputeDt( maxf, factor );
 
   // ComputeDt returns a negative value if maxF < tol_, signifying a
   // stop condition which is independent of the user-specified stopV
@@ -356,8 +504,34 @@ double cvLevelSetStructuredGrid::ComputeDeltaPhi( double factor )
   FindDelMinus();
   FindN();
 
-  InitIter();
-  while ( currNode = GetNext() ) {
+  deltaPhiDt_ = dt;
+  deltaPhiMaxF_ = maxf;
+  ForEachPartition( &cvLevelSetStructuredGrid::ComputeDeltaPhiPart );
+
+  deltaPhiValid_ = 1;
+
+  return dt;
+}
+
+
+// -------------------
+// ComputeDeltaPhiPart
+// -------------------
+
+void cvLevelSetStructuredGrid::ComputeDeltaPhiPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int n;
+  cvLevelSetNode *currNode;
+  double f0Contrib, f1Contrib;
+  double maxVal, minVal;
+  double tmp, f1MagGradPhi;
+  double phi_t;
+  double v;
+  double dt = deltaPhiDt_;
+
+  for ( n = begin; n < end; n++ ) {
+    currNode = &(grid_[n]);
 
     // This should be relevant for cvLevelSetSparseGrid only, but in general is
     // not a harmful thing to include at the abstract cvLevelSetStructuredGrid
@@ -372,13 +546,13 @@ double cvLevelSetStructuredGrid::ComputeDeltaPhi( double factor )
     // this term to phi_t:
     maxVal = svmaximum( currNode->F0_, 0.0 );
     minVal = svminimum( currNode->F0_, 0.0 );
-    f0Contrib = maxVal * currNode->delPlus_ + minVal * currNode->delMinus_;
+    f0Contrib = maxVal * na->delPlus_[n] + minVal * na->delMinus_[n];
 
     // Put this in on 2/16/00 as part of an attempt to deal with
     // singularities in the distance function:
     /*
-    if ( ( fabs(currNode->delPlus_) < tol_ ) &&
-	 ( fabs(currNode->delMinus_) < tol_ ) ) {
+    if ( ( fabs(na->delPlus_[n]) < tol_ ) &&
+	 ( fabs(na->delMinus_[n]) < tol_ ) ) {
       f0Contrib = IntSign( currNode->F0_, tol_ ) * relTol_;
     }
     */
@@ -387,9 +561,9 @@ double cvLevelSetStructuredGrid::ComputeDeltaPhi( double factor )
     // gradient with the curvature-dependent portion of velocity
     // (since curvature dependence corresponds to diffusive flow of
     // information):
-    tmp = currNode->d0_[0] * currNode->d0_[0];
-    tmp += currNode->d0_[1] * currNode->d0_[1];
-    tmp += currNode->d0_[2] * currNode->d0_[2];
+    tmp = na->d0_[0][n] * na->d0_[0][n];
+    tmp += na->d0_[1][n] * na->d0_[1][n];
+    tmp += na->d0_[2][n] * na->d0_[2][n];
     f1MagGradPhi = sqrt( tmp );
     f1Contrib = currNode->F1_ * f1MagGradPhi;
 
@@ -425,14 +599,12 @@ double cvLevelSetStructuredGrid::ComputeDeltaPhi( double factor )
 	printf( "  CFL violation (nodeId=%d): 2*v*dt = %f\n",
 		currNode->index_, 2*v*dt );
 	printf("   minH [%f]\t maxF [%f]\t v [%f]\t dt [%f]\n",
-	       minh_, GetMaxF(), v, dt );
+	       minh_, deltaPhiMaxF_, v, dt );
       }
     }
   }
 
-  deltaPhiValid_ = 1;
-
-  return dt;
+  return;
 }
 
 
@@ -442,18 +614,12 @@ double cvLevelSetStructuredGrid::ComputeDeltaPhi( double factor )
 
 int cvLevelSetStructuredGrid::UpdatePhi()
 {
-  cvLevelSetNode *currNode;
-  double dt;
-
   if ( ! deltaPhiValid_ ) {
     printf("ERR: unexpected call to UpdatePhi\n");
     return SV_ERROR;
   }
 
-  InitIter();
-  while ( currNode = GetNext() ) {
-    currNode->phi_ += currNode->deltaPhi_;
-  }
+  ForEachPartition( &cvLevelSetStructuredGrid::UpdatePhiPart );
 
 
   /* Old as of 2/19/00:
@@ -558,11 +724,27 @@ int cvLevelSetStructuredGrid::UpdatePhi()
   k3dmValid_ = 0;
   k3dgValid_ = 0;
   phiVtkValid_ = 0;
+  nodeArrays_.InvalidatePhi();
 
   return SV_OK;
 }
 
 
+// -------------
+// UpdatePhiPart
+// -------------
+
+void cvLevelSetStructuredGrid::UpdatePhiPart( int part, int begin, int end )
+{
+  int n;
+
+  for ( n = begin; n < end; n++ ) {
+    grid_[n].phi_ += grid_[n].deltaPhi_;
+  }
+  return;
+}
+
+
 // --------------
 // GetAdjacentIxs
 // --------------
@@ -689,6 +871,7 @@ int cvLevelSetStructuredGrid::GetStructuredGridMemoryUsage()
   if ( phiVtk_ ) {
     sz += phiVtk_->GetActualMemorySize() * 1024;  // vtk returns kB
   }
+  sz += nodeArrays_.GetMemoryUsage();
 
   return sz;
 }
@@ -705,141 +888,92 @@ void cvLevelSetStructuredGrid::FindD0()
 {
   if (!d0Valid_) {
     FindD0i();
-    FindD0xi();
-    FindD0yi();
-    FindD0zi();
+    FindD0ii();
     d0Valid_ = 1;
   }
   return;
 }
 
 
-// -------
-// FindD0i
-// -------
-// i.e. Find D0x, D0y, D0z.
+// ---------------------
+// LsetGrid_CenteredDiff
+// ---------------------
+// The difference kernels below loop over a [begin, end) range of
+// nodeArrays_ by node index rather than over the cvLevelSetNode list.
+// Each loop reads one contiguous input array through the neighbor
+// index arrays and writes one contiguous output array, which lets the
+// compiler vectorize them.
 
-void cvLevelSetStructuredGrid::FindD0i()
+static void LsetGrid_CenteredDiff( int begin, int end, const double *src,
+				   const int *prevIx, const int *nextIx,
+				   double twoH, double *dst )
 {
-  cvLevelSetNode *currNode, *prevNode, *nextNode;
-  double prev, next;
-  double twoHx, twoHy, twoHz;
-
-  twoHx = 2 * hv_[0];
-  twoHy = 2 * hv_[1];
-  twoHz = 2 * hv_[2];
-
-  InitIter();
-  while ( currNode = GetNext() ) {
-
-    // First find centered x difference:
-    prevNode = &(grid_[currNode->xPrevIndex_]);
-    nextNode = &(grid_[currNode->xNextIndex_]);
-    prev = prevNode->phi_;
-    next = nextNode->phi_;
-    currNode->d0_[0] = (next - prev) / twoHx;
+  int n;
 
-    // Now find centered y difference:
-    prevNode = &(grid_[currNode->yPrevIndex_]);
-    nextNode = &(grid_[currNode->yNextIndex_]);
-    prev = prevNode->phi_;
-    next = nextNode->phi_;
-    currNode->d0_[1] = (next - prev) / twoHy;
-
-    // Finally, find centered z difference:
-    prevNode = &(grid_[currNode->zPrevIndex_]);
-    nextNode = &(grid_[currNode->zNextIndex_]);
-    prev = prevNode->phi_;
-    next = nextNode->phi_;
-    currNode->d0_[2] = (next - prev) / twoHz;
+  for ( n = begin; n < end; n++ ) {
+    dst[n] = ( src[nextIx[n]] - src[prevIx[n]] ) / twoH;
   }
-
   return;
 }
 
 
-// --------
-// FindD0xi
-// --------
-// i.e. Find D0xx, D0xy, D0xz.
+// --------------------
+// LsetGrid_ForwardDiff
+// --------------------
 
-void cvLevelSetStructuredGrid::FindD0xi()
+static void LsetGrid_ForwardDiff( int begin, int end, const double *phi,
+				  const int *nextIx, double h, double *dst )
 {
-  cvLevelSetNode *currNode, *prevNode, *nextNode;
-  double prev, next;
-  double twoHx, twoHy, twoHz;
+  int n;
 
-  twoHx = 2 * hv_[0];
-  twoHy = 2 * hv_[1];
-  twoHz = 2 * hv_[2];
+  for ( n = begin; n < end; n++ ) {
+    dst[n] = ( phi[nextIx[n]] - phi[n] ) / h;
+  }
+  return;
+}
 
-  InitIter();
-  while ( currNode = GetNext() ) {
 
-    // D0xx:
-    prevNode = &(grid_[currNode->xPrevIndex_]);
-    nextNode = &(grid_[currNode->xNextIndex_]);
-    prev = prevNode->d0_[0];
-    next = nextNode->d0_[0];
-    currNode->d0x_[0] = (next - prev) / twoHx;
+// ---------------------
+// LsetGrid_BackwardDiff
+// ---------------------
 
-    // D0xy:
-    prevNode = &(grid_[currNode->yPrevIndex_]);
-    nextNode = &(grid_[currNode->yNextIndex_]);
-    prev = prevNode->d0_[0];
-    next = nextNode->d0_[0];
-    currNode->d0x_[1] = (next - prev) / twoHy;
+static void LsetGrid_BackwardDiff( int begin, int end, const double *phi,
+				   const int *prevIx, double h, double *dst )
+{
+  int n;
 
-    // D0xz:
-    prevNode = &(grid_[currNode->zPrevIndex_]);
-    nextNode = &(grid_[currNode->zNextIndex_]);
-    prev = prevNode->d0_[0];
-    next = nextNode->d0_[0];
-    currNode->d0x_[2] = (next - prev) / twoHz;
+  for ( n = begin; n < end; n++ ) {
+    dst[n] = ( phi[n] - phi[prevIx[n]] ) / h;
   }
-
   return;
 }
 
 
-// --------
-// FindD0yi
-// --------
-// i.e. Find D0yx, D0yy, D0yz.
+// -------
+// FindD0i
+// -------
+// i.e. Find D0x, D0y, D0z.
 
-void cvLevelSetStructuredGrid::FindD0yi()
+void cvLevelSetStructuredGrid::FindD0i()
 {
-  cvLevelSetNode *currNode, *prevNode, *nextNode;
-  double prev, next;
-  double twoHx, twoHy, twoHz;
-
-  twoHx = 2 * hv_[0];
-  twoHy = 2 * hv_[1];
-  twoHz = 2 * hv_[2];
+  nodeArrays_.GatherPhi( grid_ );
+  ForEachPartition( &cvLevelSetStructuredGrid::FindD0iPart );
+  return;
+}
 
-  InitIter();
-  while ( currNode = GetNext() ) {
 
-    // D0yx:
-    prevNode = &(grid_[currNode->xPrevIndex_]);
-    nextNode = &(grid_[currNode->xNextIndex_]);
-    prev = prevNode->d0_[1];
-    next = nextNode->d0_[1];
-    currNode->d0y_[0] = (next - prev) / twoHx;
+// -----------
+// FindD0iPart
+// -----------
 
-    // D0yy:
-    prevNode = &(grid_[currNode->yPrevIndex_]);
-    nextNode = &(grid_[currNode->yNextIndex_]);
-    prev = prevNode->d0_[1];
-    next = nextNode->d0_[1];
-    currNode->d0y_[1] = (next - prev) / twoHy;
+void cvLevelSetStructuredGrid::FindD0iPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int dir;
 
-    // D0yz:
-    prevNode = &(grid_[currNode->zPrevIndex_]);
-    nextNode = &(grid_[currNode->zNextIndex_]);
-    prev = prevNode->d0_[1];
-    next = nextNode->d0_[1];
-    currNode->d0y_[2] = (next - prev) / twoHz;
+  for ( dir = 0; dir < 3; dir++ ) {
+    LsetGrid_CenteredDiff( begin, end, na->phi_, na->prev_[dir], na->next_[dir],
+			   2 * hv_[dir], na->d0_[dir] );
   }
 
   return;
@@ -847,43 +981,38 @@ void cvLevelSetStructuredGrid::FindD0yi()
 
 
 // --------
-// FindD0zi
+// FindD0ii
 // --------
-// i.e. Find D0zx, D0zy, D0zz.
+// i.e. Find D0xx, D0xy, D0xz, D0yx, ... D0zz.  All nine only read the
+// D0i arrays, so they share one pass over the partitions.
 
-void cvLevelSetStructuredGrid::FindD0zi()
+void cvLevelSetStructuredGrid::FindD0ii()
 {
-  cvLevelSetNode *currNode, *prevNode, *nextNode;
-  double prev, next;
-  double twoHx, twoHy, twoHz;
+  ForEachPartition( &cvLevelSetStructuredGrid::FindD0iiPart );
+  return;
+}
 
-  twoHx = 2 * hv_[0];
-  twoHy = 2 * hv_[1];
-  twoHz = 2 * hv_[2];
 
-  InitIter();
-  while ( currNode = GetNext() ) {
-
-    // D0zx:
-    prevNode = &(grid_[currNode->xPrevIndex_]);
-    nextNode = &(grid_[currNode->xNextIndex_]);
-    prev = prevNode->d0_[2];
-    next = nextNode->d0_[2];
-    currNode->d0z_[0] = (next - prev) / twoHx;
+// ------------
+// FindD0iiPart
+// ------------
 
-    // D0zy:
-    prevNode = &(grid_[currNode->yPrevIndex_]);
-    nextNode = &(grid_[currNode->yNextIndex_]);
-    prev = prevNode->d0_[2];
-    next = nextNode->d0_[2];
-    currNode->d0z_[1] = (next - prev) / twoHy;
+void cvLevelSetStructuredGrid::FindD0iiPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int dir;
 
-    // D0zz:
-    prevNode = &(grid_[currNode->zPrevIndex_]);
-    nextNode = &(grid_[currNode->zNextIndex_]);
-    prev = prevNode->d0_[2];
-    next = nextNode->d0_[2];
-    currNode->d0z_[2] = (next - prev) / twoHz;
+  for ( dir = 0; dir < 3; dir++ ) {
+    LsetGrid_CenteredDiff( begin, end, na->d0_[0], na->prev_[dir], na->next_[dir],
+			   2 * hv_[dir], na->d0x_[dir] );
+  }
+  for ( dir = 0; dir < 3; dir++ ) {
+    LsetGrid_CenteredDiff( begin, end, na->d0_[1], na->prev_[dir], na->next_[dir],
+			   2 * hv_[dir], na->d0y_[dir] );
+  }
+  for ( dir = 0; dir < 3; dir++ ) {
+    LsetGrid_CenteredDiff( begin, end, na->d0_[2], na->prev_[dir], na->next_[dir],
+			   2 * hv_[dir], na->d0z_[dir] );
   }
 
   return;
@@ -897,33 +1026,28 @@ void cvLevelSetStructuredGrid::FindD0zi()
 
 void cvLevelSetStructuredGrid::FindDpi()
 {
-  cvLevelSetNode *currNode, *nextNode;
-  double curr, next;
-
   if (!dpiValid_) {
+    nodeArrays_.GatherPhi( grid_ );
+    ForEachPartition( &cvLevelSetStructuredGrid::FindDpiPart );
+    dpiValid_ = 1;
+  }
 
-    InitIter();
-    while ( currNode = GetNext() ) {
-
-      curr = currNode->phi_;
+  return;
+}
 
-      // Dpx:
-      nextNode = &(grid_[currNode->xNextIndex_]);
-      next = nextNode->phi_;
-      currNode->dp_[0] = (next - curr) / hv_[0];
 
-      // Dpy:
-      nextNode = &(grid_[currNode->yNextIndex_]);
-      next = nextNode->phi_;
-      currNode->dp_[1] = (next - curr) / hv_[1];
+// -----------
+// FindDpiPart
+// -----------
 
-      // Dpz:
-      nextNode = &(grid_[currNode->zNextIndex_]);
-      next = nextNode->phi_;
-      currNode->dp_[2] = (next - curr) / hv_[2];
-    }
+void cvLevelSetStructuredGrid::FindDpiPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int dir;
 
-    dpiValid_ = 1;
+  for ( dir = 0; dir < 3; dir++ ) {
+    LsetGrid_ForwardDiff( begin, end, na->phi_, na->next_[dir],
+			  hv_[dir], na->dp_[dir] );
   }
 
   return;
@@ -937,33 +1061,28 @@ void cvLevelSetStructuredGrid::FindDpi()
 
 void cvLevelSetStructuredGrid::FindDmi()
 {
-  cvLevelSetNode *currNode, *prevNode;
-  double curr, prev;
-
   if (!dmiValid_) {
+    nodeArrays_.GatherPhi( grid_ );
+    ForEachPartition( &cvLevelSetStructuredGrid::FindDmiPart );
+    dmiValid_ = 1;
+  }
 
-    InitIter();
-    while ( currNode = GetNext() ) {
-
-      curr = currNode->phi_;
+  return;
+}
 
-      // Dmx:
-      prevNode = &(grid_[currNode->xPrevIndex_]);
-      prev = prevNode->phi_;
-      currNode->dm_[0] = (curr - prev) / hv_[0];
 
-      // Dmy:
-      prevNode = &(grid_[currNode->yPrevIndex_]);
-      prev = prevNode->phi_;
-      currNode->dm_[1] = (curr - prev) / hv_[1];
+// -----------
+// FindDmiPart
+// -----------
 
-      // Dmz:
-      prevNode = &(grid_[currNode->zPrevIndex_]);
-      prev = prevNode->phi_;
-      currNode->dm_[2] = (curr - prev) / hv_[2];
-    }
+void cvLevelSetStructuredGrid::FindDmiPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int dir;
 
-    dmiValid_ = 1;
+  for ( dir = 0; dir < 3; dir++ ) {
+    LsetGrid_BackwardDiff( begin, end, na->phi_, na->prev_[dir],
+			   hv_[dir], na->dm_[dir] );
   }
 
   return;
@@ -976,70 +1095,114 @@ void cvLevelSetStructuredGrid::FindDmi()
 
 void cvLevelSetStructuredGrid::FindDelPlus()
 {
-  cvLevelSetNode *currNode;
-  double tmp, acc;
-
-  if (!delPlusValid_) {
+  if ( ! delPlusValid_ ) {
     FindDpi();
     FindDmi();
-    InitIter();
-    while ( currNode = GetNext() ) {
-      acc = 0.0;
-      tmp = svmaximum( currNode->dm_[0], 0.0 );
-      acc += tmp * tmp;
-      tmp = svminimum( currNode->dp_[0], 0.0 );
-      acc += tmp * tmp;
-      tmp = svmaximum( currNode->dm_[1], 0.0 );
-      acc += tmp * tmp;
-      tmp = svminimum( currNode->dp_[1], 0.0 );
-      acc += tmp * tmp;
-      tmp = svmaximum( currNode->dm_[2], 0.0 );
-      acc += tmp * tmp;
-      tmp = svminimum( currNode->dp_[2], 0.0 );
-      acc += tmp * tmp;
-      currNode->delPlus_ = sqrt( acc );
-    }
+    ForEachPartition( &cvLevelSetStructuredGrid::FindDelPlusPart );
     delPlusValid_ = 1;
   }
   return;
 }
 
 
+// ---------------
+// FindDelPlusPart
+// ---------------
+
+void cvLevelSetStructuredGrid::FindDelPlusPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int n;
+  const double *dpx, *dpy, *dpz, *dmx, *dmy, *dmz;
+  double *delPlus;
+  double tmp, acc;
+
+  dpx = na->dp_[0];
+  dpy = na->dp_[1];
+  dpz = na->dp_[2];
+  dmx = na->dm_[0];
+  dmy = na->dm_[1];
+  dmz = na->dm_[2];
+  delPlus = na->delPlus_;
+
+  for ( n = begin; n < end; n++ ) {
+    acc = 0.0;
+    tmp = svmaximum( dmx[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svminimum( dpx[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svmaximum( dmy[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svminimum( dpy[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svmaximum( dmz[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svminimum( dpz[n], 0.0 );
+    acc += tmp * tmp;
+    delPlus[n] = sqrt( acc );
+  }
+
+  return;
+}
+
+
 // ------------
 // FindDelMinus
 // ------------
 
 void cvLevelSetStructuredGrid::FindDelMinus()
 {
-  cvLevelSetNode *currNode;
-  double tmp, acc;
-
-  if (!delMinusValid_) {
+  if ( ! delMinusValid_ ) {
     FindDpi();
     FindDmi();
-    InitIter();
-    while ( currNode = GetNext() ) {
-      acc = 0.0;
-      tmp = svmaximum( currNode->dp_[0], 0.0 );
-      acc += tmp * tmp;
-      tmp = svminimum( currNode->dm_[0], 0.0 );
-      acc += tmp * tmp;
-      tmp = svmaximum( currNode->dp_[1], 0.0 );
-      acc += tmp * tmp;
-      tmp = svminimum( currNode->dm_[1], 0.0 );
-      acc += tmp * tmp;
-      tmp = svmaximum( currNode->dp_[2], 0.0 );
-      acc += tmp * tmp;
-      tmp = svminimum( currNode->dm_[2], 0.0 );
-      acc += tmp * tmp;
-      currNode->delMinus_ = sqrt( acc );
-    }
+    ForEachPartition( &cvLevelSetStructuredGrid::FindDelMinusPart );
     delMinusValid_ = 1;
   }
   return;
 }
 
 
+// ----------------
+// FindDelMinusPart
+// ----------------
+
+void cvLevelSetStructuredGrid::FindDelMinusPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int n;
+  const double *dpx, *dpy, *dpz, *dmx, *dmy, *dmz;
+  double *delMinus;
+  double tmp, acc;
+
+  dpx = na->dp_[0];
+  dpy = na->dp_[1];
+  dpz = na->dp_[2];
+  dmx = na->dm_[0];
+  dmy = na->dm_[1];
+  dmz = na->dm_[2];
+  delMinus = na->delMinus_;
+
+  for ( n = begin; n < end; n++ ) {
+    acc = 0.0;
+    tmp = svmaximum( dpx[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svminimum( dmx[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svmaximum( dpy[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svminimum( dmy[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svmaximum( dpz[n], 0.0 );
+    acc += tmp * tmp;
+    tmp = svminimum( dmz[n], 0.0 );
+    acc += tmp * tmp;
+    delMinus[n] = sqrt( acc );
+  }
+
+  return;
+}
+
+
 // -----
 // FindK
 // -----
@@ -1073,38 +1236,54 @@ void cvLevelSetStructuredGrid::FindK()
 
 void cvLevelSetStructuredGrid::FindK2d()
 {
-  int i;
-  cvLevelSetNode *currNode;
-  double num, den;
-  double k;
-
   if ( ! kValid_ ) {
-
     FindD0();
+    ForEachPartition( &cvLevelSetStructuredGrid::FindK2dPart );
+    kValid_ = 1;
+  }
+  return;
+}
 
-    InitIter();
-    while ( currNode = GetNext() ) {
-
-      num = currNode->d0x_[0] * currNode->d0_[1] * currNode->d0_[1];
-      num -= 2 * currNode->d0_[1] * currNode->d0_[0] * currNode->d0x_[1];
-      num += currNode->d0y_[1] * currNode->d0_[0] * currNode->d0_[0];
-      den = currNode->d0_[0] * currNode->d0_[0];
-      den += currNode->d0_[1] * currNode->d0_[1];
-      den = pow( sqrt(den), 3 );
-      if ( fabs(den) < tol_ ) {
-	if ( fabs(num) < tol_ ) {
-	  currNode->K_ = 1.0;
-	} else {
-	  currNode->K_ = oneOverTol_;
-	}
+
+// -----------
+// FindK2dPart
+// -----------
+
+void cvLevelSetStructuredGrid::FindK2dPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int n;
+  const double *d0x, *d0y, *d0xx, *d0xy, *d0yy;
+  double num, den;
+  double k;
+
+  d0x = na->d0_[0];
+  d0y = na->d0_[1];
+  d0xx = na->d0x_[0];
+  d0xy = na->d0x_[1];
+  d0yy = na->d0y_[1];
+
+  for ( n = begin; n < end; n++ ) {
+
+    num = d0xx[n] * d0y[n] * d0y[n];
+    num -= 2 * d0y[n] * d0x[n] * d0xy[n];
+    num += d0yy[n] * d0x[n] * d0x[n];
+    den = d0x[n] * d0x[n];
+    den += d0y[n] * d0y[n];
+    den = pow( sqrt(den), 3 );
+    if ( fabs(den) < tol_ ) {
+      if ( fabs(num) < tol_ ) {
+	grid_[n].K_ = 1.0;
       } else {
-	k = num / den;
-	currNode->K_ = k;
+	grid_[n].K_ = oneOverTol_;
       }
+    } else {
+      k = num / den;
+      grid_[n].K_ = k;
     }
-
-    kValid_ = 1;
   }
+
+  return;
 }
 
 
@@ -1117,47 +1296,63 @@ void cvLevelSetStructuredGrid::FindK2d()
 
 void cvLevelSetStructuredGrid::FindK3dm()
 {
-  int i;
-  cvLevelSetNode *currNode;
-  double num, den;
-  double *d0, *d0x, *d0y, *d0z;
-
   if ( ! k3dmValid_ ) {
     FindD0();
-    InitIter();
-    while ( currNode = GetNext() ) {
-
-      d0 = currNode->d0_;
-      d0x = currNode->d0x_;
-      d0y = currNode->d0y_;
-      d0z = currNode->d0z_;
-
-      num = ( d0y[1] + d0z[2] ) * d0[0] * d0[0];
-      num += ( d0x[0] + d0z[2] ) * d0[1] * d0[1];
-      num += ( d0x[0] + d0y[1] ) * d0[2] * d0[2];
-      num -= 2 * d0[0] * d0[1] * d0x[1];
-      num -= 2 * d0[0] * d0[2] * d0x[2];
-      num -= 2 * d0[1] * d0[2] * d0y[2];
-
-      den = d0[0] * d0[0];
-      den += d0[1] * d0[1];
-      den += d0[2] * d0[2];
-      den = pow( sqrt(den), 3 );
-
-      if ( fabs(den) < tol_ ) {
-	if ( fabs(num) < tol_ ) {
-	  currNode->K3dm_ = 1.0;
-	} else {
-	  currNode->K3dm_ = oneOverTol_;
-	}
+    ForEachPartition( &cvLevelSetStructuredGrid::FindK3dmPart );
+    k3dmValid_ = 1;
+  }
+  return;
+}
+
+
+// ------------
+// FindK3dmPart
+// ------------
+
+void cvLevelSetStructuredGrid::FindK3dmPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int n;
+  double d0[3], d0x[3], d0y[3], d0z[3];
+  double num, den;
+
+  for ( n = begin; n < end; n++ ) {
+
+    d0[0] = na->d0_[0][n];
+    d0[1] = na->d0_[1][n];
+    d0[2] = na->d0_[2][n];
+    d0x[0] = na->d0x_[0][n];
+    d0x[1] = na->d0x_[1][n];
+    d0x[2] = na->d0x_[2][n];
+    d0y[1] = na->d0y_[1][n];
+    d0y[2] = na->d0y_[2][n];
+    d0z[2] = na->d0z_[2][n];
+
+    num = ( d0y[1] + d0z[2] ) * d0[0] * d0[0];
+    num += ( d0x[0] + d0z[2] ) * d0[1] * d0[1];
+    num += ( d0x[0] + d0y[1] ) * d0[2] * d0[2];
+    num -= 2 * d0[0] * d0[1] * d0x[1];
+    num -= 2 * d0[0] * d0[2] * d0x[2];
+    num -= 2 * d0[1] * d0[2] * d0y[2];
+
+    den = d0[0] * d0[0];
+    den += d0[1] * d0[1];
+    den += d0[2] * d0[2];
+    den = pow( sqrt(den), 3 );
+
+    if ( fabs(den) < tol_ ) {
+      if ( fabs(num) < tol_ ) {
+	grid_[n].K3dm_ = 1.0;
       } else {
-	currNode->K3dm_ = num / den;
-	currNode->K3dm_ /= 2;
+	grid_[n].K3dm_ = oneOverTol_;
       }
+    } else {
+      grid_[n].K3dm_ = num / den;
+      grid_[n].K3dm_ /= 2;
     }
-
-    k3dmValid_ = 1;
   }
+
+  return;
 }
 
 
@@ -1169,46 +1364,62 @@ void cvLevelSetStructuredGrid::FindK3dm()
 
 void cvLevelSetStructuredGrid::FindK3dg()
 {
-  int i;
-  cvLevelSetNode *currNode;
-  double num, den;
-  double *d0, *d0x, *d0y, *d0z;
-
   if ( ! k3dgValid_ ) {
     FindD0();
-    InitIter();
-    while ( currNode = GetNext() ) {
-
-      d0 = currNode->d0_;
-      d0x = currNode->d0x_;
-      d0y = currNode->d0y_;
-      d0z = currNode->d0z_;
-
-      num = d0[0] * d0[0] * ( d0y[1] * d0z[2] - d0y[2] * d0y[2] );
-      num += d0[1] * d0[1] * ( d0x[0] * d0z[2] - d0x[2] * d0x[2] );
-      num += d0[2] * d0[2] * ( d0x[0] * d0y[1] - d0x[1] * d0x[1] );
-      num += 2 * ( d0[0] * d0[1] * ( d0x[2] * d0y[2] - d0x[1] * d0z[2] )
-		   + d0[1] * d0[2] * ( d0x[1] * d0x[2] - d0y[2] * d0x[0] )
-		   + d0[0] * d0[2] * ( d0x[1] * d0y[2] - d0x[2] * d0y[1] ) );
-
-      den = d0[0] * d0[0];
-      den += d0[1] * d0[1];
-      den += d0[2] * d0[2];
-      den = den * den;
-
-      if ( fabs(den) < tol_ ) {
-	if ( fabs(num) < tol_ ) {
-	  currNode->K3dg_ = 1.0;
-	} else {
-	  currNode->K3dg_ = oneOverTol_;
-	}
+    ForEachPartition( &cvLevelSetStructuredGrid::FindK3dgPart );
+    k3dgValid_ = 1;
+  }
+  return;
+}
+
+
+// ------------
+// FindK3dgPart
+// ------------
+
+void cvLevelSetStructuredGrid::FindK3dgPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int n;
+  double d0[3], d0x[3], d0y[3], d0z[3];
+  double num, den;
+
+  for ( n = begin; n < end; n++ ) {
+
+    d0[0] = na->d0_[0][n];
+    d0[1] = na->d0_[1][n];
+    d0[2] = na->d0_[2][n];
+    d0x[0] = na->d0x_[0][n];
+    d0x[1] = na->d0x_[1][n];
+    d0x[2] = na->d0x_[2][n];
+    d0y[1] = na->d0y_[1][n];
+    d0y[2] = na->d0y_[2][n];
+    d0z[2] = na->d0z_[2][n];
+
+    num = d0[0] * d0[0] * ( d0y[1] * d0z[2] - d0y[2] * d0y[2] );
+    num += d0[1] * d0[1] * ( d0x[0] * d0z[2] - d0x[2] * d0x[2] );
+    num += d0[2] * d0[2] * ( d0x[0] * d0y[1] - d0x[1] * d0x[1] );
+    num += 2 * ( d0[0] * d0[1] * ( d0x[2] * d0y[2] - d0x[1] * d0z[2] )
+		 + d0[1] * d0[2] * ( d0x[1] * d0x[2] - d0y[2] * d0x[0] )
+		 + d0[0] * d0[2] * ( d0x[1] * d0y[2] - d0x[2] * d0y[1] ) );
+
+    den = d0[0] * d0[0];
+    den += d0[1] * d0[1];
+    den += d0[2] * d0[2];
+    den = den * den;
+
+    if ( fabs(den) < tol_ ) {
+      if ( fabs(num) < tol_ ) {
+	grid_[n].K3dg_ = 1.0;
       } else {
-	currNode->K3dg_ = num / den;
+	grid_[n].K3dg_ = oneOverTol_;
       }
+    } else {
+      grid_[n].K3dg_ = num / den;
     }
-
-    k3dgValid_ = 1;
   }
+
+  return;
 }
 
 
@@ -1225,120 +1436,131 @@ void cvLevelSetStructuredGrid::FindK3dg()
 
 void cvLevelSetStructuredGrid::FindN()
 {
-  int i;
+  if ( ! nValid_ ) {
+    FindDpi();
+    FindDmi();
+    ForEachPartition( &cvLevelSetStructuredGrid::FindNPart );
+    nValid_ = 1;
+  }
+  return;
+}
+
+
+// ---------
+// FindNPart
+// ---------
+
+void cvLevelSetStructuredGrid::FindNPart( int part, int begin, int end )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int n;
   cvLevelSetNode *currNode;
   double dpx, dmx, dpy, dmy, dpz, dmz;
   double den1, den2, den3, den4;
   double den5, den6, den7, den8;
   double nx, ny, nz;
 
-  if ( ! nValid_ ) {
+  for ( n = begin; n < end; n++ ) {
 
-    FindDpi();
-    FindDmi();
+    currNode = &(grid_[n]);
+    dpx = na->dp_[0][n];
+    dmx = na->dm_[0][n];
+    dpy = na->dp_[1][n];
+    dmy = na->dm_[1][n];
+    dpz = na->dp_[2][n];
+    dmz = na->dm_[2][n];
 
-    InitIter();
-    while ( currNode = GetNext() ) {
-
-      dpx = currNode->dp_[0];
-      dmx = currNode->dm_[0];
-      dpy = currNode->dp_[1];
-      dmy = currNode->dm_[1];
-      dpz = currNode->dp_[2];
-      dmz = currNode->dm_[2];
-
-      if ( dim_ == 2 ) {
-	den1 = sqrt( svSqr(dpx) + svSqr(dpy) );
-	den2 = sqrt( svSqr(dmx) + svSqr(dpy) );
-	den3 = sqrt( svSqr(dpx) + svSqr(dmy) );
-	den4 = sqrt( svSqr(dmx) + svSqr(dmy) );
-      } else {
-	den1 = sqrt( svSqr(dpx) + svSqr(dpy) + svSqr(dpz) );
-	den2 = sqrt( svSqr(dmx) + svSqr(dpy) + svSqr(dpz) );
-	den3 = sqrt( svSqr(dpx) + svSqr(dmy) + svSqr(dpz) );
-	den4 = sqrt( svSqr(dmx) + svSqr(dmy) + svSqr(dpz) );
-	den5 = sqrt( svSqr(dpx) + svSqr(dpy) + svSqr(dmz) );
-	den6 = sqrt( svSqr(dmx) + svSqr(dpy) + svSqr(dmz) );
-	den7 = sqrt( svSqr(dpx) + svSqr(dmy) + svSqr(dmz) );
-	den8 = sqrt( svSqr(dmx) + svSqr(dmy) + svSqr(dmz) );
-      }
+    if ( dim_ == 2 ) {
+      den1 = sqrt( svSqr(dpx) + svSqr(dpy) );
+      den2 = sqrt( svSqr(dmx) + svSqr(dpy) );
+      den3 = sqrt( svSqr(dpx) + svSqr(dmy) );
+      den4 = sqrt( svSqr(dmx) + svSqr(dmy) );
+    } else {
+      den1 = sqrt( svSqr(dpx) + svSqr(dpy) + svSqr(dpz) );
+      den2 = sqrt( svSqr(dmx) + svSqr(dpy) + svSqr(dpz) );
+      den3 = sqrt( svSqr(dpx) + svSqr(dmy) + svSqr(dpz) );
+      den4 = sqrt( svSqr(dmx) + svSqr(dmy) + svSqr(dpz) );
+      den5 = sqrt( svSqr(dpx) + svSqr(dpy) + svSqr(dmz) );
+      den6 = sqrt( svSqr(dmx) + svSqr(dpy) + svSqr(dmz) );
+      den7 = sqrt( svSqr(dpx) + svSqr(dmy) + svSqr(dmz) );
+      den8 = sqrt( svSqr(dmx) + svSqr(dmy) + svSqr(dmz) );
+    }
 
-      nx = 0.0;
-      ny = 0.0;
-      nz = 0.0;
+    nx = 0.0;
+    ny = 0.0;
+    nz = 0.0;
 
-      if ( dim_ == 2 ) {
-	if (den1 > 0.0) {
-	  nx += dpx / den1;
-	  ny += dpy / den1;
-	}
-	if (den2 > 0.0) {
-	  nx += dmx / den2;
-	  ny += dpy / den2;
-	}
-	if (den3 > 0.0) {
-	  nx += dpx / den3;
-	  ny += dmy / den3;
-	}
-	if (den4 > 0.0) {
-	  nx += dmx / den4;
-	  ny += dmy / den4;
-	}
-      } else {
-	if (den1 > 0.0) {
-	  nx += dpx / den1;
-	  ny += dpy / den1;
-	  nz += dpz / den1;
-	}
-	if (den2 > 0.0) {
-	  nx += dmx / den2;
-	  ny += dpy / den2;
-	  nz += dpz / den2;
-	}
-	if (den3 > 0.0) {
-	  nx += dpx / den3;
-	  ny += dmy / den3;
-	  nz += dpz / den3;
-	}
-	if (den4 > 0.0) {
-	  nx += dmx / den4;
-	  ny += dmy / den4;
-	  nz += dpz / den4;
-	}
-	if (den5 > 0.0) {
-	  nx += dpx / den5;
-	  ny += dpy / den5;
-	  nz += dmz / den5;
-	}
-	if (den6 > 0.0) {
-	  nx += dmx / den6;
-	  ny += dpy / den6;
-	  nz += dmz / den6;
-	}
-	if (den7 > 0.0) {
-	  nx += dpx / den7;
-	  ny += dmy / den7;
-	  nz += dmz / den7;
-	}
-	if (den8 > 0.0) {
-	  nx += dmx / den8;
-	  ny += dmy / den8;
-	  nz += dmz / den8;
-	}
+    if ( dim_ == 2 ) {
+      if (den1 > 0.0) {
+	nx += dpx / den1;
+	ny += dpy / den1;
+      }
+      if (den2 > 0.0) {
+	nx += dmx / den2;
+	ny += dpy / den2;
+      }
+      if (den3 > 0.0) {
+	nx += dpx / den3;
+	ny += dmy / den3;
+      }
+      if (den4 > 0.0) {
+	nx += dmx / den4;
+	ny += dmy / den4;
+      }
+    } else {
+      if (den1 > 0.0) {
+	nx += dpx / den1;
+	ny += dpy / den1;
+	nz += dpz / den1;
+      }
+      if (den2 > 0.0) {
+	nx += dmx / den2;
+	ny += dpy / den2;
+	nz += dpz / den2;
+      }
+      if (den3 > 0.0) {
+	nx += dpx / den3;
+	ny += dmy / den3;
+	nz += dpz / den3;
+      }
+      if (den4 > 0.0) {
+	nx += dmx / den4;
+	ny += dmy / den4;
+	nz += dpz / den4;
+      }
+      if (den5 > 0.0) {
+	nx += dpx / den5;
+	ny += dpy / den5;
+	nz += dmz / den5;
+      }
+      if (den6 > 0.0) {
+	nx += dmx / den6;
+	ny += dpy / den6;
+	nz += dmz / den6;
+      }
+      if (den7 > 0.0) {
+	nx += dpx / den7;
+	ny += dmy / den7;
+	nz += dmz / den7;
+      }
+      if (den8 > 0.0) {
+	nx += dmx / den8;
+	ny += dmy / den8;
+	nz += dmz / den8;
       }
-
-      currNode->nn_[0] = nx;
-      currNode->nn_[1] = ny;
-      currNode->nn_[2] = nz;
-
-      NormVector( &nx, &ny, &nz );
-      currNode->n_[0] = nx;
-      currNode->n_[1] = ny;
-      currNode->n_[2] = nz;
     }
 
-    nValid_ = 1;
+    currNode->nn_[0] = nx;
+    currNode->nn_[1] = ny;
+    currNode->nn_[2] = nz;
+
+    NormVector( &nx, &ny, &nz );
+    currNode->n_[0] = nx;
+    currNode->n_[1] = ny;
+    currNode->n_[2] = nz;
   }
+
+  return;
 }
 
 
@@ -2023,20 +2245,39 @@ double cvLevelSetStructuredGrid::ComputeDt( double maxf, double cflFactor )
 // during the EvaluateV phase) for velocity magnitudes.
 
 double cvLevelSetStructuredGrid::GetMaxF()
+{
+  double currMaxF = 0.0;
+  int p;
+
+  ForEachPartition( &cvLevelSetStructuredGrid::GetMaxFPart );
+  for ( p = 0; p < numPartitions_; p++ ) {
+    currMaxF = svmaximum( partMax_[p], currMaxF );
+  }
+  return currMaxF;
+}
+
+
+// -----------
+// GetMaxFPart
+// -----------
+
+void cvLevelSetStructuredGrid::GetMaxFPart( int part, int begin, int end )
 {
   cvLevelSetNode *currNode;
   double currF;
   double currMaxF = 0.0;
+  int n;
 
-  InitIter();
-  while ( currNode = GetNext() ) {
+  for ( n = begin; n < end; n++ ) {
+    currNode = &(grid_[n]);
     if ( ! ( currNode->state_ & CV_NODE_ACTIVE ) ) {
       continue;
     }
     currF = fabs( currNode->F0_ + currNode->F1_ );
     currMaxF = svmaximum( currF, currMaxF );
   }
-  return currMaxF;
+  partMax_[part] = currMaxF;
+  return;
 }
 
 
@@ -2046,24 +2287,43 @@ double cvLevelSetStructuredGrid::GetMaxF()
 
 vtkFloatingPointType cvLevelSetStructuredGrid::GetMaxV()
 {
-  cvLevelSetNode *currNode;
-  double currV;
   vtkFloatingPointType currMaxV = 0.0;
+  int p;
 
   if ( ! deltaPhiValid_ ) {
     printf("ERR: unexpected call to GetMaxV\n");
     return oneOverTol_;
   }
 
-  InitIter();
-  while ( currNode = GetNext() ) {
+  ForEachPartition( &cvLevelSetStructuredGrid::GetMaxVPart );
+  for ( p = 0; p < numPartitions_; p++ ) {
+    currMaxV = svmaximum( (vtkFloatingPointType)partMax_[p], currMaxV );
+  }
+  return currMaxV;
+}
+
+
+// -----------
+// GetMaxVPart
+// -----------
+
+void cvLevelSetStructuredGrid::GetMaxVPart( int part, int begin, int end )
+{
+  cvLevelSetNode *currNode;
+  double currV;
+  vtkFloatingPointType currMaxV = 0.0;
+  int n;
+
+  for ( n = begin; n < end; n++ ) {
+    currNode = &(grid_[n]);
     if ( ! ( currNode->state_ & CV_NODE_ACTIVE ) ) {
       continue;
     }
     currV = fabs( currNode->velocity_ );
     currMaxV = svmaximum( currV, currMaxV );
   }
-  return currMaxV;
+  partMax_[part] = currMaxV;
+  return;
 }
 
 
@@ -2073,17 +2333,35 @@ vtkFloatingPointType cvLevelSetStructuredGrid::GetMaxV()
 
 double cvLevelSetStructuredGrid::GetMaxPhiIncr()
 {
-  cvLevelSetNode *currNode;
-  double curr;
   double currMax = 0.0;
+  int p;
 
   if ( ! deltaPhiValid_ ) {
     printf("ERR: unexpected call to GetMaxPhiIncr\n");
     return oneOverTol_;
   }
 
-  InitIter();
-  while ( currNode = GetNext() ) {
+  ForEachPartition( &cvLevelSetStructuredGrid::GetMaxPhiIncrPart );
+  for ( p = 0; p < numPartitions_; p++ ) {
+    currMax = svmaximum( partMax_[p], currMax );
+  }
+  return currMax;
+}
+
+
+// -----------------
+// GetMaxPhiIncrPart
+// -----------------
+
+void cvLevelSetStructuredGrid::GetMaxPhiIncrPart( int part, int begin, int end )
+{
+  cvLevelSetNode *currNode;
+  double curr;
+  double currMax = 0.0;
+  int n;
+
+  for ( n = begin; n < end; n++ ) {
+    currNode = &(grid_[n]);
     if ( ! ( currNode->state_ & CV_NODE_COVERED ) &&
 	 ! ( currNode->state_ & CV_NODE_ACTIVE ) ) {
       continue;
@@ -2091,7 +2369,445 @@ double cvLevelSetStructuredGrid::GetMaxPhiIncr()
     curr = fabs( currNode->deltaPhi_ );
     currMax = svmaximum( curr, currMax );
   }
-  return currMax;
+  partMax_[part] = currMax;
+  return;
+}
+
+
+// Distance marker for nodes not yet reached during reinitialization:
+static const double LsetGrid_FarDist = HUGE_VAL;
+
+
+// ---------------
+// ReinitPhiInGrid
+// ---------------
+// Rebuild phi as a signed distance function without extracting the
+// front.  Nodes next to a sign change get their distance to the
+// linearly interpolated crossings, and the distance is then
+// propagated outwards over the node graph by solving |grad(phi)| = 1
+// with first-order upwind differences.  The sign of every node is
+// kept.  Nodes which cannot be reached from any crossing (e.g. a
+// piece of the band the front has left) keep their current phi.
+
+int cvLevelSetStructuredGrid::ReinitPhiInGrid()
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int numNodes = na->GetNumNodes();
+  double *dist;
+  char *known;
+  int n, numSeeds;
+  int status;
+
+  if ( ( grid_ == NULL ) || ( numNodes < 1 ) ) {
+    return SV_ERROR;
+  }
+
+  dist = new double [numNodes];
+  known = new char [numNodes];
+
+  numSeeds = ReinitSeedInterface( dist, known );
+  if ( numSeeds < 1 ) {
+    printf("ERR: Current zero level set has no geometry.\n");
+    delete [] dist;
+    delete [] known;
+    return SV_ERROR;
+  }
+
+  switch (reinitMethod_) {
+  case REINIT_FAST_MARCH:
+    status = ReinitFastMarch( dist, known );
+    break;
+  case REINIT_FAST_SWEEP:
+    status = ReinitFastSweep( dist, known );
+    break;
+  default:
+    status = SV_ERROR;
+    break;
+  }
+
+  if ( status == SV_OK ) {
+    for ( n = 0; n < numNodes; n++ ) {
+      if ( dist[n] == LsetGrid_FarDist ) {
+	continue;
+      }
+      if ( fabs( grid_[n].phi_ ) < tol_ ) {
+	grid_[n].phi_ = 0.0;
+      } else if ( grid_[n].phi_ < 0.0 ) {
+	grid_[n].phi_ = - dist[n];
+      } else {
+	grid_[n].phi_ = dist[n];
+      }
+    }
+    phiVtkValid_ = 0;
+    nodeArrays_.InvalidatePhi();
+  }
+
+  delete [] dist;
+  delete [] known;
+  return status;
+}
+
+
+// -------------------
+// ReinitSeedInterface
+// -------------------
+// Set dist for nodes on or next to the zero level set and mark them
+// known; all other nodes get LsetGrid_FarDist.  Along each axis the
+// distance to the nearest crossing is found by linear interpolation,
+// and the per-axis distances are combined as for a planar front.
+// Returns the number of seeded nodes.
+
+int cvLevelSetStructuredGrid::ReinitSeedInterface( double *dist, char *known )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int numNodes = na->GetNumNodes();
+  int n, m, dir, side;
+  int numSeeds = 0;
+  double phin, phim, d, axisDist, sum;
+  int onFront;
+
+  na->GatherPhi( grid_ );
+
+  for ( n = 0; n < numNodes; n++ ) {
+    phin = na->phi_[n];
+    dist[n] = LsetGrid_FarDist;
+    known[n] = 0;
+
+    if ( fabs( phin ) < tol_ ) {
+      dist[n] = 0.0;
+      known[n] = 1;
+      numSeeds++;
+      continue;
+    }
+
+    sum = 0.0;
+    onFront = 0;
+    for ( dir = 0; dir < 3; dir++ ) {
+      axisDist = LsetGrid_FarDist;
+      for ( side = 0; side < 2; side++ ) {
+	m = ( side == 0 ) ? na->prev_[dir][n] : na->next_[dir][n];
+	if ( m == n ) {
+	  continue;
+	}
+	phim = na->phi_[m];
+	if ( ( phin * phim ) >= 0.0 ) {
+	  continue;
+	}
+	d = hv_[dir] * phin / ( phin - phim );
+	axisDist = svminimum( axisDist, d );
+      }
+      if ( axisDist == LsetGrid_FarDist ) {
+	continue;
+      }
+      if ( axisDist < tol_ ) {
+	onFront = 1;
+	break;
+      }
+      sum += 1.0 / ( axisDist * axisDist );
+    }
+
+    if ( onFront ) {
+      dist[n] = 0.0;
+    } else if ( sum > 0.0 ) {
+      dist[n] = 1.0 / sqrt( sum );
+    } else {
+      continue;
+    }
+    known[n] = 1;
+    numSeeds++;
+  }
+
+  return numSeeds;
+}
+
+
+// ------------------
+// ReinitSolveEikonal
+// ------------------
+// First-order upwind solution of |grad(dist)| = 1 at node n from the
+// smaller neighbor along each axis.  Axes are added in order of
+// increasing neighbor value for as long as the solution exceeds the
+// next neighbor value.  Returns LsetGrid_FarDist if n has no neighbor with
+// a finite value.
+
+double cvLevelSetStructuredGrid::ReinitSolveEikonal( const double *dist, int n )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  double a[3], h[3], tmp;
+  double sa, saa, sw, disc, t;
+  int numAxes = 0;
+  int dir, i, j, m;
+
+  for ( dir = 0; dir < 3; dir++ ) {
+    tmp = LsetGrid_FarDist;
+    m = na->prev_[dir][n];
+    if ( m != n ) {
+      tmp = svminimum( tmp, dist[m] );
+    }
+    m = na->next_[dir][n];
+    if ( m != n ) {
+      tmp = svminimum( tmp, dist[m] );
+    }
+    if ( tmp == LsetGrid_FarDist ) {
+      continue;
+    }
+
+    // Insertion sort on neighbor value:
+    for ( i = numAxes; ( i > 0 ) && ( a[i-1] > tmp ); i-- ) {
+      a[i] = a[i-1];
+      h[i] = h[i-1];
+    }
+    a[i] = tmp;
+    h[i] = hv_[dir];
+    numAxes++;
+  }
+
+  if ( numAxes == 0 ) {
+    return LsetGrid_FarDist;
+  }
+
+  t = a[0] + h[0];
+  for ( j = 1; j < numAxes; j++ ) {
+    if ( t <= a[j] ) {
+      break;
+    }
+
+    // Solve sum_i ( (t - a_i) / h_i )^2 = 1 over axes 0..j:
+    sw = 0.0;
+    sa = 0.0;
+    saa = 0.0;
+    for ( i = 0; i <= j; i++ ) {
+      sw += 1.0 / ( h[i] * h[i] );
+      sa += a[i] / ( h[i] * h[i] );
+      saa += a[i] * a[i] / ( h[i] * h[i] );
+    }
+    disc = sa * sa - sw * ( saa - 1.0 );
+    if ( disc < 0.0 ) {
+      break;
+    }
+    t = ( sa + sqrt( disc ) ) / sw;
+  }
+
+  return t;
+}
+
+
+// ---------------
+// ReinitFastMarch
+// ---------------
+// Fast marching: repeatedly accept the trial node with the smallest
+// distance and update its neighbors.  The heap may hold stale
+// entries for nodes whose distance has since dropped; those are
+// skipped when popped.
+
+typedef std::pair<double,int> LsetGrid_HeapEntry;
+
+int cvLevelSetStructuredGrid::ReinitFastMarch( double *dist, char *known )
+{
+  cvLevelSetNodeArrays *na = &nodeArrays_;
+  int numNodes = na->GetNumNodes();
+  std::priority_queue< LsetGrid_HeapEntry, std::vector<LsetGrid_HeapEntry>,
+		       std::greater<LsetGrid_HeapEntry> > heap;
+  LsetGrid_HeapEntry top;
+  int n, m, dir, side;
+  double t;
+
+  // Start from the seeded nodes:
+  for ( n = 0; n < numNodes; n++ ) {
+    if ( known[n] ) {
+      heap.push( LsetGrid_HeapEntry( dist[n], n ) );
+    }
+  }
+
+  while ( ! heap.empty() ) {
+    top = heap.top();
+    heap.pop();
+    n = top.second;
+    if ( top.first > dist[n] ) {
+      continue;  // stale
+    }
+    if ( known[n] == 2 ) {
+      continue;
+    }
+    known[n] = 2;
+
+    for ( dir = 0; dir < 3; dir++ ) {
+      for ( side = 0; side < 2; side++ ) {
+	m = ( side == 0 ) ? na->prev_[dir][n] : na->next_[dir][n];
+	if ( ( m == n ) || known[m] ) {
+	  continue;
+	}
+	t = ReinitSolveEikonal( dist, m );
+	if ( t < dist[m] ) {
+	  dist[m] = t;
+	  heap.push( LsetGrid_HeapEntry( t, m ) );
+	}
+      }
+    }
+  }
+
+  return SV_OK;
+}
+
+
+// ---------------
+// ReinitFastSweep
+// ---------------
+// Fast sweeping (Zhao, "Parallel implementations of the fast sweeping
+// method", J Comp Math 25(4), 2007): each of the 2^dim axis orderings
+// sweeps its own copy of dist with Gauss-Seidel updates, and the
+// copies are merged by taking the minimum.  This repeats until no
+// value changes by more than tol_.  The orderings are independent, so
+// they run on up to numThreads_ threads; the result does not depend
+// on the thread count.
+//
+// grid_ is sorted in i-fastest order, so nodes sharing (j,k) form
+// contiguous rows and rows sharing k form contiguous slabs.  Every
+// ordering is a walk over slabs, rows and nodes in some combination
+// of directions.
+
+int cvLevelSetStructuredGrid::ReinitFastSweep( double *dist, char *known )
+{
+  int numNodes = nodeArrays_.GetNumNodes();
+  int numOrders = ( dim_ == 2 ) ? 4 : 8;
+  int maxIters = 100;
+  int *rowStart, *slabStart;
+  int numRows, numSlabs;
+  double *copies;
+  double maxChange, d;
+  int n, r, s, iter, numWorkers;
+
+  // Row and slab boundaries:
+  rowStart = new int [numNodes + 1];
+  slabStart = new int [numNodes + 1];
+  numRows = 0;
+  numSlabs = 0;
+  for ( n = 0; n < numNodes; n++ ) {
+    if ( ( n == 0 ) || ( grid_[n].j_ != grid_[n-1].j_ ) ||
+	 ( grid_[n].k_ != grid_[n-1].k_ ) ) {
+      if ( ( n == 0 ) || ( grid_[n].k_ != grid_[n-1].k_ ) ) {
+	slabStart[numSlabs++] = numRows;
+      }
+      rowStart[numRows++] = n;
+    }
+  }
+  rowStart[numRows] = numNodes;
+  slabStart[numSlabs] = numRows;
+
+  copies = new double [numOrders * numNodes];
+  numWorkers = svminimum( numThreads_, numOrders );
+
+  for ( iter = 0; iter < maxIters; iter++ ) {
+
+    for ( s = 0; s < numOrders; s++ ) {
+      memcpy( copies + s * numNodes, dist, numNodes * sizeof(double) );
+    }
+
+    if ( numWorkers > 1 ) {
+      std::vector<std::thread> workers;
+      for ( r = 1; r < numWorkers; r++ ) {
+	workers.push_back( std::thread( &cvLevelSetStructuredGrid::ReinitSweepOrders,
+					this, copies, known, rowStart, slabStart,
+					numSlabs, r, numWorkers ) );
+      }
+      ReinitSweepOrders( copies, known, rowStart, slabStart, numSlabs,
+			 0, numWorkers );
+      for ( r = 0; r < (int)workers.size(); r++ ) {
+	workers[r].join();
+      }
+    } else {
+      ReinitSweepOrders( copies, known, rowStart, slabStart, numSlabs, 0, 1 );
+    }
+
+    maxChange = 0.0;
+    for ( n = 0; n < numNodes; n++ ) {
+      d = dist[n];
+      for ( s = 0; s < numOrders; s++ ) {
+	d = svminimum( d, copies[s * numNodes + n] );
+      }
+      if ( d < dist[n] ) {
+	if ( dist[n] == LsetGrid_FarDist ) {
+	  maxChange = LsetGrid_FarDist;
+	} else {
+	  maxChange = svmaximum( maxChange, dist[n] - d );
+	}
+	dist[n] = d;
+      }
+    }
+    if ( maxChange <= tol_ ) {
+      break;
+    }
+  }
+
+  if ( iter == maxIters ) {
+    printf("WARNING: fast sweeping did not converge in %d iterations\n",
+	   maxIters);
+  }
+
+  delete [] copies;
+  delete [] rowStart;
+  delete [] slabStart;
+  return SV_OK;
+}
+
+
+// -----------------
+// ReinitSweepOrders
+// -----------------
+// Sweep orderings first, first + stride, ... each on its own copy.
+
+void cvLevelSetStructuredGrid::ReinitSweepOrders( double *copies, const char *known,
+						  const int *rowStart,
+						  const int *slabStart,
+						  int numSlabs, int first, int stride )
+{
+  int numNodes = nodeArrays_.GetNumNodes();
+  int numOrders = ( dim_ == 2 ) ? 4 : 8;
+  int order;
+
+  for ( order = first; order < numOrders; order += stride ) {
+    ReinitSweepOrder( copies + order * numNodes, known, rowStart, slabStart,
+		      numSlabs, order );
+  }
+  return;
+}
+
+
+// ----------------
+// ReinitSweepOrder
+// ----------------
+// One Gauss-Seidel sweep over dist in the given axis ordering: bit 0
+// reverses i, bit 1 reverses j and bit 2 reverses k.
+
+void cvLevelSetStructuredGrid::ReinitSweepOrder( double *dist, const char *known,
+						 const int *rowStart,
+						 const int *slabStart,
+						 int numSlabs, int order )
+{
+  int revI = order & 1;
+  int revJ = order & 2;
+  int revK = order & 4;
+  int a, b, c, slab, row, n;
+  double t;
+
+  for ( a = 0; a < numSlabs; a++ ) {
+    slab = revK ? ( numSlabs - 1 - a ) : a;
+    for ( b = slabStart[slab]; b < slabStart[slab+1]; b++ ) {
+      row = revJ ? ( slabStart[slab] + slabStart[slab+1] - 1 - b ) : b;
+      for ( c = rowStart[row]; c < rowStart[row+1]; c++ ) {
+	n = revI ? ( rowStart[row] + rowStart[row+1] - 1 - c ) : c;
+	if ( known[n] ) {
+	  continue;
+	}
+	t = ReinitSolveEikonal( dist, n );
+	if ( t < dist[n] ) {
+	  dist[n] = t;
+	}
+      }
+    }
+  }
+
+  return;
 }
 
 
@@ -2678,3 +3394,52 @@ char *GridT_EnumToStr( GridT t )
 
   return Tcl_DStringValue( &ds );
 }
+
+
+// -----------------
+// ReinitT_StrToEnum
+// -----------------
+
+ReinitT ReinitT_StrToEnum( char *name )
+{
+  if ( !strcmp( name, "Front" ) ) {
+    return REINIT_FRONT;
+  } else if ( !strcmp( name, "FastMarch" ) ) {
+    return REINIT_FAST_MARCH;
+  } else if ( !strcmp( name, "FastSweep" ) ) {
+    return REINIT_FAST_SWEEP;
+  } else {
+    return Invalid_ReinitT;
+  }
+}
+
+
+// -----------------
+// ReinitT_EnumToStr
+// -----------------
+// Caller need NOT worry about result clean up.
+
+char *ReinitT_EnumToStr( ReinitT t )
+{
+  static Tcl_DString ds;
+
+  Tcl_DStringFree( &ds );  // both frees and reinitializes
+
+  switch (t) {
+  case REINIT_FRONT:
+    Tcl_DStringAppend( &ds, "Front", -1 );
+    break;
+  case REINIT_FAST_MARCH:
+    Tcl_DStringAppend( &ds, "FastMarch", -1 );
+    break;
+  case REINIT_FAST_SWEEP:
+    Tcl_DStringAppend( &ds, "FastSweep", -1 );
+    break;
+  default:
+    Tcl_DStringAppend( &ds, "Invalid ReinitT... must be one of { Front, "
+		       "FastMarch, FastSweep }", -1 );
+    break;
+  }
+
+  return Tcl_DStringValue( &ds );
+}
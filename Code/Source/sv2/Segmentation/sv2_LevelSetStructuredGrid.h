@@ -35,17 +35,30 @@
 #include "SimVascular.h"
 #include "svLSetExports.h" // For exports
 #include "sv2_LevelSetNode.h"
+#include "sv2_LevelSetNodeArrays.h"
 #include "sv_PolyData.h"
 #include "sv_SolidModel.h"
 #include "sv_StrPts.h"
 #include "sv_misc_utils.h"
 
+#include <vector>
+
 
 typedef enum { Dense_GridT, Sparse_GridT, Invalid_GridT } GridT;
 
 SV_EXPORT_LSET GridT GridT_StrToEnum( char *name );
 SV_EXPORT_LSET char *GridT_EnumToStr( GridT t );
 
+// Method used by ReinitPhi to rebuild the distance function:
+//   - REINIT_FRONT: distance to the extracted zero level set polydata
+//   - REINIT_FAST_MARCH: in-grid fast marching from the zero crossings
+//   - REINIT_FAST_SWEEP: in-grid fast sweeping from the zero crossings
+typedef enum { REINIT_FRONT, REINIT_FAST_MARCH, REINIT_FAST_SWEEP,
+	       Invalid_ReinitT } ReinitT;
+
+SV_EXPORT_LSET ReinitT ReinitT_StrToEnum( char *name );
+SV_EXPORT_LSET char *ReinitT_EnumToStr( ReinitT t );
+
 class SV_EXPORT_LSET cvLevelSetVelocity;
 
 class SV_EXPORT_LSET cvLevelSetStructuredGrid {
@@ -63,6 +76,8 @@ public:
   virtual int InitPhi( cvStrPts *img, double thr ) = 0;
   virtual int ReinitPhi() = 0;
   int CloseHoles();
+  void SetReinitMethod( ReinitT t ) { reinitMethod_ = t; };
+  ReinitT GetReinitMethod() const { return reinitMethod_; };
 
   // Band parameters will be relevant only for cvLevelSetSparseGrid:
   virtual int SetBandParams( double innerPhi, double outerPhi,
@@ -138,16 +153,93 @@ public:
   // Memory usage interface:
   virtual int GetMemoryUsage() = 0;
 
+  // Thread-parallel evolution.  With n > 1, the node list is split
+  // into n partitions which are processed concurrently by EvaluateV,
+  // ComputeDeltaPhi, UpdatePhi, the difference kernels and the GetMax
+  // reductions.  Results do not depend on n.
+  void SetNumThreads( int n );
+  int GetNumThreads() const { return numThreads_; };
+
 protected:
 
+  // In-grid reinitialization of phi to a signed distance function,
+  // used by ReinitPhi unless reinitMethod_ is REINIT_FRONT.  Cost is
+  // linear in the number of nodes (times log n for fast marching) and
+  // does not depend on the size of the front.
+  ReinitT reinitMethod_;
+  int ReinitPhiInGrid();
+  int ReinitSeedInterface( double *dist, char *known );
+  int ReinitFastMarch( double *dist, char *known );
+  int ReinitFastSweep( double *dist, char *known );
+  void ReinitSweepOrders( double *copies, const char *known,
+			  const int *rowStart, const int *slabStart,
+			  int numSlabs, int first, int stride );
+  void ReinitSweepOrder( double *dist, const char *known,
+			 const int *rowStart, const int *slabStart,
+			 int numSlabs, int order );
+  double ReinitSolveEikonal( const double *dist, int n );
+
+  // Partitioning for thread-parallel evolution.  Partition p owns
+  // grid_ entries partOffsets_[p] .. partOffsets_[p+1]-1.  Neighbor
+  // values are read straight from the shared grid_ and nodeArrays_,
+  // and every ForEachPartition call is a barrier, so no halo copies
+  // are needed.
+  typedef void (cvLevelSetStructuredGrid::*PartitionKernel)( int part, int begin, int end );
+  virtual int PartitionNodes( int numParts );
+  void InvalidatePartitions() { partitionValid_ = 0; };
+  void ForEachPartition( PartitionKernel kernel );
+  int numThreads_;
+  int numPartitions_;
+  int partitionValid_;
+  int partitionedNodes_;
+  int partitionBusy_;
+  int *partOffsets_;
+  double *partMax_;   // per-partition GetMax* results, reduced in order
+  int *partFlags_;    // per-partition status flags
+
+  // Partition kernels:
+  void FindD0iPart( int part, int begin, int end );
+  void FindD0iiPart( int part, int begin, int end );
+  void FindDpiPart( int part, int begin, int end );
+  void FindDmiPart( int part, int begin, int end );
+  void FindDelPlusPart( int part, int begin, int end );
+  void FindDelMinusPart( int part, int begin, int end );
+  void FindK2dPart( int part, int begin, int end );
+  void FindK3dmPart( int part, int begin, int end );
+  void FindK3dgPart( int part, int begin, int end );
+  void FindNPart( int part, int begin, int end );
+  void EvaluateVPart( int part, int begin, int end );
+  void ComputeDeltaPhiPart( int part, int begin, int end );
+  void UpdatePhiPart( int part, int begin, int end );
+  void GetMaxFPart( int part, int begin, int end );
+  void GetMaxVPart( int part, int begin, int end );
+  void GetMaxPhiIncrPart( int part, int begin, int end );
+
+  // EvaluateV samples the velocity function at zero level set
+  // crossings in parallel, then applies the samples to the nodes in
+  // node order so that AssignNode sees the same sequence as a serial
+  // sweep.
+  typedef struct {
+    int nodeIx;
+    int adjIx;        // -1 if the zls passes through the node itself
+    int status;
+    int forceMinVFlag;
+    double zls[3];
+    double v[3];
+    double f0, f1;
+    double toDot[3];
+  } VelocitySample;
+  std::vector< std::vector<VelocitySample> > vSamples_;
+  cvLevelSetVelocity *evalVfn_;
+  double deltaPhiDt_;
+  double deltaPhiMaxF_;
+
   // Memory usage local to cvLevelSetStructuredGrid:
   int GetStructuredGridMemoryUsage();
 
   // Compute centered diff's:
   void FindD0i();    // 1st-order centered
-  void FindD0xi();   // 2nd-order centered of D0x
-  void FindD0yi();   // 2nd-order centered of D0y
-  void FindD0zi();   // 2nd-order centered of D0z
+  void FindD0ii();   // 2nd-order centered of D0x, D0y, D0z
 
   // Compute entropy-satisfying terms:
   void FindDelPlus();
@@ -189,6 +281,11 @@ protected:
   cvLevelSetNode *grid_;      // allocated by derived class
   int numNodes_;    // set by derived class
 
+  // Difference kernel storage parallel to grid_.  Derived classes
+  // must call nodeArrays_.Build once grid_ neighbor indices are set,
+  // and nodeArrays_.Deallocate when grid_ goes away.
+  cvLevelSetNodeArrays nodeArrays_;
+
   int I_, J_, K_;
   int numDenseNodes_;
   double hv_[3];
@@ -76,6 +76,12 @@ public:
   virtual int Evaluate( double pos[], double *f0, double *f1,
 			double v[], int *forceFlag, double toDot[] ) = 0;
 
+  // Evaluate may be called from several threads at once during
+  // cvLevelSetStructuredGrid::EvaluateV.  Anything Evaluate would
+  // otherwise compute lazily must be set up here instead; this is
+  // called once, serially, before each round of evaluations.
+  virtual int PrepareEvaluate() { return SV_OK; };
+
   virtual int GetMemoryUsage() = 0;
 
   char tclName_[CV_STRLEN];
@@ -302,19 +302,9 @@ int cvLevelSetVelocityExponentialDecay::Evaluate( double pos[], double *f0, doub
   }
 
   // Look up intensity gradient:
-  if ( ! GetGradIx( image_, pos, &(gradI[0]) ) ) {
+  if ( ! Img_GetGrad( image_, pos, gradI ) ) {
     return SV_ERROR;
   }
-  if ( ! GetGradIy( image_, pos, &(gradI[1]) ) ) {
-    return SV_ERROR;
-  }
-  if ( image_->dim == 3 ) {
-    if ( ! GetGradIz( image_, pos, &(gradI[2]) ) ) {
-      return SV_ERROR;
-    }
-  } else {
-    gradI[2] = 0.0;
-  }
 
   // Recall:
   //   - tmpF0 is for K-independent terms
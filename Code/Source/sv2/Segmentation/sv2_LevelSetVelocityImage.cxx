@@ -265,3 +265,21 @@ int cvLevelSetVelocityImage::ClearImage()
   image_ = NULL;
   return SV_OK;
 }
+
+
+// ---------------
+// PrepareEvaluate
+// ---------------
+// The Get*GradI* accessors compute image gradients on first use,
+// which is not safe during a parallel EvaluateV.
+
+int cvLevelSetVelocityImage::PrepareEvaluate()
+{
+  if ( image_ == NULL ) {
+    return SV_OK;
+  }
+  if ( ! image_->gradValid ) {
+    ComputeImageGrad( image_ );
+  }
+  return SV_OK;
+}
@@ -65,6 +65,7 @@ public:
   int GetIntensityRange( double rng[] );
   int ClearImage();
   virtual void PostSetImageAction() { return; };
+  virtual int PrepareEvaluate();
 
 protected:
   Image_T *image_;
@@ -112,19 +112,18 @@ void cvLevelSetVelocityKGI::SetUpPotentialField( Image_T *img )
   Image_T *tmp;
   int numPix, i;
   double mag;
+  double grad[3];
   double *data;
 
   if ( potential_ != NULL ) {
     Image_Delete( potential_ );
   }
-  ComputeImageGrad( img );
 
   numPix = img->imgDims[0] * img->imgDims[1] * img->imgDims[2];
   data = new double [numPix];
   for ( i = 0; i < numPix; i++ ) {
-    mag = Magnitude( img->pixels[i].gradX,
-		     img->pixels[i].gradY,
-		     img->pixels[i].gradZ );
+    Img_GetPixelGrad( img, i, grad );
+    mag = Magnitude( grad[0], grad[1], grad[2] );
     //    data[i] = 1.0 / ( 1.0 + mag );
     data[i] = - mag;
   }
@@ -379,6 +378,22 @@ int cvLevelSetVelocityKGI::StopCondition()
 }
 
 
+// ---------------
+// PrepareEvaluate
+// ---------------
+
+int cvLevelSetVelocityKGI::PrepareEvaluate()
+{
+  if ( cvLevelSetVelocityImage::PrepareEvaluate() != SV_OK ) {
+    return SV_ERROR;
+  }
+  if ( ( potential_ != NULL ) && ( ! potential_->gradValid ) ) {
+    ComputeImageGrad( potential_ );
+  }
+  return SV_OK;
+}
+
+
 // --------
 // Evaluate
 // --------
@@ -414,34 +429,14 @@ int cvLevelSetVelocityKGI::Evaluate( double pos[], double *f0, double *f1, doubl
   }
 
   // Look up intensity gradient:
-  if ( ! GetGradIx( image_, pos, &(gradI[0]) ) ) {
+  if ( ! Img_GetGrad( image_, pos, gradI ) ) {
     return SV_ERROR;
   }
-  if ( ! GetGradIy( image_, pos, &(gradI[1]) ) ) {
-    return SV_ERROR;
-  }
-  if ( image_->dim == 3 ) {
-    if ( ! GetGradIz( image_, pos, &(gradI[2]) ) ) {
-      return SV_ERROR;
-    }
-  } else {
-    gradI[2] = 0.0;
-  }
 
   // Look up potential gradient:
-  if ( ! GetGradIx( potential_, pos, &(gradg[0]) ) ) {
+  if ( ! Img_GetGrad( potential_, pos, gradg ) ) {
     return SV_ERROR;
   }
-  if ( ! GetGradIy( potential_, pos, &(gradg[1]) ) ) {
-    return SV_ERROR;
-  }
-  if ( image_->dim == 3 ) {
-    if ( ! GetGradIz( potential_, pos, &(gradg[2]) ) ) {
-      return SV_ERROR;
-    }
-  } else {
-    gradg[2] = 0.0;
-  }
   toDot[0] = beta_ * gradg[0];
   toDot[1] = beta_ * gradg[1];
   toDot[2] = beta_ * gradg[2];
@@ -73,6 +73,7 @@ public:
 
   int Valid();
   int StopCondition();
+  int PrepareEvaluate();
   int Evaluate( double pos[], double *f0, double *f1, double v[],
 		int *forceFlag, double toDot[] );
 
@@ -178,19 +178,9 @@ int cvLevelSetVelocityPotential::Evaluate( double pos[], double *f0, double *f1,
   }
 
   // Look up potential gradient:
-  if ( ! GetGradIx( image_, pos, &(gradP[0]) ) ) {
+  if ( ! Img_GetGrad( image_, pos, gradP ) ) {
     return SV_ERROR;
   }
-  if ( ! GetGradIy( image_, pos, &(gradP[1]) ) ) {
-    return SV_ERROR;
-  }
-  if ( image_->dim == 3 ) {
-    if ( ! GetGradIz( image_, pos, &(gradP[2]) ) ) {
-      return SV_ERROR;
-    }
-  } else {
-    gradP[2] = 0.0;
-  }
 
 
   tmpF0 = 0.0;
@@ -132,6 +132,12 @@ static int LsetCore_SetTimersMtd( ClientData clientData, Tcl_Interp *interp,
 static int LsetCore_GetTimersMtd( ClientData clientData, Tcl_Interp *interp,
 				int argc, CONST84 char *argv[] );
 
+static int LsetCore_SetNumThreadsMtd( ClientData clientData, Tcl_Interp *interp,
+				      int argc, CONST84 char *argv[] );
+
+static int LsetCore_GetNumThreadsMtd( ClientData clientData, Tcl_Interp *interp,
+				      int argc, CONST84 char *argv[] );
+
 static int LsetCore_GetTimerGranularityMtd( ClientData clientData,
 					    Tcl_Interp *interp,
 					    int argc, CONST84 char *argv[] );
@@ -144,6 +150,14 @@ static int LsetCore_GetVExtensionMtd( ClientData clientData,
 				      Tcl_Interp *interp,
 				      int argc, CONST84 char *argv[] );
 
+static int LsetCore_SetReinitMtd( ClientData clientData,
+				  Tcl_Interp *interp,
+				  int argc, CONST84 char *argv[] );
+
+static int LsetCore_GetReinitMtd( ClientData clientData,
+				  Tcl_Interp *interp,
+				  int argc, CONST84 char *argv[] );
+
 static int LsetCore_InitMtd( ClientData clientData, Tcl_Interp *interp,
 			     int argc, CONST84 char *argv[] );
 
@@ -445,8 +459,12 @@ static void PrintMethods()
   printf("SetTimers\n");
   printf("GetTimers\n");
   printf("GetTimerGranularity\n");
+  printf("SetNumThreads\n");
+  printf("GetNumThreads\n");
   printf("SetVExtension\n");
   printf("GetVExtension\n");
+  printf("SetReinit\n");
+  printf("GetReinit\n");
   printf("Init\n");
   printf("IsInit\n");
   printf("EvolveOneTimeStep\n");
@@ -594,6 +612,16 @@ int LsetCore_ObjectCmd( ClientData clientData, Tcl_Interp *interp,
       return TCL_ERROR;
     }
 
+  } else if ( Tcl_StringMatch( argv[1], "SetNumThreads" ) ) {
+    if ( LsetCore_SetNumThreadsMtd( clientData, interp, argc, argv ) != TCL_OK ) {
+      return TCL_ERROR;
+    }
+
+  } else if ( Tcl_StringMatch( argv[1], "GetNumThreads" ) ) {
+    if ( LsetCore_GetNumThreadsMtd( clientData, interp, argc, argv ) != TCL_OK ) {
+      return TCL_ERROR;
+    }
+
   } else if ( Tcl_StringMatch( argv[1], "GetTimerGranularity" ) ) {
     if ( LsetCore_GetTimerGranularityMtd( clientData, interp, argc, argv )
 	 != TCL_OK ) {
@@ -612,6 +640,18 @@ int LsetCore_ObjectCmd( ClientData clientData, Tcl_Interp *interp,
       return TCL_ERROR;
     }
 
+  } else if ( Tcl_StringMatch( argv[1], "SetReinit" ) ) {
+    if ( LsetCore_SetReinitMtd( clientData, interp, argc, argv )
+	 != TCL_OK ) {
+      return TCL_ERROR;
+    }
+
+  } else if ( Tcl_StringMatch( argv[1], "GetReinit" ) ) {
+    if ( LsetCore_GetReinitMtd( clientData, interp, argc, argv )
+	 != TCL_OK ) {
+      return TCL_ERROR;
+    }
+
   } else if ( Tcl_StringMatch( argv[1], "Init" ) ) {
     if ( LsetCore_InitMtd( clientData, interp, argc, argv )
 	 != TCL_OK ) {
@@ -1750,6 +1790,105 @@ static int LsetCore_GetTimersMtd( ClientData clientData, Tcl_Interp *interp,
 }
 
 
+// -------------------------
+// LsetCore_SetNumThreadsMtd
+// -------------------------
+
+// $object SetNumThreads -num <int>
+
+static int LsetCore_SetNumThreadsMtd( ClientData clientData, Tcl_Interp *interp,
+				      int argc, CONST84 char *argv[] )
+{
+  cvLevelSet *ls = (cvLevelSet *)clientData;
+  int i;
+  int value;
+  int numFlag;
+  char usage[CV_STRLEN];
+
+  sprintf( usage, "usage: $LsetCoreObject %s -num <int>", argv[1] );
+
+  // If no add'l arg's given, return usage string:
+  if ( argc == 2 ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_OK;
+  }
+
+  // If we don't have an even number of arg's, then usage is incorrect:
+  if ( argc != 4 ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_ERROR;
+  }
+
+  numFlag = 0;
+
+  // Now, for each arg/val pair:
+  for ( i = 2; i < argc; i += 2 ) {
+
+    // Set number of threads:
+    if ( Tcl_StringMatch( argv[i], "-num" ) ) {
+      if ( Tcl_GetInt( interp, argv[i+1], &value ) != TCL_OK ) {
+	Tcl_AppendResult( interp, "invalid value for num: ",
+			  argv[i+1], (char *)NULL );
+	return TCL_ERROR;
+      }
+      numFlag = 1;
+    }
+
+    // Syntax errors:
+    else if ( argv[i][0] == '-' ) {
+      Tcl_AppendResult( interp, "\"", argv[i],
+			"\" not a recognized flag", (char *)NULL );
+      return TCL_ERROR;
+    } else {
+      Tcl_AppendResult( interp, "expecting a flag, but found \"", argv[i],
+			"\" instead", (char *)NULL );
+      return TCL_ERROR;
+    }
+  }
+
+  if ( !numFlag ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_ERROR;
+  }
+
+  if ( ls->SetNumThreads( value ) != SV_OK ) {
+    Tcl_AppendResult( interp, "number of threads must be >= 1",
+		      (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  return TCL_OK;
+}
+
+
+// -------------------------
+// LsetCore_GetNumThreadsMtd
+// -------------------------
+
+static int LsetCore_GetNumThreadsMtd( ClientData clientData, Tcl_Interp *interp,
+				      int argc, CONST84 char *argv[] )
+{
+  cvLevelSet *ls = (cvLevelSet *)clientData;
+  int value;
+
+  // If any add'l arg's given, return usage string:
+  if ( argc != 2 ) {
+    Tcl_AppendResult( interp, "usage: $LsetCoreObject ",
+		      argv[1], (char *)NULL );
+    return TCL_ERROR;
+  }
+
+  ls->GetNumThreads( &value );
+
+  char rtnstr[255];
+  rtnstr[0]='\0';
+  sprintf( rtnstr, "%d", value );
+  Tcl_SetResult( interp, rtnstr, TCL_VOLATILE );
+
+  return TCL_OK;
+}
+
+
 // -------------------------------
 // LsetCore_GetTimerGranularityMtd
 // -------------------------------
@@ -1853,6 +1992,81 @@ static int LsetCore_GetVExtensionMtd( ClientData clientData,
   return TCL_OK;
 }
 
+// ---------------------
+// LsetCore_SetReinitMtd
+// ---------------------
+
+// $object SetReinit -fn <Front | FastMarch | FastSweep>
+
+static int LsetCore_SetReinitMtd( ClientData clientData,
+				  Tcl_Interp *interp,
+				  int argc, CONST84 char *argv[] )
+{
+  cvLevelSet *ls = (cvLevelSet *)clientData;
+  char *usage;
+  char *fnName;
+  ReinitT rtype;
+
+  int table_size = 1;
+  ARG_Entry arg_table[] = {
+    { "-fn", STRING_Type, &fnName, NULL, REQUIRED, 0, { 0 } },
+  };
+
+  usage = ARG_GenSyntaxStr( 2, argv, table_size, arg_table );
+
+  if ( argc == 2 ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_OK;
+  }
+
+  if ( ARG_ParseTclStr( interp, argc, argv, 2,
+			table_size, arg_table ) != TCL_OK ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_ERROR;
+  }
+
+  // Do work of command:
+  rtype = ReinitT_StrToEnum( fnName );
+  if ( ls->SetReinit( rtype ) != SV_OK ) {
+    Tcl_SetResult( interp, "error setting reinitialization", TCL_STATIC );
+    return TCL_ERROR;
+  }
+
+  return TCL_OK;
+}
+
+
+// ---------------------
+// LsetCore_GetReinitMtd
+// ---------------------
+
+static int LsetCore_GetReinitMtd( ClientData clientData,
+				  Tcl_Interp *interp,
+				  int argc, CONST84 char *argv[] )
+{
+  cvLevelSet *ls = (cvLevelSet *)clientData;
+  char *usage;
+  ReinitT rtype;
+
+  usage = ARG_GenSyntaxStr( 2, argv, 0, NULL );
+
+  if ( argc != 2 ) {
+    Tcl_SetResult( interp, usage, TCL_VOLATILE );
+    return TCL_ERROR;
+  }
+
+  if ( ls->GetReinit( &rtype ) != SV_OK ) {
+    Tcl_SetResult( interp, "error getting reinitialization method",
+		   TCL_STATIC );
+    return TCL_ERROR;
+  }
+
+  Tcl_AppendElement( interp, "-fn" );
+  Tcl_AppendElement( interp, ReinitT_EnumToStr( rtype ) );
+
+  return TCL_OK;
+}
+
 // ----------------
 // LsetCore_InitMtd
 // ----------------
@@ -1243,7 +1243,7 @@ int LsetVImage_GetImageObjMtd( ClientData clientData, Tcl_Interp *interp,
   vtkShortArray *vtkdata = vtkShortArray::New();
   //vtkdata->SetDataTypeToShort();
   for (i = 0; i < numData; i++) {
-    vtkdata->InsertTuple1( i, (short)image->pixels[i].intensity );
+    vtkdata->InsertTuple1( i, (short)Img_GetPixelIntensity( image, i ) );
   }
 
   // Build vtkStructuredPoints:
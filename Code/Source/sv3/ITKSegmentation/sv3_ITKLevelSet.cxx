@@ -704,17 +704,32 @@ int cvITKLevelSet::ComputePhaseTwoLevelSet(float kupp,float klow)
 
 int cvITKLevelSet::GenerateFeatureImage()
 {
-	ITKInternalImageType::Pointer tempImg = ITKInternalImageType::New();
-	cvITKLSUtil::vtk2itkRecastAndRescale<ITKInternalImageType,ITKExternalImageType>(m_cvInputImage->GetVtkStructuredPoints(),tempImg,
-			&InternalImgInfo);
-	if (m_UseInputImageAsFeature)
-	{
-		cvITKLSUtil::itkGenerateFeatureImageNoGrad<ITKInternalImageType>(tempImg, m_itkFeatureImage, m_SigmaFeature);
-	}
-	else
+	typedef cvITKLSUtil::FeatureImageCache<ITKInternalImageType> FeatureCacheType;
+
+	cvITKLSUtil::FeatureImageKey key(m_cvInputImage->GetVtkStructuredPoints(),
+			&InternalImgInfo,m_SigmaFeature,
+			m_UseInputImageAsFeature ? cvITKLSUtil::FEATURE_NO_GRADIENT : cvITKLSUtil::FEATURE_GRADIENT);
+	ITKInternalImageType::Pointer featureImg = FeatureCacheType::Instance().Find(key);
+
+	if (featureImg.IsNull())
 	{
-		cvITKLSUtil::itkGenerateFeatureImage<ITKInternalImageType>(tempImg, m_itkFeatureImage, m_SigmaFeature);
+		ITKInternalImageType::Pointer tempImg = ITKInternalImageType::New();
+		cvITKLSUtil::vtk2itkRecastAndRescale<ITKInternalImageType,ITKExternalImageType>(m_cvInputImage->GetVtkStructuredPoints(),tempImg,
+				&InternalImgInfo);
+		featureImg = ITKInternalImageType::New();
+		if (m_UseInputImageAsFeature)
+		{
+			cvITKLSUtil::itkGenerateFeatureImageNoGrad<ITKInternalImageType>(tempImg, featureImg, m_SigmaFeature);
+		}
+		else
+		{
+			cvITKLSUtil::itkGenerateFeatureImage<ITKInternalImageType>(tempImg, featureImg, m_SigmaFeature);
+		}
+		FeatureCacheType::Instance().Insert(key,featureImg);
 	}
+
+	// the cached image is shared, work on a copy
+	cvITKLSUtil::itkDeepCopy<ITKInternalImageType>(featureImg.GetPointer(),m_itkFeatureImage);
 	//cvITKLSUtil::WriteImage2(m_itkFeatureImage.GetPointer(),"featureimage.mha");
 
 
@@ -80,6 +80,7 @@
 #include "sv3_ITKLset_ImgInfo.h"
 
 #include "sv3_ITKLset_ITKUtils.h"
+#include "sv3_ITKLset_FeatureCache.h"
 
 
 #define CVITKException(x)																\
@@ -765,12 +765,26 @@ typename TInternalPixelType>
 int cvITKLevelSetBase<TInputImage, TInternalPixelType>
 ::GenerateFeatureImage()
  {
-	typename ITKInternalImageType::Pointer tempImg = ITKInternalImageType::New();
+	typedef cvITKLSUtil::FeatureImageCache<ITKInternalImageType> FeatureCacheType;
 
-	cvITKLSUtil::vtk2itkRecastAndRescale<ITKInternalImageType,ITKExternalImageType>(m_cvInputImage->GetVtkStructuredPoints(),tempImg,
-			&InternalImgInfo);
-	cvITKLSUtil::WriteImage2(tempImg.GetPointer(),"inputimage.mha");
-	cvITKLSUtil::itkGenerateFeatureImage<ITKInternalImageType>(tempImg, m_itkFeatureImage, m_SigmaFeature);
+	cvITKLSUtil::FeatureImageKey key(m_cvInputImage->GetVtkStructuredPoints(),
+			&InternalImgInfo,m_SigmaFeature,cvITKLSUtil::FEATURE_GRADIENT);
+	typename ITKInternalImageType::Pointer featureImg = FeatureCacheType::Instance().Find(key);
+
+	if(featureImg.IsNull())
+	{
+		typename ITKInternalImageType::Pointer tempImg = ITKInternalImageType::New();
+
+		cvITKLSUtil::vtk2itkRecastAndRescale<ITKInternalImageType,ITKExternalImageType>(m_cvInputImage->GetVtkStructuredPoints(),tempImg,
+				&InternalImgInfo);
+		cvITKLSUtil::WriteImage2(tempImg.GetPointer(),"inputimage.mha");
+		featureImg = ITKInternalImageType::New();
+		cvITKLSUtil::itkGenerateFeatureImage<ITKInternalImageType>(tempImg, featureImg, m_SigmaFeature);
+		FeatureCacheType::Instance().Insert(key,featureImg);
+	}
+
+	// the cached image is shared, work on a copy
+	cvITKLSUtil::itkDeepCopy<ITKInternalImageType>(featureImg.GetPointer(),m_itkFeatureImage);
 
 	// Debug only, vtk image not used
 	cvITKLSUtil::itk2vtkRecastAndRescale<ITKInternalImageType,ITKExternalImageType>(m_itkFeatureImage,m_vtkFeatureImage,&ExternalImgInfo);
@@ -76,6 +76,7 @@
 #include "sv3_ITKLset_ImgInfo.h"
 
 #include "sv3_ITKLset_ITKUtils.h"
+#include "sv3_ITKLset_FeatureCache.h"
 
 #ifndef NULL
 #define NULL   ((void *) 0)
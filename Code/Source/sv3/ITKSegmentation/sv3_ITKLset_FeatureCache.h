@@ -0,0 +1,230 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * sv3_ITKLset_FeatureCache.h
+ *
+ *      Feature (edge) images keyed by the source scalars and the
+ *      parameters used to build them.  Consecutive contours on the same
+ *      image slice, or parameter sweeps that only touch the level set
+ *      scalings, reuse the gradient image instead of recomputing it.
+ *
+ *      Cached images are shared between level set objects and threads;
+ *      copy them before use, since many ITK filters run in place.
+ */
+
+#ifndef CVITKLSETFEATURECACHE_H_
+#define CVITKLSETFEATURECACHE_H_
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "itkImage.h"
+#include "vtkStructuredPoints.h"
+#include "vtkPointData.h"
+#include "vtkDataArray.h"
+#include "sv3_ITKLset_ImgInfo.h"
+
+namespace cvITKLSUtil {
+
+// Which feature generator produced the image.
+enum FeatureImageKind {
+	FEATURE_GRADIENT = 0,
+	FEATURE_NO_GRADIENT
+};
+
+class FeatureImageKey
+{
+public:
+	FeatureImageKey()
+	{
+		scalars = 0;
+		scalarsMTime = 0;
+		kind = FEATURE_GRADIENT;
+		sigma = 0;
+	}
+
+	// Image identity is the scalar array (shared between shallow copies
+	// such as cvStrPts) and its modification time; VTK modification
+	// times only grow, so a recycled address never matches a stale key.
+	FeatureImageKey(vtkStructuredPoints* vtkImage,ImgInfo* refInfo,
+			double vsigma,int vkind)
+	{
+		vtkDataArray* s = vtkImage->GetPointData()->GetScalars();
+		scalars = s;
+		scalarsMTime = (s != NULL) ? s->GetMTime() : 0;
+		kind = vkind;
+		sigma = vsigma;
+
+		int i, ext[6];
+		double vec[3];
+		vtkImage->GetExtent(ext);
+		for(i = 0; i < 6; i++)
+			values.push_back(ext[i]);
+		vtkImage->GetOrigin(vec);
+		values.insert(values.end(),vec,vec+3);
+		vtkImage->GetSpacing(vec);
+		values.insert(values.end(),vec,vec+3);
+
+		refInfo->GetExtent(ext);
+		for(i = 0; i < 6; i++)
+			values.push_back(ext[i]);
+		refInfo->GetOrigin(vec);
+		values.insert(values.end(),vec,vec+3);
+		refInfo->GetSpacing(vec);
+		values.insert(values.end(),vec,vec+3);
+		values.push_back(refInfo->GetMinValue());
+		values.push_back(refInfo->GetMaxValue());
+	}
+
+	bool operator<(const FeatureImageKey& other) const
+	{
+		if(scalars != other.scalars)
+			return scalars < other.scalars;
+		if(scalarsMTime != other.scalarsMTime)
+			return scalarsMTime < other.scalarsMTime;
+		if(kind != other.kind)
+			return kind < other.kind;
+		if(sigma != other.sigma)
+			return sigma < other.sigma;
+		return values < other.values;
+	}
+
+private:
+	const void* scalars;
+	unsigned long scalarsMTime;
+	int kind;
+	double sigma;
+	std::vector<double> values;
+};
+
+/*
+ * FeatureImageCache: one least-recently-used cache per image type,
+ * bounded by the memory of the pixel buffers it holds.  Safe to use
+ * from several segmentation threads at once.
+ */
+template <typename TImageType>
+class FeatureImageCache
+{
+public:
+	typedef typename TImageType::Pointer ImagePointer;
+
+	static FeatureImageCache& Instance()
+	{
+		static FeatureImageCache cache;
+		return cache;
+	}
+
+	// Returns a null pointer on a miss.
+	ImagePointer Find(const FeatureImageKey& key)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		typename IndexType::iterator it = m_Index.find(key);
+		if(it == m_Index.end())
+			return ImagePointer();
+		m_Entries.splice(m_Entries.begin(),m_Entries,it->second);
+		return it->second->second;
+	}
+
+	void Insert(const FeatureImageKey& key,ImagePointer image)
+	{
+		size_t bytes = ImageBytes(image);
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if(bytes == 0 || bytes > m_MemoryBudget || m_Index.find(key) != m_Index.end())
+			return;
+		m_Entries.push_front(std::make_pair(key,image));
+		m_Index[key] = m_Entries.begin();
+		m_MemoryUsed += bytes;
+		Evict();
+	}
+
+	void SetMemoryBudget(size_t bytes)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_MemoryBudget = bytes;
+		Evict();
+	}
+	size_t GetMemoryBudget()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_MemoryBudget;
+	}
+
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Entries.clear();
+		m_Index.clear();
+		m_MemoryUsed = 0;
+	}
+
+private:
+	typedef std::list<std::pair<FeatureImageKey,ImagePointer> > EntryListType;
+	typedef std::map<FeatureImageKey,typename EntryListType::iterator> IndexType;
+
+	FeatureImageCache()
+	{
+		m_MemoryBudget = 256*1024*1024;
+		m_MemoryUsed = 0;
+	}
+	FeatureImageCache(const FeatureImageCache &); // purposely not implemented
+	void operator=(const FeatureImageCache &); // purposely not implemented
+
+	static size_t ImageBytes(ImagePointer image)
+	{
+		return image->GetBufferedRegion().GetNumberOfPixels()*
+				sizeof(typename TImageType::PixelType);
+	}
+
+	// drop least recently used images until back under budget
+	void Evict()
+	{
+		while(m_MemoryUsed > m_MemoryBudget && !m_Entries.empty())
+		{
+			m_MemoryUsed -= ImageBytes(m_Entries.back().second);
+			m_Index.erase(m_Entries.back().first);
+			m_Entries.pop_back();
+		}
+	}
+
+	EntryListType m_Entries;
+	IndexType m_Index;
+	size_t m_MemoryBudget;
+	size_t m_MemoryUsed;
+	std::mutex m_Mutex;
+};
+
+}
+
+#endif /* CVITKLSETFEATURECACHE_H_ */
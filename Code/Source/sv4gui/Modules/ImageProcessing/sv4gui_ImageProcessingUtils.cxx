@@ -66,10 +66,22 @@
 
 #include <vtkMarchingCubes.h>
 #include <vtkImageCast.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkMarchingCubesTriangleCases.h>
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
 #include "vtkPolyDataConnectivityFilter.h"
-#include "vtkCellLocator.h"
 #include <vtkMetaImageWriter.h>
 
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
 sv4guiImageProcessingUtils::sv4guiImageProcessingUtils(){
 
 }
@@ -101,6 +113,36 @@ vtkSmartPointer<vtkImageData> sv4guiImageProcessingUtils::itkImageToVtkImage(sv4
   return vtkImage;
 }
 
+vtkSmartPointer<vtkImageData> sv4guiImageProcessingUtils::itkImageToVtkImageView(sv4guiImageProcessingUtils::itkImPoint image){
+  auto region  = image->GetBufferedRegion();
+  auto index   = region.GetIndex();
+  auto size    = region.GetSize();
+  auto spacing = image->GetSpacing();
+  auto origin  = image->GetOrigin();
+
+  //save = 1 so vtk never frees the itk buffer
+  auto scalars = vtkSmartPointer<vtkFloatArray>::New();
+  scalars->SetNumberOfComponents(1);
+  scalars->SetArray(image->GetBufferPointer(), region.GetNumberOfPixels(), 1);
+
+  auto vtkImage = vtkSmartPointer<vtkImageData>::New();
+  vtkImage->SetExtent(index[0], index[0]+size[0]-1,
+                      index[1], index[1]+size[1]-1,
+                      index[2], index[2]+size[2]-1);
+  vtkImage->SetSpacing(spacing[0], spacing[1], spacing[2]);
+  vtkImage->SetOrigin(origin[0], origin[1], origin[2]);
+  vtkImage->GetPointData()->SetScalars(scalars);
+  return vtkImage;
+}
+
+vtkSmartPointer<vtkPolyData> sv4guiImageProcessingUtils::marchingCubes(sv4guiImageProcessingUtils::itkImPoint image,
+  double isovalue, bool largest_cc){
+
+  //image stays referenced for the whole call, so the view is safe here
+  auto vtkImage = sv4guiImageProcessingUtils::itkImageToVtkImageView(image);
+  return sv4guiImageProcessingUtils::marchingCubes(vtkImage, isovalue, largest_cc);
+}
+
 vtkSmartPointer<vtkPolyData> sv4guiImageProcessingUtils::marchingCubes(vtkImageData* imageData, double isovalue, bool largest_cc){
   auto MC = vtkSmartPointer<vtkMarchingCubes>::New();
   MC->SetInputData(imageData);
@@ -121,37 +163,394 @@ vtkSmartPointer<vtkPolyData> sv4guiImageProcessingUtils::marchingCubes(vtkImageD
 
 }
 
+//seed marching cubes helpers, the corner and edge numbering is the one
+//vtkMarchingCubes and vtkMarchingCubesTriangleCases use
+static const int sv4guiMCCorner[8][3] = {{0,0,0},{1,0,0},{1,1,0},{0,1,0},
+                                         {0,0,1},{1,0,1},{1,1,1},{0,1,1}};
+static const int sv4guiMCEdge[12][2] = {{0,1},{1,2},{3,2},{0,3},{4,5},{5,6},
+                                        {7,6},{4,7},{0,4},{1,5},{3,7},{2,6}};
+
+//corners on the -x,+x,-y,+y,-z,+z faces of a cell, as case bits
+static const int sv4guiMCFaceMask[6] = {153, 102, 51, 204, 15, 240};
+
+struct sv4guiSeedMCContext
+{
+  int dims[3];
+  double origin[3];
+  double spacing[3];
+  double isovalue;
+  const std::vector<vtkIdType>* cells;
+  const void* scalars;
+  int scalarType;
+};
+
+struct sv4guiSeedMCSlab
+{
+  sv4guiSeedMCContext* context;
+  size_t firstCell;
+  size_t lastCell;
+  std::vector<long long> edgeKeys;
+  std::vector<float> points;
+  std::vector<vtkIdType> triangles;
+};
+
+template <class T>
+static int sv4guiMCCase(const T* s, const int dims[3], int i, int j, int k, double isovalue)
+{
+  int index = 0;
+  for (int n = 0; n < 8; n++){
+    long long p = (i+sv4guiMCCorner[n][0]) +
+      (long long)dims[0]*((j+sv4guiMCCorner[n][1]) + (long long)dims[1]*(k+sv4guiMCCorner[n][2]));
+    if (s[p] >= isovalue){
+      index |= (1 << n);
+    }
+  }
+  return index;
+}
+
+//triangulates the slab's cells; a vertex is named by the grid edge it lies
+//on (lower end point id * 3 + axis) so it is shared with every cell around
+//that edge
+template <class T>
+static void sv4guiSeedMCTriangulate(sv4guiSeedMCSlab& slab)
+{
+  sv4guiSeedMCContext* c = slab.context;
+  const T* s = static_cast<const T*>(c->scalars);
+  const int* dims = c->dims;
+  long long cx = dims[0]-1, cy = dims[1]-1;
+  vtkMarchingCubesTriangleCases* cases = vtkMarchingCubesTriangleCases::GetCases();
+  std::unordered_map<long long,vtkIdType> vertexIds;
+
+  for (size_t n = slab.firstCell; n < slab.lastCell; n++){
+    long long cell = (*c->cells)[n];
+    int i = cell % cx;
+    int j = (cell / cx) % cy;
+    int k = cell / (cx*cy);
+
+    int index = sv4guiMCCase(s, dims, i, j, k, c->isovalue);
+    int* edge = cases[index].edges;
+
+    for (; edge[0] > -1; edge++){
+      const int* e0 = sv4guiMCCorner[sv4guiMCEdge[edge[0]][0]];
+      const int* e1 = sv4guiMCCorner[sv4guiMCEdge[edge[0]][1]];
+      int axis = (e0[0] != e1[0]) ? 0 : ((e0[1] != e1[1]) ? 1 : 2);
+      const int* lo = (e0[axis] < e1[axis]) ? e0 : e1;
+
+      long long p0 = (i+e0[0]) + dims[0]*((j+e0[1]) + (long long)dims[1]*(k+e0[2]));
+      long long p1 = (i+e1[0]) + dims[0]*((j+e1[1]) + (long long)dims[1]*(k+e1[2]));
+      long long plo = (i+lo[0]) + dims[0]*((j+lo[1]) + (long long)dims[1]*(k+lo[2]));
+      long long key = plo*3 + axis;
+
+      auto it = vertexIds.find(key);
+      if (it == vertexIds.end()){
+        double t = (c->isovalue - s[p0]) / ((double)s[p1] - s[p0]);
+        for (int d = 0; d < 3; d++){
+          double x = (d == 0 ? i : (d == 1 ? j : k)) + e0[d] + t*(e1[d]-e0[d]);
+          slab.points.push_back(c->origin[d] + x*c->spacing[d]);
+        }
+        it = vertexIds.insert(std::make_pair(key,(vtkIdType)slab.edgeKeys.size())).first;
+        slab.edgeKeys.push_back(key);
+      }
+      slab.triangles.push_back(it->second);
+    }
+  }
+}
+
+static void sv4guiRunSeedMCSlab(sv4guiSeedMCSlab& slab)
+{
+  switch (slab.context->scalarType){
+    vtkTemplateMacro(sv4guiSeedMCTriangulate<VTK_TT>(slab));
+  }
+}
+
+//finds the cells of the isosurface component nearest the seed, then floods
+//that component across faces the surface passes through; only these cells
+//are ever triangulated. The nearest component is the one holding the
+//surface vertex physically closest to the seed (as the closest point region
+//of the full marching cubes output used to be): cells are visited in order
+//of their physical distance to the seed, which bounds the distance to any
+//vertex they hold, until no unvisited cell can hold a closer vertex. That
+//vertex is returned as its edge key in seedKey. The flood may also take in
+//pieces that only share a cell or an ambiguous face with the component,
+//they are dropped after triangulation.
+template <class T>
+static void sv4guiSeedMCComponent(const T* s, const int dims[3], const double spacing[3],
+  double isovalue, const double seedIndex[3], std::vector<vtkIdType>& component, long long& seedKey)
+{
+  long long cdims[3] = {dims[0]-1, dims[1]-1, dims[2]-1};
+  long long numCells = cdims[0]*cdims[1]*cdims[2];
+  if (numCells <= 0){
+    return;
+  }
+
+  std::vector<bool> visited(numCells,false);
+
+  int ijk[3];
+  for (int d = 0; d < 3; d++){
+    ijk[d] = std::max(0, std::min((int)cdims[d]-1, (int)floor(seedIndex[d])));
+  }
+  long long start = ijk[0] + cdims[0]*(ijk[1] + cdims[1]*ijk[2]);
+
+  typedef std::pair<double,long long> QueueItem;
+  std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem> > queue;
+
+  long long seedCell = -1;
+  double best = 0;
+  queue.push(QueueItem(0.0,start));
+  visited[start] = true;
+  while (!queue.empty() && (seedCell < 0 || queue.top().first < best)){
+    long long cell = queue.top().second;
+    queue.pop();
+    int c[3] = {(int)(cell % cdims[0]), (int)((cell / cdims[0]) % cdims[1]), (int)(cell / (cdims[0]*cdims[1]))};
+
+    //squared distance from the seed to the cell's vertices, which lie on
+    //the edges whose end points are on opposite sides of the isovalue
+    int index = sv4guiMCCase(s, dims, c[0], c[1], c[2], isovalue);
+    if (index != 0 && index != 255){
+      for (int e = 0; e < 12; e++){
+        int n0 = sv4guiMCEdge[e][0], n1 = sv4guiMCEdge[e][1];
+        if (((index >> n0) & 1) == ((index >> n1) & 1)) continue;
+        const int* e0 = sv4guiMCCorner[n0];
+        const int* e1 = sv4guiMCCorner[n1];
+        long long p0 = (c[0]+e0[0]) + dims[0]*((c[1]+e0[1]) + (long long)dims[1]*(c[2]+e0[2]));
+        long long p1 = (c[0]+e1[0]) + dims[0]*((c[1]+e1[1]) + (long long)dims[1]*(c[2]+e1[2]));
+        double t = (isovalue - s[p0]) / ((double)s[p1] - s[p0]);
+        double d2 = 0;
+        for (int d = 0; d < 3; d++){
+          double x = (c[d] + e0[d] + t*(e1[d]-e0[d]) - seedIndex[d])*spacing[d];
+          d2 += x*x;
+        }
+        if (seedCell < 0 || d2 < best){
+          seedCell = cell;
+          seedKey = std::min(p0, p1)*3 + ((e0[0] != e1[0]) ? 0 : ((e0[1] != e1[1]) ? 1 : 2));
+          best = d2;
+        }
+      }
+    }
+
+    for (int f = 0; f < 6; f++){
+      int nc[3] = {c[0], c[1], c[2]};
+      nc[f/2] += (f % 2) ? 1 : -1;
+      if (nc[f/2] < 0 || nc[f/2] >= cdims[f/2]) continue;
+      long long ncell = nc[0] + cdims[0]*(nc[1] + cdims[1]*nc[2]);
+      if (!visited[ncell]){
+        visited[ncell] = true;
+        double d2 = 0;
+        for (int d = 0; d < 3; d++){
+          double x = std::max(0.0, std::max(nc[d] - seedIndex[d], seedIndex[d] - (nc[d]+1)))*spacing[d];
+          d2 += x*x;
+        }
+        queue.push(QueueItem(d2,ncell));
+      }
+    }
+  }
+
+  if (seedCell < 0){
+    return;
+  }
+
+  std::fill(visited.begin(), visited.end(), false);
+  component.push_back(seedCell);
+  visited[seedCell] = true;
+  for (size_t n = 0; n < component.size(); n++){
+    long long cell = component[n];
+    int c[3] = {(int)(cell % cdims[0]), (int)((cell / cdims[0]) % cdims[1]), (int)(cell / (cdims[0]*cdims[1]))};
+    int index = sv4guiMCCase(s, dims, c[0], c[1], c[2], isovalue);
+    for (int f = 0; f < 6; f++){
+      int faceBits = index & sv4guiMCFaceMask[f];
+      if (faceBits == 0 || faceBits == sv4guiMCFaceMask[f]) continue;
+      int nc[3] = {c[0], c[1], c[2]};
+      nc[f/2] += (f % 2) ? 1 : -1;
+      if (nc[f/2] < 0 || nc[f/2] >= cdims[f/2]) continue;
+      long long ncell = nc[0] + cdims[0]*(nc[1] + cdims[1]*nc[2]);
+      if (!visited[ncell]){
+        visited[ncell] = true;
+        component.push_back(ncell);
+      }
+    }
+  }
+}
+
 vtkSmartPointer<vtkPolyData> sv4guiImageProcessingUtils::seedMarchingCubes(vtkImageData* imageData, double isovalue,
 double px, double py, double pz){
-  auto MC = vtkSmartPointer<vtkMarchingCubes>::New();
-  MC->SetInputData(imageData);
-  MC->SetValue(0,isovalue);
-  MC->Update();
 
-  auto cellLocator = vtkSmartPointer<vtkCellLocator>::New();
-  cellLocator->SetDataSet(MC->GetOutput());
-  cellLocator->BuildLocator();
-
-  double testPoint[3] = {px, py, pz};
-  double closestPointDistance;
-  double closestPoint[3];
-  vtkIdType cellId;
-  int subId;
-
-  cellLocator->FindClosestPoint(testPoint, closestPoint, cellId, subId, closestPointDistance);
-
-  std::cout << "Vtk connectivity filter\n";
-  vtkSmartPointer<vtkPolyDataConnectivityFilter> polyDataConnectivityFilter
-  = vtkSmartPointer<vtkPolyDataConnectivityFilter>::New();
-  polyDataConnectivityFilter->SetExtractionModeToCellSeededRegions();
-  polyDataConnectivityFilter->SetInputData(MC->GetOutput());
-  polyDataConnectivityFilter->InitializeSeedList();
-  polyDataConnectivityFilter->AddSeed(cellId);
-  std::cout << "Running connectivity filter\n";
-  polyDataConnectivityFilter->Update();
-
-  std::cout << "get connectivity output\n";
-  auto pd = polyDataConnectivityFilter->GetOutput();
+  auto pd = vtkSmartPointer<vtkPolyData>::New();
+
+  vtkDataArray* scalars = imageData->GetPointData()->GetScalars();
+  if (scalars == NULL || scalars->GetNumberOfComponents() != 1){
+    std::cout << "Seed marching cubes needs a single component image\n";
+    return pd;
+  }
+
+  sv4guiSeedMCContext context;
+  int extent[6];
+  imageData->GetDimensions(context.dims);
+  imageData->GetExtent(extent);
+  imageData->GetSpacing(context.spacing);
+  imageData->GetOrigin(context.origin);
+  context.isovalue = isovalue;
+  context.scalars = scalars->GetVoidPointer(0);
+  context.scalarType = scalars->GetDataType();
+
+  //cell indices are relative to the extent start, fold it into the origin
+  double seed[3] = {px, py, pz};
+  double seedIndex[3];
+  for (int d = 0; d < 3; d++){
+    context.origin[d] += extent[2*d]*context.spacing[d];
+    seedIndex[d] = (seed[d] - context.origin[d]) / context.spacing[d];
+  }
+
+  std::vector<vtkIdType> component;
+  long long seedKey = -1;
+  switch (scalars->GetDataType()){
+    vtkTemplateMacro(sv4guiSeedMCComponent(static_cast<const VTK_TT*>(context.scalars),
+      context.dims, context.spacing, isovalue, seedIndex, component, seedKey));
+    default:
+      std::cout << "Unsupported scalar type for seed marching cubes\n";
+      return pd;
+  }
+
+  if (component.empty()){
+    return pd;
+  }
+
+  //slabs of whole cell layers so that only the plane between two
+  //consecutive slabs can hold vertices that both of them create
+  std::sort(component.begin(), component.end());
+  context.cells = &component;
+
+  long long layer = (long long)(context.dims[0]-1)*(context.dims[1]-1);
+  size_t slabSize = std::max((size_t)4096, component.size()/(4*QThread::idealThreadCount()) + 1);
+
+  QList<sv4guiSeedMCSlab> slabs;
+  size_t first = 0;
+  while (first < component.size()){
+    size_t last = std::min(first + slabSize, component.size());
+    long long k = component[last-1] / layer;
+    while (last < component.size() && component[last] / layer == k){
+      last++;
+    }
+    sv4guiSeedMCSlab slab;
+    slab.context = &context;
+    slab.firstCell = first;
+    slab.lastCell = last;
+    slabs.push_back(slab);
+    first = last;
+  }
+
+  //each slab only writes its own buffers
+  QtConcurrent::blockingMap(slabs, sv4guiRunSeedMCSlab);
+
+  //stitch the slabs, vertices on the shared plane of two consecutive
+  //slabs take the id given by the lower one
+  long long plane = (long long)context.dims[0]*context.dims[1];
+  std::vector<float> coords;
+  std::vector<vtkIdType> triangles;
+  std::unordered_map<long long,vtkIdType> sharedIds, nextShared;
+  std::vector<vtkIdType> globalIds;
+  vtkIdType seedPoint = -1;
+
+  for (int n = 0; n < slabs.size(); n++){
+    sv4guiSeedMCSlab& slab = slabs[n];
+    long long kmin = component[slab.firstCell] / layer;
+    long long kmax = component[slab.lastCell-1] / layer;
+
+    globalIds.resize(slab.edgeKeys.size());
+    nextShared.clear();
+    for (size_t v = 0; v < slab.edgeKeys.size(); v++){
+      long long key = slab.edgeKeys[v];
+      long long k = (key/3) / plane;
+      bool inPlane = (key % 3) != 2;
+
+      auto it = sharedIds.end();
+      if (inPlane && k == kmin){
+        it = sharedIds.find(key);
+      }
+      if (it != sharedIds.end()){
+        globalIds[v] = it->second;
+      }else{
+        globalIds[v] = coords.size()/3;
+        coords.insert(coords.end(), slab.points.begin()+3*v, slab.points.begin()+3*v+3);
+      }
+      if (inPlane && k == kmax+1){
+        nextShared[key] = globalIds[v];
+      }
+      if (key == seedKey){
+        seedPoint = globalIds[v];
+      }
+    }
+    sharedIds.swap(nextShared);
+
+    for (size_t t = 0; t < slab.triangles.size(); t++){
+      triangles.push_back(globalIds[slab.triangles[t]]);
+    }
+
+    //free the slab as soon as it is merged
+    std::vector<long long>().swap(slab.edgeKeys);
+    std::vector<float>().swap(slab.points);
+    std::vector<vtkIdType>().swap(slab.triangles);
+  }
+
+  if (seedPoint < 0){
+    return pd;
+  }
+
+  //keep the triangles connected to the seed vertex through shared points,
+  //which is the region the connectivity filter used to extract
+  vtkIdType numPoints = coords.size()/3;
+  vtkIdType numTriangles = triangles.size()/3;
+  std::vector<vtkIdType> linkOffsets(numPoints+1, 0);
+  std::vector<vtkIdType> links(triangles.size());
+  for (size_t t = 0; t < triangles.size(); t++){
+    linkOffsets[triangles[t]+1]++;
+  }
+  for (vtkIdType v = 0; v < numPoints; v++){
+    linkOffsets[v+1] += linkOffsets[v];
+  }
+  std::vector<vtkIdType> linkEnds(linkOffsets.begin(), linkOffsets.end()-1);
+  for (size_t t = 0; t < triangles.size(); t++){
+    links[linkEnds[triangles[t]]++] = t/3;
+  }
+
+  std::vector<bool> reached(numPoints, false);
+  std::vector<bool> keep(numTriangles, false);
+  std::vector<vtkIdType> front(1, seedPoint);
+  reached[seedPoint] = true;
+  while (!front.empty()){
+    vtkIdType v = front.back();
+    front.pop_back();
+    for (vtkIdType l = linkOffsets[v]; l < linkOffsets[v+1]; l++){
+      vtkIdType t = links[l];
+      if (keep[t]) continue;
+      keep[t] = true;
+      for (int n = 0; n < 3; n++){
+        vtkIdType w = triangles[3*t+n];
+        if (!reached[w]){
+          reached[w] = true;
+          front.push_back(w);
+        }
+      }
+    }
+  }
+
+  auto points = vtkSmartPointer<vtkPoints>::New();
+  auto polys = vtkSmartPointer<vtkCellArray>::New();
+  std::vector<vtkIdType> pointIds(numPoints, -1);
+  for (vtkIdType t = 0; t < numTriangles; t++){
+    if (!keep[t]) continue;
+    vtkIdType tri[3];
+    for (int n = 0; n < 3; n++){
+      vtkIdType v = triangles[3*t+n];
+      if (pointIds[v] < 0){
+        pointIds[v] = points->InsertNextPoint(coords[3*v], coords[3*v+1], coords[3*v+2]);
+      }
+      tri[n] = pointIds[v];
+    }
+    polys->InsertNextCell(3, tri);
+  }
+
+  pd->SetPoints(points);
+  pd->SetPolys(polys);
   return pd;
 }
 
@@ -175,6 +574,22 @@ sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::elementwiseMi
     return min->GetOutput();
 }
 
+sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::elementwiseMinimumInPlace(sv4guiImageProcessingUtils::itkImPoint image1,
+  sv4guiImageProcessingUtils::itkImPoint image2){
+
+    auto min = itk::MinimumImageFilter<sv4guiImageProcessingUtils::itkImageType,
+      sv4guiImageProcessingUtils::itkImageType, sv4guiImageProcessingUtils::itkImageType>::New();
+
+    min->InPlaceOn();
+    min->SetInput(0, image1);
+    min->SetInput(1, image2);
+    min->Update();
+
+    itkImPoint itkImage = min->GetOutput();
+    itkImage->DisconnectPipeline();
+    return itkImage;
+}
+
 sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::threshold(sv4guiImageProcessingUtils::itkImPoint image,
   double lowerThreshold, double upperThreshold){
 
@@ -265,22 +680,43 @@ sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::collidingFron
   int x1, int y1, int z1, int x2, int y2, int z2,
     double lowerThreshold, double upperThreshold){
 
+  auto speed = sv4guiImageProcessingUtils::collidingFrontsSpeed(image, lowerThreshold, upperThreshold);
+
+  return sv4guiImageProcessingUtils::collidingFrontsFromSpeed(speed, x1, y1, z1, x2, y2, z2);
+}
+
+sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::collidingFrontsSpeed(sv4guiImageProcessingUtils::itkImPoint image,
+  double lowerThreshold, double upperThreshold){
+
   typedef sv4guiImageProcessingUtils::itkImageType CFImageType;
 
+  //threshold and rescale as one pipeline, the rescale overwrites the
+  //threshold output instead of allocating another image
   auto thresh = itk::ThresholdImageFilter<CFImageType>::New();
 
+  thresh->InPlaceOff();
   thresh->SetInput(image);
   thresh->ThresholdOutside(lowerThreshold,upperThreshold);
   thresh->SetOutsideValue(0.0);
-  thresh->Update();
 
   //finally CF needs pixel values to be between 0 and 1, so we rescale the image
   auto scaler = itk::RescaleIntensityImageFilter<CFImageType,CFImageType>::New();
+  scaler->InPlaceOn();
   scaler->SetInput(thresh->GetOutput());
   scaler->SetOutputMinimum(0.0);
   scaler->SetOutputMaximum(1.0);
   scaler->Update();
 
+  itkImPoint itkImage = scaler->GetOutput();
+  itkImage->DisconnectPipeline();
+  return itkImage;
+}
+
+sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::collidingFrontsFromSpeed(sv4guiImageProcessingUtils::itkImPoint speed,
+  int x1, int y1, int z1, int x2, int y2, int z2){
+
+  typedef sv4guiImageProcessingUtils::itkImageType CFImageType;
+
   //now construct collidingfronts filter
   typedef itk::CollidingFrontsImageFilter<CFImageType,CFImageType> CFType;
   auto CF = CFType::New();
@@ -321,19 +757,22 @@ sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::collidingFron
   seedContainer2->InsertElement(0,n2);
 
   //now set the inputs for the colliding fronts filter
-  CF->SetInput(scaler->GetOutput());
+  CF->SetInput(speed);
   CF->SetSeedPoints1(seedContainer1);
   CF->SetSeedPoints2(seedContainer2);
   // CF->ApplyConnectivityOn();
   CF->StopOnTargetsOn();
-  CF->Update();
 
+  //the front image is only an intermediate, threshold it in place
+  auto thresh = itk::ThresholdImageFilter<CFImageType>::New();
+  thresh->InPlaceOn();
   thresh->SetInput(CF->GetOutput());
   thresh->ThresholdAbove(-1e-12);
   thresh->SetOutsideValue(1.0);
   thresh->Update();
 
-  auto itkImage = thresh->GetOutput();
+  itkImPoint itkImage = thresh->GetOutput();
+  itkImage->DisconnectPipeline();
   return itkImage;
 }
 
@@ -468,6 +907,75 @@ sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::fillHoles(sv4
   return itkImage;
 }
 
+sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::seedSegmentation(sv4guiImageProcessingUtils::itkImPoint image,
+  double lowerThreshold, double upperThreshold, std::vector<std::vector<int>> seeds,
+  int openCloseRadius, bool fill){
+
+  typedef sv4guiImageProcessingUtils::itkImageType ImageType;
+
+  //the stages are connected and updated once at the end; every intermediate
+  //output is released as soon as the following stage has consumed it, so
+  //besides the caller's input image at most two full size buffers, a stage's
+  //input and output, are alive at any time
+  auto connected = itk::ConnectedThresholdImageFilter<ImageType, ImageType>::New();
+  connected->SetInput(image);
+  connected->SetLower(lowerThreshold);
+  connected->SetUpper(upperThreshold);
+  connected->SetReplaceValue(1.0);
+
+  for (int i = 0; i < seeds.size(); i++){
+    auto v = seeds[i];
+    ImageType::IndexType index = {{v[0],v[1],v[2]}};
+    connected->AddSeed(index);
+  }
+
+  ImageType* stage = connected->GetOutput();
+
+  sv4guiImageProcessingUtils::StructElType structuringElement;
+  auto erode = itk::GrayscaleErodeImageFilter<ImageType, ImageType, sv4guiImageProcessingUtils::StructElType>::New();
+  auto dilate = itk::GrayscaleDilateImageFilter<ImageType, ImageType, sv4guiImageProcessingUtils::StructElType>::New();
+
+  if (openCloseRadius > 0){
+    structuringElement.SetRadius(openCloseRadius);
+    structuringElement.CreateStructuringElement();
+
+    stage->ReleaseDataFlagOn();
+    erode->SetInput(stage);
+    erode->SetKernel(structuringElement);
+
+    erode->GetOutput()->ReleaseDataFlagOn();
+    dilate->SetInput(erode->GetOutput());
+    dilate->SetKernel(structuringElement);
+    stage = dilate->GetOutput();
+  }
+
+  auto fillHole = itk::BinaryFillholeImageFilter<ImageType>::New();
+
+  if (fill){
+    stage->ReleaseDataFlagOn();
+    fillHole->SetInput(stage);
+    fillHole->SetForegroundValue(1.0);
+    stage = fillHole->GetOutput();
+  }
+
+  stage->Update();
+
+  itkImPoint itkImage = stage;
+  itkImage->DisconnectPipeline();
+  return itkImage;
+}
+
+vtkSmartPointer<vtkPolyData> sv4guiImageProcessingUtils::seedSegmentationSurface(sv4guiImageProcessingUtils::itkImPoint image,
+  double lowerThreshold, double upperThreshold, std::vector<std::vector<int>> seeds,
+  int openCloseRadius, bool fill, double isovalue, bool largest_cc){
+
+  auto segmentation = sv4guiImageProcessingUtils::seedSegmentation(image,
+    lowerThreshold, upperThreshold, seeds, openCloseRadius, fill);
+
+  //marching cubes reads the segmentation buffer directly, no itk -> vtk copy
+  return sv4guiImageProcessingUtils::marchingCubes(segmentation, isovalue, largest_cc);
+}
+
 sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessingUtils::gradientMagnitude(sv4guiImageProcessingUtils::itkImPoint image, double sigma){
   auto gradientFilter = itk::GradientMagnitudeRecursiveGaussianImageFilter<sv4guiImageProcessingUtils::itkImageType, sv4guiImageProcessingUtils::itkImageType>::New();
 
@@ -43,6 +43,7 @@
 
 #include <itkImage.h>
 #include <string>
+#include <vector>
 #include <itkBinaryBallStructuringElement.h>
 
 class SV4GUIMODULEIMAGEPROCESSING_EXPORT sv4guiImageProcessingUtils
@@ -63,9 +64,19 @@ public:
     static itkImPoint vtkImageToItkImage(vtkImageData* imageData);
     static vtkSmartPointer<vtkImageData> itkImageToVtkImage(itkImPoint image);
 
+    //vtk view of an itk image that shares its pixel buffer; the itk image
+    //must outlive the view
+    static vtkSmartPointer<vtkImageData> itkImageToVtkImageView(itkImPoint image);
+
     static vtkSmartPointer<vtkPolyData> marchingCubes(vtkImageData* imageData, double isovalue,
       bool largest_cc);
 
+    static vtkSmartPointer<vtkPolyData> marchingCubes(itkImPoint image, double isovalue,
+      bool largest_cc);
+
+    //isosurface component nearest the seed point (px,py,pz); only the cells
+    //that component crosses are triangulated, in parallel slabs. API only
+    //for now, the plugin's isovalue step has no seed point
     static vtkSmartPointer<vtkPolyData> seedMarchingCubes(vtkImageData* imageData, double isovalue,
     double px, double py, double pz);
 
@@ -88,6 +99,29 @@ public:
     static itkImPoint collidingFronts(itkImPoint image, int x1, int y1, int z1, int x2,
       int y2, int z2, double lowerThreshold, double upperThreshold);
 
+    //thresholded, [0,1] rescaled speed image used by collidingFronts; compute
+    //it once when running several seed pairs on the same image
+    static itkImPoint collidingFrontsSpeed(itkImPoint image,
+      double lowerThreshold, double upperThreshold);
+
+    static itkImPoint collidingFrontsFromSpeed(itkImPoint speed, int x1, int y1, int z1,
+      int x2, int y2, int z2);
+
+    //elementwise minimum written over image1's buffer
+    static itkImPoint elementwiseMinimumInPlace(itkImPoint image1, itkImPoint image2);
+
+    //connectedThreshold -> openClose -> fillHoles run as one itk pipeline,
+    //with each stage's buffer released as soon as the next has consumed it;
+    //openCloseRadius <= 0 skips the morphology, insideValue is 1. API only,
+    //the plugin has no connected threshold, open/close or fill holes step
+    static itkImPoint seedSegmentation(itkImPoint image,
+      double lowerThreshold, double upperThreshold, std::vector<std::vector<int>> seeds,
+      int openCloseRadius, bool fill);
+
+    static vtkSmartPointer<vtkPolyData> seedSegmentationSurface(itkImPoint image,
+      double lowerThreshold, double upperThreshold, std::vector<std::vector<int>> seeds,
+      int openCloseRadius, bool fill, double isovalue, bool largest_cc);
+
     static itkImPoint zeroLevel(itkImPoint image, double pixelValue);
 
     static itkImPoint openClose(itkImPoint image, int radius);
@@ -31,6 +31,8 @@
 set(H_FILES
     sv4gui_Mesh.h
     sv4gui_MeshTetGen.h
+    sv4gui_MeshCache.h
+    sv4gui_MeshBinaryIO.h
     sv4gui_MitkMesh.h
     sv4gui_MeshFactory.h
     sv4gui_RegisterTetGenFunction.h
@@ -47,6 +49,8 @@ set(H_FILES
 set(CPP_FILES
     sv4gui_Mesh.cxx
     sv4gui_MeshTetGen.cxx
+    sv4gui_MeshCache.cxx
+    sv4gui_MeshBinaryIO.cxx
     sv4gui_MeshFactory.cxx
     sv4gui_RegisterTetGenFunction.cxx
     sv4gui_MitkMesh.cxx
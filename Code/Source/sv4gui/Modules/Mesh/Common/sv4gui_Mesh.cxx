@@ -31,6 +31,7 @@
 
 #include "sv4gui_Mesh.h"
 
+#include "sv4gui_MeshBinaryIO.h"
 #include "sv4gui_StringUtils.h"
 
 #include <vtkXMLPolyDataWriter.h>
@@ -231,6 +232,16 @@ bool sv4guiMesh::WriteVolumeFile(std::string filePath)
     return true;
 }
 
+bool sv4guiMesh::WriteBinaryFile(std::string filePath)
+{
+    // nothing loaded means the .vtp/.vtu were not rewritten either, so an
+    // existing container still matches them
+    if(!m_SurfaceMesh && !m_VolumeMesh)
+        return true;
+
+    return sv4guiMeshBinaryIO::Write(filePath,m_SurfaceMesh,m_VolumeMesh);
+}
+
 bool sv4guiMesh::ReadSurfaceFile(std::string filePath)
 {
     m_SurfaceMesh=CreateSurfaceMeshFromFile(filePath);
@@ -247,6 +258,14 @@ bool sv4guiMesh::ReadVolumeFile(std::string filePath)
 
 vtkSmartPointer<vtkPolyData> sv4guiMesh::CreateSurfaceMeshFromFile(std::string filePath)
 {
+    std::string binaryFilePath=sv4guiMeshBinaryIO::GetFilePath(filePath);
+    if(sv4guiMeshBinaryIO::IsCurrent(binaryFilePath,filePath))
+    {
+        vtkSmartPointer<vtkPolyData> surfaceMesh=sv4guiMeshBinaryIO::ReadSurface(binaryFilePath);
+        if(surfaceMesh)
+            return surfaceMesh;
+    }
+
     vtkSmartPointer<vtkPolyData> surfaceMesh=NULL;
     std::ifstream surfaceFile(filePath);
     if (surfaceFile) {
@@ -262,6 +281,14 @@ vtkSmartPointer<vtkPolyData> sv4guiMesh::CreateSurfaceMeshFromFile(std::string f
 
 vtkSmartPointer<vtkUnstructuredGrid> sv4guiMesh::CreateVolumeMeshFromFile(std::string filePath)
 {
+    std::string binaryFilePath=sv4guiMeshBinaryIO::GetFilePath(filePath);
+    if(sv4guiMeshBinaryIO::IsCurrent(binaryFilePath,filePath))
+    {
+        vtkSmartPointer<vtkUnstructuredGrid> volumeMesh=sv4guiMeshBinaryIO::ReadVolume(binaryFilePath);
+        if(volumeMesh)
+            return volumeMesh;
+    }
+
     vtkSmartPointer<vtkUnstructuredGrid> volumeMesh=NULL;
     std::ifstream volumeFile(filePath);
     if (volumeFile) {
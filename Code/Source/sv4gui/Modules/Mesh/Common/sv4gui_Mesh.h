@@ -76,7 +76,7 @@ public:
 
     virtual bool ParseCommand(std::string cmd, std::string& flag, double values[20], std::string strValues[5], bool& option, std::string& msg) {return false;}
 
-    bool ExecuteCommands(std::vector<std::string> cmds, std::string& msg);
+    virtual bool ExecuteCommands(std::vector<std::string> cmds, std::string& msg);
 
 //    bool ExecuteCommandFile(std::string filePath);
 
@@ -100,6 +100,8 @@ public:
 
     virtual bool WriteVolumeFile(std::string filePath);
 
+    virtual bool WriteBinaryFile(std::string filePath);
+
     virtual bool ReadSurfaceFile(std::string filePath);
 
     virtual bool ReadVolumeFile(std::string filePath);
@@ -0,0 +1,805 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sv4gui_MeshBinaryIO.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkDataArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <map>
+
+struct sv4guiMeshBinaryHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 numBlocks;
+    quint32 unused;
+};
+
+struct sv4guiMeshBinaryBlock
+{
+    char name[64];
+    quint32 dataType;
+    quint32 components;
+    qint32 attribute;
+    quint32 unused;
+    qint64 tuples;
+    qint64 count;
+    qint64 offset;
+    qint64 size;
+};
+
+static const char sv4guiMeshBinary_Magic[8]={'S','V','M','E','S','H','B','\0'};
+static const quint32 sv4guiMeshBinary_Version=1;
+static const quint32 sv4guiMeshBinary_ByteOrder=0x01020304;
+
+// Bytes per value in the file; 0 for types that are not stored. Id type
+// values are always int64, whatever the size of vtkIdType.
+static qint64 sv4guiMeshBinary_TypeSize(int dataType)
+{
+    switch(dataType)
+    {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR:
+    case VTK_UNSIGNED_CHAR:
+        return 1;
+    case VTK_SHORT:
+    case VTK_UNSIGNED_SHORT:
+        return 2;
+    case VTK_INT:
+    case VTK_UNSIGNED_INT:
+    case VTK_FLOAT:
+        return 4;
+    case VTK_LONG_LONG:
+    case VTK_UNSIGNED_LONG_LONG:
+    case VTK_DOUBLE:
+    case VTK_ID_TYPE:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+// -------------------
+//  Writing
+// -------------------
+
+class sv4guiMeshBinaryWriter
+{
+public:
+
+    bool AddBlock(std::string name, int dataType, int components, qint64 tuples, qint64 count, int attribute, const void* values)
+    {
+        qint64 typeSize=sv4guiMeshBinary_TypeSize(dataType);
+        if(typeSize==0 || name.size()>=sizeof(((sv4guiMeshBinaryBlock*)0)->name))
+            return false;
+
+        sv4guiMeshBinaryBlock block;
+        memset(&block,0,sizeof(block));
+        strcpy(block.name,name.c_str());
+        block.dataType=dataType;
+        block.components=components;
+        block.attribute=attribute;
+        block.tuples=tuples;
+        block.count=count;
+        block.size=tuples*components*typeSize;
+        m_Blocks.push_back(block);
+        m_Values.push_back(values);
+        return true;
+    }
+
+    bool AddArray(std::string name, vtkDataArray* array, int attribute, qint64 count)
+    {
+        if(array==NULL)
+            return false;
+
+        qint64 numValues=array->GetNumberOfTuples()*array->GetNumberOfComponents();
+        const void* values=numValues>0?array->GetVoidPointer(0):NULL;
+        if(array->GetDataType()==VTK_ID_TYPE && sizeof(vtkIdType)!=8)
+        {
+            m_Converted.push_back(std::vector<qint64>(numValues));
+            const vtkIdType* ids=static_cast<const vtkIdType*>(values);
+            for(qint64 i=0;i<numValues;i++)
+                m_Converted.back()[i]=ids[i];
+            values=numValues>0?&m_Converted.back()[0]:NULL;
+        }
+
+        return AddBlock(name,array->GetDataType(),array->GetNumberOfComponents(),array->GetNumberOfTuples(),count,attribute,values);
+    }
+
+    // every array has to be stored, or the container would not match the
+    // XML file and must not be written
+    bool AddAttributes(std::string prefix, vtkDataSetAttributes* attributes)
+    {
+        for(int i=0;i<attributes->GetNumberOfArrays();i++)
+        {
+            vtkDataArray* array=attributes->GetArray(i);
+            if(array==NULL || array->GetName()==NULL)
+                return false;
+
+            if(!AddArray(prefix+array->GetName(),array,attributes->IsArrayAnAttribute(i),array->GetNumberOfTuples()))
+                return false;
+        }
+        return true;
+    }
+
+    // copies the blocks whose names start with prefix out of an existing
+    // container, so they no longer depend on its mapping
+    void CopyBlocks(std::string prefix, const std::vector<sv4guiMeshBinaryBlock>& blocks, const uchar* data)
+    {
+        for(size_t i=0;i<blocks.size();i++)
+        {
+            const sv4guiMeshBinaryBlock& block=blocks[i];
+            if(std::string(block.name).compare(0,prefix.size(),prefix)!=0)
+                continue;
+
+            m_Copied.push_back(std::vector<char>(data+block.offset,data+block.offset+block.size));
+            m_Blocks.push_back(block);
+            m_Values.push_back(m_Copied.back().empty()?NULL:&m_Copied.back()[0]);
+        }
+    }
+
+    bool AddFaceIndex(vtkPolyData* surfaceMesh)
+    {
+        vtkDataArray* faceIDs=surfaceMesh->GetCellData()->GetArray("ModelFaceID");
+        if(faceIDs==NULL || faceIDs->GetNumberOfComponents()!=1)
+            return true;
+
+        vtkIdType numCells=surfaceMesh->GetPolys()->GetNumberOfCells();
+        vtkIdType* ids=surfaceMesh->GetPolys()->GetPointer();
+        std::map<int,std::vector<qint64> > faceCells;
+        std::vector<qint64> locations(numCells);
+        qint64 location=0;
+        for(vtkIdType i=0;i<numCells;i++)
+        {
+            faceCells[static_cast<int>(faceIDs->GetTuple1(i))].push_back(i);
+            locations[i]=location;
+            location+=ids[location]+1;
+        }
+
+        m_FaceIDs.clear();
+        std::vector<qint64> offsets(1,0);
+        std::vector<qint64> cells;
+        std::vector<qint64> cellLocations;
+        cells.reserve(numCells);
+        cellLocations.reserve(numCells);
+        for(std::map<int,std::vector<qint64> >::iterator it=faceCells.begin();it!=faceCells.end();++it)
+        {
+            m_FaceIDs.push_back(it->first);
+            for(size_t j=0;j<it->second.size();j++)
+            {
+                cells.push_back(it->second[j]);
+                cellLocations.push_back(locations[it->second[j]]);
+            }
+            offsets.push_back(cells.size());
+        }
+
+        m_Converted.push_back(offsets);
+        const void* offsetValues=&m_Converted.back()[0];
+        m_Converted.push_back(cells);
+        const void* cellValues=cells.empty()?NULL:&m_Converted.back()[0];
+        m_Converted.push_back(cellLocations);
+        const void* locationValues=cellLocations.empty()?NULL:&m_Converted.back()[0];
+
+        qint64 numFaces=m_FaceIDs.size();
+        return AddBlock("face.ids",VTK_INT,1,numFaces,numFaces,-1,numFaces>0?&m_FaceIDs[0]:NULL)
+                && AddBlock("face.offsets",VTK_LONG_LONG,1,numFaces+1,numFaces+1,-1,offsetValues)
+                && AddBlock("face.cells",VTK_LONG_LONG,1,numCells,numCells,-1,cellValues)
+                && AddBlock("face.locations",VTK_LONG_LONG,1,numCells,numCells,-1,locationValues);
+    }
+
+    bool Save(std::string filePath)
+    {
+        sv4guiMeshBinaryHeader header;
+        memset(&header,0,sizeof(header));
+        memcpy(header.magic,sv4guiMeshBinary_Magic,sizeof(header.magic));
+        header.version=sv4guiMeshBinary_Version;
+        header.byteOrder=sv4guiMeshBinary_ByteOrder;
+        header.numBlocks=m_Blocks.size();
+
+        qint64 offset=sizeof(header)+m_Blocks.size()*sizeof(sv4guiMeshBinaryBlock);
+        for(size_t i=0;i<m_Blocks.size();i++)
+        {
+            offset=(offset+7)/8*8;
+            m_Blocks[i].offset=offset;
+            offset+=m_Blocks[i].size;
+        }
+
+        // written under a temporary name so a failed write never leaves a
+        // truncated container behind
+        QString path=QString::fromStdString(filePath);
+        QString tempPath=path+".tmp";
+        QFile file(tempPath);
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+
+        bool ok=file.write(reinterpret_cast<const char*>(&header),sizeof(header))==sizeof(header);
+        if(ok && !m_Blocks.empty())
+        {
+            qint64 directorySize=m_Blocks.size()*sizeof(sv4guiMeshBinaryBlock);
+            ok=file.write(reinterpret_cast<const char*>(&m_Blocks[0]),directorySize)==directorySize;
+        }
+
+        const char padding[8]={0,0,0,0,0,0,0,0};
+        for(size_t i=0;ok && i<m_Blocks.size();i++)
+        {
+            qint64 pad=m_Blocks[i].offset-file.pos();
+            if(pad>0)
+                ok=file.write(padding,pad)==pad;
+            if(ok && m_Blocks[i].size>0)
+                ok=file.write(static_cast<const char*>(m_Values[i]),m_Blocks[i].size)==m_Blocks[i].size;
+        }
+
+        file.close();
+        if(!ok || file.error()!=QFileDevice::NoError)
+        {
+            QFile::remove(tempPath);
+            return false;
+        }
+
+        QFile::remove(path);
+        if(!QFile::rename(tempPath,path))
+        {
+            QFile::remove(tempPath);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+
+    std::vector<sv4guiMeshBinaryBlock> m_Blocks;
+
+    std::vector<const void*> m_Values;
+
+    std::deque<std::vector<qint64> > m_Converted;
+
+    std::deque<std::vector<char> > m_Copied;
+
+    std::vector<int> m_FaceIDs;
+};
+
+// -------------------
+//  Reading
+// -------------------
+
+class sv4guiMeshBinaryFile
+{
+public:
+
+    sv4guiMeshBinaryFile() : m_Data(NULL), m_Size(0) {}
+
+    // maps the file and checks the header and the directory; block data
+    // is only paged in once it is read
+    bool Open(std::string filePath)
+    {
+        m_File.setFileName(QString::fromStdString(filePath));
+        if(!m_File.open(QIODevice::ReadOnly))
+            return false;
+
+        m_Size=m_File.size();
+        if(m_Size<(qint64)sizeof(sv4guiMeshBinaryHeader))
+            return false;
+
+        m_Data=m_File.map(0,m_Size);
+        if(m_Data==NULL)
+            return false;
+
+        sv4guiMeshBinaryHeader header;
+        memcpy(&header,m_Data,sizeof(header));
+        if(memcmp(header.magic,sv4guiMeshBinary_Magic,sizeof(header.magic))!=0
+                || header.version!=sv4guiMeshBinary_Version
+                || header.byteOrder!=sv4guiMeshBinary_ByteOrder)
+            return false;
+
+        if(sizeof(header)+(qint64)header.numBlocks*sizeof(sv4guiMeshBinaryBlock)>(quint64)m_Size)
+            return false;
+
+        m_Blocks.resize(header.numBlocks);
+        for(quint32 i=0;i<header.numBlocks;i++)
+        {
+            sv4guiMeshBinaryBlock& block=m_Blocks[i];
+            memcpy(&block,m_Data+sizeof(header)+i*sizeof(sv4guiMeshBinaryBlock),sizeof(block));
+
+            // the size is only computed once the factors are known to be
+            // small enough not to overflow
+            qint64 typeSize=sv4guiMeshBinary_TypeSize(block.dataType);
+            if(memchr(block.name,'\0',sizeof(block.name))==NULL || typeSize==0
+                    || block.components==0 || block.tuples<0 || block.count<0
+                    || (block.tuples>0 && block.components>m_Size/typeSize/block.tuples)
+                    || block.offset<0 || block.offset%8!=0
+                    || block.size!=block.tuples*block.components*typeSize
+                    || block.offset>m_Size || block.size>m_Size-block.offset)
+                return false;
+        }
+
+        return true;
+    }
+
+    void Close()
+    {
+        if(m_Data)
+            m_File.unmap(m_Data);
+        m_Data=NULL;
+        m_File.close();
+    }
+
+    const std::vector<sv4guiMeshBinaryBlock>& GetBlocks()
+    {
+        return m_Blocks;
+    }
+
+    const uchar* GetData()
+    {
+        return m_Data;
+    }
+
+    const sv4guiMeshBinaryBlock* Find(std::string name)
+    {
+        for(size_t i=0;i<m_Blocks.size();i++)
+        {
+            if(name==m_Blocks[i].name)
+                return &m_Blocks[i];
+        }
+        return NULL;
+    }
+
+    const uchar* GetValues(const sv4guiMeshBinaryBlock* block)
+    {
+        return m_Data+block->offset;
+    }
+
+    // copies a block, or only the given tuples of it, into a new array
+    vtkSmartPointer<vtkDataArray> CreateArray(const sv4guiMeshBinaryBlock* block, const std::vector<qint64>* tupleIDs=NULL)
+    {
+        vtkSmartPointer<vtkDataArray> array=vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(block->dataType));
+        qint64 numTuples=tupleIDs?tupleIDs->size():block->tuples;
+        array->SetNumberOfComponents(block->components);
+        array->SetNumberOfTuples(numTuples);
+
+        const uchar* values=GetValues(block);
+        qint64 tupleSize=block->components*sv4guiMeshBinary_TypeSize(block->dataType);
+        bool convertIDs=(block->dataType==VTK_ID_TYPE && sizeof(vtkIdType)!=8);
+        for(qint64 i=0;i<numTuples;i++)
+        {
+            qint64 source=tupleIDs?(*tupleIDs)[i]:i;
+            if(convertIDs)
+            {
+                const qint64* ids=reinterpret_cast<const qint64*>(values+source*tupleSize);
+                for(quint32 j=0;j<block->components;j++)
+                    array->SetComponent(i,j,ids[j]);
+            }
+            else if(tupleIDs)
+            {
+                memcpy(static_cast<uchar*>(array->GetVoidPointer(0))+i*tupleSize,values+source*tupleSize,tupleSize);
+            }
+            else
+            {
+                if(numTuples>0)
+                    memcpy(array->GetVoidPointer(0),values,block->size);
+                break;
+            }
+        }
+
+        return array;
+    }
+
+    // every array has to hold one tuple per point or cell (numTuples); the
+    // tupleIDs, if given, have been checked against numTuples
+    bool ReadAttributes(std::string prefix, vtkDataSetAttributes* attributes, qint64 numTuples, const std::vector<qint64>* tupleIDs=NULL)
+    {
+        for(size_t i=0;i<m_Blocks.size();i++)
+        {
+            std::string name=m_Blocks[i].name;
+            if(name.compare(0,prefix.size(),prefix)!=0)
+                continue;
+
+            if(m_Blocks[i].tuples!=numTuples)
+                return false;
+        }
+
+        for(size_t i=0;i<m_Blocks.size();i++)
+        {
+            std::string name=m_Blocks[i].name;
+            if(name.compare(0,prefix.size(),prefix)!=0)
+                continue;
+
+            vtkSmartPointer<vtkDataArray> array=CreateArray(&m_Blocks[i],tupleIDs);
+            array->SetName(name.substr(prefix.size()).c_str());
+            attributes->AddArray(array);
+            if(m_Blocks[i].attribute>=0)
+                attributes->SetActiveAttribute(array->GetName(),m_Blocks[i].attribute);
+        }
+        return true;
+    }
+
+    vtkSmartPointer<vtkPoints> ReadPoints(std::string name)
+    {
+        const sv4guiMeshBinaryBlock* block=Find(name);
+        if(block==NULL || block->components!=3)
+            return NULL;
+
+        vtkSmartPointer<vtkPoints> points=vtkSmartPointer<vtkPoints>::New();
+        points->SetData(CreateArray(block));
+        return points;
+    }
+
+    // the connectivity has to hold exactly block->count cells, each with
+    // its point count followed by that many ids of the numPoints points
+    vtkSmartPointer<vtkCellArray> ReadCells(std::string name, qint64 numPoints)
+    {
+        const sv4guiMeshBinaryBlock* block=Find(name);
+        if(block==NULL || block->dataType!=VTK_ID_TYPE || block->components!=1)
+            return NULL;
+
+        const qint64* ids=reinterpret_cast<const qint64*>(GetValues(block));
+        qint64 location=0;
+        for(qint64 i=0;i<block->count;i++)
+        {
+            if(location>=block->tuples || ids[location]<0 || ids[location]>=block->tuples-location)
+                return NULL;
+
+            for(qint64 j=location+1;j<=location+ids[location];j++)
+            {
+                if(ids[j]<0 || ids[j]>=numPoints)
+                    return NULL;
+            }
+            location+=ids[location]+1;
+        }
+        if(location!=block->tuples)
+            return NULL;
+
+        vtkSmartPointer<vtkCellArray> cells=vtkSmartPointer<vtkCellArray>::New();
+        cells->SetCells(block->count,vtkIdTypeArray::SafeDownCast(CreateArray(block)));
+        return cells;
+    }
+
+private:
+
+    QFile m_File;
+
+    uchar* m_Data;
+
+    qint64 m_Size;
+
+    std::vector<sv4guiMeshBinaryBlock> m_Blocks;
+};
+
+// -------------------
+//  GetFilePath
+// -------------------
+/**
+ * @brief The container belonging to a mesh file: the same path with the
+ *        extension replaced by .msb.
+ */
+
+std::string sv4guiMeshBinaryIO::GetFilePath(std::string meshFilePath)
+{
+    std::string::size_type dot=meshFilePath.find_last_of('.');
+    std::string::size_type slash=meshFilePath.find_last_of("/\\");
+    if(dot==std::string::npos || (slash!=std::string::npos && dot<slash))
+        return meshFilePath+".msb";
+
+    return meshFilePath.substr(0,dot)+".msb";
+}
+
+// Whether the file exists and is at least as new as the XML file.
+static bool sv4guiMeshBinary_IsNewer(std::string filePath, std::string sourceFilePath)
+{
+    QFileInfo info(QString::fromStdString(filePath));
+    QFileInfo sourceInfo(QString::fromStdString(sourceFilePath));
+    return info.exists() && sourceInfo.exists() && info.lastModified()>=sourceInfo.lastModified();
+}
+
+// -------------------
+//  Write
+// -------------------
+/**
+ * @brief Write the container. A mesh that is not given (not loaded) keeps
+ *        its blocks from the existing container, as long as that container
+ *        is current with the XML file (<name>.vtp or <name>.vtu), which was
+ *        not rewritten either.
+ */
+
+bool sv4guiMeshBinaryIO::Write(std::string filePath, vtkSmartPointer<vtkPolyData> surfaceMesh, vtkSmartPointer<vtkUnstructuredGrid> volumeMesh)
+{
+    // neither XML file was rewritten, so the container is as current as before
+    if(!surfaceMesh && !volumeMesh)
+        return true;
+
+    sv4guiMeshBinaryWriter writer;
+
+    if(!surfaceMesh || !volumeMesh)
+    {
+        // the XML files share the path of the container up to the extension
+        std::string basePath=GetFilePath(filePath);
+        basePath=basePath.substr(0,basePath.size()-4);
+
+        sv4guiMeshBinaryFile file;
+        if(file.Open(filePath))
+        {
+            if(!surfaceMesh && sv4guiMeshBinary_IsNewer(filePath,basePath+".vtp"))
+            {
+                writer.CopyBlocks("surface.",file.GetBlocks(),file.GetData());
+                writer.CopyBlocks("face.",file.GetBlocks(),file.GetData());
+            }
+            if(!volumeMesh && sv4guiMeshBinary_IsNewer(filePath,basePath+".vtu"))
+                writer.CopyBlocks("volume.",file.GetBlocks(),file.GetData());
+        }
+        file.Close();
+    }
+
+    // a container that could not be brought up to date must not stay
+    // around, or it would be read instead of the new XML files
+    QFile::remove(QString::fromStdString(filePath));
+
+    if(surfaceMesh)
+    {
+        if(surfaceMesh->GetPoints()==NULL
+                || surfaceMesh->GetNumberOfVerts()>0
+                || surfaceMesh->GetNumberOfLines()>0
+                || surfaceMesh->GetNumberOfStrips()>0)
+            return false;
+
+        vtkCellArray* polys=surfaceMesh->GetPolys();
+        if(!writer.AddArray("surface.points",surfaceMesh->GetPoints()->GetData(),-1,surfaceMesh->GetNumberOfPoints())
+                || !writer.AddArray("surface.polys",polys->GetData(),-1,polys->GetNumberOfCells())
+                || !writer.AddAttributes("surface.point.",surfaceMesh->GetPointData())
+                || !writer.AddAttributes("surface.cell.",surfaceMesh->GetCellData())
+                || !writer.AddFaceIndex(surfaceMesh))
+            return false;
+    }
+
+    if(volumeMesh)
+    {
+        if(volumeMesh->GetPoints()==NULL || volumeMesh->GetCells()==NULL
+                || volumeMesh->GetCellTypesArray()==NULL || volumeMesh->GetFaces()!=NULL)
+            return false;
+
+        if(!writer.AddArray("volume.points",volumeMesh->GetPoints()->GetData(),-1,volumeMesh->GetNumberOfPoints())
+                || !writer.AddArray("volume.cells",volumeMesh->GetCells()->GetData(),-1,volumeMesh->GetNumberOfCells())
+                || !writer.AddArray("volume.types",volumeMesh->GetCellTypesArray(),-1,volumeMesh->GetNumberOfCells())
+                || !writer.AddAttributes("volume.point.",volumeMesh->GetPointData())
+                || !writer.AddAttributes("volume.cell.",volumeMesh->GetCellData()))
+            return false;
+    }
+
+    return writer.Save(filePath);
+}
+
+// -------------------
+//  IsCurrent
+// -------------------
+/**
+ * @brief Whether the container is valid and at least as new as the XML
+ *        file it was written with, so it can be read in its place.
+ */
+
+bool sv4guiMeshBinaryIO::IsCurrent(std::string filePath, std::string sourceFilePath)
+{
+    if(!sv4guiMeshBinary_IsNewer(filePath,sourceFilePath))
+        return false;
+
+    sv4guiMeshBinaryFile file;
+    return file.Open(filePath);
+}
+
+bool sv4guiMeshBinaryIO::HasVolume(std::string filePath)
+{
+    sv4guiMeshBinaryFile file;
+    return file.Open(filePath) && file.Find("volume.cells")!=NULL;
+}
+
+vtkSmartPointer<vtkPolyData> sv4guiMeshBinaryIO::ReadSurface(std::string filePath)
+{
+    sv4guiMeshBinaryFile file;
+    if(!file.Open(filePath))
+        return NULL;
+
+    // anything inconsistent returns NULL, so the XML file is read instead
+    vtkSmartPointer<vtkPoints> points=file.ReadPoints("surface.points");
+    if(!points)
+        return NULL;
+
+    vtkSmartPointer<vtkCellArray> polys=file.ReadCells("surface.polys",points->GetNumberOfPoints());
+    if(!polys)
+        return NULL;
+
+    vtkSmartPointer<vtkPolyData> surfaceMesh=vtkSmartPointer<vtkPolyData>::New();
+    surfaceMesh->SetPoints(points);
+    surfaceMesh->SetPolys(polys);
+    if(!file.ReadAttributes("surface.point.",surfaceMesh->GetPointData(),points->GetNumberOfPoints())
+            || !file.ReadAttributes("surface.cell.",surfaceMesh->GetCellData(),polys->GetNumberOfCells()))
+        return NULL;
+
+    return surfaceMesh;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> sv4guiMeshBinaryIO::ReadVolume(std::string filePath)
+{
+    sv4guiMeshBinaryFile file;
+    if(!file.Open(filePath))
+        return NULL;
+
+    // anything inconsistent returns NULL, so the XML file is read instead
+    vtkSmartPointer<vtkPoints> points=file.ReadPoints("volume.points");
+    if(!points)
+        return NULL;
+
+    vtkSmartPointer<vtkCellArray> cells=file.ReadCells("volume.cells",points->GetNumberOfPoints());
+    const sv4guiMeshBinaryBlock* typeBlock=file.Find("volume.types");
+    if(!cells || typeBlock==NULL || typeBlock->dataType!=VTK_UNSIGNED_CHAR
+            || typeBlock->components!=1 || typeBlock->tuples!=cells->GetNumberOfCells())
+        return NULL;
+
+    // polyhedra would need the face stream, which is never written
+    const uchar* cellTypes=file.GetValues(typeBlock);
+    std::vector<int> types(cellTypes,cellTypes+typeBlock->tuples);
+    for(size_t i=0;i<types.size();i++)
+    {
+        if(types[i]>=VTK_NUMBER_OF_CELL_TYPES || types[i]==VTK_POLYHEDRON)
+            return NULL;
+    }
+
+    vtkSmartPointer<vtkUnstructuredGrid> volumeMesh=vtkSmartPointer<vtkUnstructuredGrid>::New();
+    volumeMesh->SetPoints(points);
+    volumeMesh->SetCells(types.empty()?NULL:&types[0],cells);
+    if(!file.ReadAttributes("volume.point.",volumeMesh->GetPointData(),points->GetNumberOfPoints())
+            || !file.ReadAttributes("volume.cell.",volumeMesh->GetCellData(),cells->GetNumberOfCells()))
+        return NULL;
+
+    return volumeMesh;
+}
+
+std::vector<int> sv4guiMeshBinaryIO::GetFaceIDs(std::string filePath)
+{
+    std::vector<int> faceIDs;
+
+    sv4guiMeshBinaryFile file;
+    if(!file.Open(filePath))
+        return faceIDs;
+
+    const sv4guiMeshBinaryBlock* block=file.Find("face.ids");
+    if(block && block->dataType==VTK_INT && block->components==1)
+    {
+        const int* ids=reinterpret_cast<const int*>(file.GetValues(block));
+        faceIDs.assign(ids,ids+block->tuples);
+    }
+
+    return faceIDs;
+}
+
+// -------------------
+//  ReadFace
+// -------------------
+/**
+ * @brief The surface cells with the given ModelFaceID and the points they
+ *        use, with the point and cell data of both. Only the blocks of
+ *        that face are read.
+ */
+
+vtkSmartPointer<vtkPolyData> sv4guiMeshBinaryIO::ReadFace(std::string filePath, int faceID)
+{
+    sv4guiMeshBinaryFile file;
+    if(!file.Open(filePath))
+        return NULL;
+
+    const sv4guiMeshBinaryBlock* idBlock=file.Find("face.ids");
+    const sv4guiMeshBinaryBlock* offsetBlock=file.Find("face.offsets");
+    const sv4guiMeshBinaryBlock* cellBlock=file.Find("face.cells");
+    const sv4guiMeshBinaryBlock* locationBlock=file.Find("face.locations");
+    const sv4guiMeshBinaryBlock* polyBlock=file.Find("surface.polys");
+    const sv4guiMeshBinaryBlock* pointBlock=file.Find("surface.points");
+    if(!idBlock || !offsetBlock || !cellBlock || !locationBlock || !polyBlock || !pointBlock
+            || idBlock->dataType!=VTK_INT || idBlock->components!=1
+            || offsetBlock->dataType!=VTK_LONG_LONG || offsetBlock->components!=1
+            || cellBlock->dataType!=VTK_LONG_LONG || cellBlock->components!=1
+            || locationBlock->dataType!=VTK_LONG_LONG || locationBlock->components!=1
+            || polyBlock->dataType!=VTK_ID_TYPE || polyBlock->components!=1
+            || pointBlock->components!=3
+            || offsetBlock->tuples!=idBlock->tuples+1 || locationBlock->tuples!=cellBlock->tuples)
+        return NULL;
+
+    const int* ids=reinterpret_cast<const int*>(file.GetValues(idBlock));
+    const int* id=std::lower_bound(ids,ids+idBlock->tuples,faceID);
+    if(id==ids+idBlock->tuples || *id!=faceID)
+        return NULL;
+
+    const qint64* offsets=reinterpret_cast<const qint64*>(file.GetValues(offsetBlock));
+    const qint64* faceCells=reinterpret_cast<const qint64*>(file.GetValues(cellBlock));
+    const qint64* locations=reinterpret_cast<const qint64*>(file.GetValues(locationBlock));
+    const qint64* polys=reinterpret_cast<const qint64*>(file.GetValues(polyBlock));
+    qint64 first=offsets[id-ids];
+    qint64 last=offsets[id-ids+1];
+    if(first<0 || first>last || last>cellBlock->tuples)
+        return NULL;
+
+    std::vector<qint64> cellIDs(faceCells+first,faceCells+last);
+    for(size_t i=0;i<cellIDs.size();i++)
+    {
+        if(cellIDs[i]<0 || cellIDs[i]>=polyBlock->count)
+            return NULL;
+    }
+    std::vector<qint64> pointIDs;
+    std::map<qint64,vtkIdType> pointMap;
+    vtkSmartPointer<vtkCellArray> cells=vtkSmartPointer<vtkCellArray>::New();
+    std::vector<vtkIdType> cellPoints;
+    for(qint64 i=first;i<last;i++)
+    {
+        qint64 location=locations[i];
+        if(location<0 || location>=polyBlock->tuples || polys[location]<0
+                || polys[location]>=polyBlock->tuples-location)
+            return NULL;
+
+        cellPoints.resize(polys[location]);
+        for(qint64 j=0;j<polys[location];j++)
+        {
+            qint64 pointID=polys[location+1+j];
+            if(pointID<0 || pointID>=pointBlock->tuples)
+                return NULL;
+
+            std::map<qint64,vtkIdType>::iterator it=pointMap.find(pointID);
+            if(it==pointMap.end())
+            {
+                it=pointMap.insert(std::make_pair(pointID,(vtkIdType)pointIDs.size())).first;
+                pointIDs.push_back(pointID);
+            }
+            cellPoints[j]=it->second;
+        }
+        cells->InsertNextCell(cellPoints.size(),cellPoints.empty()?NULL:&cellPoints[0]);
+    }
+
+    vtkSmartPointer<vtkPoints> points=vtkSmartPointer<vtkPoints>::New();
+    points->SetData(file.CreateArray(pointBlock,&pointIDs));
+
+    vtkSmartPointer<vtkPolyData> face=vtkSmartPointer<vtkPolyData>::New();
+    face->SetPoints(points);
+    face->SetPolys(cells);
+    if(!file.ReadAttributes("surface.point.",face->GetPointData(),pointBlock->tuples,&pointIDs)
+            || !file.ReadAttributes("surface.cell.",face->GetCellData(),polyBlock->count,&cellIDs))
+        return NULL;
+
+    return face;
+}
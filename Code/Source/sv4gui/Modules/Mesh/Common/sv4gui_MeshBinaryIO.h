@@ -0,0 +1,98 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SV4GUI_MESHBINARYIO_H
+#define SV4GUI_MESHBINARYIO_H
+
+#include <sv4guiModuleMeshExports.h>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <string>
+#include <vector>
+
+// Binary container holding the surface and volume mesh of a mesh node
+// (<name>.msb, next to <name>.vtp and <name>.vtu). The blocks are raw
+// arrays read straight out of a memory mapping, with no XML parsing or
+// decompression. The .vtp/.vtu files stay the reference copy; the
+// container is only used while it is at least as new as they are.
+//
+//   header     "SVMESHB\0", uint32 version, uint32 0x01020304 (byte
+//              order check), uint32 number of blocks, uint32 unused
+//   directory  one entry per block: char name[64], uint32 VTK data type,
+//              uint32 components, int32 attribute (vtkDataSetAttributes
+//              type, or -1), uint32 unused, int64 tuples, int64 count,
+//              int64 offset, int64 size in bytes
+//   blocks     raw values, each starting on an 8 byte boundary
+//
+// Blocks are surface.points, surface.polys (vtkCellArray layout as int64,
+// count is the number of cells), surface.point.<array> and
+// surface.cell.<array>; the volume has the same with volume.cells and
+// volume.types. The face index lists the surface cells of each
+// ModelFaceID: face.ids, face.offsets (into face.cells), face.cells and
+// face.locations (where each cell starts in surface.polys). Only the
+// directory is read when the file is opened, so the pages of the volume,
+// or of faces that are not extracted, are never touched.
+//
+// Write keeps the blocks of a mesh that is not given from the existing
+// container. The readers check every block against the others and return
+// NULL for anything inconsistent, so callers read the XML file instead.
+// HasVolume, GetFaceIDs and ReadFace are API only for now; nothing in the
+// tree calls them yet.
+
+class SV4GUIMODULEMESH_EXPORT sv4guiMeshBinaryIO
+{
+public:
+
+  sv4guiMeshBinaryIO(){}
+  virtual ~sv4guiMeshBinaryIO(){}
+
+  static std::string GetFilePath(std::string meshFilePath);
+
+  static bool Write(std::string filePath, vtkSmartPointer<vtkPolyData> surfaceMesh, vtkSmartPointer<vtkUnstructuredGrid> volumeMesh);
+
+  static bool IsCurrent(std::string filePath, std::string sourceFilePath);
+
+  static bool HasVolume(std::string filePath);
+
+  static vtkSmartPointer<vtkPolyData> ReadSurface(std::string filePath);
+
+  static vtkSmartPointer<vtkUnstructuredGrid> ReadVolume(std::string filePath);
+
+  static std::vector<int> GetFaceIDs(std::string filePath);
+
+  static vtkSmartPointer<vtkPolyData> ReadFace(std::string filePath, int faceID);
+
+};
+
+#endif // SV4GUI_MESHBINARYIO_H
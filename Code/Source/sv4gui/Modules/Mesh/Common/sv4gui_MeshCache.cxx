@@ -0,0 +1,441 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sv4gui_MeshCache.h"
+
+#include "sv4gui_StringUtils.h"
+
+#include "simvascular_options.h"
+#include "simvascular_version.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+
+#include <vtkAbstractArray.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkErrorCode.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkXMLPolyDataReader.h>
+#include <vtkXMLPolyDataWriter.h>
+#include <vtkXMLUnstructuredGridReader.h>
+#include <vtkXMLUnstructuredGridWriter.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+qint64 sv4guiMeshCache::m_MaximumSize=qint64(2)*1024*1024*1024;
+
+static void sv4guiMeshCache_AddBytes(QCryptographicHash& hash, const void* data, qint64 numBytes)
+{
+    const char* bytes=static_cast<const char*>(data);
+    const qint64 chunk=qint64(1)<<30;
+    while(numBytes>0)
+    {
+        int n=static_cast<int>(std::min(numBytes,chunk));
+        hash.addData(bytes,n);
+        bytes+=n;
+        numBytes-=n;
+    }
+}
+
+static void sv4guiMeshCache_AddString(QCryptographicHash& hash, std::string s)
+{
+    // the length keeps consecutive strings from running together
+    qint64 length=s.size();
+    sv4guiMeshCache_AddBytes(hash,&length,sizeof(length));
+    sv4guiMeshCache_AddBytes(hash,s.data(),length);
+}
+
+static void sv4guiMeshCache_AddDataArray(QCryptographicHash& hash, vtkDataArray* array)
+{
+    if(array==NULL)
+    {
+        sv4guiMeshCache_AddString(hash,"null");
+        return;
+    }
+
+    sv4guiMeshCache_AddString(hash,array->GetName()?array->GetName():"");
+    qint64 header[3]={array->GetDataType(),array->GetNumberOfComponents(),array->GetNumberOfTuples()};
+    sv4guiMeshCache_AddBytes(hash,header,sizeof(header));
+    if(header[1]>0 && header[2]>0)
+        sv4guiMeshCache_AddBytes(hash,array->GetVoidPointer(0),header[1]*header[2]*array->GetDataTypeSize());
+}
+
+static void sv4guiMeshCache_AddFieldData(QCryptographicHash& hash, vtkFieldData* fieldData)
+{
+    int numArrays=fieldData->GetNumberOfArrays();
+    sv4guiMeshCache_AddBytes(hash,&numArrays,sizeof(numArrays));
+    for(int i=0;i<numArrays;i++)
+    {
+        vtkAbstractArray* array=fieldData->GetAbstractArray(i);
+        if(vtkDataArray::SafeDownCast(array))
+            sv4guiMeshCache_AddDataArray(hash,vtkDataArray::SafeDownCast(array));
+        else if(array)
+            sv4guiMeshCache_AddString(hash,array->GetName()?array->GetName():"");
+    }
+}
+
+static void sv4guiMeshCache_AddCellArray(QCryptographicHash& hash, vtkCellArray* cells)
+{
+    qint64 numCells=cells?cells->GetNumberOfCells():0;
+    sv4guiMeshCache_AddBytes(hash,&numCells,sizeof(numCells));
+    if(numCells>0)
+        sv4guiMeshCache_AddDataArray(hash,cells->GetData());
+}
+
+static void sv4guiMeshCache_TouchStamp(QString stampPath)
+{
+    QFile stamp(stampPath);
+    if(stamp.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        stamp.write(QDateTime::currentDateTime().toString(Qt::ISODate).toUtf8());
+        stamp.close();
+    }
+}
+
+// -------------------
+//  NormalizeCommand
+// -------------------
+/**
+ * @brief Reduce a mesh command to a canonical form for hashing: single
+ *        spaces, a lower case command name (and option name), and numbers
+ *        printed at full precision so "0.50" and "0.5" are the same.
+ */
+
+std::string sv4guiMeshCache::NormalizeCommand(std::string cmd)
+{
+    std::vector<std::string> params=sv4guiStringUtils_split(sv4guiStringUtils_trim(cmd),' ');
+    std::string normalized="";
+    for(int i=0;i<params.size();i++)
+    {
+        std::string param=sv4guiStringUtils_trim(params[i]);
+        if(param=="")
+            continue;
+
+        if(i==0 || (i==1 && sv4guiStringUtils_lower(params[0])=="option"))
+            param=sv4guiStringUtils_lower(param);
+
+        char* end=NULL;
+        double value=strtod(param.c_str(),&end);
+        if(end!=param.c_str() && *end=='\0')
+        {
+            char buffer[64];
+            sprintf(buffer,"%.17g",value);
+            param=buffer;
+        }
+
+        if(normalized!="")
+            normalized+=" ";
+        normalized+=param;
+    }
+
+    return normalized;
+}
+
+// -------------------
+//  GetMesherVersion
+// -------------------
+/**
+ * @brief The mesher and library versions a mesh of this type depends on.
+ *        TetGen and the vmtk boundary layer code are built with SimVascular,
+ *        so the SimVascular version covers changes to either of them.
+ */
+
+std::string sv4guiMeshCache::GetMesherVersion(std::string meshType)
+{
+    std::string version=meshType;
+
+    if(meshType=="TetGen")
+    {
+#if defined(TETGEN151)
+        version+=" 1.5.1";
+#elif defined(TETGEN150)
+        version+=" 1.5.0";
+#elif defined(TETGEN143)
+        version+=" 1.4.3";
+#endif
+#ifdef SV_USE_VMTK
+        version+=" vmtk";
+#endif
+    }
+
+#ifdef SV_FULL_VERSION
+    version+=std::string(" ")+SV_FULL_VERSION;
+#endif
+
+    return version;
+}
+
+// -------------
+//  ComputeKey
+// -------------
+/**
+ * @brief Hash the mesher type and version, the model surface, the model
+ *        faces and the normalized commands into a cache key.
+ * @return The hex SHA-1 digest, or an empty string if there is no model surface.
+ */
+
+QString sv4guiMeshCache::ComputeKey(std::string meshType, sv4guiModelElement* modelElement, std::vector<std::string> cmds)
+{
+    if(modelElement==NULL)
+        return "";
+
+    vtkSmartPointer<vtkPolyData> surface=modelElement->GetWholeVtkPolyData();
+    if(surface==NULL || surface->GetPoints()==NULL)
+        return "";
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    sv4guiMeshCache_AddString(hash,"sv4guiMeshCache 2");
+    sv4guiMeshCache_AddString(hash,meshType);
+    sv4guiMeshCache_AddString(hash,GetMesherVersion(meshType));
+
+    sv4guiMeshCache_AddDataArray(hash,surface->GetPoints()->GetData());
+    sv4guiMeshCache_AddCellArray(hash,surface->GetVerts());
+    sv4guiMeshCache_AddCellArray(hash,surface->GetLines());
+    sv4guiMeshCache_AddCellArray(hash,surface->GetPolys());
+    sv4guiMeshCache_AddCellArray(hash,surface->GetStrips());
+    sv4guiMeshCache_AddFieldData(hash,surface->GetPointData());
+    sv4guiMeshCache_AddFieldData(hash,surface->GetCellData());
+
+    // commands refer to faces by name
+    std::vector<sv4guiModelElement::svFace*> faces=modelElement->GetFaces();
+    for(int i=0;i<faces.size();i++)
+    {
+        if(faces[i]==NULL)
+            continue;
+
+        sv4guiMeshCache_AddBytes(hash,&faces[i]->id,sizeof(faces[i]->id));
+        sv4guiMeshCache_AddString(hash,faces[i]->name);
+        sv4guiMeshCache_AddString(hash,faces[i]->type);
+    }
+
+    for(int i=0;i<cmds.size();i++)
+    {
+        std::string cmd=NormalizeCommand(cmds[i]);
+        if(cmd!="")
+            sv4guiMeshCache_AddString(hash,cmd);
+    }
+
+    return QString(hash.result().toHex());
+}
+
+// -------
+//  Load
+// -------
+/**
+ * @brief Read the meshes stored under key. A complete entry has a stamp
+ *        file and a surface; the volume is optional.
+ * @retval true if the entry exists and was read.
+ */
+
+bool sv4guiMeshCache::Load(QString cacheDir, QString key, vtkSmartPointer<vtkPolyData>& surfaceMesh, vtkSmartPointer<vtkUnstructuredGrid>& volumeMesh)
+{
+    if(cacheDir=="" || key=="")
+        return false;
+
+    QDir dir(cacheDir);
+    QString stampPath=dir.absoluteFilePath(key+".stamp");
+    QString surfacePath=dir.absoluteFilePath(key+".vtp");
+    QString volumePath=dir.absoluteFilePath(key+".vtu");
+    if(!QFile::exists(stampPath) || !QFile::exists(surfacePath))
+        return false;
+
+    vtkSmartPointer<vtkXMLPolyDataReader> surfaceReader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
+    surfaceReader->SetFileName(surfacePath.toStdString().c_str());
+    surfaceReader->Update();
+    if(surfaceReader->GetErrorCode() != 0 || surfaceReader->GetOutput()->GetNumberOfPoints()==0)
+    {
+        Remove(cacheDir,key);
+        return false;
+    }
+
+    vtkSmartPointer<vtkUnstructuredGrid> volume=NULL;
+    if(QFile::exists(volumePath))
+    {
+        vtkSmartPointer<vtkXMLUnstructuredGridReader> volumeReader = vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
+        volumeReader->SetFileName(volumePath.toStdString().c_str());
+        volumeReader->Update();
+        if(volumeReader->GetErrorCode() != 0 || volumeReader->GetOutput()->GetNumberOfPoints()==0)
+        {
+            Remove(cacheDir,key);
+            return false;
+        }
+        volume=volumeReader->GetOutput();
+    }
+
+    surfaceMesh=surfaceReader->GetOutput();
+    volumeMesh=volume;
+
+    sv4guiMeshCache_TouchStamp(stampPath);
+
+    return true;
+}
+
+// --------
+//  Store
+// --------
+/**
+ * @brief Write the meshes under key, then trim the cache to its maximum size.
+ *        The stamp file is written last so a partial entry is never loaded.
+ */
+
+bool sv4guiMeshCache::Store(QString cacheDir, QString key, vtkSmartPointer<vtkPolyData> surfaceMesh, vtkSmartPointer<vtkUnstructuredGrid> volumeMesh)
+{
+    if(cacheDir=="" || key=="" || surfaceMesh==NULL)
+        return false;
+
+    if(!QDir().mkpath(cacheDir))
+        return false;
+
+    QDir dir(cacheDir);
+    QString surfacePath=dir.absoluteFilePath(key+".vtp");
+    QString volumePath=dir.absoluteFilePath(key+".vtu");
+
+    Remove(cacheDir,key);
+
+    if(volumeMesh)
+    {
+        vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
+        writer->SetFileName(volumePath.toStdString().c_str());
+        writer->SetInputData(volumeMesh);
+        if (writer->Write() == 0 || writer->GetErrorCode() != 0 )
+        {
+            std::cerr << "vtkXMLUnstructuredGridWriter error: " << vtkErrorCode::GetStringFromErrorCode(writer->GetErrorCode())<<std::endl;
+            Remove(cacheDir,key);
+            return false;
+        }
+    }
+
+    vtkSmartPointer<vtkXMLPolyDataWriter> writer = vtkSmartPointer<vtkXMLPolyDataWriter>::New();
+    writer->SetFileName(surfacePath.toStdString().c_str());
+    writer->SetInputData(surfaceMesh);
+    if (writer->Write() == 0 || writer->GetErrorCode() != 0 )
+    {
+        std::cerr << "vtkXMLPolyDataWriter error: " << vtkErrorCode::GetStringFromErrorCode(writer->GetErrorCode())<<std::endl;
+        Remove(cacheDir,key);
+        return false;
+    }
+
+    sv4guiMeshCache_TouchStamp(dir.absoluteFilePath(key+".stamp"));
+
+    Trim(cacheDir,key);
+
+    return true;
+}
+
+void sv4guiMeshCache::Remove(QString cacheDir, QString key)
+{
+    if(cacheDir=="" || key=="")
+        return;
+
+    QDir dir(cacheDir);
+    dir.remove(key+".stamp");
+    dir.remove(key+".vtp");
+    dir.remove(key+".vtu");
+}
+
+void sv4guiMeshCache::Clear(QString cacheDir)
+{
+    if(cacheDir=="")
+        return;
+
+    QDir dir(cacheDir);
+    QStringList files=dir.entryList(QStringList() << "*.stamp" << "*.vtp" << "*.vtu", QDir::Files);
+    for(int i=0;i<files.size();i++)
+        dir.remove(files[i]);
+}
+
+// -------
+//  Trim
+// -------
+/**
+ * @brief Remove the least recently used entries until the cache fits in
+ *        the maximum size. Entries without a stamp are partial and go first.
+ * @param keepKey An entry that is never removed, usually the one just stored.
+ */
+
+void sv4guiMeshCache::Trim(QString cacheDir, QString keepKey)
+{
+    if(cacheDir=="")
+        return;
+
+    QDir dir(cacheDir);
+    QFileInfoList files=dir.entryInfoList(QStringList() << "*.stamp" << "*.vtp" << "*.vtu", QDir::Files);
+
+    QMap<QString,qint64> entrySize;
+    QMap<QString,qint64> entryTime;
+    qint64 totalSize=0;
+    for(int i=0;i<files.size();i++)
+    {
+        QString key=files[i].completeBaseName();
+        entrySize[key]+=files[i].size();
+        totalSize+=files[i].size();
+        if(files[i].suffix()=="stamp")
+            entryTime[key]=files[i].lastModified().toMSecsSinceEpoch();
+        else if(!entryTime.contains(key))
+            entryTime[key]=-1;
+    }
+
+    if(totalSize<=m_MaximumSize)
+        return;
+
+    std::vector<std::pair<qint64,QString> > entries;
+    for(QMap<QString,qint64>::const_iterator it=entryTime.constBegin();it!=entryTime.constEnd();++it)
+        entries.push_back(std::make_pair(it.value(),it.key()));
+    std::sort(entries.begin(),entries.end());
+
+    for(int i=0;i<entries.size() && totalSize>m_MaximumSize;i++)
+    {
+        if(entries[i].second==keepKey)
+            continue;
+
+        Remove(cacheDir,entries[i].second);
+        totalSize-=entrySize[entries[i].second];
+    }
+}
+
+void sv4guiMeshCache::SetMaximumSize(qint64 bytes)
+{
+    m_MaximumSize=bytes;
+}
+
+qint64 sv4guiMeshCache::GetMaximumSize()
+{
+    return m_MaximumSize;
+}
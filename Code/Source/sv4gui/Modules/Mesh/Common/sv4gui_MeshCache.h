@@ -0,0 +1,86 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SV4GUI_MESHCACHE_H
+#define SV4GUI_MESHCACHE_H
+
+#include <sv4guiModuleMeshExports.h>
+
+#include "sv4gui_ModelElement.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <QString>
+
+// On-disk cache of generated meshes. An entry is keyed by a hash of the
+// mesher type and version, the model surface (points, cells and data
+// arrays), the model face names and the normalized mesh commands, so a
+// changed input or an upgraded mesher never hits a stale entry. Each entry is <key>.vtp, an optional
+// <key>.vtu, and <key>.stamp, which is written last and touched on every
+// hit; the least recently used entries are removed once the cache
+// directory grows past the maximum size.
+
+class SV4GUIMODULEMESH_EXPORT sv4guiMeshCache
+{
+public:
+
+  sv4guiMeshCache(){}
+  virtual ~sv4guiMeshCache(){}
+
+  static QString ComputeKey(std::string meshType, sv4guiModelElement* modelElement, std::vector<std::string> cmds);
+
+  static std::string GetMesherVersion(std::string meshType);
+
+  static std::string NormalizeCommand(std::string cmd);
+
+  static bool Load(QString cacheDir, QString key, vtkSmartPointer<vtkPolyData>& surfaceMesh, vtkSmartPointer<vtkUnstructuredGrid>& volumeMesh);
+
+  static bool Store(QString cacheDir, QString key, vtkSmartPointer<vtkPolyData> surfaceMesh, vtkSmartPointer<vtkUnstructuredGrid> volumeMesh);
+
+  static void Remove(QString cacheDir, QString key);
+
+  static void Clear(QString cacheDir);
+
+  static void Trim(QString cacheDir, QString keepKey="");
+
+  static void SetMaximumSize(qint64 bytes);
+
+  static qint64 GetMaximumSize();
+
+private:
+
+  static qint64 m_MaximumSize;
+
+};
+
+#endif // SV4GUI_MESHCACHE_H
@@ -30,12 +30,14 @@
  */
 
 #include "sv4gui_MeshTetGen.h"
+#include "sv4gui_MeshCache.h"
 
 #include "sv4gui_StringUtils.h"
 #include "sv4gui_ModelUtils.h"
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 sv4guiMeshTetGen::sv4guiMeshTetGen()
     : m_cvTetGenMesh(NULL)
@@ -46,7 +48,9 @@ sv4guiMeshTetGen::sv4guiMeshTetGen()
 
 sv4guiMeshTetGen::sv4guiMeshTetGen(const sv4guiMeshTetGen &other)
     : sv4guiMesh(other)
+    , m_cvTetGenMesh(NULL)
 //    , m_cvTetGenMesh(other.m_cvTetGenMesh)
+    , m_CacheDirectory(other.m_CacheDirectory)
 {
 }
 
@@ -67,6 +71,8 @@ void sv4guiMeshTetGen::InitNewMesher()
         delete m_cvTetGenMesh;
 
     m_cvTetGenMesh=new cvTetGenMeshObject(NULL);
+    m_PendingRefinements.clear();
+    m_PendingRefinementCmds.clear();
 }
 
 bool sv4guiMeshTetGen::SetModelElement(sv4guiModelElement* modelElement)
@@ -106,6 +112,63 @@ bool sv4guiMeshTetGen::SetModelElement(sv4guiModelElement* modelElement)
     return true;
 }
 
+// ------------------
+//  ExecuteCommands
+// ------------------
+/**
+ * @brief Execute a list of mesh commands, going through the mesh cache
+ *        when a cache directory is set. If the same model surface was
+ *        meshed with the same commands before, the stored meshes are
+ *        loaded instead of running the mesher.
+ * @param[in] cmds The mesh commands.
+ * @param[out] msg The string describing the details of command success or failure.
+ * @retval true if the commands were executed or the meshes loaded from the cache.
+ */
+
+bool sv4guiMeshTetGen::ExecuteCommands(std::vector<std::string> cmds, std::string& msg)
+{
+    QString cacheDir=QString::fromStdString(m_CacheDirectory);
+    QString key="";
+    if(m_CacheDirectory!="")
+        key=sv4guiMeshCache::ComputeKey(m_Type, m_ModelElement, cmds);
+
+    vtkSmartPointer<vtkPolyData> surfaceMesh=NULL;
+    vtkSmartPointer<vtkUnstructuredGrid> volumeMesh=NULL;
+    if(key!="" && sv4guiMeshCache::Load(cacheDir, key, surfaceMesh, volumeMesh))
+    {
+        m_SurfaceMesh=surfaceMesh;
+        m_VolumeMesh=volumeMesh;
+        m_PendingRefinements.clear();
+        m_PendingRefinementCmds.clear();
+        msg="Mesh loaded from cache";
+        return true;
+    }
+
+    vtkSmartPointer<vtkPolyData> oldSurfaceMesh=m_SurfaceMesh;
+    if(!sv4guiMesh::ExecuteCommands(cmds, msg))
+        return false;
+
+    // refinement zones queued by the last commands
+    if(!ApplyPendingRefinements(msg))
+        return false;
+
+    // only cache a mesh these commands generated
+    if(key!="" && m_SurfaceMesh!=NULL && m_SurfaceMesh!=oldSurfaceMesh)
+        sv4guiMeshCache::Store(cacheDir, key, m_SurfaceMesh, m_VolumeMesh);
+
+    return true;
+}
+
+void sv4guiMeshTetGen::SetCacheDirectory(std::string dir)
+{
+    m_CacheDirectory=dir;
+}
+
+std::string sv4guiMeshTetGen::GetCacheDirectory() const
+{
+    return m_CacheDirectory;
+}
+
 // ----------
 //  Execute  
 // ----------
@@ -136,6 +199,31 @@ bool sv4guiMeshTetGen::Execute(std::string flag, double values[20], std::string
         return true;
     }
 
+    // Consecutive refinement zones are collected and applied to the
+    // sizing function together, before the next command runs.
+    if(flag=="sphereRefinement")
+    {
+        TGenUtils_RefinementZone zone;
+        zone.type=TGENUTILS_SPHERE_ZONE;
+        zone.size=values[0];
+        zone.radius=values[1];
+        zone.length=0.0;
+        for(int i=0;i<3;i++)
+        {
+            zone.center[i]=values[2+i];
+            zone.normal[i]=0.0;
+        }
+        m_PendingRefinements.push_back(zone);
+        std::ostringstream cmd;
+        cmd<<"sphereRefinement "<<values[0]<<" "<<values[1]<<" "<<values[2]<<" "<<values[3]<<" "<<values[4];
+        m_PendingRefinementCmds.push_back(cmd.str());
+        msg="Command executed";
+        return true;
+    }
+
+    if(!ApplyPendingRefinements(msg))
+        return false;
+
     if(option)
     {
         if(flag=="LocalEdgeSize")
@@ -217,15 +305,6 @@ bool sv4guiMeshTetGen::Execute(std::string flag, double values[20], std::string
           return false;
       }
     }
-    else if(flag=="sphereRefinement")
-    {
-        double center[3]={values[2],values[3],values[4]};
-        if(m_cvTetGenMesh->SetSphereRefinement(values[0],values[1],center)!=SV_OK)
-        {
-            msg="Failed in sphere refinement";
-            return false;
-        }
-    }
     else if(flag=="AllowMultipleRegions")
     {
         bool value = (int(values[0]) == 1);
@@ -520,8 +599,53 @@ bool sv4guiMeshTetGen::ParseCommand(std::string cmd, std::string& flag, double v
 
 }
 
+// --------------------------
+//  ApplyPendingRefinements
+// --------------------------
+/**
+ * @brief Apply the refinement zones collected from consecutive
+ *        sphereRefinement commands in a single sizing function pass.
+ * @param[out] msg The string describing the details of a failure,
+ *        naming the sphereRefinement commands which queued the zones.
+ * @retval true if there was nothing to apply or the zones were applied.
+ */
+
+bool sv4guiMeshTetGen::ApplyPendingRefinements(std::string& msg)
+{
+    if(m_PendingRefinements.empty() || m_cvTetGenMesh==NULL)
+        return true;
+
+    int status=m_cvTetGenMesh->SetRefinementZones(m_PendingRefinements.size(),&m_PendingRefinements[0]);
+    std::vector<std::string> cmds;
+    cmds.swap(m_PendingRefinementCmds);
+    m_PendingRefinements.clear();
+    if(status!=SV_OK)
+    {
+        msg="Failed in sphere refinement:";
+        for(int i=0;i<cmds.size();i++)
+            msg+="\n"+cmds[i];
+        return false;
+    }
+
+    return true;
+}
+
+// ------------
+//  GetMesher
+// ------------
+/**
+ * @brief Get the mesher, after applying any queued refinement zones.
+ * @retval NULL if the queued refinement zones could not be applied.
+ */
+
 cvTetGenMeshObject* sv4guiMeshTetGen::GetMesher()
 {
+    std::string msg;
+    if(!ApplyPendingRefinements(msg))
+    {
+        std::cerr<<msg<<std::endl;
+        return NULL;
+    }
     return m_cvTetGenMesh;
 }
 
@@ -58,8 +58,16 @@ public:
 
     bool ParseCommand(std::string cmd, std::string& flag, double values[20], std::string strValues[5], bool& option, std::string& msg) override;
 
+    bool ExecuteCommands(std::vector<std::string> cmds, std::string& msg) override;
+
+    void SetCacheDirectory(std::string dir);
+
+    std::string GetCacheDirectory() const;
+
     cvTetGenMeshObject* GetMesher();
 
+    bool ApplyPendingRefinements(std::string& msg);
+
     static sv4guiMesh* CreateMesh();
 
 //    bool WriteMeshComplete(vtkSmartPointer<vtkPolyData> surfaceMesh, vtkSmartPointer<vtkUnstructuredGrid> volumeMesh, sv4guiModelElement* modelElement, std::string meshDir) override;
@@ -70,6 +78,12 @@ public:
 
     cvTetGenMeshObject* m_cvTetGenMesh;
 
+    std::vector<TGenUtils_RefinementZone> m_PendingRefinements;
+
+    std::vector<std::string> m_PendingRefinementCmds;
+
+    std::string m_CacheDirectory;
+
   };
 
 
@@ -33,6 +33,7 @@
 
 #include "sv4gui_MitkMesh.h"
 #include "sv4gui_MeshFactory.h"
+#include "sv4gui_MeshBinaryIO.h"
 
 #include <mitkCustomMimeType.h>
 #include <mitkIOMimeTypes.h>
@@ -157,6 +158,12 @@ void sv4guiMitkMeshIO::Write()
         if(!mesh->WriteVolumeFile(volumeFileName))
             mitkThrow() << "Error in writing surface mesh to file: " << surfaceFileName;
 
+        // the .vtp/.vtu are complete at this point; without the container
+        // the next read just takes the slower path
+        std::string binaryFileName=sv4guiMeshBinaryIO::GetFilePath(fileName);
+        if(!mesh->WriteBinaryFile(binaryFileName))
+            MITK_WARN << "Error in writing binary mesh to file: " << binaryFileName;
+
     }
 
     if (document.SaveFile(fileName) == false)
@@ -263,6 +270,15 @@ sv4guiMitkMesh::Pointer sv4guiMitkMeshIO::ReadFromFile(std::string fileName, boo
                 std::string surfaceFileName=fileName.substr(0,fileName.find_last_of("."))+".vtp";
                 mesh->ReadSurfaceFile(surfaceFileName);
             }
+            else
+            {
+                // the surface can be shown right away when it only has to
+                // be copied out of the binary container
+                std::string surfaceFileName=fileName.substr(0,fileName.find_last_of("."))+".vtp";
+                std::string binaryFileName=sv4guiMeshBinaryIO::GetFilePath(fileName);
+                if(sv4guiMeshBinaryIO::IsCurrent(binaryFileName,surfaceFileName))
+                    mesh->SetSurfaceMesh(sv4guiMeshBinaryIO::ReadSurface(binaryFileName));
+            }
 
             if(readVolumeMesh)
             {
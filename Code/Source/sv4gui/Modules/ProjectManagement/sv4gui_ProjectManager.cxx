@@ -1051,6 +1051,7 @@ void sv4guiProjectManager::SaveProject(mitk::DataStorage::Pointer dataStorage, m
         dirMesh.remove(QString::fromStdString(removeList[i])+".msh");
         dirMesh.remove(QString::fromStdString(removeList[i])+".vtp");
         dirMesh.remove(QString::fromStdString(removeList[i])+".vtu");
+        dirMesh.remove(QString::fromStdString(removeList[i])+".msb");
         dirMesh.remove(QString::fromStdString(removeList[i])+".sms");
     }
     meshFolder->ClearRemoveList();
@@ -1386,6 +1387,7 @@ void sv4guiProjectManager::RenameDataNode(mitk::DataStorage::Pointer dataStorage
         extensions.push_back(".msh");
         extensions.push_back(".vtp");
         extensions.push_back(".vtu");
+        extensions.push_back(".msb");
         extensions.push_back(".sms");
     }
     else if(isSimJob->CheckNode(dataNode))
@@ -71,6 +71,8 @@
 #include <vtkContourFilter.h>
 #include <vtkPolyDataConnectivityFilter.h>
 
+#include <QtConcurrentMap>
+
 #include <iostream>
 using namespace std;
 
@@ -527,6 +529,17 @@ cvStrPts* sv4guiSegmentationUtils::vtkImageData2cvStrPts(vtkImageData* vtkImg)
 }
 
 sv4guiContour* sv4guiSegmentationUtils::CreateLSContour(sv4guiPathElement::sv4guiPathPoint pathPoint, vtkImageData* volumeimage, svLSParam* param, double size,  bool forceClosed)
+{
+    cvStrPts* strPts=GetSlicevtkImage(pathPoint, volumeimage, size);
+
+    sv4guiContour* contour=CreateLSContour(pathPoint, strPts, param, forceClosed);
+
+    delete strPts;
+
+    return contour;
+}
+
+sv4guiContour* sv4guiSegmentationUtils::CreateLSContour(sv4guiPathElement::sv4guiPathPoint pathPoint, cvStrPts* slice, svLSParam* param, bool forceClosed)
 {
     //stage 1
     //**************************
@@ -554,8 +567,7 @@ sv4guiContour* sv4guiSegmentationUtils::CreateLSContour(sv4guiPathElement::sv4gu
     ls->SetAdvectionScaling(1.0);
     ls->SetCurvatureScaling(1.0);
 
-    cvStrPts*  strPts=GetSlicevtkImage(pathPoint, volumeimage,  size);
-    ls->SetInputImage(strPts);
+    ls->SetInputImage(slice);
     ls->SetSeed(seedPd);
 
     //$itklset PhaseOneLevelSet -Kc $kThr -expRising $expRise -expFalling $expFall -sigmaFeat $gSigma1 -sigmaAdv $advSigma1
@@ -587,8 +599,8 @@ sv4guiContour* sv4guiSegmentationUtils::CreateLSContour(sv4guiPathElement::sv4gu
     ls2->SetAdvectionScaling(1.0);
     ls2->SetCurvatureScaling(1.0);
 
-    cvStrPts*  strPts2=GetSlicevtkImage(pathPoint, volumeimage,  size);
-    ls2->SetInputImage(strPts2);
+    //both stages only read the slice, so it is not cut a second time
+    ls2->SetInputImage(slice);
     ls2->SetSeed(front1);
 
     if(param->sigmaFeat2 >= 0)
@@ -651,9 +663,59 @@ sv4guiContour* sv4guiSegmentationUtils::CreateLSContour(sv4guiPathElement::sv4gu
     contour->SetClosed(ifClosed||forceClosed);
     contour->SetContourPoints(contourPoints);
 
+    delete dst2;
+    delete dst;
+    delete front2;
+    delete front1;
+    delete seedPd;
+    delete ls2;
+    delete ls;
+
     return contour;
 }
 
+struct sv4guiLSContourJob
+{
+    sv4guiPathElement::sv4guiPathPoint pathPoint;
+    cvStrPts* slice;
+    sv4guiSegmentationUtils::svLSParam* param;
+    bool forceClosed;
+    sv4guiContour* contour;
+};
+
+static void sv4guiRunLSContourJob(sv4guiLSContourJob& job)
+{
+    job.contour=sv4guiSegmentationUtils::CreateLSContour(job.pathPoint, job.slice, job.param, job.forceClosed);
+}
+
+std::vector<sv4guiContour*> sv4guiSegmentationUtils::CreateLSContours(std::vector<sv4guiPathElement::sv4guiPathPoint> pathPoints, vtkImageData* volumeimage, svLSParam* param, double size, bool forceClosed)
+{
+    //reslicing shares the volume's pipeline, so all planes are cut up front on this thread
+    QList<sv4guiLSContourJob> jobs;
+    for(int i=0;i<pathPoints.size();i++)
+    {
+        sv4guiLSContourJob job;
+        job.pathPoint=pathPoints[i];
+        job.slice=GetSlicevtkImage(pathPoints[i], volumeimage, size);
+        job.param=param;
+        job.forceClosed=forceClosed;
+        job.contour=NULL;
+        jobs.push_back(job);
+    }
+
+    //each job only touches its own slice and level sets
+    QtConcurrent::blockingMap(jobs,sv4guiRunLSContourJob);
+
+    std::vector<sv4guiContour*> contours;
+    for(int i=0;i<jobs.size();i++)
+    {
+        contours.push_back(jobs[i].contour);
+        delete jobs[i].slice;
+    }
+
+    return contours;
+}
+
 vtkPolyData* sv4guiSegmentationUtils::orientBack(vtkPolyData* srcPd, mitk::PlaneGeometry* planeGeometry)
 {
 
@@ -127,6 +127,11 @@ public:
 
     static sv4guiContour* CreateLSContour(sv4guiPathElement::sv4guiPathPoint pathPoint, vtkImageData* volumeimage, svLSParam* param, double size, bool forceClosed = true);
 
+    static sv4guiContour* CreateLSContour(sv4guiPathElement::sv4guiPathPoint pathPoint, cvStrPts* slice, svLSParam* param, bool forceClosed = true);
+
+    //segment a whole list of path points; slices are cut serially, the level sets run on the Qt thread pool
+    static std::vector<sv4guiContour*> CreateLSContours(std::vector<sv4guiPathElement::sv4guiPathPoint> pathPoints, vtkImageData* volumeimage, svLSParam* param, double size, bool forceClosed = true);
+
     static vtkPolyData* orientBack(vtkPolyData* srcPd, mitk::PlaneGeometry* planeGeometry);
 
 
@@ -0,0 +1,800 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sv4gui_SimulationResultsConverter.h"
+
+#include "simvascular_solverio.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+
+#include <vtkPoints.h>
+#include <vtkPointSet.h>
+#include <vtkPointData.h>
+#include <vtkCellData.h>
+#include <vtkFieldData.h>
+#include <vtkDataArray.h>
+#include <vtkXMLPolyDataReader.h>
+#include <vtkXMLUnstructuredGridReader.h>
+#include <vtkXMLPolyDataWriter.h>
+#include <vtkXMLUnstructuredGridWriter.h>
+
+//the writers compute and cache array ranges, do it once up front so the
+//threads writing steps only read the shared mesh arrays
+static void sv4guiPrepareSharedDataSet(vtkDataSet* ds)
+{
+    vtkFieldData* fields[2]={ds->GetPointData(),ds->GetCellData()};
+    double range[2];
+    for(int f=0;f<2;++f)
+    {
+        for(int i=0;i<fields[f]->GetNumberOfArrays();++i)
+        {
+            vtkDataArray* array=fields[f]->GetArray(i);
+            if(array==NULL)
+                continue;
+            for(int c=-1;c<array->GetNumberOfComponents();++c)
+                array->GetRange(range,c);
+        }
+    }
+
+    vtkPointSet* ps=vtkPointSet::SafeDownCast(ds);
+    if(ps && ps->GetPoints())
+    {
+        vtkDataArray* array=ps->GetPoints()->GetData();
+        for(int c=-1;c<array->GetNumberOfComponents();++c)
+            array->GetRange(range,c);
+    }
+}
+
+// The restart blocks the postsolver exports and the arrays it names them,
+// each array taking numComps of the block's variables from firstComp on.
+// The solution is stored as p, u, v, w; ybar in the solver order u, v, w, p
+// with the speed last.
+struct sv4guiResultBlockField
+{
+    const char* key;
+    const char* name;
+    int firstComp;
+    int numComps;
+};
+
+static const sv4guiResultBlockField sv4guiResultBlockFields[]={
+    {"solution","pressure",0,1},
+    {"solution","velocity",1,3},
+    {"time derivative of solution","timeDeriv",0,4},
+    {"ybar","average_pressure",3,1},
+    {"ybar","average_speed",4,1},
+    {"traction","vinplane_traction",0,3},
+    {"wall shear stresses","vWSS",0,3},
+    {"displacement","displacement",0,3}
+};
+
+static const int sv4guiNumResultBlockFields=sizeof(sv4guiResultBlockFields)/sizeof(sv4guiResultBlockFields[0]);
+
+static bool sv4guiGetGlobalIDs(vtkDataSet* ds, std::vector<int>& globalIDs, int& maxID)
+{
+    vtkDataArray* array=ds->GetPointData()->GetArray("GlobalNodeID");
+    if(array==NULL)
+        return false;
+
+    globalIDs.resize(ds->GetNumberOfPoints());
+    for(vtkIdType i=0;i<ds->GetNumberOfPoints();++i)
+    {
+        globalIDs[i]=array->GetComponent(i,0);
+        if(globalIDs[i]>maxID)
+            maxID=globalIDs[i];
+    }
+
+    return true;
+}
+
+sv4guiSimulationResultsConverter::sv4guiSimulationResultsConverter()
+    : m_Start(0)
+    , m_Stop(0)
+    , m_Increment(1)
+    , m_VolumeOutput(true)
+    , m_SurfaceOutput(true)
+    , m_SingleFile(false)
+    , m_NumProcs(0)
+    , m_NumGlobalNodes(0)
+{
+}
+
+sv4guiSimulationResultsConverter::~sv4guiSimulationResultsConverter()
+{
+}
+
+void sv4guiSimulationResultsConverter::SetResultDir(std::string resultDir)
+{
+    m_ResultDir=resultDir;
+}
+
+void sv4guiSimulationResultsConverter::SetOutputDir(std::string outputDir)
+{
+    m_OutputDir=outputDir;
+}
+
+void sv4guiSimulationResultsConverter::SetMeshFiles(std::string volumeFilePath, std::string surfaceFilePath)
+{
+    m_VolumeFilePath=volumeFilePath;
+    m_SurfaceFilePath=surfaceFilePath;
+}
+
+void sv4guiSimulationResultsConverter::SetSteps(int start, int stop, int increment)
+{
+    m_Start=start;
+    m_Stop=stop;
+    m_Increment=increment;
+}
+
+void sv4guiSimulationResultsConverter::SetVolumeOutput(bool volumeOutput)
+{
+    m_VolumeOutput=volumeOutput;
+}
+
+void sv4guiSimulationResultsConverter::SetSurfaceOutput(bool surfaceOutput)
+{
+    m_SurfaceOutput=surfaceOutput;
+}
+
+void sv4guiSimulationResultsConverter::SetSingleFile(bool singleFile)
+{
+    m_SingleFile=singleFile;
+}
+
+std::vector<int> sv4guiSimulationResultsConverter::GetFailedSteps()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_FailedSteps;
+}
+
+std::string sv4guiSimulationResultsConverter::GetRestartFilePath(int step, int proc)
+{
+    return m_ResultDir+"/restart."+std::to_string(step)+"."+std::to_string(proc+1);
+}
+
+std::string sv4guiSimulationResultsConverter::GetGeombcFilePath(int proc)
+{
+    return m_ResultDir+"/geombc.dat."+std::to_string(proc+1);
+}
+
+std::string sv4guiSimulationResultsConverter::GetStepFileName(int step, std::string extension)
+{
+    if(m_SingleFile)
+        return "all_results"+extension;
+
+    char stepStr[32];
+    sprintf(stepStr,"%05i",step);
+    return "all_results_"+std::string(stepStr)+extension;
+}
+
+std::string sv4guiSimulationResultsConverter::GetStepSuffix(int step)
+{
+    char stepStr[32];
+    sprintf(stepStr,"_%05i",step);
+    return stepStr;
+}
+
+void sv4guiSimulationResultsConverter::AddMessage(std::string msg)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Messages+=msg+"\n";
+}
+
+std::string sv4guiSimulationResultsConverter::GetMessages()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Messages;
+}
+
+bool sv4guiSimulationResultsConverter::ReadNodeMap(int proc, std::string& msg)
+{
+    std::string filePath=GetGeombcFilePath(proc);
+
+    cvsolverIO io;
+    if(io.openFile(filePath.c_str(),"read")!=CVSOLVER_IO_OK)
+    {
+        msg="Can't open "+filePath;
+        return false;
+    }
+
+    int iarray[1]={-1};
+    io.readHeader("mode number map",iarray,1,"integer","binary");
+    int nshg=iarray[0];
+
+    if(nshg<=0)
+    {
+        io.closeFile();
+        if(m_NumProcs==1)
+            return true;
+
+        msg="No mode number map in "+filePath;
+        return false;
+    }
+
+    std::vector<int>& nodeMap=m_NodeMaps[proc];
+    nodeMap.resize(nshg);
+    if(io.readDataBlock("mode number map",&nodeMap[0],nshg,"integer","binary")!=CVSOLVER_IO_OK)
+    {
+        io.closeFile();
+        msg="Fail to read mode number map in "+filePath;
+        return false;
+    }
+    io.closeFile();
+
+    for(int i=0;i<nshg;++i)
+    {
+        if(nodeMap[i]>m_NumGlobalNodes)
+            m_NumGlobalNodes=nodeMap[i];
+    }
+
+    return true;
+}
+
+bool sv4guiSimulationResultsConverter::Initialize(std::string& msg)
+{
+    msg="";
+
+    if(!m_VolumeOutput && !m_SurfaceOutput)
+    {
+        msg="No output selected.";
+        return false;
+    }
+
+    if(m_Increment<=0 || m_Stop<m_Start)
+    {
+        msg="Invalid start, stop or increment.";
+        return false;
+    }
+
+    m_NumProcs=0;
+    while(QFileInfo(QString::fromStdString(GetGeombcFilePath(m_NumProcs))).exists())
+        m_NumProcs++;
+
+    if(m_NumProcs==0)
+    {
+        msg="Can't find geombc.dat.1 in "+m_ResultDir;
+        return false;
+    }
+
+    m_Messages="";
+    m_FailedSteps.clear();
+    m_VolumeStepArrays.clear();
+    m_SurfaceStepArrays.clear();
+
+    m_NumGlobalNodes=0;
+    m_NodeMaps.assign(m_NumProcs,std::vector<int>());
+    for(int p=0;p<m_NumProcs;++p)
+    {
+        if(!ReadNodeMap(p,msg))
+            return false;
+    }
+
+    int maxID=0;
+
+    vtkSmartPointer<vtkXMLUnstructuredGridReader> volumeReader=vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
+    volumeReader->SetFileName(m_VolumeFilePath.c_str());
+    volumeReader->Update();
+    m_Volume=volumeReader->GetOutput();
+    if(m_Volume->GetNumberOfPoints()==0 || !sv4guiGetGlobalIDs(m_Volume,m_VolumeGlobalIDs,maxID))
+    {
+        msg="No valid mesh with GlobalNodeID in "+m_VolumeFilePath;
+        return false;
+    }
+
+    if(m_SurfaceOutput)
+    {
+        vtkSmartPointer<vtkXMLPolyDataReader> surfaceReader=vtkSmartPointer<vtkXMLPolyDataReader>::New();
+        surfaceReader->SetFileName(m_SurfaceFilePath.c_str());
+        surfaceReader->Update();
+        m_Surface=surfaceReader->GetOutput();
+        if(m_Surface->GetNumberOfPoints()==0 || !sv4guiGetGlobalIDs(m_Surface,m_SurfaceGlobalIDs,maxID))
+        {
+            msg="No valid surface with GlobalNodeID in "+m_SurfaceFilePath;
+            return false;
+        }
+        sv4guiPrepareSharedDataSet(m_Surface);
+    }
+
+    sv4guiPrepareSharedDataSet(m_Volume);
+
+    //a serial run has no map, the solver nodes are the mesh nodes
+    if(maxID>m_NumGlobalNodes)
+        m_NumGlobalNodes=maxID;
+
+    if(m_SingleFile)
+    {
+        std::vector<int> steps=GetSteps();
+        for(int i=0;i<steps.size();++i)
+        {
+            m_VolumeStepArrays[steps[i]];
+            m_SurfaceStepArrays[steps[i]];
+        }
+    }
+
+    return true;
+}
+
+std::vector<int> sv4guiSimulationResultsConverter::GetSteps()
+{
+    std::vector<int> steps;
+    for(int step=m_Start;step<=m_Stop;step+=m_Increment)
+        steps.push_back(step);
+
+    return steps;
+}
+
+bool sv4guiSimulationResultsConverter::IsStepUpToDate(int step)
+{
+    std::vector<std::string> extensions;
+    if(m_VolumeOutput)
+        extensions.push_back(".vtu");
+    if(m_SurfaceOutput)
+        extensions.push_back(".vtp");
+
+    QDateTime newestInput=QFileInfo(QString::fromStdString(m_VolumeFilePath)).lastModified();
+    if(m_SurfaceOutput)
+        newestInput=std::max(newestInput,QFileInfo(QString::fromStdString(m_SurfaceFilePath)).lastModified());
+
+    for(int p=0;p<m_NumProcs;++p)
+    {
+        QFileInfo info(QString::fromStdString(GetRestartFilePath(step,p)));
+        if(!info.exists())
+            return false;
+
+        newestInput=std::max(newestInput,info.lastModified());
+    }
+
+    for(int i=0;i<extensions.size();++i)
+    {
+        QFileInfo info(QString::fromStdString(m_OutputDir+"/"+GetStepFileName(step,extensions[i])));
+        if(!info.exists() || info.lastModified()<newestInput)
+            return false;
+    }
+
+    return true;
+}
+
+std::vector<int> sv4guiSimulationResultsConverter::GetStepsToConvert()
+{
+    std::vector<int> steps=GetSteps();
+
+    //the single file holds every step, it is either all up to date or rewritten
+    if(m_SingleFile)
+    {
+        for(int i=0;i<steps.size();++i)
+        {
+            if(!IsStepUpToDate(steps[i]))
+                return steps;
+        }
+        return std::vector<int>();
+    }
+
+    std::vector<int> stepsToConvert;
+    for(int i=0;i<steps.size();++i)
+    {
+        if(!IsStepUpToDate(steps[i]))
+            stepsToConvert.push_back(steps[i]);
+    }
+
+    return stepsToConvert;
+}
+
+bool sv4guiSimulationResultsConverter::ReadStep(int step, std::vector<sv4guiSimulationResultField>& fields)
+{
+    fields.clear();
+
+    std::vector<double> q;
+
+    for(int p=0;p<m_NumProcs;++p)
+    {
+        std::string filePath=GetRestartFilePath(step,p);
+
+        cvsolverIO io;
+        if(io.openFile(filePath.c_str(),"read")!=CVSOLVER_IO_OK)
+        {
+            AddMessage("Can't open "+filePath);
+            return false;
+        }
+
+        const std::vector<int>& nodeMap=m_NodeMaps[p];
+
+        //fields sharing a block are next to each other, the block is read once
+        const char* blockKey=NULL;
+        bool blockFound=false;
+        int nshg=0;
+        int numVars=0;
+        size_t numFields=0;
+
+        for(int f=0;f<sv4guiNumResultBlockFields;++f)
+        {
+            const sv4guiResultBlockField& blockField=sv4guiResultBlockFields[f];
+
+            if(blockKey==NULL || strcmp(blockKey,blockField.key)!=0)
+            {
+                blockKey=blockField.key;
+
+                //contains: nshg,numVars,lstep
+                int iarray[3]={-1,-1,-1};
+                blockFound=(io.readHeader(blockKey,iarray,3,"double","binary")==CVSOLVER_IO_OK);
+                nshg=iarray[0];
+                numVars=iarray[1];
+
+                if(blockFound)
+                {
+                    if(nshg<=0 || numVars<=0 || (nodeMap.size()>0 && nodeMap.size()!=nshg))
+                    {
+                        io.closeFile();
+                        AddMessage("No valid "+std::string(blockKey)+" in "+filePath);
+                        return false;
+                    }
+
+                    q.resize((size_t)nshg*numVars);
+                    if(io.readDataBlock(blockKey,&q[0],nshg*numVars,"double","binary")!=CVSOLVER_IO_OK)
+                    {
+                        io.closeFile();
+                        AddMessage("Fail to read "+std::string(blockKey)+" in "+filePath);
+                        return false;
+                    }
+                }
+            }
+
+            if(!blockFound || numVars<blockField.firstComp+blockField.numComps)
+                continue;
+
+            //every processor has to write the same fields
+            if(p==0)
+            {
+                sv4guiSimulationResultField field;
+                field.name=blockField.name;
+                field.numComps=blockField.numComps;
+                field.values.assign((size_t)m_NumGlobalNodes*field.numComps,0.0);
+                fields.push_back(field);
+            }
+            else if(numFields>=fields.size() || fields[numFields].name!=blockField.name)
+            {
+                io.closeFile();
+                AddMessage("The fields in "+filePath+" differ from processor 1.");
+                return false;
+            }
+
+            sv4guiSimulationResultField& field=fields[numFields++];
+
+            //the blocks are stored by variable
+            for(int i=0;i<nshg;++i)
+            {
+                int g=(nodeMap.size()>0 ? nodeMap[i] : i+1)-1;
+                if(g<0 || g>=m_NumGlobalNodes)
+                    continue;
+
+                for(int k=0;k<field.numComps;++k)
+                    field.values[(size_t)field.numComps*g+k]=q[(size_t)(blockField.firstComp+k)*nshg+i];
+            }
+        }
+        io.closeFile();
+
+        if(numFields!=fields.size())
+        {
+            AddMessage("The fields in "+filePath+" differ from processor 1.");
+            return false;
+        }
+    }
+
+    if(fields.size()<2 || fields[0].name!="pressure" || fields[1].name!="velocity")
+    {
+        AddMessage("No valid solution in "+GetRestartFilePath(step,0));
+        return false;
+    }
+
+    return true;
+}
+
+void sv4guiSimulationResultsConverter::AddStepArrays(std::string suffix, std::vector<int>& globalIDs
+                                                 , std::vector<sv4guiSimulationResultField>& fields
+                                                 , std::vector<vtkSmartPointer<vtkDoubleArray> >& arrays)
+{
+    int numPoints=globalIDs.size();
+
+    arrays.clear();
+    for(int f=0;f<fields.size();++f)
+    {
+        sv4guiSimulationResultField& field=fields[f];
+        int numComps=field.numComps;
+
+        vtkSmartPointer<vtkDoubleArray> array=vtkSmartPointer<vtkDoubleArray>::New();
+        array->SetNumberOfComponents(numComps);
+        array->SetNumberOfTuples(numPoints);
+        array->SetName((field.name+suffix).c_str());
+
+        for(int i=0;i<numPoints;++i)
+        {
+            int g=globalIDs[i]-1;
+            for(int k=0;k<numComps;++k)
+            {
+                if(g<0 || g>=m_NumGlobalNodes)
+                    array->SetValue((vtkIdType)numComps*i+k,0.0);
+                else
+                    array->SetValue((vtkIdType)numComps*i+k,field.values[(size_t)numComps*g+k]);
+            }
+        }
+
+        arrays.push_back(array);
+    }
+}
+
+void sv4guiSimulationResultsConverter::AddAverageArrays(std::map<int,std::vector<vtkSmartPointer<vtkDoubleArray> > >& stepArrays
+                                                    , vtkPointData* pointData)
+{
+    int numSteps=stepArrays.size();
+    if(numSteps==0)
+        return;
+
+    //sums by field name, averaged only if every step has the field
+    std::map<std::string,vtkSmartPointer<vtkDoubleArray> > sums;
+    std::map<std::string,int> counts;
+    for(auto& step_arrays:stepArrays)
+    {
+        std::string suffix=GetStepSuffix(step_arrays.first);
+        for(int i=0;i<step_arrays.second.size();++i)
+        {
+            vtkDoubleArray* array=step_arrays.second[i];
+            std::string name=array->GetName();
+            name=name.substr(0,name.size()-suffix.size());
+
+            vtkSmartPointer<vtkDoubleArray>& sum=sums[name];
+            if(sum==NULL)
+            {
+                sum=vtkSmartPointer<vtkDoubleArray>::New();
+                sum->DeepCopy(array);
+                sum->SetName((name+"_avg").c_str());
+            }
+            else
+            {
+                for(vtkIdType j=0;j<sum->GetNumberOfValues();++j)
+                    sum->SetValue(j,sum->GetValue(j)+array->GetValue(j));
+            }
+            counts[name]++;
+        }
+    }
+
+    for(auto& name_sum:sums)
+    {
+        if(counts[name_sum.first]!=numSteps)
+            continue;
+
+        vtkDoubleArray* average=name_sum.second;
+        for(vtkIdType j=0;j<average->GetNumberOfValues();++j)
+            average->SetValue(j,average->GetValue(j)/numSteps);
+        pointData->AddArray(average);
+
+        //the solver works in cgs units
+        if(name_sum.first=="pressure")
+        {
+            vtkSmartPointer<vtkDoubleArray> mmHg=vtkSmartPointer<vtkDoubleArray>::New();
+            mmHg->DeepCopy(average);
+            mmHg->SetName("pressure_avg_mmHg");
+            for(vtkIdType j=0;j<mmHg->GetNumberOfValues();++j)
+                mmHg->SetValue(j,mmHg->GetValue(j)/1333.2237);
+            pointData->AddArray(mmHg);
+        }
+    }
+
+    //OSI=(1-|sum of wss|/sum of |wss|)/2
+    auto wss=sums.find("vWSS");
+    if(wss==sums.end() || counts["vWSS"]!=numSteps)
+        return;
+
+    vtkIdType numPoints=wss->second->GetNumberOfTuples();
+    std::vector<double> magnitudeSum(numPoints,0.0);
+    for(auto& step_arrays:stepArrays)
+    {
+        std::string name="vWSS"+GetStepSuffix(step_arrays.first);
+        for(int i=0;i<step_arrays.second.size();++i)
+        {
+            vtkDoubleArray* array=step_arrays.second[i];
+            if(name!=array->GetName())
+                continue;
+
+            for(vtkIdType j=0;j<numPoints;++j)
+            {
+                double* t=array->GetTuple3(j);
+                magnitudeSum[j]+=sqrt(t[0]*t[0]+t[1]*t[1]+t[2]*t[2]);
+            }
+        }
+    }
+
+    vtkSmartPointer<vtkDoubleArray> osi=vtkSmartPointer<vtkDoubleArray>::New();
+    osi->SetNumberOfComponents(1);
+    osi->SetNumberOfTuples(numPoints);
+    osi->SetName("OSI");
+    for(vtkIdType j=0;j<numPoints;++j)
+    {
+        double* t=wss->second->GetTuple3(j);
+        double sumMagnitude=sqrt(t[0]*t[0]+t[1]*t[1]+t[2]*t[2])*numSteps;
+        osi->SetValue(j,magnitudeSum[j]>0.0 ? 0.5*(1.0-sumMagnitude/magnitudeSum[j]) : 0.0);
+    }
+    pointData->AddArray(osi);
+}
+
+bool sv4guiSimulationResultsConverter::ConvertStep(int step)
+{
+    bool converted=WriteStep(step);
+    if(!converted)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_FailedSteps.push_back(step);
+    }
+
+    return converted;
+}
+
+bool sv4guiSimulationResultsConverter::WriteStep(int step)
+{
+    std::vector<sv4guiSimulationResultField> fields;
+    if(!ReadStep(step,fields))
+        return false;
+
+    if(m_SingleFile)
+    {
+        std::string suffix=GetStepSuffix(step);
+
+        //the slots were created in Initialize, each step only touches its own
+        auto volumeSlot=m_VolumeStepArrays.find(step);
+        auto surfaceSlot=m_SurfaceStepArrays.find(step);
+        if(volumeSlot==m_VolumeStepArrays.end() || surfaceSlot==m_SurfaceStepArrays.end())
+        {
+            AddMessage("Step "+std::to_string(step)+" is not in the conversion range.");
+            return false;
+        }
+
+        if(m_VolumeOutput)
+            AddStepArrays(suffix,m_VolumeGlobalIDs,fields,volumeSlot->second);
+        if(m_SurfaceOutput)
+            AddStepArrays(suffix,m_SurfaceGlobalIDs,fields,surfaceSlot->second);
+
+        return true;
+    }
+
+    std::vector<vtkSmartPointer<vtkDoubleArray> > arrays;
+
+    if(m_VolumeOutput)
+    {
+        AddStepArrays("",m_VolumeGlobalIDs,fields,arrays);
+
+        vtkSmartPointer<vtkUnstructuredGrid> ug=vtkSmartPointer<vtkUnstructuredGrid>::New();
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            ug->ShallowCopy(m_Volume);
+        }
+        for(int i=0;i<arrays.size();++i)
+            ug->GetPointData()->AddArray(arrays[i]);
+
+        std::string filePath=m_OutputDir+"/"+GetStepFileName(step,".vtu");
+        vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer=vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
+        writer->SetFileName(filePath.c_str());
+        writer->SetInputData(ug);
+        if(writer->Write()==0)
+        {
+            AddMessage("Fail to write "+filePath);
+            return false;
+        }
+    }
+
+    if(m_SurfaceOutput)
+    {
+        AddStepArrays("",m_SurfaceGlobalIDs,fields,arrays);
+
+        vtkSmartPointer<vtkPolyData> pd=vtkSmartPointer<vtkPolyData>::New();
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            pd->ShallowCopy(m_Surface);
+        }
+        for(int i=0;i<arrays.size();++i)
+            pd->GetPointData()->AddArray(arrays[i]);
+
+        std::string filePath=m_OutputDir+"/"+GetStepFileName(step,".vtp");
+        vtkSmartPointer<vtkXMLPolyDataWriter> writer=vtkSmartPointer<vtkXMLPolyDataWriter>::New();
+        writer->SetFileName(filePath.c_str());
+        writer->SetInputData(pd);
+        if(writer->Write()==0)
+        {
+            AddMessage("Fail to write "+filePath);
+            return false;
+        }
+    }
+
+    AddMessage("Converted step "+std::to_string(step));
+
+    return true;
+}
+
+bool sv4guiSimulationResultsConverter::WriteSingleFile()
+{
+    if(!m_SingleFile)
+        return true;
+
+    //steps are added in step order whatever order they were converted in
+    if(m_VolumeOutput)
+    {
+        vtkSmartPointer<vtkUnstructuredGrid> ug=vtkSmartPointer<vtkUnstructuredGrid>::New();
+        ug->ShallowCopy(m_Volume);
+        for(auto step_arrays:m_VolumeStepArrays)
+            for(int i=0;i<step_arrays.second.size();++i)
+                ug->GetPointData()->AddArray(step_arrays.second[i]);
+        AddAverageArrays(m_VolumeStepArrays,ug->GetPointData());
+
+        std::string filePath=m_OutputDir+"/"+GetStepFileName(0,".vtu");
+        vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer=vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
+        writer->SetFileName(filePath.c_str());
+        writer->SetInputData(ug);
+        if(writer->Write()==0)
+        {
+            AddMessage("Fail to write "+filePath);
+            return false;
+        }
+    }
+
+    if(m_SurfaceOutput)
+    {
+        vtkSmartPointer<vtkPolyData> pd=vtkSmartPointer<vtkPolyData>::New();
+        pd->ShallowCopy(m_Surface);
+        for(auto step_arrays:m_SurfaceStepArrays)
+            for(int i=0;i<step_arrays.second.size();++i)
+                pd->GetPointData()->AddArray(step_arrays.second[i]);
+        AddAverageArrays(m_SurfaceStepArrays,pd->GetPointData());
+
+        std::string filePath=m_OutputDir+"/"+GetStepFileName(0,".vtp");
+        vtkSmartPointer<vtkXMLPolyDataWriter> writer=vtkSmartPointer<vtkXMLPolyDataWriter>::New();
+        writer->SetFileName(filePath.c_str());
+        writer->SetInputData(pd);
+        if(writer->Write()==0)
+        {
+            AddMessage("Fail to write "+filePath);
+            return false;
+        }
+    }
+
+    //free the steps, they are in the file now
+    for(auto& step_arrays:m_VolumeStepArrays)
+        step_arrays.second.clear();
+    for(auto& step_arrays:m_SurfaceStepArrays)
+        step_arrays.second.clear();
+
+    AddMessage("Wrote all steps to "+GetStepFileName(0,""));
+
+    return true;
+}
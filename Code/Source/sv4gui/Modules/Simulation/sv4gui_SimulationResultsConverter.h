@@ -0,0 +1,168 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SV4GUI_SIMULATIONRESULTSCONVERTER_H
+#define SV4GUI_SIMULATIONRESULTSCONVERTER_H
+
+#include <sv4guiModuleSimulationExports.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkDoubleArray.h>
+#include <vtkPointData.h>
+
+// Converts the partitioned solver output (restart.N.P with geombc.dat.P)
+// into all_results vtu/vtp files, one step at a time, in process.
+//
+// Every field block the postsolver exports is read from the restart files
+// and mapped onto the mesh-complete volume and exterior meshes by
+// GlobalNodeID, under the postsolver's array names: pressure, velocity,
+// timeDeriv, average_pressure and average_speed (ybar), vinplane_traction,
+// vWSS and displacement. Blocks a run did not write are skipped. The
+// single file also gets the <name>_avg arrays over all steps,
+// pressure_avg_mmHg and, with wall shear stress, OSI.
+//
+// Initialize() reads the meshes and the node maps of every processor once,
+// after that ConvertStep() can be called for different steps from several
+// threads at the same time. In single file mode the steps are kept in
+// memory until WriteSingleFile() is called.
+
+// one output array of a step, values indexed by global node id (0 based)
+struct sv4guiSimulationResultField
+{
+    std::string name;
+    int numComps;
+    std::vector<double> values;
+};
+
+class SV4GUIMODULESIMULATION_EXPORT sv4guiSimulationResultsConverter
+{
+
+public:
+
+    sv4guiSimulationResultsConverter();
+
+    virtual ~sv4guiSimulationResultsConverter();
+
+    void SetResultDir(std::string resultDir);
+    void SetOutputDir(std::string outputDir);
+    void SetMeshFiles(std::string volumeFilePath, std::string surfaceFilePath);
+    void SetSteps(int start, int stop, int increment);
+    void SetVolumeOutput(bool volumeOutput);
+    void SetSurfaceOutput(bool surfaceOutput);
+    void SetSingleFile(bool singleFile);
+
+    bool Initialize(std::string& msg);
+
+    std::vector<int> GetSteps();
+
+    // steps whose output files are missing or older than their restart files
+    std::vector<int> GetStepsToConvert();
+
+    bool IsStepUpToDate(int step);
+
+    bool ConvertStep(int step);
+
+    bool WriteSingleFile();
+
+    // steps ConvertStep() failed on, in no particular order
+    std::vector<int> GetFailedSteps();
+
+    std::string GetStepFileName(int step, std::string extension);
+
+    std::string GetMessages();
+
+  protected:
+
+    bool ReadNodeMap(int proc, std::string& msg);
+
+    bool ReadStep(int step, std::vector<sv4guiSimulationResultField>& fields);
+
+    void AddStepArrays(std::string suffix, std::vector<int>& globalIDs
+                       , std::vector<sv4guiSimulationResultField>& fields
+                       , std::vector<vtkSmartPointer<vtkDoubleArray> >& arrays);
+
+    void AddAverageArrays(std::map<int,std::vector<vtkSmartPointer<vtkDoubleArray> > >& stepArrays
+                          , vtkPointData* pointData);
+
+    bool WriteStep(int step);
+
+    std::string GetStepSuffix(int step);
+
+    std::string GetRestartFilePath(int step, int proc);
+
+    std::string GetGeombcFilePath(int proc);
+
+    void AddMessage(std::string msg);
+
+    std::string m_ResultDir;
+    std::string m_OutputDir;
+    std::string m_VolumeFilePath;
+    std::string m_SurfaceFilePath;
+
+    int m_Start;
+    int m_Stop;
+    int m_Increment;
+
+    bool m_VolumeOutput;
+    bool m_SurfaceOutput;
+    bool m_SingleFile;
+
+    int m_NumProcs;
+    int m_NumGlobalNodes;
+
+    // global node ids (1 based) of the local nodes of each processor,
+    // empty for a serial run without a map
+    std::vector<std::vector<int> > m_NodeMaps;
+
+    vtkSmartPointer<vtkUnstructuredGrid> m_Volume;
+    vtkSmartPointer<vtkPolyData> m_Surface;
+    std::vector<int> m_VolumeGlobalIDs;
+    std::vector<int> m_SurfaceGlobalIDs;
+
+    // single file mode, one slot per step, filled by ConvertStep
+    std::map<int,std::vector<vtkSmartPointer<vtkDoubleArray> > > m_VolumeStepArrays;
+    std::map<int,std::vector<vtkSmartPointer<vtkDoubleArray> > > m_SurfaceStepArrays;
+
+    std::mutex m_Mutex;
+    std::string m_Messages;
+    std::vector<int> m_FailedSteps;
+
+  };
+
+
+#endif // SV4GUI_SIMULATIONRESULTSCONVERTER_H
@@ -44,6 +44,9 @@
 #include <vtkPointData.h>
 #include <vtkDoubleArray.h>
 #include <vtkAbstractArray.h>
+#include <vtkDataSet.h>
+
+#include <QtConcurrentMap>
 
 std::string sv4guiSimulationUtils::CreatePreSolverFileContent(sv4guiSimJob* job, std::string outputDir)
 {
@@ -615,6 +618,200 @@ std::string sv4guiSimulationUtils::CreateFlowSolverFileContent(sv4guiSimJob* job
     return ss.str();
 }
 
+//face data shared by all the steps, built once in CreateFlowFiles
+struct sv4guiFlowFaceCache
+{
+    std::vector<std::string> names;
+    std::vector<vtkSmartPointer<vtkPolyData>> vtps;
+
+    //GlobalNodeID array of the step data the local ids were built from
+    vtkSmartPointer<vtkDataArray> refGlobalIDs;
+    std::vector<std::vector<vtkIdType>> refLocalIDs;
+};
+
+//one unit of work: a step file, or one step of the combo file
+struct sv4guiFlowStepJob
+{
+    const sv4guiFlowFaceCache* faces;
+    std::string filePath;
+    vtkSmartPointer<vtkDataSet> sim;
+    std::string step;
+    std::string pressureName;
+    std::string velocityName;
+
+    std::vector<double> pressure;
+    std::vector<double> flowrate;
+    bool hasPressure;
+    bool hasFlowrate;
+};
+
+static vtkSmartPointer<vtkDataSet> sv4guiReadFlowStepFile(const std::string& filePath)
+{
+    vtkSmartPointer<vtkDataSet> sim=NULL;
+
+    if(filePath.substr(filePath.find_last_of('.'),4)==".vtp")
+    {
+        vtkSmartPointer<vtkXMLPolyDataReader> reader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
+        reader->SetFileName(filePath.c_str());
+        reader->Update();
+        sim=reader->GetOutput();
+    }
+    else if(filePath.substr(filePath.find_last_of('.'),4)==".vtu")
+    {
+        vtkSmartPointer<vtkXMLUnstructuredGridReader> reader = vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
+        reader->SetFileName(filePath.c_str());
+        reader->Update();
+        sim=reader->GetOutput();
+    }
+
+    return sim;
+}
+
+//map the face GlobalNodeIDs to point ids of the step data, ids missing from
+//the step data map to point 0 like the std::map lookup they replace
+static void sv4guiBuildFaceLocalIDs(const sv4guiFlowFaceCache& faces, vtkDataArray* simGlobalIDs
+                                    , std::vector<std::vector<vtkIdType>>& localIDs)
+{
+    localIDs.assign(faces.vtps.size(),std::vector<vtkIdType>());
+    if(simGlobalIDs==NULL)
+        return;
+
+    int maxID=0;
+    vtkIdType numPoints=simGlobalIDs->GetNumberOfTuples();
+    for(vtkIdType i=0;i<numPoints;++i)
+    {
+        int nodeID=simGlobalIDs->GetComponent(i,0);
+        if(nodeID>maxID)
+            maxID=nodeID;
+    }
+
+    std::vector<vtkIdType> global2Local(maxID+1,0);
+    for(vtkIdType i=0;i<numPoints;++i)
+    {
+        int nodeID=simGlobalIDs->GetComponent(i,0);
+        if(nodeID>=0)
+            global2Local[nodeID]=i;
+    }
+
+    for(int f=0;f<faces.vtps.size();++f)
+    {
+        vtkDataArray* faceNodeIDs=faces.vtps[f]->GetPointData()->GetArray("GlobalNodeID");
+        int faceNumPoint=faces.vtps[f]->GetNumberOfPoints();
+        localIDs[f].resize(faceNumPoint,0);
+        for(int j=0;j<faceNumPoint;++j)
+        {
+            int gID=faceNodeIDs->GetComponent(j,0);
+            if(gID>=0 && gID<=maxID)
+                localIDs[f][j]=global2Local[gID];
+        }
+    }
+}
+
+static bool sv4guiSameGlobalIDs(vtkDataArray* a, vtkDataArray* b)
+{
+    if(a==b)
+        return true;
+
+    if(a==NULL || b==NULL || a->GetNumberOfTuples()!=b->GetNumberOfTuples())
+        return false;
+
+    for(vtkIdType i=0;i<a->GetNumberOfTuples();++i)
+    {
+        if(a->GetComponent(i,0)!=b->GetComponent(i,0))
+            return false;
+    }
+
+    return true;
+}
+
+//runs on the thread pool, only reads the shared face data
+static void sv4guiProcessFlowStep(sv4guiFlowStepJob& job)
+{
+    const sv4guiFlowFaceCache& faces=*job.faces;
+    int numFaces=faces.vtps.size();
+
+    job.pressure.assign(numFaces,0.0);
+    job.flowrate.assign(numFaces,0.0);
+    job.hasPressure=false;
+    job.hasFlowrate=false;
+
+    if(job.sim==NULL)
+        job.sim=sv4guiReadFlowStepFile(job.filePath);
+
+    if(job.sim==NULL)
+        return;
+
+    vtkPointData* pointData=job.sim->GetPointData();
+    vtkDataArray* parray=job.pressureName=="" ? NULL : pointData->GetArray(job.pressureName.c_str());
+    vtkDataArray* varray=job.velocityName=="" ? NULL : pointData->GetArray(job.velocityName.c_str());
+
+    if(parray==NULL && varray==NULL)
+        return;
+
+    vtkDataArray* simGlobalIDs=pointData->GetArray("GlobalNodeID");
+    if(simGlobalIDs==NULL)
+        return;
+
+    //step files normally share one mesh, only remap if this one differs
+    std::vector<std::vector<vtkIdType>> ownLocalIDs;
+    const std::vector<std::vector<vtkIdType>>* localIDs=&faces.refLocalIDs;
+    if(!sv4guiSameGlobalIDs(simGlobalIDs,faces.refGlobalIDs))
+    {
+        sv4guiBuildFaceLocalIDs(faces,simGlobalIDs,ownLocalIDs);
+        localIDs=&ownLocalIDs;
+    }
+
+    for(int f=0;f<numFaces;++f)
+    {
+        const std::vector<vtkIdType>& ids=(*localIDs)[f];
+        int faceNumPoint=ids.size();
+
+        vtkSmartPointer<vtkPolyData> facevtp=vtkSmartPointer<vtkPolyData>::New();
+        facevtp->ShallowCopy(faces.vtps[f]);
+
+        if(parray!=NULL)
+        {
+            vtkSmartPointer<vtkDoubleArray> facep=vtkSmartPointer<vtkDoubleArray>::New();
+            facep->SetNumberOfComponents(1);
+            facep->SetNumberOfTuples(faceNumPoint);
+            facep->SetName(job.pressureName.c_str());
+            for(int j=0;j<faceNumPoint;++j)
+                facep->SetValue(j,parray->GetComponent(ids[j],0));
+
+            facevtp->GetPointData()->AddArray(facep);
+            facevtp->GetPointData()->SetActiveScalars(job.pressureName.c_str());
+
+            double force=0,area=0;
+            sys_geom_IntegrateSurface2(facevtp,0,&force,&area);
+            job.pressure[f]=force/area;
+            job.hasPressure=true;
+        }
+
+        if(varray!=NULL)
+        {
+            vtkSmartPointer<vtkDoubleArray> facev=vtkSmartPointer<vtkDoubleArray>::New();
+            facev->SetNumberOfComponents(3);
+            facev->SetNumberOfTuples(faceNumPoint);
+            facev->SetName(job.velocityName.c_str());
+            for(int j=0;j<faceNumPoint;++j)
+                for(int k=0;k<3;++k)
+                    facev->SetComponent(j,k,varray->GetComponent(ids[j],k));
+
+            facevtp->GetPointData()->AddArray(facev);
+            facevtp->GetPointData()->SetActiveVectors(job.velocityName.c_str());
+
+            double flowrate=0,area=0;
+            sys_geom_IntegrateSurface2(facevtp,1,&flowrate,&area);
+            job.flowrate[f]=flowrate;
+            job.hasFlowrate=true;
+        }
+    }
+
+    //release the step data as soon as it is integrated
+    if(job.filePath!="")
+        job.sim=NULL;
+}
+
 bool sv4guiSimulationUtils::CreateFlowFiles(std::string outFlowFilePath, std::string outPressureFlePath
                                         , std::string outAverageFilePath, std::string outAverageUnitsFilePath
                                         , std::vector<std::string> vtxFilePaths, bool useComboFile
@@ -645,96 +842,117 @@ bool sv4guiSimulationUtils::CreateFlowFiles(std::string outFlowFilePath, std::st
 
         facevtp->GetPointData()->SetActiveScalars("GlobalNodeID");
 
+        //build the cell structures now so the threads only read them
+        facevtp->BuildLinks();
+
         vtpMap[faceName]=facevtp;
     }
 
-    std::map<std::string,vtkSmartPointer<vtkPolyData>> simVtps;
-    std::map<std::string,vtkSmartPointer<vtkUnstructuredGrid>> simUgs;
+    if(vtpMap.size()==0)
+        return false;
+
+    sv4guiFlowFaceCache faces;
+    for(auto name_vtp:vtpMap)
+    {
+        faces.names.push_back(name_vtp.first);
+        faces.vtps.push_back(name_vtp.second);
+    }
 
+    std::vector<std::string> stepFilePaths;
     for(int i=0;i<vtxFilePaths.size();i++)
     {
         std::string vtxFilePath=vtxFilePaths[i];
+        std::string ext=vtxFilePath.substr(vtxFilePath.find_last_of('.'),4);
+        if(ext==".vtp" || ext==".vtu")
+            stepFilePaths.push_back(vtxFilePath);
+    }
 
-        vtkSmartPointer<vtkPolyData> simvtp=NULL;
-        vtkSmartPointer<vtkUnstructuredGrid> simvtu=NULL;
+    if(stepFilePaths.size()==0)
+        return false;
 
-        if(vtxFilePath.substr(vtxFilePath.find_last_of('.'),4)==".vtp")
-        {
-            vtkSmartPointer<vtkXMLPolyDataReader> reader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
-            reader->SetFileName(vtxFilePath.c_str());
-            reader->Update();
-            simvtp=reader->GetOutput();
-        }
-        else if(vtxFilePath.substr(vtxFilePath.find_last_of('.'),4)==".vtu")
-        {
-            vtkSmartPointer<vtkXMLUnstructuredGridReader> reader = vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
-            reader->SetFileName(vtxFilePath.c_str());
-            reader->Update();
-            simvtu=reader->GetOutput();
-        }
+    std::vector<sv4guiFlowStepJob> jobs;
 
-        if(useComboFile)
-        {
-            if(simvtp!=NULL)
-                simVtps["combo"]=simvtp;
+    if(useComboFile)
+    {
+        //all the steps are arrays of one file, integrate them in parallel
+        vtkSmartPointer<vtkDataSet> sim=sv4guiReadFlowStepFile(stepFilePaths.back());
+        vtkPointData* pointData=sim->GetPointData();
 
-            if(simvtu!=NULL)
-                simUgs["combo"]=simvtu;
-        }
-        else
+        std::map<std::string,int> stepJobs;
+        for(int i=0;i<pointData->GetNumberOfArrays();++i)
         {
-            std::string str=vtxFilePath.substr(vtxFilePath.find_last_of('_')+1);
-            std::string step=str.substr(0,str.find_last_of('.'));
-            if(simvtp!=NULL)
-                simVtps[step]=simvtp;
+            std::string name(pointData->GetAbstractArray(i)->GetName());
 
-            if(simvtu!=NULL)
-                simUgs[step]=simvtu;
-        }
+            if(name=="pressure_avg" || name=="pressure_avg_mmHg")
+                continue;
 
-    }
+            if(name.substr(0,9)!="pressure_" && name.substr(0,9)!="velocity_")
+                continue;
 
-    if(simVtps.size()==0 && simUgs.size()==0)
-        return false;
+            std::string step=name.substr(9);
+            if(stepJobs.find(step)==stepJobs.end())
+            {
+                sv4guiFlowStepJob job;
+                job.faces=&faces;
+                job.sim=sim;
+                job.step=step;
+                stepJobs[step]=jobs.size();
+                jobs.push_back(job);
+            }
 
-    std::map<std::string,std::map<std::string, double>> pressureMap;
-    std::map<std::string,std::map<std::string, double>> flowrateMap;
-    std::map<std::string,std::map<std::string, double>> areaMap;
+            if(name.substr(0,9)=="pressure_")
+                jobs[stepJobs[step]].pressureName=name;
+            else
+                jobs[stepJobs[step]].velocityName=name;
+        }
 
-    auto it=vtpMap.begin();
-    while(it!=vtpMap.end())
+        faces.refGlobalIDs=pointData->GetArray("GlobalNodeID");
+    }
+    else
     {
-        for(auto step_simvtp:simVtps)
+        //one file per step, read and integrated in parallel
+        for(int i=0;i<stepFilePaths.size();i++)
         {
-            std::string step=step_simvtp.first;
-            vtkSmartPointer<vtkPolyData> simvtp=step_simvtp.second;
-
-            if(simvtp!=NULL)
-                VtpExtractSingleFace(step,simvtp, it->second);
+            std::string str=stepFilePaths[i].substr(stepFilePaths[i].find_last_of('_')+1);
+
+            sv4guiFlowStepJob job;
+            job.faces=&faces;
+            job.filePath=stepFilePaths[i];
+            job.step=str.substr(0,str.find_last_of('.'));
+            job.pressureName="pressure";
+            job.velocityName="velocity";
+            jobs.push_back(job);
         }
 
-        for(auto step_simug:simUgs)
-        {
-            std::string step=step_simug.first;
-            vtkSmartPointer<vtkUnstructuredGrid> simug=step_simug.second;
+        //the first step provides the node numbering the others are checked against
+        jobs[0].sim=sv4guiReadFlowStepFile(jobs[0].filePath);
+        if(jobs[0].sim!=NULL)
+            faces.refGlobalIDs=jobs[0].sim->GetPointData()->GetArray("GlobalNodeID");
+    }
 
-            if(simug!=NULL)
-                VtuExtractSingleFace(step,simug, it->second);
-        }
+    sv4guiBuildFaceLocalIDs(faces,faces.refGlobalIDs,faces.refLocalIDs);
 
-        std::map<std::string, double> pmap;
-        std::map<std::string, double> qmap;
-        std::map<std::string, double> amap;
+    QtConcurrent::blockingMap(jobs,sv4guiProcessFlowStep);
 
-        VtpIntegrateFace(it->second,pmap,qmap,amap);
+    //merge in job order, so later files win for repeated steps as before
+    std::map<std::string,std::map<std::string, double>> pressureMap;
+    std::map<std::string,std::map<std::string, double>> flowrateMap;
 
-        pressureMap[it->first]=pmap;
-        flowrateMap[it->first]=qmap;
-        areaMap[it->first]=amap;
+    for(int i=0;i<jobs.size();++i)
+    {
+        for(int f=0;f<faces.names.size();++f)
+        {
+            if(jobs[i].hasPressure)
+                pressureMap[faces.names[f]][jobs[i].step]=jobs[i].pressure[f];
 
-        it++;
+            if(jobs[i].hasFlowrate)
+                flowrateMap[faces.names[f]][jobs[i].step]=jobs[i].flowrate[f];
+        }
     }
 
+    if(pressureMap.size()==0 || flowrateMap.size()==0)
+        return false;
+
     ofstream pressurefs(outPressureFlePath.c_str());
     ofstream flowfs(outFlowFilePath.c_str());
     ofstream averagefs(outAverageFilePath.c_str());
@@ -672,11 +672,14 @@ sv4guiImageProcessingUtils::itkImPoint sv4guiImageProcessing::CombinedCollidingF
 double lower, double upper){
 
   bool min_init = false;
-  auto minImage = sv4guiImageProcessingUtils::copyImage(itkImage);
+  sv4guiImageProcessingUtils::itkImPoint minImage;
 
   int startSeeds = m_SeedContainer->getNumStartSeeds();
   if (startSeeds == 0) return NULL;
 
+  //the speed image only depends on the thresholds, share it between seed pairs
+  auto speedImage = sv4guiImageProcessingUtils::collidingFrontsSpeed(itkImage, lower, upper);
+
   for (int s = 0; s < startSeeds; s++){
     int endSeeds = m_SeedContainer->getNumEndSeeds(s);
     if (endSeeds == 0) break;
@@ -695,14 +698,13 @@ double lower, double upper){
 
       std::cout << s_index[0] << ", " << e_index[0] << "\n";
 
-      auto temp_im = sv4guiImageProcessingUtils::collidingFronts(itkImage,
+      auto temp_im = sv4guiImageProcessingUtils::collidingFrontsFromSpeed(speedImage,
         s_index[0], s_index[1], s_index[2],
-        e_index[0], e_index[1], e_index[2],
-        lower, upper);
+        e_index[0], e_index[1], e_index[2]);
 
       std::cout << "taking image minimum\n";
       if (min_init){
-        minImage = sv4guiImageProcessingUtils::elementwiseMinimum(minImage, temp_im);
+        minImage = sv4guiImageProcessingUtils::elementwiseMinimumInPlace(minImage, temp_im);
       }else {
         min_init = true;
         minImage = temp_im;
@@ -799,10 +801,8 @@ void sv4guiImageProcessing::runFullCollidingFronts(){
   double isovalue =
     std::stod(ui->fullCFIsoValueLineEdit->text().toStdString());
 
-  vtkSmartPointer<vtkImageData> vtkImage =
-    sv4guiImageProcessingUtils::itkImageToVtkImage(lsImage);
   vtkSmartPointer<vtkPolyData> vtkPd     =
-    sv4guiImageProcessingUtils::marchingCubes(vtkImage, isovalue, false);
+    sv4guiImageProcessingUtils::marchingCubes(lsImage, isovalue, false);
   storePolyData(vtkPd);
 }
 
@@ -917,8 +917,7 @@ void sv4guiImageProcessing::runIsovalue(){
   bool largest_cc = ui->isoCheckBox->isChecked();
 
   auto itkImage = getItkImage(0);
-  vtkSmartPointer<vtkImageData> vtkImage = sv4guiImageProcessingUtils::itkImageToVtkImage(itkImage);
 
-  vtkSmartPointer<vtkPolyData> vtkPd     = sv4guiImageProcessingUtils::marchingCubes(vtkImage, isovalue, largest_cc);
+  vtkSmartPointer<vtkPolyData> vtkPd     = sv4guiImageProcessingUtils::marchingCubes(itkImage, isovalue, largest_cc);
   storePolyData(vtkPd);
 }
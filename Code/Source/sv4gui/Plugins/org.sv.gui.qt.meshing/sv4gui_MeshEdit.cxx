@@ -37,6 +37,8 @@
 #include "sv4gui_Model.h"
 #include "sv4gui_MeshFactory.h"
 #include "sv4gui_Mesh.h"
+#include "sv4gui_MeshCache.h"
+#include "sv4gui_MeshTetGen.h"
 #include "sv4gui_MitkMesh.h"
 #include "sv4gui_MitkMeshOperation.h"
 #include "sv4gui_MitkMeshIO.h"
@@ -165,6 +167,17 @@ void sv4guiMeshEdit::CreateQtPartControl( QWidget *parent )
 
     connect(ui->btnMeshInfo, SIGNAL(clicked()), this, SLOT(DisplayMeshInfo()) );
     connect(ui->checkBoxShowModel, SIGNAL(clicked(bool)), this, SLOT(ShowModel(bool)) );
+
+    berry::IPreferencesService* prefService = berry::Platform::GetPreferencesService();
+    if (prefService)
+    {
+        berry::IPreferences::Pointer prefs = prefService->GetSystemPreferences()->Node("/org.sv.views.meshing");
+        ui->spinBoxCacheSize->setValue(prefs->GetInt("Mesh Cache Size MB", ui->spinBoxCacheSize->value()));
+    }
+    sv4guiMeshCache::SetMaximumSize(qint64(ui->spinBoxCacheSize->value())*1024*1024);
+
+    connect(ui->spinBoxCacheSize, SIGNAL(valueChanged(int)), this, SLOT(SetMeshCacheSize(int)) );
+    connect(ui->btnClearCache, SIGNAL(clicked()), this, SLOT(ClearMeshCache()) );
 }
 
 void sv4guiMeshEdit::SetupGUI(QWidget *parent )
@@ -751,6 +764,12 @@ void sv4guiMeshEdit::RunCommands(bool fromGUI)
     newMesh->InitNewMesher();
     newMesh->SetModelElement(modelElement);
 
+    // unchanged meshes are loaded from the cache in the project's mesh folder
+    sv4guiMeshTetGen* tetgenMesh=dynamic_cast<sv4guiMeshTetGen*>(newMesh);
+    QString cacheDir=GetMeshCacheDirectory();
+    if(tetgenMesh && cacheDir!="" && sv4guiMeshCache::GetMaximumSize()>0)
+        tetgenMesh->SetCacheDirectory(cacheDir.toStdString());
+
     std::vector<std::string> cmds;
     if(fromGUI)
     {
@@ -2548,6 +2567,51 @@ QString sv4guiMeshEdit::GetMeshFolderPath()
     return meshFolderPath;
 }
 
+QString sv4guiMeshEdit::GetMeshCacheDirectory()
+{
+    std::string meshPath="";
+    if(m_MeshNode.IsNotNull())
+        m_MeshNode->GetStringProperty("path",meshPath);
+
+    if(meshPath=="")
+        return "";
+
+    return QString::fromStdString(meshPath+"/.cache");
+}
+
+void sv4guiMeshEdit::SetMeshCacheSize(int megabytes)
+{
+    sv4guiMeshCache::SetMaximumSize(qint64(megabytes)*1024*1024);
+
+    berry::IPreferencesService* prefService = berry::Platform::GetPreferencesService();
+    if (prefService)
+    {
+        berry::IPreferences::Pointer prefs = prefService->GetSystemPreferences()->Node("/org.sv.views.meshing");
+        prefs->PutInt("Mesh Cache Size MB", megabytes);
+        prefs->Flush();
+    }
+
+    // a smaller limit takes effect on the cache of the current mesh folder right away
+    QString cacheDir=GetMeshCacheDirectory();
+    if(cacheDir!="" && QDir(cacheDir).exists())
+        sv4guiMeshCache::Trim(cacheDir);
+}
+
+void sv4guiMeshEdit::ClearMeshCache()
+{
+    QString cacheDir=GetMeshCacheDirectory();
+    if(cacheDir=="" || !QDir(cacheDir).exists())
+        return;
+
+    if (QMessageBox::question(m_Parent, "Clear Cache", "Remove all cached meshes in this mesh folder?",
+                              QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+    {
+        return;
+    }
+
+    sv4guiMeshCache::Clear(cacheDir);
+}
+
 void sv4guiMeshEdit::ShowModel(bool checked)
 {
     if(m_ModelNode.IsNotNull())
@@ -127,6 +127,10 @@ public slots:
 
     void ShowModel(bool checked = false);
 
+    void SetMeshCacheSize(int megabytes);
+
+    void ClearMeshCache();
+
 public:
 
     int GetTimeStep();
@@ -171,6 +175,8 @@ public:
 
     QString GetMeshFolderPath();
 
+    QString GetMeshCacheDirectory();
+
 protected:
 
     QWidget* m_Parent;
@@ -753,6 +753,18 @@ void sv4guiSeg2DEdit::CreateContours(SegmentationMethod method)
 
     mitk::ProgressBar::GetInstance()->AddStepsToDo(posList.size());
 
+    //level sets of different slices are independent, so segment them all at once
+    std::vector<sv4guiContour*> lsContours;
+    if(method==LEVELSET_METHOD)
+    {
+        std::vector<sv4guiPathElement::sv4guiPathPoint> pathPoints;
+        for(int i=0;i<posList.size();i++)
+            pathPoints.push_back(ui->resliceSlider->getPathPoint(posList[i]));
+
+        sv4guiSegmentationUtils::svLSParam tmpLSParam = m_LSParamWidget->GetLSParam();
+        lsContours=sv4guiSegmentationUtils::CreateLSContours(pathPoints,m_cvImage->GetVtkStructuredPoints(),&tmpLSParam,ui->resliceSlider->getResliceSize());
+    }
+
     for(int i=0;i<posList.size();i++)
     {
         int posID=posList[i];
@@ -767,11 +779,8 @@ void sv4guiSeg2DEdit::CreateContours(SegmentationMethod method)
         switch(method)
         {
             case LEVELSET_METHOD:
-            {
-                sv4guiSegmentationUtils::svLSParam tmpLSParam = m_LSParamWidget->GetLSParam();
-                contour=sv4guiSegmentationUtils::CreateLSContour(ui->resliceSlider->getPathPoint(posID),m_cvImage->GetVtkStructuredPoints(),&tmpLSParam,ui->resliceSlider->getResliceSize());
+                contour=lsContours[i];
                 break;
-            }
             case THRESHOLD_METHOD:
                 contour=sv4guiSegmentationUtils::CreateThresholdContour(ui->resliceSlider->getPathPoint(posID),m_cvImage->GetVtkStructuredPoints(),ui->sliderThreshold->value(), ui->resliceSlider->getResliceSize());
                 break;
@@ -41,6 +41,7 @@
 #include "sv4gui_MeshLegacyIO.h"
 #include "sv4gui_MPIPreferencePage.h"
 #include "sv4gui_SimulationUtils.h"
+#include "sv4gui_SimulationResultsConverter.h"
 #include "sv4gui_SimulationPreferences.h"
 #include "sv4gui_SimulationPreferencePage.h"
 
@@ -71,6 +72,11 @@
 #include <QScrollArea>
 #include <QVBoxLayout>
 #include <QApplication>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QtConcurrentMap>
+
+#include <algorithm>
 
 using namespace sv4guiSimulationPreferenceDBKey;
 
@@ -81,6 +87,18 @@ const QString sv4guiSimulationView::EXTENSION_ID = "org.sv.views.simulation";
 // Note: On MacOS the window title is ignored (as required by the Mac OS X Guidelines). 
 const QString sv4guiSimulationView::MsgTitle = "SimVascular SV Simulation";
 
+// Converts one time step, run by QtConcurrent::map in ExportResults.
+struct sv4guiConvertResultStep
+{
+    sv4guiSimulationResultsConverter* converter;
+
+    void operator()(int& step)
+    {
+        //failures are collected by the converter and reported afterwards
+        converter->ConvertStep(step);
+    }
+};
+
 //----------------------
 // sv4guiSimulationView
 //----------------------
@@ -2671,11 +2689,15 @@ void sv4guiSimulationView::SetResultDir()
 //
 void sv4guiSimulationView::ExportResults()
 {
+    //the vtu/vtp conversion runs in process, postsolver is only needed
+    //to write restart files
+    bool toRestart=ui->checkBoxToRestart->isChecked();
+
     QString postsolverPath=m_PostsolverPath;
     if(postsolverPath=="")
         postsolverPath=m_PostsolverPath;
 
-    if(postsolverPath=="" || !QFile(postsolverPath).exists())
+    if(toRestart && (postsolverPath=="" || !QFile(postsolverPath).exists()))
     {
         QMessageBox::warning(m_Parent,"Postsolver Missing","Please make sure postsolver exists!");
         return;
@@ -2751,47 +2773,98 @@ void sv4guiSimulationView::ExportResults()
         return;
     }
 
-    QStringList arguments;
-    arguments << "-all";
-    arguments << "-indir" << resultDir;
-    arguments << "-outdir" << exportDir;
-    arguments << "-start" << startNo;
-    arguments << "-stop" << stopNo;
-    arguments << "-incr" << increment;
-    if(ui->checkBoxSingleFile->isChecked())
-        arguments << "-vtkcombo";
+    mitk::StatusBar::GetInstance()->DisplayText("Exporting results.");
 
-    if(ui->checkBoxVolume->isChecked())
-    {
-       if(ui->checkBoxSingleFile->isChecked())
-           arguments << "-vtu" << "all_results.vtu";
-       else
-           arguments << "-vtu" << "all_results";
-    }
+    QString detailedInfo="";
+    QString failedInfo="";
 
-    if(ui->checkBoxSurface->isChecked())
+    if(ui->checkBoxVolume->isChecked() || ui->checkBoxSurface->isChecked())
     {
-       if(ui->checkBoxSingleFile->isChecked())
-           arguments << "-vtp" << "all_results.vtp";
-       else
-           arguments << "-vtp" << "all_results";
+        QString meshCompleteDir=GetJobPath()+"/mesh-complete";
+
+        sv4guiSimulationResultsConverter converter;
+        converter.SetResultDir(resultDir.toStdString());
+        converter.SetOutputDir(exportDir.toStdString());
+        converter.SetMeshFiles((meshCompleteDir+"/mesh-complete.mesh.vtu").toStdString()
+                               , (meshCompleteDir+"/mesh-complete.exterior.vtp").toStdString());
+        converter.SetSteps(startNo.toInt(),stopNo.toInt(),increment.toInt());
+        converter.SetVolumeOutput(ui->checkBoxVolume->isChecked());
+        converter.SetSurfaceOutput(ui->checkBoxSurface->isChecked());
+        converter.SetSingleFile(ui->checkBoxSingleFile->isChecked());
+
+        std::string msg="";
+        if(!converter.Initialize(msg))
+        {
+            QMessageBox::warning(m_Parent,"Results Conversion Error",QString::fromStdString(msg));
+            return;
+        }
+
+        std::vector<int> allSteps=converter.GetSteps();
+        std::vector<int> steps=converter.GetStepsToConvert();
+        if(steps.size()<allSteps.size())
+            detailedInfo+=QString::number(allSteps.size()-steps.size())+" steps already up to date.\n";
+
+        if(steps.size()>0)
+        {
+            //one step per task on the global thread pool
+            QProgressDialog progress("Converting results...","Cancel",0,steps.size(),m_Parent);
+            progress.setWindowTitle("Export Results");
+            progress.setWindowModality(Qt::WindowModal);
+            progress.setMinimumDuration(0);
+
+            QFutureWatcher<void> watcher;
+            connect(&watcher, SIGNAL(progressValueChanged(int)), &progress, SLOT(setValue(int)));
+            connect(&watcher, SIGNAL(finished()), &progress, SLOT(reset()));
+            connect(&progress, SIGNAL(canceled()), &watcher, SLOT(cancel()));
+
+            sv4guiConvertResultStep convertStep;
+            convertStep.converter=&converter;
+            watcher.setFuture(QtConcurrent::map(steps,convertStep));
+
+            progress.exec();
+            watcher.waitForFinished();
+
+            std::vector<int> failedSteps=converter.GetFailedSteps();
+            std::sort(failedSteps.begin(),failedSteps.end());
+
+            if(watcher.isCanceled())
+                detailedInfo+="Conversion canceled.\n";
+            else if(failedSteps.size()>0)
+            {
+                QStringList stepList;
+                for(int i=0;i<failedSteps.size();i++)
+                    stepList<<QString::number(failedSteps[i]);
+                failedInfo="Fail to convert step(s) "+stepList.join(", ")+".";
+            }
+            else if(ui->checkBoxSingleFile->isChecked() && !converter.WriteSingleFile())
+                failedInfo="Fail to write the single result file.";
+        }
+
+        detailedInfo+=QString::fromStdString(converter.GetMessages());
     }
 
-    if(ui->checkBoxToRestart->isChecked())
+    if(toRestart)
+    {
+        QStringList arguments;
+        arguments << "-all";
+        arguments << "-indir" << resultDir;
+        arguments << "-outdir" << exportDir;
+        arguments << "-start" << startNo;
+        arguments << "-stop" << stopNo;
+        arguments << "-incr" << increment;
         arguments << "-ph" << "-laststep";
 
-    mitk::StatusBar::GetInstance()->DisplayText("Exporting results.");
-
-    QProcess *postsolverProcess = new QProcess(m_Parent);
-    postsolverProcess->setWorkingDirectory(exportDir);
-    postsolverProcess->setProgram(postsolverPath);
-    postsolverProcess->setArguments(arguments);
+        QProcess *postsolverProcess = new QProcess(m_Parent);
+        postsolverProcess->setWorkingDirectory(exportDir);
+        postsolverProcess->setProgram(postsolverPath);
+        postsolverProcess->setArguments(arguments);
 
-    sv4guiProcessHandler* handler=new sv4guiProcessHandler(postsolverProcess,m_JobNode,false,false,m_Parent);
-    handler->Start();
+        sv4guiProcessHandler* handler=new sv4guiProcessHandler(postsolverProcess,m_JobNode,false,false,m_Parent);
+        handler->Start();
 
-    QString detailedInfo=handler->GetMessage();
-    delete handler;
+        detailedInfo+=handler->GetMessage();
+        delete handler;
+    }
 
     bool convertedFilesExit=true;
     bool meshFaceDirExits=true;
@@ -2870,7 +2943,9 @@ void sv4guiSimulationView::ExportResults()
     }
 
     QString msg="";
-    if(convertedFilesExit)
+    if(failedInfo!="")
+        msg=failedInfo;
+    else if(convertedFilesExit)
     {
         msg="Results have been converted.";
         if(!meshFaceDirExits)
@@ -2888,7 +2963,7 @@ void sv4guiSimulationView::ExportResults()
     QMessageBox mb(m_Parent);
     mb.setWindowTitle("Finished");
     mb.setText(msg);
-    mb.setIcon(QMessageBox::Information);
+    mb.setIcon(failedInfo=="" ? QMessageBox::Information : QMessageBox::Warning);
     mb.setDetailedText(detailedInfo);
     mb.setDefaultButton(QMessageBox::Ok);
     mb.exec();
@@ -47,6 +47,17 @@
 #include "cvSolverIO.h"
 
 #include <ctype.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+#ifndef _WIN32
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
 
 #define INT 1
 #define FLOAT 2
@@ -57,6 +68,8 @@
 
 cvsolverIO** cvsolverIOfp = NULL;
 
+bool cvsolverIO::useHeaderIndexFile_ = false;
+
 cvsolverIO::cvsolverIO () {
     //byte_order_;
     type_of_data_=0;
@@ -64,11 +77,18 @@ cvsolverIO::cvsolverIO () {
     LastHeaderNotFound_ = false;
     Wrong_Endian_ = false ;
     binary_format_ = true;
-    char *mode_ = NULL;
-    char *fname_ = NULL;
+    headerIndexBuilt_ = false;
+    headerIndexBinary_ = true;
+    lastHeaderIndex_ = -1;
+    mappedData_ = NULL;
+    mappedSize_ = 0;
+    filePointer_ = Z_NULL;
+    mode_ = NULL;
+    fname_ = NULL;
 }
 
 cvsolverIO::~cvsolverIO () {
+    unmapFile();
     if (mode_ != NULL) delete [] mode_;
     if (fname_ != NULL) delete [] fname_;
 }
@@ -90,6 +110,8 @@ int cvsolverIO::openFile (const char *filename, const char *mode) {
         filePointer_ = gzopen( fname_ , "wb" );
     else if( cscompare( mode_, "append" ) )
         filePointer_ = gzopen( fname_ , "ab" );
+    else if( cscompare( mode_, "mapped" ) )
+        filePointer_ = gzopen( fname_, "rb" );
     else {
         fprintf(stdout,"ERROR: invalid mode! [%s].\n",mode_);
         return CVSOLVER_IO_ERROR;
@@ -113,6 +135,19 @@ int cvsolverIO::openFile (const char *filename, const char *mode) {
     //fprintf(stdout,"fname_ : %s\n",fname_);
     //fprintf(stdout,"mode_ : %s\n",mode_);
 
+    // the header index needs the iotype, so it is built on the first
+    // readHeader call unless a valid sidecar index exists
+    if ( useHeaderIndexFile_ && ( cscompare( mode_, "read" ) || cscompare( mode_, "mapped" ) ) ) {
+        std::string indexfile = std::string(fname_) + ".hdridx";
+        loadHeaderIndex( indexfile.c_str() );
+    }
+
+    // compressed files (or platforms without mmap) silently keep
+    // reading through gzread
+    if ( cscompare( mode_, "mapped" ) ) {
+        mapFile();
+    }
+
     return CVSOLVER_IO_OK;
 
 }
@@ -122,12 +157,14 @@ int cvsolverIO::closeFile() {
       gzflush(filePointer_,Z_FULL_FLUSH);
     }
     gzclose(filePointer_);
+    unmapFile();
     return CVSOLVER_IO_OK;
 }
 
 int cvsolverIO::rewindFile() {
      gzrewind(filePointer_);
      gzclearerr(filePointer_);
+     lastHeaderIndex_ = -1;
      return CVSOLVER_IO_OK;
 }
 
@@ -140,88 +177,43 @@ int cvsolverIO::readHeader (const char* keyphrase,int* valueArray,
                           int  nItems,const char*  datatype,
                           const char*  iotype) {
 
-   int i,skip_size,integer_value;
-   int rewinded = 0;
+   int i;
 
    isBinary( iotype );
 
    LastHeaderKey_[0] = '\0';
 
-   while (rewinded < 2) {
-     while (gzgets(filePointer_, Line_, 1024) != Z_NULL) {
-
-         // ignore comment lines
-         if (Line_[0] == '#') {
-             //fprintf(stdout,"COMMENT: %s",Line_);
-             continue;
-         }
-
-         // ignore blank lines
-
-         //char* chkblank = StringStripper(Line_);
-         //fprintf(stdout,"chkblank: %i\n",strlen(chkblank));
-         if (strlen(Line_) <= 1) {
-             //fprintf(stdout,"Skipping blank line?\n");
-             continue;
-         }
-         //fprintf(stdout,"Line_: %s",Line_);
-         char* token = strtok ( Line_, ":" );
-         //fprintf(stdout,"token: %s\n",token);
-         if( cscompare( keyphrase , token ) ) {
-            LastHeaderKey_[0] = '\0';
-            sprintf(LastHeaderKey_,"%s",keyphrase);
-            token = strtok( NULL, " ,;<>" );
-            skip_size = 0;
-            skip_size = atoi( token );
-            for( i=0;i < nItems && ( token = strtok( NULL," ,;<>") );i++) {
-                valueArray[i] = atoi(token);
-                //fprintf(stdout,"integer (%i): %i\n",i,atoi(token));
-            }
-            if ( i < nItems ) {
-                fprintf(stderr,"Expected # of ints not recoverd from head\n");
-                fprintf(stderr,"when looking for : %s\n", keyphrase);
-                return CVSOLVER_IO_ERROR;
-            } else {
-                return CVSOLVER_IO_OK;
-            }
-         }
-         // this really belongs when you open the file!
-         if ( cscompare(token,"byteorder magic number") ) {
-           if ( binary_format_ ) {
-               gzread(filePointer_,&integer_value,sizeof(int));
-               char junk;
-               gzread(filePointer_,&junk,sizeof(char)); /* reading the new line */
-           } else {
-	       gzgets(filePointer_,Line_,1024);
-               sscanf(Line_,"%i",&integer_value);
-           }
-           if ( FLOWSOLVER_MAGIC_NUMBER != integer_value ) {
-               //fprintf(stdout,"NOTE: Wrong_Endian found.\n");
-             Wrong_Endian_ = true;
-           }
-           continue;
-         }
-
-         // skip to next header
-         token = strtok( NULL, " ,;<>" );
-         skip_size = atoi( token );
-         if ( binary_format_ ) {
-             gzseek(filePointer_,skip_size,SEEK_CUR);
-         } else {
-            for( int gama=0; gama < skip_size; gama++ ) {
-              gzgets(filePointer_,Line_,1024);
-            }
-         }
-
-     } // end inner while
+   if ( !headerIndexBuilt_ || headerIndexBinary_ != binary_format_ ) {
+       if ( buildHeaderIndex() == CVSOLVER_IO_ERROR ) {
+           return CVSOLVER_IO_ERROR;
+       }
+   }
 
-     gzrewind(filePointer_);
-     gzclearerr(filePointer_);
-     rewinded++;
-
-   }  // end outer while
+   int found = findHeader( keyphrase );
+   if ( found < 0 ) {
+       // the old scan was left rewound after a miss
+       lastHeaderIndex_ = -1;
+       return CVSOLVER_IO_ERROR;
+   }
+
+   HeaderIndexEntry& entry = headerIndex_[found];
+   lastHeaderIndex_ = found;
+   sprintf(LastHeaderKey_,"%s",keyphrase);
+
+   // position the file at the start of the data block
+   gzclearerr(filePointer_);
+   gzseek(filePointer_,entry.offset,SEEK_SET);
+
+   for( i=0; i < nItems && i < (int)entry.values.size(); i++) {
+       valueArray[i] = entry.values[i];
+   }
+   if ( i < nItems ) {
+       fprintf(stderr,"Expected # of ints not recoverd from head\n");
+       fprintf(stderr,"when looking for : %s\n", keyphrase);
+       return CVSOLVER_IO_ERROR;
+   }
 
-   return CVSOLVER_IO_ERROR;
+   return CVSOLVER_IO_OK;
 
 }
 
@@ -275,7 +267,24 @@ int cvsolverIO::readDataBlock ( const char* keyphrase,
 
     isBinary( iotype );
 
-    if ( binary_format_ ) {
+    if ( binary_format_ && mappedData_ != NULL ) {
+
+        size_t offset = gztell(filePointer_);
+        size_t nbytes = type_size*nItems;
+        if ( offset + nbytes > mappedSize_ ) {
+            fprintf(stderr,"ERROR: data block extends past end of file\n");
+            fprintf(stderr,"DataBlock: %s\n", keyphrase);
+            return CVSOLVER_IO_ERROR;
+        }
+        memcpy(valueArray,mappedData_+offset,nbytes);
+        gzseek(filePointer_,offset+nbytes+sizeof(char),SEEK_SET); /* skip the new line */
+        // blocks handed out by mapDataBlock are already swapped in place
+        if ( Wrong_Endian_ &&
+             std::find( swappedBlocks_.begin(), swappedBlocks_.end(), (z_off_t)offset ) == swappedBlocks_.end() ) {
+            SwapArrayByteOrder( valueArray, type_size, nItems );
+        }
+
+    } else if ( binary_format_ ) {
 
         //fread(valueArray,type_size,nItems,filePointer_ );
         gzread(filePointer_,valueArray,type_size*nItems);
@@ -328,6 +337,67 @@ int cvsolverIO::readDataBlock ( const char* keyphrase,
     return CVSOLVER_IO_OK;
 }
 
+int cvsolverIO::mapDataBlock ( const char* keyphrase,
+                              const void** valuePointer,
+                              int nItems,
+                              const char*  datatype,
+                              const char*  iotype ) {
+
+    *valuePointer = NULL;
+
+    // not an error worth reporting, callers fall back to readDataBlock
+    // for compressed files opened in "mapped" mode
+    if ( mappedData_ == NULL ) {
+        return CVSOLVER_IO_ERROR;
+    }
+
+    if ( ! cscompare( LastHeaderKey_, keyphrase ) ) {
+        fprintf(stderr,"ERROR: header not consistant with data block\n");
+        fprintf(stderr,"Header: %s\n", LastHeaderKey_);
+        fprintf(stderr,"DataBlock: %s\n", keyphrase);
+        fprintf(stderr,"Please recheck read sequence\n");
+        return CVSOLVER_IO_ERROR;
+    }
+
+    size_t type_size = typeSize( datatype );
+
+    if (type_size == 0) {
+        fprintf(stderr,"ERROR: Requested data type invalid!! \n");
+        fprintf(stderr,"Header: %s\n", LastHeaderKey_);
+        fprintf(stderr,"DataBlock: %s\n", keyphrase);
+        fprintf(stderr,"Please recheck read sequence\n");
+        return CVSOLVER_IO_ERROR;
+    }
+
+    isBinary( iotype );
+
+    if ( ! binary_format_ ) {
+        fprintf(stderr,"ERROR: only binary data blocks can be mapped\n");
+        return CVSOLVER_IO_ERROR;
+    }
+
+    z_off_t offset = gztell(filePointer_);
+    size_t nbytes = type_size*nItems;
+    if ( (size_t)offset + nbytes > mappedSize_ ) {
+        fprintf(stderr,"ERROR: data block extends past end of file\n");
+        fprintf(stderr,"DataBlock: %s\n", keyphrase);
+        return CVSOLVER_IO_ERROR;
+    }
+
+    // the private mapping makes the swap copy only the touched pages,
+    // and it is done once per block however often the block is mapped
+    if ( Wrong_Endian_ &&
+         std::find( swappedBlocks_.begin(), swappedBlocks_.end(), offset ) == swappedBlocks_.end() ) {
+        SwapArrayByteOrder( mappedData_+offset, type_size, nItems );
+        swappedBlocks_.push_back( offset );
+    }
+
+    *valuePointer = mappedData_+offset;
+    gzseek(filePointer_,offset+nbytes+sizeof(char),SEEK_SET); /* skip the new line */
+
+    return CVSOLVER_IO_OK;
+}
+
 int cvsolverIO::readString(char* line) {
   while (gzgets(filePointer_, line, 1024) != Z_NULL) {
         return CVSOLVER_IO_OK;
@@ -550,12 +620,336 @@ size_t cvsolverIO::typeSize( const char* typestring ) {
         }
 }
 
-void cvsolverIO::SwapArrayByteOrder( void* array, int nbytes, int nItems ) {
-        /* This swaps the byte order for the array of nItems each
-           of size nbytes , This will be called only locally  */
-        int i,j;
+//
+//  Memory mapping
+//
+
+int cvsolverIO::mapFile() {
+
+#ifdef _WIN32
+    return CVSOLVER_IO_ERROR;
+#else
+    unmapFile();
+
+    int fd = open( fname_, O_RDONLY );
+    if ( fd < 0 ) {
+        return CVSOLVER_IO_ERROR;
+    }
+
+    struct stat info;
+    unsigned char magic[2] = {0, 0};
+    if ( fstat( fd, &info ) != 0 || info.st_size < 2 ||
+         read( fd, magic, 2 ) != 2 ) {
+        close( fd );
+        return CVSOLVER_IO_ERROR;
+    }
+
+    // gzip compressed, offsets in the index are not file offsets
+    if ( magic[0] == 0x1f && magic[1] == 0x8b ) {
+        close( fd );
+        return CVSOLVER_IO_ERROR;
+    }
+
+    void* data = mmap( NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if ( data == MAP_FAILED ) {
+        return CVSOLVER_IO_ERROR;
+    }
+
+    mappedData_ = static_cast<char*>( data );
+    mappedSize_ = info.st_size;
+    swappedBlocks_.clear();
+
+    return CVSOLVER_IO_OK;
+#endif
+}
+
+void cvsolverIO::unmapFile() {
+#ifndef _WIN32
+    if ( mappedData_ != NULL ) {
+        munmap( mappedData_, mappedSize_ );
+    }
+#endif
+    mappedData_ = NULL;
+    mappedSize_ = 0;
+    swappedBlocks_.clear();
+}
+
+//
+//  Header index
+//
+
+void cvsolverIO::setUseHeaderIndexFile( bool flag ) {
+    useHeaderIndexFile_ = flag;
+}
+
+std::string cvsolverIO::normalizeKey( const char* key ) {
+    // same equivalence as cscompare: case and blanks are ignored
+    // and a '?' ends the significant part of the key
+    std::string normalized;
+    for ( ; *key && *key != '?' && *key != '\n'; key++ ) {
+        if ( *key == ' ' ) continue;
+        normalized += (char)tolower( *key );
+    }
+    return normalized;
+}
+
+void cvsolverIO::addToHeaderIndexMap( int index ) {
+    // cscompare matches a keyphrase against every header key it is a
+    // prefix of, so the entry is listed under each prefix of its key
+    std::string key = normalizeKey( headerIndex_[index].key.c_str() );
+    for ( size_t n = 0; n <= key.size(); n++ ) {
+        headerIndexMap_[key.substr( 0, n )].push_back( index );
+    }
+}
+
+int cvsolverIO::findHeader( const char* keyphrase ) {
+
+    std::unordered_map< std::string, std::vector<int> >::iterator it =
+        headerIndexMap_.find( normalizeKey( keyphrase ) );
+    if ( it == headerIndexMap_.end() ) {
+        return -1;
+    }
+
+    // like the old linear scan, take the first match after the last
+    // header found and wrap around once, so duplicate keys are read in
+    // order and exact and prefix matches compete by file position
+    std::vector<int>& matches = it->second;
+    std::vector<int>::iterator next =
+        std::upper_bound( matches.begin(), matches.end(), lastHeaderIndex_ );
+    return ( next != matches.end() ) ? *next : matches[0];
+}
+
+int cvsolverIO::buildHeaderIndex() {
+
+    int skip_size,integer_value;
+    bool leadingComments = true;
+
+    if (filePointer_ == Z_NULL) {
+        fprintf(stderr,"No file associated with Descriptor \n");
+        fprintf(stderr,"openfile_ function has to be called before \n");
+        fprintf(stderr,"acessing the file\n");
+        return CVSOLVER_IO_ERROR;
+    }
+
+    headerIndex_.clear();
+    headerIndexMap_.clear();
+    commentHeaders_.clear();
+    lastHeaderIndex_ = -1;
+
+    gzrewind(filePointer_);
+    gzclearerr(filePointer_);
+
+    while (gzgets(filePointer_, Line_, 1024) != Z_NULL) {
+
+        // ignore comment lines
+        if (Line_[0] == '#') {
+            if ( leadingComments ) commentHeaders_.push_back( Line_ );
+            continue;
+        }
+        leadingComments = false;
+
+        // ignore blank lines
+        if (strlen(Line_) <= 1) {
+            continue;
+        }
+
+        char* token = strtok ( Line_, ":" );
+        if ( token == NULL ) {
+            continue;
+        }
+
+        HeaderIndexEntry entry;
+        entry.key = token;
+        entry.skipSize = 0;
+        token = strtok( NULL, " ,;<>" );
+        if ( token != NULL ) {
+            entry.skipSize = atoi( token );
+            while ( ( token = strtok( NULL, " ,;<>\n" ) ) ) {
+                entry.values.push_back( atoi( token ) );
+            }
+        }
+        entry.offset = gztell(filePointer_);
+
+        headerIndex_.push_back( entry );
+        addToHeaderIndexMap( headerIndex_.size() - 1 );
+
+        // this really belongs when you open the file!
+        if ( cscompare(entry.key.c_str(),"byteorder magic number") ) {
+            if ( binary_format_ ) {
+                gzread(filePointer_,&integer_value,sizeof(int));
+                char junk;
+                gzread(filePointer_,&junk,sizeof(char)); /* reading the new line */
+            } else {
+                gzgets(filePointer_,Line_,1024);
+                sscanf(Line_,"%i",&integer_value);
+            }
+            if ( FLOWSOLVER_MAGIC_NUMBER != integer_value ) {
+                Wrong_Endian_ = true;
+            }
+            continue;
+        }
+
+        // skip to next header
+        skip_size = entry.skipSize;
+        if ( binary_format_ ) {
+            gzseek(filePointer_,skip_size,SEEK_CUR);
+        } else {
+            for( int gama=0; gama < skip_size; gama++ ) {
+                gzgets(filePointer_,Line_,1024);
+            }
+        }
+
+    }
+
+    gzrewind(filePointer_);
+    gzclearerr(filePointer_);
+
+    headerIndexBuilt_ = true;
+    headerIndexBinary_ = binary_format_;
+
+    if ( useHeaderIndexFile_ ) {
+        std::string indexfile = std::string(fname_) + ".hdridx";
+        saveHeaderIndex( indexfile.c_str() );
+    }
+
+    return CVSOLVER_IO_OK;
+}
+
+int cvsolverIO::saveHeaderIndex( const char* indexfile ) {
+
+    struct stat info;
+    if ( !headerIndexBuilt_ || stat( fname_, &info ) != 0 ) {
+        return CVSOLVER_IO_ERROR;
+    }
+
+    FILE* fp = fopen( indexfile, "w" );
+    if ( fp == NULL ) {
+        return CVSOLVER_IO_ERROR;
+    }
+
+    // the size and modification time of the data file are stored
+    // so a stale index is detected and rebuilt
+    fprintf(fp,"# cvsolverIO header index\n");
+    fprintf(fp,"file %ld %ld\n",(long)info.st_size,(long)info.st_mtime);
+    fprintf(fp,"binary %i\n",headerIndexBinary_ ? 1 : 0);
+    fprintf(fp,"wrongendian %i\n",Wrong_Endian_ ? 1 : 0);
+    fprintf(fp,"comments %i\n",(int)commentHeaders_.size());
+    for ( int i = 0; i < (int)commentHeaders_.size(); i++ ) {
+        fprintf(fp,"%s",commentHeaders_[i].c_str());
+        if ( commentHeaders_[i].empty() ||
+             commentHeaders_[i][commentHeaders_[i].size()-1] != '\n' ) {
+            fprintf(fp,"\n");
+        }
+    }
+    fprintf(fp,"headers %i\n",(int)headerIndex_.size());
+    for ( int i = 0; i < (int)headerIndex_.size(); i++ ) {
+        HeaderIndexEntry& entry = headerIndex_[i];
+        fprintf(fp,"%ld %i %i",(long)entry.offset,entry.skipSize,(int)entry.values.size());
+        for ( int j = 0; j < (int)entry.values.size(); j++ ) {
+            fprintf(fp," %i",entry.values[j]);
+        }
+        fprintf(fp," %s\n",entry.key.c_str());
+    }
+
+    fclose(fp);
+    return CVSOLVER_IO_OK;
+}
+
+int cvsolverIO::loadHeaderIndex( const char* indexfile ) {
+
+    struct stat info;
+    if ( stat( fname_, &info ) != 0 ) {
+        return CVSOLVER_IO_ERROR;
+    }
+
+    FILE* fp = fopen( indexfile, "r" );
+    if ( fp == NULL ) {
+        return CVSOLVER_IO_ERROR;
+    }
+
+    char line[1024];
+    long fsize, fmtime;
+    int binary, wrongendian, numComments, numHeaders;
+
+    if ( fgets( line, 1024, fp ) == NULL ||
+         fscanf( fp, "file %ld %ld\n", &fsize, &fmtime ) != 2 ||
+         fsize != (long)info.st_size || fmtime != (long)info.st_mtime ||
+         fscanf( fp, "binary %i\n", &binary ) != 1 ||
+         fscanf( fp, "wrongendian %i\n", &wrongendian ) != 1 ||
+         fscanf( fp, "comments %i\n", &numComments ) != 1 ) {
+        fclose(fp);
+        return CVSOLVER_IO_ERROR;
+    }
+
+    std::vector< std::string > comments;
+    for ( int i = 0; i < numComments; i++ ) {
+        if ( fgets( line, 1024, fp ) == NULL ) {
+            fclose(fp);
+            return CVSOLVER_IO_ERROR;
+        }
+        comments.push_back( line );
+    }
+
+    if ( fscanf( fp, "headers %i\n", &numHeaders ) != 1 ) {
+        fclose(fp);
+        return CVSOLVER_IO_ERROR;
+    }
+
+    std::vector<HeaderIndexEntry> entries( numHeaders );
+    for ( int i = 0; i < numHeaders; i++ ) {
+        HeaderIndexEntry& entry = entries[i];
+        long offset;
+        int numValues;
+        if ( fscanf( fp, "%ld %i %i", &offset, &entry.skipSize, &numValues ) != 3 ) {
+            fclose(fp);
+            return CVSOLVER_IO_ERROR;
+        }
+        entry.offset = offset;
+        entry.values.resize( numValues );
+        for ( int j = 0; j < numValues; j++ ) {
+            if ( fscanf( fp, "%i", &entry.values[j] ) != 1 ) {
+                fclose(fp);
+                return CVSOLVER_IO_ERROR;
+            }
+        }
+        if ( fgets( line, 1024, fp ) == NULL ) {
+            fclose(fp);
+            return CVSOLVER_IO_ERROR;
+        }
+        line[strcspn( line, "\n" )] = '\0';
+        entry.key = ( line[0] == ' ' ) ? line + 1 : line;
+    }
+
+    fclose(fp);
+
+    headerIndex_.swap( entries );
+    commentHeaders_.swap( comments );
+    headerIndexMap_.clear();
+    for ( int i = 0; i < (int)headerIndex_.size(); i++ ) {
+        addToHeaderIndexMap( i );
+    }
+    headerIndexBinary_ = ( binary != 0 );
+    Wrong_Endian_ = ( wrongendian != 0 );
+    lastHeaderIndex_ = -1;
+    headerIndexBuilt_ = true;
+
+    return CVSOLVER_IO_OK;
+}
+
+int cvsolverIO::getCommentHeaders( std::vector< std::string >& headers ) {
+
+    if ( !headerIndexBuilt_ ) {
+        return CVSOLVER_IO_ERROR;
+    }
+    headers.insert( headers.end(), commentHeaders_.begin(), commentHeaders_.end() );
+    return CVSOLVER_IO_OK;
+}
+
+static void SwapArrayByteOrderRange( unsigned char* ucDst, int nbytes, size_t nItems ) {
+        size_t i;
+        int j;
         unsigned char ucTmp;
-        unsigned char* ucDst = (unsigned char*)array;
 
         for(i=0; i < nItems; i++) {
             for(j=0; j < (nbytes/2); j++)
@@ -564,6 +958,48 @@ void cvsolverIO::SwapArrayByteOrder( void* array, int nbytes, int nItems ) {
         }
 }
 
+void cvsolverIO::SwapArrayByteOrder( void* array, int nbytes, int nItems ) {
+        /* This swaps the byte order for the array of nItems each
+           of size nbytes , This will be called only locally  */
+        unsigned char* ucDst = (unsigned char*)array;
+
+        if ( nItems <= 0 || nbytes < 2 ) {
+            return;
+        }
+
+        // only split large blocks (solution arrays), thread startup
+        // costs more than swapping a few header sized blocks
+        size_t minItemsPerThread = std::max( ( 1 << 20 ) / nbytes, 1 );
+        size_t numThreads = std::thread::hardware_concurrency();
+        numThreads = std::min( numThreads, (size_t)nItems / minItemsPerThread );
+
+        if ( numThreads < 2 ) {
+            SwapArrayByteOrderRange( ucDst, nbytes, nItems );
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        size_t chunk = ( nItems + numThreads - 1 ) / numThreads;
+        size_t start = 0;
+        try {
+            threads.reserve( numThreads );
+            for ( ; start < (size_t)nItems; start += chunk ) {
+                size_t count = std::min( chunk, (size_t)nItems - start );
+                threads.push_back( std::thread( SwapArrayByteOrderRange,
+                                                ucDst + start*nbytes, nbytes, count ) );
+            }
+        } catch ( std::exception& ) {
+            // no exception may leave through the Fortran interface, so
+            // whatever could not be handed to a thread is swapped here
+        }
+        if ( start < (size_t)nItems ) {
+            SwapArrayByteOrderRange( ucDst + start*nbytes, nbytes, nItems - start );
+        }
+        for ( size_t i = 0; i < threads.size(); i++ ) {
+            threads[i].join();
+        }
+}
+
 int openfile_( const char* filename,
                 const char* mode,
                 int*  fileDescriptor ) {
@@ -665,11 +1101,32 @@ void writestring_( int* fileDescriptor,
     cvsolverIOfp[(*fileDescriptor)]->writeString(string);
 }
 
+void mapdatablock_( int*  fileDescriptor,
+                    const char* keyphrase,
+                    const void** valuePointer,
+                    int*  nItems,
+                    const char*  datatype,
+                    const char*  iotype ) {
+    int num = *nItems;
+    cvsolverIOfp[(*fileDescriptor)]->mapDataBlock(keyphrase,
+                       valuePointer,num,datatype,iotype );
+    return;
+}
+
+void useheaderindexfile_( int* flag ) {
+    cvsolverIO::setUseHeaderIndexFile( (*flag) != 0 );
+}
+
 #include <vector>
 #include <string>
 #include <iostream>
 void Gather_Headers( int* fileDescriptor, std::vector< std::string >& headers ) {
 
+    // leading comments are recorded when the header index is built
+    if ( cvsolverIOfp[(*fileDescriptor)]->getCommentHeaders(headers) == CVSOLVER_IO_OK ) {
+        return;
+    }
+
     char Line[1024];
     cvsolverIOfp[(*fileDescriptor)]->rewindFile();
      while ( cvsolverIOfp[(*fileDescriptor)]->readString(Line) == CVSOLVER_IO_OK) {
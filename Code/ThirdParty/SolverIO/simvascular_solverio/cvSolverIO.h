@@ -66,6 +66,8 @@
    #define gzwrite(p1,p2,p3) fwrite((p2),(p3),1,(p1))
    #define gzseek fseek
    #define gzgets(p1,p2,p3) fgets((p2),(p3),(p1))
+   #define gztell ftell
+   #define z_off_t long
    #define Z_NULL NULL
 #endif
 
@@ -78,11 +80,17 @@
 #define writeheader_ WRITEHEADER
 #define writedatablock_ WRITEDATABLOCK
 #define writestring_ WRITESTRING
+#define useheaderindexfile_ USEHEADERINDEXFILE
+#define mapdatablock_ MAPDATABLOCK
 
 #endif
 
 #ifdef __cplusplus
 
+#include <string>
+#include <vector>
+#include <unordered_map>
+
 class cvsolverIO {
 
 public:
@@ -107,6 +115,12 @@ public:
                        const char*  datatype,
                        const char*  iotype );
     int readString(char* line);
+    int mapDataBlock (const char* keyphrase,
+                      const void** valuePointer,
+                      int  nItems,
+                      const char*  datatype,
+                      const char*  iotype );
+    bool isMapped () { return mappedData_ != NULL; }
 
     // write info
     int writeHeader (const char* keyphrase,
@@ -131,8 +145,48 @@ public:
     size_t typeSize ( const char* typestring );
     void SwapArrayByteOrder ( void* array, int nbytes, int nItems );
 
+    // memory mapping of uncompressed binary files
+    int mapFile ();
+    void unmapFile ();
+
+    // header index
+    int buildHeaderIndex ();
+    int loadHeaderIndex ( const char* indexfile );
+    int saveHeaderIndex ( const char* indexfile );
+    int getCommentHeaders ( std::vector< std::string >& headers );
+    static void setUseHeaderIndexFile ( bool flag );
+
 private:
 
+    // one entry per "key : < skip > v1 v2 ..." header line, in file order
+    struct HeaderIndexEntry {
+        std::string key;
+        z_off_t offset;
+        int skipSize;
+        std::vector<int> values;
+    };
+
+    std::string normalizeKey ( const char* key );
+    void addToHeaderIndexMap ( int index );
+    int findHeader ( const char* keyphrase );
+
+    std::vector<HeaderIndexEntry> headerIndex_;
+    // header indices in file order, keyed by each prefix of the
+    // normalized key
+    std::unordered_map< std::string, std::vector<int> > headerIndexMap_;
+    std::vector< std::string > commentHeaders_;
+    bool headerIndexBuilt_;
+    bool headerIndexBinary_;
+    int lastHeaderIndex_;
+
+    static bool useHeaderIndexFile_;
+
+    // whole file mapped copy-on-write, so wrong endian blocks can be
+    // swapped in place; swappedBlocks_ holds the offsets already swapped
+    char* mappedData_;
+    size_t mappedSize_;
+    std::vector<z_off_t> swappedBlocks_;
+
     gzFile filePointer_;
 
     bool byte_order_;
@@ -200,6 +254,17 @@ void
 writestring_( int* fileDescriptor,
               const char* string );
 
+void
+useheaderindexfile_( int* flag );
+
+void
+mapdatablock_( int*  fileDescriptor,
+               const char* keyphrase,
+               const void** valuePointer,
+               int*  nItems,
+               const char*  datatype,
+               const char*  iotype );
+
 #ifdef __cplusplus
 }
 #endif
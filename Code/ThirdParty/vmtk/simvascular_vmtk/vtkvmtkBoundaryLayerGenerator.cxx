@@ -36,6 +36,51 @@ Version:   $Revision: 1.7 $
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Point neighborhoods of the input surface in the order the smoothing
+// visits them, and its connected components. The surface topology does
+// not change while the layer is warped, so this is gathered once instead
+// of at every substep.
+class vtkvmtkBoundaryLayerGeneratorTopology
+{
+public:
+  std::vector<vtkIdType> NeighborOffsets;
+  std::vector<vtkIdType> Neighbors;
+  std::vector<char> OnEdge;
+  std::vector<vtkIdType> ComponentOffsets;
+  std::vector<vtkIdType> ComponentPoints;
+};
+
+// Calls body(begin,end) over contiguous chunks of [0,n), one per thread.
+// Small ranges run on the calling thread.
+template <class Body>
+static void vtkvmtkBoundaryLayerGeneratorParallelFor(vtkIdType n, vtkIdType grain, const Body& body)
+{
+  vtkIdType numberOfThreads = std::max(1,(int)std::thread::hardware_concurrency());
+  numberOfThreads = std::min(numberOfThreads,std::max((vtkIdType)1,n/grain));
+  if (numberOfThreads <= 1)
+    {
+    body(0,n);
+    return;
+    }
+  std::vector<std::thread> threads;
+  for (vtkIdType t=1; t<numberOfThreads; t++)
+    {
+    threads.push_back(std::thread(body,(t*n)/numberOfThreads,((t+1)*n)/numberOfThreads));
+    }
+  body(0,n/numberOfThreads);
+  for (size_t t=0; t<threads.size(); t++)
+    {
+    threads[t].join();
+    }
+}
+
+static const vtkIdType VTK_VMTK_BOUNDARY_LAYER_GRAIN = 4096;
+
 
 vtkStandardNewMacro(vtkvmtkBoundaryLayerGenerator);
 
@@ -71,6 +116,8 @@ vtkvmtkBoundaryLayerGenerator::vtkvmtkBoundaryLayerGenerator()
   this->VolumeCellEntityId = 0;
 
   this->InnerSurface = NULL;
+
+  this->Topology = NULL;
 }
 
 vtkvmtkBoundaryLayerGenerator::~vtkvmtkBoundaryLayerGenerator()
@@ -103,6 +150,9 @@ vtkvmtkBoundaryLayerGenerator::~vtkvmtkBoundaryLayerGenerator()
     delete[] this->SurfaceCellIdsArrayName;
     this->SurfaceCellIdsArrayName = NULL;
     }
+
+  delete this->Topology;
+  this->Topology = NULL;
 }
 
 int vtkvmtkBoundaryLayerGenerator::RequestData(
@@ -208,6 +258,21 @@ int vtkvmtkBoundaryLayerGenerator::RequestData(
   vtkIdType numberOfOutputPoints = numberOfInputPoints + numberOfLayerPoints * this->NumberOfSubLayers;
   outputPoints->SetNumberOfPoints(numberOfOutputPoints);
 
+  // one volume cell per input cell and sublayer, plus the inner and outer
+  // surfaces; only sidewall cells are left to grow the arrays
+  vtkIdType numberOfOutputCells = numberOfInputCells * this->NumberOfSubLayers;
+  if (this->IncludeSurfaceCells)
+    {
+    numberOfOutputCells += 2 * numberOfInputCells;
+    }
+  boundaryLayerCellArray->Allocate(boundaryLayerCellArray->EstimateSize(numberOfOutputCells,warpQuadratic ? 15 : 8));
+  boundaryLayerCellTypes->Allocate(numberOfOutputCells);
+  cellEntityIdsArray->Allocate(numberOfOutputCells);
+  if (outputSurfaceCellIdsArray != NULL)
+    {
+    outputSurfaceCellIdsArray->Allocate(numberOfOutputCells);
+    }
+
   double point[3];
   for (i=0; i<numberOfInputPoints; i++)
     {
@@ -270,6 +335,7 @@ int vtkvmtkBoundaryLayerGenerator::RequestData(
   int finalNumberOfSubsteps = this->NumberOfSubsteps - initialNumberOfSubsteps - intermediateNumberOfSubsteps;
 
   this->BuildWarpVectors(input);
+  this->BuildTopology(input);
   this->IncrementalWarpVectors(input,initialNumberOfSubsteps,relaxation);
 
   int iteration = 0;
@@ -549,17 +615,22 @@ int vtkvmtkBoundaryLayerGenerator::RequestData(
   innerSurfaceCellEntityIdsArray->Delete();
   checkArray->Delete();
 
+  delete this->Topology;
+  this->Topology = NULL;
+
   return 1;
 }
 
 void vtkvmtkBoundaryLayerGenerator::BuildWarpVectors(vtkUnstructuredGrid* input)
 {
-  double warpVector[3];
-  double layerThickness;
-
   vtkIdType numberOfInputPoints = input->GetNumberOfPoints();
 
-  for (vtkIdType i=0; i<numberOfInputPoints; i++)
+  vtkvmtkBoundaryLayerGeneratorParallelFor(numberOfInputPoints,VTK_VMTK_BOUNDARY_LAYER_GRAIN,
+    [&](vtkIdType begin, vtkIdType end)
+  {
+  double warpVector[3];
+  double layerThickness;
+  for (vtkIdType i=begin; i<end; i++)
     {
     this->WarpVectorsArray->GetTuple(i,warpVector);
     if (this->NegateWarpVectors)
@@ -593,6 +664,139 @@ void vtkvmtkBoundaryLayerGenerator::BuildWarpVectors(vtkUnstructuredGrid* input)
 
     this->WarpVectorsArray->SetTuple(i,warpVector);
     }
+  });
+}
+
+void vtkvmtkBoundaryLayerGenerator::BuildTopology(vtkUnstructuredGrid* input)
+{
+  delete this->Topology;
+  this->Topology = new vtkvmtkBoundaryLayerGeneratorTopology;
+
+  std::vector<vtkIdType>& neighborOffsets = this->Topology->NeighborOffsets;
+  std::vector<vtkIdType>& neighbors = this->Topology->Neighbors;
+  std::vector<char>& onEdge = this->Topology->OnEdge;
+
+  vtkIdType numberOfInputPoints = input->GetNumberOfPoints();
+
+  neighborOffsets.resize(numberOfInputPoints+1);
+  onEdge.assign(numberOfInputPoints,0);
+  neighborOffsets[0] = 0;
+
+  vtkIdType npts, *pts;
+  vtkIdList* cellIds = vtkIdList::New();
+  vtkIdList* neighborIds = vtkIdList::New();
+  vtkIdList* edgePointIds = vtkIdList::New();
+  vtkIdList* edgeNeighborCellIds = vtkIdList::New();
+
+  // same id list operations as the smoothing used to do at every substep,
+  // so neighbors come out in the same order and sum to the same barycenter
+  for (vtkIdType j=0; j<numberOfInputPoints; j++)
+    {
+    input->GetPointCells(j,cellIds);
+
+    neighborIds->Initialize();
+
+    vtkIdType numberOfNeighborCells = cellIds->GetNumberOfIds();
+    for (int k=0; k<numberOfNeighborCells; k++)
+      {
+      input->GetCellPoints(cellIds->GetId(k),npts,pts);
+
+      neighborIds->InsertUniqueId(pts[0]);
+      neighborIds->InsertUniqueId(pts[1]);
+      neighborIds->InsertUniqueId(pts[2]);
+      }
+    neighborIds->DeleteId(j);
+
+    int numberOfNeighbors = neighborIds->GetNumberOfIds();
+
+    edgePointIds->Initialize();
+    edgeNeighborCellIds->Initialize();
+    edgePointIds->InsertId(0,j);
+    for (int k=0; k<numberOfNeighbors; k++)
+      {
+      edgePointIds->InsertId(1,neighborIds->GetId(k));
+      input->GetCellNeighbors(-1,edgePointIds,edgeNeighborCellIds);
+      if (edgeNeighborCellIds->GetNumberOfIds() < 2)
+        {
+        onEdge[j] = 1;
+        break;
+        }
+      }
+
+    for (int k=0; k<numberOfNeighbors; k++)
+      {
+      neighbors.push_back(neighborIds->GetId(k));
+      }
+    neighborOffsets[j+1] = neighbors.size();
+    }
+
+  cellIds->Delete();
+  neighborIds->Delete();
+  edgePointIds->Delete();
+  edgeNeighborCellIds->Delete();
+
+  // Connected components of the surface. The smoothing is Gauss-Seidel in
+  // point id order, and points only ever read their neighbors, so
+  // components can be smoothed independently as long as each one keeps
+  // ascending point order.
+  std::vector<vtkIdType> parent(numberOfInputPoints);
+  for (vtkIdType j=0; j<numberOfInputPoints; j++)
+    {
+    parent[j] = j;
+    }
+  for (vtkIdType j=0; j<numberOfInputPoints; j++)
+    {
+    for (vtkIdType k=neighborOffsets[j]; k<neighborOffsets[j+1]; k++)
+      {
+      vtkIdType a = j;
+      vtkIdType b = neighbors[k];
+      while (parent[a] != a)
+        {
+        a = parent[a] = parent[parent[a]];
+        }
+      while (parent[b] != b)
+        {
+        b = parent[b] = parent[parent[b]];
+        }
+      if (a != b)
+        {
+        parent[std::max(a,b)] = std::min(a,b);
+        }
+      }
+    }
+
+  std::vector<vtkIdType> componentIds(numberOfInputPoints);
+  std::vector<vtkIdType>& componentOffsets = this->Topology->ComponentOffsets;
+  std::vector<vtkIdType>& componentPoints = this->Topology->ComponentPoints;
+  componentOffsets.assign(1,0);
+  for (vtkIdType j=0; j<numberOfInputPoints; j++)
+    {
+    vtkIdType root = j;
+    while (parent[root] != root)
+      {
+      root = parent[root];
+      }
+    if (root == j)
+      {
+      componentIds[j] = componentOffsets.size()-1;
+      componentOffsets.push_back(0);
+      }
+    else
+      {
+      componentIds[j] = componentIds[root];
+      }
+    componentOffsets[componentIds[j]+1]++;
+    }
+  for (size_t c=1; c<componentOffsets.size(); c++)
+    {
+    componentOffsets[c] += componentOffsets[c-1];
+    }
+  componentPoints.resize(numberOfInputPoints);
+  std::vector<vtkIdType> fill(componentOffsets.begin(),componentOffsets.end()-1);
+  for (vtkIdType j=0; j<numberOfInputPoints; j++)
+    {
+    componentPoints[fill[componentIds[j]]++] = j;
+    }
 }
 
 void vtkvmtkBoundaryLayerGenerator::IncrementalWarpVectors(vtkUnstructuredGrid* input, int numberOfSubsteps, double relaxation)
@@ -610,8 +814,11 @@ void vtkvmtkBoundaryLayerGenerator::IncrementalWarpVectors(vtkUnstructuredGrid*
     basePoints->DeepCopy(warpedPoints);
     }
 
+  vtkvmtkBoundaryLayerGeneratorParallelFor(numberOfInputPoints,VTK_VMTK_BOUNDARY_LAYER_GRAIN,
+    [&](vtkIdType begin, vtkIdType end)
+  {
   double warpVector[3], basePoint[3], warpedPoint[3];
-  for (vtkIdType j=0; j<numberOfInputPoints; j++)
+  for (vtkIdType j=begin; j<end; j++)
     {
     inputPoints->GetPoint(j,basePoint);
     warpedPoints->GetPoint(j,warpedPoint);
@@ -626,6 +833,7 @@ void vtkvmtkBoundaryLayerGenerator::IncrementalWarpVectors(vtkUnstructuredGrid*
     warpVector[2] = warpVector[2] * layerThickness;
     this->WarpVectorsArray->SetTuple(j,warpVector);
     }
+  });
 
   warpedPoints->Delete();
   basePoints->Delete();
@@ -633,26 +841,30 @@ void vtkvmtkBoundaryLayerGenerator::IncrementalWarpVectors(vtkUnstructuredGrid*
 
 int vtkvmtkBoundaryLayerGenerator::CheckTangle(vtkUnstructuredGrid* input, vtkUnsignedCharArray* checkArray)
 {
-  vtkIdList* pointList=vtkIdList::New();
+  std::atomic<vtkIdType> found(0);
+
+  vtkvmtkBoundaryLayerGeneratorParallelFor(input->GetNumberOfCells(),VTK_VMTK_BOUNDARY_LAYER_GRAIN,
+    [&](vtkIdType begin, vtkIdType end)
+  {
+  vtkIdType npts, *pts;
 
   double warpVector1[3], warpVector2[3],  warpVector3[3];
   double basePoint1[3], basePoint2[3], basePoint3[3];
   double warpedPoint1[3], warpedPoint2[3], warpedPoint3[3];
   double baseNormal[3], warpedNormal[3];
 
-  int found = 0;
-  int check = 0;
-  for (vtkIdType j=0; j<input->GetNumberOfCells(); j++)
+  vtkIdType chunkFound = 0;
+  for (vtkIdType j=begin; j<end; j++)
     {
-    input->GetCellPoints(j,pointList);
+    input->GetCellPoints(j,npts,pts);
     //points on base triangle
-    input->GetPoint(pointList->GetId(0),basePoint1);
-    input->GetPoint(pointList->GetId(1),basePoint2);
-    input->GetPoint(pointList->GetId(2),basePoint3);
+    input->GetPoint(pts[0],basePoint1);
+    input->GetPoint(pts[1],basePoint2);
+    input->GetPoint(pts[2],basePoint3);
 
-    this->WarpVectorsArray->GetTuple(pointList->GetId(0),warpVector1);
-    this->WarpVectorsArray->GetTuple(pointList->GetId(1),warpVector2);
-    this->WarpVectorsArray->GetTuple(pointList->GetId(2),warpVector3);
+    this->WarpVectorsArray->GetTuple(pts[0],warpVector1);
+    this->WarpVectorsArray->GetTuple(pts[1],warpVector2);
+    this->WarpVectorsArray->GetTuple(pts[2],warpVector3);
 
     //points on extruded triangle
     warpedPoint1[0] = basePoint1[0] + warpVector1[0];
@@ -674,8 +886,7 @@ int vtkvmtkBoundaryLayerGenerator::CheckTangle(vtkUnstructuredGrid* input, vtkUn
     double testArea = warpedArea / baseArea;
     if (prod < 0 || testArea <= 0.1 )
       {
-      check = 1;
-      found = found + 1;
+      chunkFound = chunkFound + 1;
       checkArray->SetValue(j,1);
       }
     else
@@ -683,10 +894,11 @@ int vtkvmtkBoundaryLayerGenerator::CheckTangle(vtkUnstructuredGrid* input, vtkUn
       checkArray->SetValue(j,0);
       }
     }
+  found += chunkFound;
+  });
   //std::cout << found <<" tangle triangles found"<<std::endl;
 
-  pointList->Delete();
-  return check;
+  return found > 0 ? 1 : 0;
 }
 
 void vtkvmtkBoundaryLayerGenerator::LocalUntangle(vtkUnstructuredGrid* input, vtkUnsignedCharArray* checkArray, double alpha)
@@ -807,9 +1019,8 @@ void vtkvmtkBoundaryLayerGenerator::LocalUntangle(vtkUnstructuredGrid* input, vt
 
 void vtkvmtkBoundaryLayerGenerator::WarpPoints(vtkPoints* inputPoints, vtkPoints* warpedPoints, int subLayerId, bool quadratic)
 {
-  double point[3], warpedPoint[3], warpVector[3];
-  double layerThickness, subLayerThicknessRatio, subLayerThickness;
-  double totalLayerZeroSubLayerRatio, subLayerOffsetRatio, subLayerOffset;
+  double subLayerThicknessRatio;
+  double totalLayerZeroSubLayerRatio, subLayerOffsetRatio;
 
   vtkIdType numberOfInputPoints = inputPoints->GetNumberOfPoints();
 
@@ -838,7 +1049,12 @@ void vtkvmtkBoundaryLayerGenerator::WarpPoints(vtkPoints* inputPoints, vtkPoints
     warpedPoints->SetNumberOfPoints(2*numberOfInputPoints);
     }
 
-  for (i=0; i<numberOfInputPoints; i++)
+  vtkvmtkBoundaryLayerGeneratorParallelFor(numberOfInputPoints,VTK_VMTK_BOUNDARY_LAYER_GRAIN,
+    [&](vtkIdType begin, vtkIdType end)
+  {
+  double point[3], warpedPoint[3], warpVector[3];
+  double layerThickness, subLayerOffset, subLayerThickness;
+  for (vtkIdType i=begin; i<end; i++)
     {
     inputPoints->GetPoint(i,point);
     this->WarpVectorsArray->GetTuple(i,warpVector);
@@ -869,18 +1085,21 @@ void vtkvmtkBoundaryLayerGenerator::WarpPoints(vtkPoints* inputPoints, vtkPoints
       warpedPoints->SetPoint(i,warpedPoint);
       }
     }
+  });
 }
 
-void vtkvmtkBoundaryLayerGenerator::IncrementalWarpPoints(vtkUnstructuredGrid* input, vtkPoints* basePoints, vtkPoints* warpedPoints, int substep, int numberOfSubsteps, double relaxation)
+void vtkvmtkBoundaryLayerGenerator::IncrementalWarpPoints(vtkUnstructuredGrid* vtkNotUsed(input), vtkPoints* basePoints, vtkPoints* warpedPoints, int substep, int numberOfSubsteps, double relaxation)
 {
-  double point[3], warpedPoint[3], warpVector[3];
-  double layerThickness;
-
   vtkIdType numberOfInputPoints = basePoints->GetNumberOfPoints();
 
   warpedPoints->SetNumberOfPoints(numberOfInputPoints);
 
-  for (vtkIdType i=0; i<numberOfInputPoints; i++)
+  vtkvmtkBoundaryLayerGeneratorParallelFor(numberOfInputPoints,VTK_VMTK_BOUNDARY_LAYER_GRAIN,
+    [&](vtkIdType begin, vtkIdType end)
+  {
+  double point[3], warpedPoint[3], warpVector[3];
+  double layerThickness;
+  for (vtkIdType i=begin; i<end; i++)
     {
     basePoints->GetPoint(i,point);
     this->WarpVectorsArray->GetTuple(i,warpVector);
@@ -895,84 +1114,61 @@ void vtkvmtkBoundaryLayerGenerator::IncrementalWarpPoints(vtkUnstructuredGrid* i
     warpedPoint[2] = point[2] + warpVector[2] * layerThickness;
     warpedPoints->SetPoint(i,warpedPoint);
     }
-
-  vtkIdType npts, *pts;
-  vtkIdList* cellIds = vtkIdList::New();
-  vtkIdType cellId;
-
-  vtkIdList* neighborIds = vtkIdList::New();
-  vtkIdList* edgePointIds = vtkIdList::New();
-  vtkIdList* edgeNeighborCellIds = vtkIdList::New();
-
-  for (vtkIdType j=0; j<numberOfInputPoints; j++)
+  });
+
+  const vtkIdType* neighborOffsets = &this->Topology->NeighborOffsets[0];
+  const vtkIdType* neighbors = this->Topology->Neighbors.empty() ? NULL : &this->Topology->Neighbors[0];
+  const char* onEdge = this->Topology->OnEdge.empty() ? NULL : &this->Topology->OnEdge[0];
+  const std::vector<vtkIdType>& componentOffsets = this->Topology->ComponentOffsets;
+  const std::vector<vtkIdType>& componentPoints = this->Topology->ComponentPoints;
+  vtkIdType numberOfComponents = componentOffsets.size() - 1;
+
+  // each component is smoothed by one thread in ascending point order,
+  // which gives the same result as a single pass over all points
+  std::atomic<vtkIdType> nextComponent(0);
+  vtkvmtkBoundaryLayerGeneratorParallelFor(numberOfComponents,1,
+    [&](vtkIdType, vtkIdType)
+  {
+  double warpedPoint[3], neighborPoint[3], barycenter[3];
+  for (vtkIdType c=nextComponent++; c<numberOfComponents; c=nextComponent++)
     {
-    input->GetPointCells(j,cellIds);
-
-    neighborIds->Initialize();
-
-    vtkIdType numberOfNeighborCells = cellIds->GetNumberOfIds();
-    for (int k=0; k<numberOfNeighborCells; k++)
+    for (vtkIdType p=componentOffsets[c]; p<componentOffsets[c+1]; p++)
       {
-      cellId = cellIds->GetId(k);
-      input->GetCellPoints(cellId,npts,pts);
-
-      neighborIds->InsertUniqueId(pts[0]);
-      neighborIds->InsertUniqueId(pts[1]);
-      neighborIds->InsertUniqueId(pts[2]);
-      }
-    neighborIds->DeleteId(j);
-
-    int numberOfNeighbors = neighborIds->GetNumberOfIds();
+      vtkIdType j = componentPoints[p];
 
-    bool onEdge = false;
-    edgePointIds->Initialize();
-    edgeNeighborCellIds->Initialize();
-    edgePointIds->InsertId(0,j);
-    for (int k=0; k<numberOfNeighbors; k++)
-      {
-      edgePointIds->InsertId(1,neighborIds->GetId(k));
-      input->GetCellNeighbors(-1,edgePointIds,edgeNeighborCellIds);
-      if (edgeNeighborCellIds->GetNumberOfIds() < 2)
+      if (onEdge[j])
         {
-        onEdge = true;
-        break;
+        continue;
         }
-      }
 
-    if (onEdge)
-      {
-      continue;
-      }
+      int numberOfNeighbors = neighborOffsets[j+1] - neighborOffsets[j];
 
-    double barycenter[3];
-    barycenter[0] = barycenter[1] = barycenter[2] = 0.0;
-    double neighborPoint[3];
-    for (int k=0; k<numberOfNeighbors; k++)
-      {
-      warpedPoints->GetPoint(neighborIds->GetId(k),neighborPoint);
-      barycenter[0] += neighborPoint[0];
-      barycenter[1] += neighborPoint[1];
-      barycenter[2] += neighborPoint[2];
-      }
-    barycenter[0] /= numberOfNeighbors;
-    barycenter[1] /= numberOfNeighbors;
-    barycenter[2] /= numberOfNeighbors;
+      barycenter[0] = barycenter[1] = barycenter[2] = 0.0;
+      for (vtkIdType k=neighborOffsets[j]; k<neighborOffsets[j+1]; k++)
+        {
+        warpedPoints->GetPoint(neighbors[k],neighborPoint);
+        barycenter[0] += neighborPoint[0];
+        barycenter[1] += neighborPoint[1];
+        barycenter[2] += neighborPoint[2];
+        }
+      barycenter[0] /= numberOfNeighbors;
+      barycenter[1] /= numberOfNeighbors;
+      barycenter[2] /= numberOfNeighbors;
 
-    warpedPoints->GetPoint(j,warpedPoint);
+      warpedPoints->GetPoint(j,warpedPoint);
 
-    // TODO: find out if the current surface is intersecting the original
-    // input surface (not the input surface at this iteration) and in that
-    // case (before it gets too close) stop the warp
+      // TODO: find out if the current surface is intersecting the original
+      // input surface (not the input surface at this iteration) and in that
+      // case (before it gets too close) stop the warp
 
-    warpedPoint[0] += relaxation * (barycenter[0] - warpedPoint[0]);
-    warpedPoint[1] += relaxation * (barycenter[1] - warpedPoint[1]);
-    warpedPoint[2] += relaxation * (barycenter[2] - warpedPoint[2]);
+      warpedPoint[0] += relaxation * (barycenter[0] - warpedPoint[0]);
+      warpedPoint[1] += relaxation * (barycenter[1] - warpedPoint[1]);
+      warpedPoint[2] += relaxation * (barycenter[2] - warpedPoint[2]);
 
-    warpedPoints->SetPoint(j,warpedPoint);
+      warpedPoints->SetPoint(j,warpedPoint);
+      }
     }
-
-  cellIds->Delete();
-  neighborIds->Delete();
+  });
 }
 
 void vtkvmtkBoundaryLayerGenerator::PrintSelf(ostream& os, vtkIndent indent)
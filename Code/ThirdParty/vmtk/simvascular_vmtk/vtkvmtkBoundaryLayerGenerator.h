@@ -31,6 +31,7 @@ Version:   $Revision: 1.4 $
 class vtkPoints;
 class vtkUnsignedCharArray;
 class vtkDataArray;
+class vtkvmtkBoundaryLayerGeneratorTopology;
 
 class VTK_VMTK_MISC_EXPORT vtkvmtkBoundaryLayerGenerator : public vtkUnstructuredGridAlgorithm
 {
@@ -117,6 +118,7 @@ class VTK_VMTK_MISC_EXPORT vtkvmtkBoundaryLayerGenerator : public vtkUnstructure
   virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
 
   void BuildWarpVectors(vtkUnstructuredGrid* input);
+  void BuildTopology(vtkUnstructuredGrid* input);
   void IncrementalWarpPoints(vtkUnstructuredGrid* input, vtkPoints* basePoints, vtkPoints* warpedPoints, int substep, int numberOfSubsteps, double relaxation);
   void IncrementalWarpVectors(vtkUnstructuredGrid* input, int numberOfSubsteps, double relaxation);
   int CheckTangle(vtkUnstructuredGrid* input, vtkUnsignedCharArray* checkArray);
@@ -157,6 +159,10 @@ class VTK_VMTK_MISC_EXPORT vtkvmtkBoundaryLayerGenerator : public vtkUnstructure
   double Relaxation;
   double LocalCorrectionFactor;
 
+  // point neighborhoods and connected components of the input surface,
+  // gathered once per RequestData
+  vtkvmtkBoundaryLayerGeneratorTopology* Topology;
+
   private:
   vtkvmtkBoundaryLayerGenerator(const vtkvmtkBoundaryLayerGenerator&);  // Not implemented.
   void operator=(const vtkvmtkBoundaryLayerGenerator&);  // Not implemented.